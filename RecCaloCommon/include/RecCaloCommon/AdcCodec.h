@@ -0,0 +1,111 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/AdcCodec.h
+ * @date Oct, 2026
+ * @brief Conversion of pulse amplitudes to and from integer ADC counts.
+ */
+
+#ifndef RECCALOCOMMON_ADCCODEC_H
+#define RECCALOCOMMON_ADCCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Conversion of pulse amplitudes to and from integer ADC counts.
+ *
+ * An amplitude @c x is stored as the count
+ *   round(pedestal + gain * x),
+ * clipped to the range of an ADC of @c nBits bits, [0, 2^nBits - 1].
+ * Decoding gives back (count - pedestal) / gain, so the quantization
+ * error is at most 0.5 / gain for amplitudes within the range.
+ *
+ * Storing pulses as small integers rather than floats makes them much
+ * more compressible, since the low bits of the floats are mostly noise.
+ */
+class AdcCodec {
+public:
+  /**
+   * @brief Constructor.
+   * @param gain ADC counts per unit of amplitude; must be positive.
+   * @param pedestal ADC count of a zero amplitude.
+   * @param nBits Number of bits of the ADC, from 1 to 31.
+   *
+   * Throws std::invalid_argument if @c gain or @c nBits is out of range.
+   */
+  AdcCodec(float gain, float pedestal, unsigned nBits);
+
+  /**
+   * @brief Convert amplitudes to ADC counts.
+   * @param amplitudes The amplitudes.
+   * @param[out] counts The counts, of the same size as @c amplitudes.
+   *
+   * Returns the number of samples clipped to the range of the ADC
+   * (including NaN amplitudes, which are stored as 0).
+   */
+  size_t encode(std::span<const float> amplitudes, std::span<int32_t> counts) const;
+
+  /**
+   * @brief Convert ADC counts to amplitudes.
+   * @param counts The counts.
+   * @param[out] amplitudes The amplitudes, of the same size as @c counts.
+   */
+  void decode(std::span<const int32_t> counts, std::span<float> amplitudes) const;
+
+  /**
+   * @brief Convert one ADC count to an amplitude.
+   * @param count The count.
+   */
+  float decode(int32_t count) const;
+
+  /// ADC counts per unit of amplitude.
+  float gain() const;
+
+  /// ADC count of a zero amplitude.
+  float pedestal() const;
+
+  /// Number of bits of the ADC.
+  unsigned nBits() const;
+
+  /// Largest ADC count.
+  int32_t maxCount() const;
+
+private:
+  float m_gain;
+  float m_invGain;
+  float m_pedestal;
+  unsigned m_nBits;
+  int32_t m_maxCount;
+};
+
+/**
+ * @brief Convert one ADC count to an amplitude.
+ */
+inline float AdcCodec::decode(int32_t count) const { return (static_cast<float>(count) - m_pedestal) * m_invGain; }
+
+/**
+ * @brief ADC counts per unit of amplitude.
+ */
+inline float AdcCodec::gain() const { return m_gain; }
+
+/**
+ * @brief ADC count of a zero amplitude.
+ */
+inline float AdcCodec::pedestal() const { return m_pedestal; }
+
+/**
+ * @brief Number of bits of the ADC.
+ */
+inline unsigned AdcCodec::nBits() const { return m_nBits; }
+
+/**
+ * @brief Largest ADC count.
+ */
+inline int32_t AdcCodec::maxCount() const { return m_maxCount; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_ADCCODEC_H
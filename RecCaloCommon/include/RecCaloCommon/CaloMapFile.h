@@ -0,0 +1,194 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CaloMapFile.h
+ * @date Oct, 2026
+ * @brief Memory-mappable binary file holding per-cell maps.
+ */
+
+#ifndef RECCALOCOMMON_CALOMAPFILE_H
+#define RECCALOCOMMON_CALOMAPFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Memory-mappable binary file holding per-cell maps.
+ *
+ * The neighbour, noise, and crosstalk maps were originally read from ROOT
+ * TTrees entry-by-entry, which can take tens of seconds at the start
+ * of each job.  This class defines a simple flat binary format for the
+ * same information which can be mapped read-only into memory and used
+ * in place, without any parsing.
+ *
+ * A file consists of:
+ *  - A fixed-size header, giving a magic string, the format version,
+ *    the kind of map, a tag to check the byte order, the number of sections,
+ *    the file size, checksums of the header and of the payload,
+ *    and an optional user tag (see below).
+ *  - A table of section descriptors.  Each gives a section ID, the size of one
+ *    element, the number of elements, and the offset of the data from the
+ *    start of the file.
+ *  - The section data, each aligned to 64 bytes.
+ *
+ * Which sections are present depends on the kind of map:
+ *  - NEIGHBOURS: CELLIDS (sorted uint64), OFFSETS (uint32, one more than
+ *    the number of cells), NEIGHBOUR_INDICES (uint32 indices into CELLIDS).
+ *    This is the layout of NeighbourTable.
+ *  - NOISE: CELLIDS (sorted uint64), NOISE_RMS and NOISE_OFFSET (double).
+ *  - CROSSTALK: CELLIDS (sorted uint64), OFFSETS (uint32), NEIGHBOUR_IDS
+ *    (uint64), COEFFICIENTS (double).
+ *  - CELLLIST: CELLIDS (uint64).  This is the layout of CellIDList.
+ *
+ * The user tag is not interpreted by this class.  CaloCellConstantsSvc
+ * uses it to record the geometry and version keys of the files it
+ * publishes, so that stale files can be recognized.
+ *
+ * The header checksum is always verified when a file is opened.  Verifying
+ * the payload checksum requires reading the entire file, so it may
+ * optionally be skipped.
+ */
+class CaloMapFile {
+public:
+  /// The kind of map held in a file.
+  enum Kind : uint32_t { NEIGHBOURS = 1, NOISE = 2, CROSSTALK = 3, CELLLIST = 4 };
+
+  /// Identifiers for the sections of a file.
+  enum SectionID : uint32_t {
+    CELLIDS = 1,
+    OFFSETS = 2,
+    NEIGHBOUR_INDICES = 3,
+    NOISE_RMS = 4,
+    NOISE_OFFSET = 5,
+    NEIGHBOUR_IDS = 6,
+    COEFFICIENTS = 7
+  };
+
+  /// Current version of the format.
+  static constexpr uint32_t VERSION = 1;
+
+  /// A section to be written.
+  struct Section {
+    uint32_t id;
+    uint32_t elementSize;
+    uint64_t count;
+    const void* data;
+
+    template <class T>
+    Section(SectionID theId, std::span<const T> theData)
+        : id(theId), elementSize(sizeof(T)), count(theData.size()), data(theData.data()) {}
+  };
+
+  /**
+   * @brief Open and map a file.
+   * @param path Path of the file to open.
+   * @param kind Expected kind of map.
+   * @param verifyChecksum If true, verify the checksum of the payload.
+   *
+   * Throws CaloMapFileException on error.
+   */
+  CaloMapFile(const std::string& path, Kind kind, bool verifyChecksum = true);
+
+  /// Unmap the file.
+  ~CaloMapFile();
+
+  CaloMapFile(const CaloMapFile&) = delete;
+  CaloMapFile& operator=(const CaloMapFile&) = delete;
+
+  /**
+   * @brief Return the data of a section.
+   * @param id ID of the section.
+   *
+   * Throws CaloMapFileException if the section is missing or if its
+   * element size does not match @c T.
+   */
+  template <class T>
+  std::span<const T> get(SectionID id) const;
+
+  /**
+   * @brief Return the user tag with which the file was written.
+   */
+  uint64_t tag() const;
+
+  /**
+   * @brief Test if a file starts with the magic string for this format.
+   * @param path Path of the file to test.
+   */
+  static bool isCaloMapFile(const std::string& path);
+
+  /**
+   * @brief Write a file.
+   * @param path Path of the file to write.
+   * @param kind Kind of map.
+   * @param sections Sections to write.
+   * @param tag User tag to record in the header.
+   *
+   * The file is first written under a temporary name unique to this
+   * process, and then renamed, so that readers never see a partial file.
+   * Throws CaloMapFileException on error.
+   */
+  static void write(const std::string& path, Kind kind, std::span<const Section> sections, uint64_t tag = 0);
+
+  /**
+   * @brief Compute the checksum used for the file contents.
+   * @param data Data over which to compute the checksum.
+   */
+  static uint64_t checksum(std::span<const std::byte> data);
+
+  /**
+   * @brief Exceptions thrown on errors.
+   */
+  class CaloMapFileException : public std::runtime_error {
+  public:
+    CaloMapFileException(const std::string& what);
+  };
+
+private:
+  /// Descriptor for one section, as stored in the file.
+  struct SectionDesc {
+    uint32_t id;
+    uint32_t elementSize;
+    uint64_t count;
+    uint64_t offset;
+  };
+
+  /// Return the data for a section, checking the element size.
+  const void* getRaw(SectionID id, size_t elementSize, size_t& count) const;
+
+  /// Path of the file, for error reporting.
+  std::string m_path;
+
+  /// The mapped file.
+  void* m_addr = nullptr;
+  size_t m_size = 0;
+
+  /// Section descriptors.
+  std::span<const SectionDesc> m_sections;
+
+  /// User tag from the header.
+  uint64_t m_tag = 0;
+};
+
+/**
+ * @brief Return the data of a section.
+ */
+template <class T>
+std::span<const T> CaloMapFile::get(SectionID id) const {
+  size_t count = 0;
+  const void* p = getRaw(id, sizeof(T), count);
+  return std::span<const T>(static_cast<const T*>(p), count);
+}
+
+/**
+ * @brief Return the user tag with which the file was written.
+ */
+inline uint64_t CaloMapFile::tag() const { return m_tag; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CALOMAPFILE_H
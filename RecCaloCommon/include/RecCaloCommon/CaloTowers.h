@@ -0,0 +1,51 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CaloTowers.h
+ * @date Oct, 2026
+ * @brief Calorimeter towers of one event, as built by a tower tool.
+ */
+
+#ifndef RECCALOCOMMON_CALOTOWERS_H
+#define RECCALOCOMMON_CALOTOWERS_H
+
+#include "RecCaloCommon/CellMarks.h"
+#include "RecCaloCommon/TowerGrid.h"
+
+// datamodel
+#include "edm4hep/CalorimeterHit.h"
+
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Calorimeter towers of one event, as built by a tower tool.
+ *
+ * Returned by ITowerTool::buildTowers and ITowerToolThetaModule::buildTowers,
+ * and passed back to attachCells, so that the tools keep no per-event state.
+ * The cell indices in the grid refer to @c cells; a cell spanning several
+ * towers appears once in @c cells.
+ */
+struct CaloTowers {
+  /**
+   * @brief Constructor.
+   * @param nRows Number of towers in eta (or theta).
+   * @param nPhi Number of towers in phi.
+   */
+  CaloTowers(int nRows = 0, int nPhi = 0) : grid(nRows, nPhi) {}
+
+  /// Tower energies, and the cells in each tower.
+  TowerGrid grid;
+  /// Cells in the towers, if requested when building them.
+  std::vector<edm4hep::CalorimeterHit> cells;
+  /// Number of cells used to build the towers (zero for an empty event).
+  unsigned int nCells = 0;
+  /// Indices in @c cells of the cells attached to the current cluster, used by attachCells.
+  /// Mutable scratch space reused for all clusters of the event, so the towers must not be
+  /// shared between threads while clusters are being made.
+  mutable CellMarks attachedCells;
+};
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CALOTOWERS_H
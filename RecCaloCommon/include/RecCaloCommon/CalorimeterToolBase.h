@@ -12,6 +12,7 @@
 #include "DD4hep/Readout.h"
 #include "GaudiKernel/AlgTool.h"
 #include "GaudiKernel/ServiceHandle.h"
+#include "RecCaloCommon/CellIDList.h"
 #include "RecCaloCommon/ICaloCellConstantsSvc.h"
 #include "RecCaloCommon/ICalorimeterTool.h"
 #include "k4Interface/IGeoSvc.h"
@@ -30,12 +31,12 @@ public:
    */
   virtual StatusCode initialize() override;
 
-  /** Return a vector of all existing cells in the current geometry.
+  /** Return all existing cells in the current geometry.
    *
    * The result is sorted and unique.
-   * Returns an empty vector on error.
+   * Returns an empty span on error.
    */
-  virtual const std::vector<CellID>& cellIDs() const final override;
+  virtual std::span<const CellID> cellIDs() const final override;
 
   /** Prepare a map of all existing cells in current geometry.
    *   @param[out] aCells map of existing cells (and deposited energy, set to 0)
@@ -74,16 +75,16 @@ private:
   ServiceHandle<IGeoSvc> m_geoSvc{this, "GeoSvc", "GeoSvc"};
 
   /// Handle to the cell constants service.
-  /// Used to hold the set of cell IDs.
+  /// Used to hold the set of cell IDs, possibly shared between processes.
   ServiceHandle<k4::recCalo::ICaloCellConstantsSvc> m_constantsSvc{this, "CaloCellConstantsSvc",
                                                                    "k4::recCalo::CaloCellConstantsSvc", ""};
 
   /// Resolved detector readout.
   dd4hep::Readout m_readout;
 
-  // Pointer to the vector of cells.  The vector itself is stored in the
+  // Pointer to the list of cells.  The list itself is stored in the
   // constants service; we create it if it's not already there.
-  const std::vector<CellID>* m_cells;
+  const k4::recCalo::CellIDList* m_cells = nullptr;
 };
 
 #endif // not RECCALOCOMMON_CALORIMETERTOOLBASE_H
@@ -0,0 +1,216 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CellEnergyAccumulator.h
+ * @date Oct, 2026
+ * @brief Per-event sum of energies per cell, using dense cell indices.
+ */
+
+#ifndef RECCALOCOMMON_CELLENERGYACCUMULATOR_H
+#define RECCALOCOMMON_CELLENERGYACCUMULATOR_H
+
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Per-event sum of energies per cell, using dense cell indices.
+ *
+ * Summing energies per cell was done with a std::unordered_map from
+ * cell ID to energy, rebuilt for each event.  This instead uses
+ * an ICaloIndexer to map cell IDs to dense indices, and holds the energies
+ * in an array indexed by these.  This is a sparse set: along with the
+ * energies, we keep a list of the indices touched in the current event
+ * and, for each index, the generation (event) in which it was last touched.
+ * Clearing the accumulator then only requires incrementing the generation
+ * and clearing the list of touched indices, independent of the number
+ * of cells.  Accumulating an energy is a lookup in the indexer
+ * plus an array access.
+ *
+ * Cell IDs which the indexer does not know, or all cells if no indexer
+ * is given, are held in a separate hash map.
+ *
+ * Iteration is in the order in which cells were first touched,
+ * or in increasing index order after calling @c sortByIndex; cells
+ * not known to the indexer come last.
+ *
+ * An accumulator is meant to be reused between events, so that its arrays
+ * are allocated only once; see ObjectPool for use in re-entrant algorithms.
+ */
+class CellEnergyAccumulator {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /**
+   * @brief Constructor.
+   * @param indexer Indexer used to map cell IDs to indices.  May be null,
+   *                in which case all cells are held in the hash map.
+   *                It must outlive the accumulator.
+   */
+  CellEnergyAccumulator(const ICaloIndexer* indexer);
+
+  /**
+   * @brief Add an energy to a cell.
+   * @param id The cell ID.
+   * @param e The energy to add.
+   */
+  void add(CellID id, double e);
+
+  /**
+   * @brief Add energies to a set of cells.
+   * @param ids The cell IDs.
+   * @param e The energies to add, in the same order as @c ids.
+   *
+   * This uses the batch lookup of the indexer.
+   */
+  void add(std::span<const CellID> ids, std::span<const double> e);
+
+  /**
+   * @brief Return the energy of a cell, or 0 if it has not been touched.
+   * @param id The cell ID.
+   */
+  double energy(CellID id) const;
+
+  /**
+   * @brief Test if a cell has been touched since the last @c clear.
+   * @param id The cell ID.
+   */
+  bool contains(CellID id) const;
+
+  /**
+   * @brief Number of cells touched since the last @c clear.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Test if no cells have been touched since the last @c clear.
+   */
+  bool empty() const;
+
+  /**
+   * @brief Forget all cells.  The cost is independent of the number of cells.
+   */
+  void clear();
+
+  /**
+   * @brief Sort the touched cells known to the indexer by index,
+   *        so that they are iterated in a reproducible order.
+   */
+  void sortByIndex();
+
+  /**
+   * @brief Call a function for each touched cell.
+   * @param f Called as f(CellID, double).
+   */
+  template <class FUNC>
+  void forEach(FUNC&& f) const;
+
+  /**
+   * @brief Append the touched cells and their energies to a vector.
+   * @param[out] out The vector to which to append.
+   */
+  void exportTo(std::vector<std::pair<CellID, double>>& out) const;
+
+  /**
+   * @brief Append all cells of a list, and any other touched cells, to a vector.
+   * @param allCells The cells to export, whether or not they have been touched.
+   *                 If there is an indexer, these should be the cells
+   *                 of the indexer.
+   * @param[out] out The vector to which to append.  Cells which have not
+   *                 been touched are given zero energy.
+   */
+  void exportAll(std::span<const CellID> allCells, std::vector<std::pair<CellID, double>>& out) const;
+
+  /**
+   * @brief The indexer used by this accumulator (may be null).
+   */
+  const ICaloIndexer* indexer() const;
+
+private:
+  /// Add an energy to a cell given by index.
+  void addIndex(index_t ndx, double e);
+
+  /// The indexer used to map cell IDs to indices.
+  const ICaloIndexer* m_indexer;
+
+  /// The IDs of the cells of the indexer, by index.
+  std::span<const CellID> m_cellIDs;
+
+  /// The energy per index.  Valid only if m_gen for the index is current.
+  std::vector<double> m_energies;
+
+  /// The generation in which each index was last touched.
+  std::vector<uint32_t> m_gen;
+
+  /// The current generation.
+  uint32_t m_curGen = 1;
+
+  /// Indices touched in the current generation.
+  std::vector<index_t> m_touched;
+
+  /// Energies of cells not known to the indexer.
+  std::unordered_map<CellID, double> m_overflow;
+};
+
+/**
+ * @brief Add an energy to a cell given by index.
+ */
+inline void CellEnergyAccumulator::addIndex(index_t ndx, double e) {
+  if (m_gen[ndx] != m_curGen) {
+    m_gen[ndx] = m_curGen;
+    m_energies[ndx] = e;
+    m_touched.push_back(ndx);
+  } else {
+    m_energies[ndx] += e;
+  }
+}
+
+/**
+ * @brief Add an energy to a cell.
+ */
+inline void CellEnergyAccumulator::add(CellID id, double e) {
+  index_t ndx = m_indexer ? m_indexer->index(id) : INVALID;
+  if (ndx != INVALID) {
+    addIndex(ndx, e);
+  } else {
+    m_overflow[id] += e;
+  }
+}
+
+/**
+ * @brief Number of cells touched since the last @c clear.
+ */
+inline size_t CellEnergyAccumulator::size() const { return m_touched.size() + m_overflow.size(); }
+
+/**
+ * @brief Test if no cells have been touched since the last @c clear.
+ */
+inline bool CellEnergyAccumulator::empty() const { return m_touched.empty() && m_overflow.empty(); }
+
+/**
+ * @brief Call a function for each touched cell.
+ */
+template <class FUNC>
+void CellEnergyAccumulator::forEach(FUNC&& f) const {
+  for (index_t ndx : m_touched) {
+    f(m_cellIDs[ndx], m_energies[ndx]);
+  }
+  for (const auto& [id, e] : m_overflow) {
+    f(id, e);
+  }
+}
+
+/**
+ * @brief The indexer used by this accumulator (may be null).
+ */
+inline const ICaloIndexer* CellEnergyAccumulator::indexer() const { return m_indexer; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CELLENERGYACCUMULATOR_H
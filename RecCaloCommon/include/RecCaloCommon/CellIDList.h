@@ -0,0 +1,94 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CellIDList.h
+ * @date Oct, 2026
+ * @brief A list of cell IDs which may be shared between processes.
+ */
+
+#ifndef RECCALOCOMMON_CELLIDLIST_H
+#define RECCALOCOMMON_CELLIDLIST_H
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief A list of cell IDs which may be shared between processes.
+ *
+ * This is used to hold the lists of all cells of a calorimeter in
+ * CaloCellConstantsSvc.  The list may either own its contents or be a view
+ * of a memory-mapped CaloMapFile, in which case the contents may be shared
+ * between processes.  Copies of a list share the same contents.
+ */
+class CellIDList {
+public:
+  using CellID = ICaloIndexer::CellID;
+
+  /// Kind of CaloMapFile used to hold this list.
+  static constexpr CaloMapFile::Kind MAP_KIND = CaloMapFile::CELLLIST;
+
+  /**
+   * @brief Constructor.
+   * @param cells The cell IDs, passed via move.  The order is preserved.
+   */
+  CellIDList(std::vector<CellID>&& cells);
+
+  /**
+   * @brief Return the cell IDs.
+   */
+  std::span<const CellID> cellIDs() const;
+
+  /**
+   * @brief Number of cells in the list.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Map a list from a binary file.
+   * @param path Path of the file, written by @c writeMapFile.
+   * @param verifyChecksum If true, verify the checksum of the file contents.
+   */
+  static CellIDList fromMapFile(const std::string& path, bool verifyChecksum = true);
+
+  /**
+   * @brief Make a list viewing an already-opened binary file.
+   * @param file The file, which is kept alive as long as the list exists.
+   */
+  static CellIDList fromMapFile(std::shared_ptr<const CaloMapFile> file);
+
+  /**
+   * @brief Write the list to a binary file (see CaloMapFile).
+   * @param path Path of the file to write.
+   * @param tag User tag to record in the file header.
+   */
+  void writeMapFile(const std::string& path, uint64_t tag = 0) const;
+
+private:
+  /// Constructor from an existing array.
+  CellIDList(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs);
+
+  /// Object owning the array.
+  std::shared_ptr<const void> m_storage;
+
+  /// The cell IDs.
+  std::span<const CellID> m_cellIDs;
+};
+
+/**
+ * @brief Return the cell IDs.
+ */
+inline auto CellIDList::cellIDs() const -> std::span<const CellID> { return m_cellIDs; }
+
+/**
+ * @brief Number of cells in the list.
+ */
+inline size_t CellIDList::size() const { return m_cellIDs.size(); }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CELLIDLIST_H
@@ -0,0 +1,88 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CellMarks.h
+ * @date Oct, 2026
+ * @brief Set of cell indices, cleared in constant time.
+ */
+
+#ifndef RECCALOCOMMON_CELLMARKS_H
+#define RECCALOCOMMON_CELLMARKS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Set of cell indices, cleared in constant time.
+ *
+ * Used to avoid attaching a cell twice to a cluster when it is found
+ * in several towers.  Each index has a generation counter, and an
+ * index is marked if its counter equals the current generation, so
+ * that starting a new set (for the next cluster) only increments the
+ * generation.  The counters are reset only when the generation wraps
+ * around.  Marking and testing an index are a single array access, in
+ * place of a search through the indices already seen.
+ */
+class CellMarks {
+public:
+  /**
+   * @brief Start a new, empty set.
+   * @param n The indices to be marked will be smaller than this.
+   */
+  void clear(size_t n);
+
+  /**
+   * @brief Mark an index.
+   * @param ndx The index, smaller than the size given to @c clear.
+   * @return true if the index was not already marked.
+   */
+  bool mark(size_t ndx);
+
+  /**
+   * @brief Test whether an index is marked.
+   * @param ndx The index, smaller than the size given to @c clear.
+   */
+  bool marked(size_t ndx) const;
+
+private:
+  /// Generation in which each index was last marked.
+  std::vector<uint32_t> m_marks;
+  /// Current generation; never zero, so that new counters are unmarked.
+  uint32_t m_generation = 0;
+};
+
+/**
+ * @brief Start a new, empty set.
+ */
+inline void CellMarks::clear(size_t n) {
+  if (m_marks.size() < n) {
+    m_marks.resize(n, 0);
+  }
+  if (++m_generation == 0) {
+    std::fill(m_marks.begin(), m_marks.end(), 0);
+    m_generation = 1;
+  }
+}
+
+/**
+ * @brief Mark an index.
+ */
+inline bool CellMarks::mark(size_t ndx) {
+  if (m_marks[ndx] == m_generation) {
+    return false;
+  }
+  m_marks[ndx] = m_generation;
+  return true;
+}
+
+/**
+ * @brief Test whether an index is marked.
+ */
+inline bool CellMarks::marked(size_t ndx) const { return m_marks[ndx] == m_generation; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CELLMARKS_H
@@ -0,0 +1,183 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CellNoiseTable.h
+ * @date Oct, 2026
+ * @brief Table of per-cell noise constants.
+ */
+
+#ifndef RECCALOCOMMON_CELLNOISETABLE_H
+#define RECCALOCOMMON_CELLNOISETABLE_H
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Table of per-cell noise constants.
+ *
+ * Holds the noise RMS and offset for a set of cells, as parallel arrays
+ * sorted by cell ID.  As for NeighbourTable, the arrays may either be
+ * owned by the table or be a view of a memory-mapped CaloMapFile.
+ */
+class CellNoiseTable {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /// Kind of CaloMapFile used to hold this table.
+  static constexpr CaloMapFile::Kind MAP_KIND = CaloMapFile::NOISE;
+
+  /**
+   * @brief Constructor.
+   * @param cells IDs of the cells, in any order.
+   * @param noiseRMS Noise RMS of each cell.
+   * @param noiseOffset Noise offset of each cell.
+   *
+   * If a cell ID is given more than once, the first entry is used.
+   * Throws CellNoiseTableException if the input sizes differ.
+   */
+  CellNoiseTable(std::span<const CellID> cells, std::span<const double> noiseRMS,
+                 std::span<const double> noiseOffset);
+
+  /**
+   * @brief Constructor from existing arrays.
+   * @param storage Object owning the arrays; it is kept alive as long
+   *                as the table (or any copy of it) exists.
+   * @param cellIDs Sorted list of cell IDs.
+   * @param noiseRMS Noise RMS of each cell.
+   * @param noiseOffset Noise offset of each cell.
+   *
+   * Throws CellNoiseTableException if the array sizes differ.
+   */
+  CellNoiseTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                 std::span<const double> noiseRMS, std::span<const double> noiseOffset);
+
+  /**
+   * @brief Number of cells in the table.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+   * @param id The cell ID to look for.
+   */
+  index_t index(CellID id) const;
+
+  /**
+   * @brief Return the noise [rms, offset] for a cell, or [0, 0] if it is
+   *        not known.
+   * @param id The cell ID to look for.
+   */
+  std::pair<double, double> noise(CellID id) const;
+
+  /**
+   * @brief Return the sorted cell IDs.
+   */
+  std::span<const CellID> cellIDs() const;
+
+  /**
+   * @brief Return the noise RMS values, indexed like @c cellIDs().
+   */
+  std::span<const double> noiseRMS() const;
+
+  /**
+   * @brief Return the noise offsets, indexed like @c cellIDs().
+   */
+  std::span<const double> noiseOffset() const;
+
+  /**
+   * @brief Map a table from a binary file.
+   * @param path Path of the file, written by @c writeMapFile.
+   * @param verifyChecksum If true, verify the checksum of the file contents.
+   */
+  static CellNoiseTable fromMapFile(const std::string& path, bool verifyChecksum = true);
+
+  /**
+   * @brief Make a table viewing an already-opened binary file.
+   * @param file The file, which is kept alive as long as the table exists.
+   */
+  static CellNoiseTable fromMapFile(std::shared_ptr<const CaloMapFile> file);
+
+  /**
+   * @brief Write the table to a binary file (see CaloMapFile).
+   * @param path Path of the file to write.
+   * @param tag User tag to record in the file header.
+   */
+  void writeMapFile(const std::string& path, uint64_t tag = 0) const;
+
+  /**
+   * @brief Exceptions thrown by the ctor.
+   */
+  class CellNoiseTableException : public std::runtime_error {
+  public:
+    CellNoiseTableException(const std::string& what);
+  };
+
+private:
+  /// Arrays owned by the table, if it was built from unsorted input.
+  struct Storage {
+    std::vector<CellID> cellIDs;
+    std::vector<double> noiseRMS;
+    std::vector<double> noiseOffset;
+  };
+
+  /// Object owning the arrays.
+  std::shared_ptr<const void> m_storage;
+
+  std::span<const CellID> m_cellIDs;
+  std::span<const double> m_noiseRMS;
+  std::span<const double> m_noiseOffset;
+};
+
+/**
+ * @brief Number of cells in the table.
+ */
+inline size_t CellNoiseTable::size() const { return m_cellIDs.size(); }
+
+/**
+ * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+ */
+inline auto CellNoiseTable::index(CellID id) const -> index_t {
+  auto it = std::lower_bound(m_cellIDs.begin(), m_cellIDs.end(), id);
+  if (it != m_cellIDs.end() && *it == id)
+    return it - m_cellIDs.begin();
+  return INVALID;
+}
+
+/**
+ * @brief Return the noise [rms, offset] for a cell.
+ */
+inline std::pair<double, double> CellNoiseTable::noise(CellID id) const {
+  index_t ndx = index(id);
+  if (ndx != INVALID)
+    return std::make_pair(m_noiseRMS[ndx], m_noiseOffset[ndx]);
+  return std::make_pair(0., 0.);
+}
+
+/**
+ * @brief Return the sorted cell IDs.
+ */
+inline auto CellNoiseTable::cellIDs() const -> std::span<const CellID> { return m_cellIDs; }
+
+/**
+ * @brief Return the noise RMS values.
+ */
+inline std::span<const double> CellNoiseTable::noiseRMS() const { return m_noiseRMS; }
+
+/**
+ * @brief Return the noise offsets.
+ */
+inline std::span<const double> CellNoiseTable::noiseOffset() const { return m_noiseOffset; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CELLNOISETABLE_H
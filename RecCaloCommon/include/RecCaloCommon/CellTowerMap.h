@@ -0,0 +1,138 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CellTowerMap.h
+ * @date Oct, 2026
+ * @brief Precomputed towers covered by each cell, indexed by an ICaloIndexer.
+ */
+
+#ifndef RECCALOCOMMON_CELLTOWERMAP_H
+#define RECCALOCOMMON_CELLTOWERMAP_H
+
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Precomputed towers covered by each cell, indexed by an ICaloIndexer.
+ *
+ * The tower tools find the towers of each cell of each event from its
+ * position (or its segmentation), with the transcendental functions and
+ * divisions that this involves, although the result depends only on the
+ * cell ID.
+ *
+ * Here, the towers covered by every cell known to an indexer are found
+ * once, as a list of (tower, weight) entries: the flat index of the
+ * tower in the TowerGrid, and the factor applied to the cell energy to
+ * give its contribution to the tower (for example, sin(theta) times the
+ * fraction of the cell in the tower).  A cell may cover several towers,
+ * or none if it is not used for the towers.  The entries are stored in
+ * compressed-sparse-row form, in the order of the indexer's
+ * @c cellIDs(), so that filling the towers of an event is a scatter-add.
+ *
+ * The map remembers the list of cell IDs for which it was made, which
+ * must outlive it.  The weights are rounded to single precision.
+ */
+class CellTowerMap {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /// A tower covered by a cell.
+  struct Entry {
+    /// Flat index of the tower, as given by TowerGrid::tower.
+    uint32_t tower;
+    /// Factor applied to the cell energy for this tower.
+    float weight;
+  };
+
+  /**
+   * @brief Default constructor: a map with no cells.
+   */
+  CellTowerMap() = default;
+
+  /**
+   * @brief Constructor.
+   * @param indexer The indexer for the cells.  Its list of cell IDs must
+   *                remain valid for the lifetime of the map.
+   * @param towers Callable as <code>towers(id, entries)</code>, appending
+   *               to the std::vector<Entry> @c entries the towers covered
+   *               by the cell @c id.
+   *
+   * @c towers is called once for each cell of @c indexer.
+   */
+  template <class TOWERS>
+  CellTowerMap(const ICaloIndexer& indexer, TOWERS&& towers);
+
+  /**
+   * @brief Number of cells in the map.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Total number of (cell, tower) entries.
+   */
+  size_t nEntries() const;
+
+  /**
+   * @brief Return the towers covered by the cell with index @c ndx.
+   */
+  std::span<const Entry> entries(index_t ndx) const;
+
+  /**
+   * @brief Return the cell IDs for which the map was made.
+   */
+  std::span<const CellID> cellIDs() const;
+
+private:
+  /// The cell IDs for which the map was made.
+  std::span<const CellID> m_cellIDs;
+  /// Offsets into m_entries, indexed by cell; one more than the number of cells.
+  std::vector<uint32_t> m_offsets;
+  /// Concatenated lists of towers of each cell.
+  std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Constructor.
+ */
+template <class TOWERS>
+CellTowerMap::CellTowerMap(const ICaloIndexer& indexer, TOWERS&& towers) : m_cellIDs(indexer.cellIDs()) {
+  m_offsets.reserve(m_cellIDs.size() + 1);
+  m_offsets.push_back(0);
+  m_entries.reserve(m_cellIDs.size());
+  for (CellID id : m_cellIDs) {
+    towers(id, m_entries);
+    m_offsets.push_back(m_entries.size());
+  }
+  m_entries.shrink_to_fit();
+}
+
+/**
+ * @brief Number of cells in the map.
+ */
+inline size_t CellTowerMap::size() const { return m_cellIDs.size(); }
+
+/**
+ * @brief Total number of (cell, tower) entries.
+ */
+inline size_t CellTowerMap::nEntries() const { return m_entries.size(); }
+
+/**
+ * @brief Return the towers covered by the cell with index @c ndx.
+ */
+inline std::span<const CellTowerMap::Entry> CellTowerMap::entries(index_t ndx) const {
+  return std::span<const Entry>(m_entries.data() + m_offsets[ndx], m_offsets[ndx + 1] - m_offsets[ndx]);
+}
+
+/**
+ * @brief Return the cell IDs for which the map was made.
+ */
+inline auto CellTowerMap::cellIDs() const -> std::span<const CellID> { return m_cellIDs; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CELLTOWERMAP_H
@@ -0,0 +1,180 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/CrosstalkTable.h
+ * @date Oct, 2026
+ * @brief Table of crosstalk neighbours and coefficients.
+ */
+
+#ifndef RECCALOCOMMON_CROSSTALKTABLE_H
+#define RECCALOCOMMON_CROSSTALKTABLE_H
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Table of crosstalk neighbours and coefficients.
+ *
+ * For each cell, holds the list of cells to which it has crosstalk,
+ * together with the crosstalk coefficients.  The data are stored in
+ * compressed-sparse-row form sorted by cell ID, with the neighbours
+ * held directly as cell IDs.  As for NeighbourTable, the arrays may either
+ * be owned by the table or be a view of a memory-mapped CaloMapFile.
+ */
+class CrosstalkTable {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /// Kind of CaloMapFile used to hold this table.
+  static constexpr CaloMapFile::Kind MAP_KIND = CaloMapFile::CROSSTALK;
+
+  /**
+   * @brief Constructor.
+   * @param cells IDs of cells for which crosstalk is given, in any order.
+   * @param offsets The neighbours of @c cells[i] are given by
+   *                <code>neighbourIDs[offsets[i]] .. neighbourIDs[offsets[i+1]-1]</code>.
+   *                Must have one more element than @c cells.
+   * @param neighbourIDs Concatenated lists of neighbour IDs.
+   * @param coefficients Crosstalk coefficients, parallel to @c neighbourIDs.
+   *
+   * If a cell ID is given more than once, the first entry is used.
+   * Throws CrosstalkTableException if the inputs are inconsistent.
+   */
+  CrosstalkTable(std::span<const CellID> cells, std::span<const uint64_t> offsets,
+                 std::span<const CellID> neighbourIDs, std::span<const double> coefficients);
+
+  /**
+   * @brief Constructor from existing arrays.
+   * @param storage Object owning the arrays; it is kept alive as long
+   *                as the table (or any copy of it) exists.
+   * @param cellIDs Sorted list of cell IDs.
+   * @param offsets Offsets of the neighbours of each cell.
+   * @param neighbourIDs Concatenated lists of neighbour IDs.
+   * @param coefficients Crosstalk coefficients, parallel to @c neighbourIDs.
+   *
+   * The arrays are used in place.  Their structure is checked, in time
+   * linear in their size: the sizes must be consistent, the offsets must
+   * not decrease, and the cell IDs must be sorted and unique.
+   * Throws CrosstalkTableException if any check fails.
+   */
+  CrosstalkTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                 std::span<const uint32_t> offsets, std::span<const CellID> neighbourIDs,
+                 std::span<const double> coefficients);
+
+  /**
+   * @brief Number of cells in the table.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+   * @param id The cell ID to look for.
+   */
+  index_t index(CellID id) const;
+
+  /**
+   * @brief Return the crosstalk neighbours of a cell (empty if not known).
+   * @param id The cell ID to look for.
+   */
+  std::span<const CellID> neighbours(CellID id) const;
+
+  /**
+   * @brief Return the crosstalk coefficients of a cell (empty if not known).
+   * @param id The cell ID to look for.
+   */
+  std::span<const double> crosstalks(CellID id) const;
+
+  /**
+   * @brief Map a table from a binary file.
+   * @param path Path of the file, written by @c writeMapFile.
+   * @param verifyChecksum If true, verify the checksum of the file contents.
+   */
+  static CrosstalkTable fromMapFile(const std::string& path, bool verifyChecksum = true);
+
+  /**
+   * @brief Make a table viewing an already-opened binary file.
+   * @param file The file, which is kept alive as long as the table exists.
+   */
+  static CrosstalkTable fromMapFile(std::shared_ptr<const CaloMapFile> file);
+
+  /**
+   * @brief Write the table to a binary file (see CaloMapFile).
+   * @param path Path of the file to write.
+   * @param tag User tag to record in the file header.
+   */
+  void writeMapFile(const std::string& path, uint64_t tag = 0) const;
+
+  /**
+   * @brief Exceptions thrown by the ctor.
+   */
+  class CrosstalkTableException : public std::runtime_error {
+  public:
+    CrosstalkTableException(const std::string& what);
+  };
+
+private:
+  /// Arrays owned by the table, if it was built from unsorted input.
+  struct Storage {
+    std::vector<CellID> cellIDs;
+    std::vector<uint32_t> offsets;
+    std::vector<CellID> neighbourIDs;
+    std::vector<double> coefficients;
+  };
+
+  /// Object owning the arrays.
+  std::shared_ptr<const void> m_storage;
+
+  std::span<const CellID> m_cellIDs;
+  std::span<const uint32_t> m_offsets;
+  std::span<const CellID> m_neighbourIDs;
+  std::span<const double> m_coefficients;
+};
+
+/**
+ * @brief Number of cells in the table.
+ */
+inline size_t CrosstalkTable::size() const { return m_cellIDs.size(); }
+
+/**
+ * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+ */
+inline auto CrosstalkTable::index(CellID id) const -> index_t {
+  auto it = std::lower_bound(m_cellIDs.begin(), m_cellIDs.end(), id);
+  if (it != m_cellIDs.end() && *it == id)
+    return it - m_cellIDs.begin();
+  return INVALID;
+}
+
+/**
+ * @brief Return the crosstalk neighbours of a cell.
+ */
+inline auto CrosstalkTable::neighbours(CellID id) const -> std::span<const CellID> {
+  index_t ndx = index(id);
+  if (ndx == INVALID)
+    return std::span<const CellID>();
+  return m_neighbourIDs.subspan(m_offsets[ndx], m_offsets[ndx + 1] - m_offsets[ndx]);
+}
+
+/**
+ * @brief Return the crosstalk coefficients of a cell.
+ */
+inline std::span<const double> CrosstalkTable::crosstalks(CellID id) const {
+  index_t ndx = index(id);
+  if (ndx == INVALID)
+    return std::span<const double>();
+  return m_coefficients.subspan(m_offsets[ndx], m_offsets[ndx + 1] - m_offsets[ndx]);
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_CROSSTALKTABLE_H
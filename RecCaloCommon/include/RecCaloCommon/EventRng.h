@@ -0,0 +1,43 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/EventRng.h
+ * @date Oct, 2026
+ * @brief Make a CounterRng for the event being processed.
+ */
+
+#ifndef RECCALOCOMMON_EVENTRNG_H
+#define RECCALOCOMMON_EVENTRNG_H
+
+#include "GaudiKernel/EventContext.h"
+#include "GaudiKernel/ThreadLocalContext.h"
+#include "RecCaloCommon/CounterRng.h"
+
+namespace k4::recCalo {
+
+/**
+ * @brief Make a CounterRng for an event.
+ * @param seed User seed.
+ * @param stream Stream ID; see CounterRng::streamID.
+ * @param ctx Context of the event.
+ *
+ * The event is identified by its run number and by its sequence number
+ * in the job, which does not depend on the scheduling of the events.
+ */
+inline CounterRng eventRng(uint64_t seed, uint64_t stream, const EventContext& ctx) {
+  return CounterRng(seed, stream, ctx.eventID().run_number(), ctx.evt());
+}
+
+/**
+ * @brief Make a CounterRng for the event being processed by this thread.
+ * @param seed User seed.
+ * @param stream Stream ID; see CounterRng::streamID.
+ *
+ * For use in tools, which are not passed the event context.
+ */
+inline CounterRng eventRng(uint64_t seed, uint64_t stream) {
+  return eventRng(seed, stream, Gaudi::Hive::currentContext());
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_EVENTRNG_H
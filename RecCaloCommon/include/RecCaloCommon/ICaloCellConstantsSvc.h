@@ -10,9 +10,14 @@
 #define RECCALOCOMMON_ICALOCELLCONSTANTSSVC_H
 
 #include "GaudiKernel/IInterface.h"
+#include "RecCaloCommon/CaloMapFile.h"
 #include <any>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <typeinfo>
 
@@ -37,10 +42,20 @@ namespace k4::recCalo {
  * does not allow for storing arbitrary types, and in general does not
  * really seem intended for the storage of data which is not meant
  * to be persistent.
+ *
+ * Objects which can be written to a CaloMapFile may further be shared
+ * between processes on the same host, via @c getOrMakeObj.  If the service
+ * is configured with a shared area, the first process to need such
+ * an object builds it and publishes it there; later processes map
+ * the published file rather than building their own copy.
  */
 class ICaloCellConstantsSvc : virtual public IInterface {
 public:
-  DeclareInterfaceID(ICaloCellConstantsSvc, 1, 0);
+  DeclareInterfaceID(ICaloCellConstantsSvc, 1, 1);
+
+  /// Callback used to publish an object: called with the path to write
+  /// and the tag to record in the file.
+  using PublishFn = std::function<void(const std::string& path, uint64_t tag)>;
 
   /**
    * @brief Retrieve an object from the store.
@@ -91,6 +106,77 @@ public:
    * (an object was already recorded with the same key, for example).
    */
   virtual bool putAnyObj(const std::string& key, std::any&& obj) = 0;
+
+  /**
+   * @brief Retrieve an object from the store, making it if needed.
+   * @param key Key of the object.
+   * @param version Version key of the object; see @c attachShared.
+   * @param build Callable returning a new @c T.
+   *
+   * If there is no object of type @c T recorded with key @c key, then
+   * one is first attached from the shared area (if configured), or
+   * else made by calling @c build.  @c T must be one of the types which
+   * can be held in a CaloMapFile, such as CellIDList or NeighbourTable.
+   * Exceptions from @c build are propagated.  Returns @c nullptr
+   * only if the object could not be recorded.
+   */
+  template <class T, class BUILD>
+  const T* getOrMakeObj(const std::string& key, uint64_t version, BUILD&& build) {
+    if (const T* obj = getObj<T>(key))
+      return obj;
+    std::optional<T> built;
+    std::shared_ptr<const CaloMapFile> file =
+        attachShared(key, T::MAP_KIND, version, [&](const std::string& path, uint64_t tag) {
+          built.emplace(build());
+          built->writeMapFile(path, tag);
+        });
+    if (file) {
+      putObj(key, T::fromMapFile(std::move(file)));
+    } else {
+      if (!built)
+        built.emplace(build());
+      putObj(key, std::move(*built));
+    }
+    return getObj<T>(key);
+  }
+
+  /**
+   * @brief Attach to a file in the shared area, publishing it if needed.
+   * @param key Key of the object held in the file.
+   * @param kind Kind of the file.
+   * @param version Version key of the object.  This should change
+   *                whenever the inputs to the object or the code making it
+   *                change; for an object read from a file, for example,
+   *                it may be taken from @c fileVersion.
+   * @param publish Called to write the file, if no current version has
+   *                been published.
+   *
+   * Files are tagged with a hash of the key, version, and the geometry
+   * identified by the service; files with a different tag are considered
+   * stale and are replaced.  Returns the mapped file, or @c nullptr if no shared area
+   * is configured or if the file could not be published.
+   */
+  virtual std::shared_ptr<const CaloMapFile> attachShared(const std::string& /*key*/, CaloMapFile::Kind /*kind*/,
+                                                          uint64_t /*version*/, const PublishFn& /*publish*/) {
+    return nullptr;
+  }
+
+  /**
+   * @brief Make a version key from the size and modification time of a file.
+   * @param path Path of the file.
+   *
+   * Returns 0 if the file cannot be examined.
+   */
+  static uint64_t fileVersion(const std::string& path) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+      return 0;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+      return 0;
+    return size * 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(mtime.time_since_epoch().count());
+  }
 };
 
 } // namespace k4::recCalo
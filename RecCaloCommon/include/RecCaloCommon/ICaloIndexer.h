@@ -57,6 +57,19 @@ public:
    */
   virtual index_t index(CellID id) const = 0;
 
+  /**
+   * @brief Return the indices of a set of identifiers.
+   * @param ids The identifiers to look for.
+   * @param[out] out The index of each identifier in @c cellIDs(),
+   *                 or @c INVALID.  Must be at least as large as @c ids.
+   *
+   * This is equivalent to calling @c index for each identifier, but
+   * with only one virtual call; implementations may also overlap the memory
+   * accesses for the different identifiers.  Prefer this when looking
+   * up whole collections of hits or cells.
+   */
+  virtual void indices(std::span<const CellID> ids, std::span<index_t> out) const;
+
   /**
    * @brief Return the set of all identifiers that we index.
    */
@@ -73,6 +86,16 @@ public:
   virtual size_t detIDBits() const = 0;
 };
 
+/**
+ * @brief Return the indices of a set of identifiers.
+ *
+ * Default implementation, calling @c index for each identifier.
+ */
+inline void ICaloIndexer::indices(std::span<const CellID> ids, std::span<index_t> out) const {
+  for (size_t i = 0; i < ids.size(); ++i)
+    out[i] = index(ids[i]);
+}
+
 } // namespace k4::recCalo
 
 #endif // not RECCALOCOMMON_ICALOINDEXER_H
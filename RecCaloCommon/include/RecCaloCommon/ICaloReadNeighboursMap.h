@@ -20,6 +20,7 @@
 #define RECCALOCOMMON_ICALOREADNEIGHBOURSMAP_H
 
 #include "DDSegmentation/BitFieldCoder.h" // CellID
+#include "RecCaloCommon/NeighbourTable.h"
 
 // Gaudi
 #include "GaudiKernel/IAlgTool.h"
@@ -36,9 +37,19 @@ class ICaloReadNeighboursMap : virtual public IAlgTool {
 public:
   using CellID = dd4hep::DDSegmentation::CellID;
 
-  DeclareInterfaceID(ICaloReadNeighboursMap, 1, 0);
+  DeclareInterfaceID(ICaloReadNeighboursMap, 1, 1);
 
+  /** Return the neighbours of a cell.
+   *  The returned vector is only guaranteed to remain valid until the next call
+   *  from the same thread.
+   */
   virtual const std::vector<CellID>& neighbours(CellID aCellId) const = 0;
+
+  /** Return the neighbours as a compact table indexed by cell,
+   *  or nullptr if not available.  The table may be indexed like
+   *  a calorimeter indexer; see NeighbourTable::matches.
+   */
+  virtual const NeighbourTable* neighbourTable() const { return nullptr; }
 };
 
 } // namespace k4::recCalo
@@ -27,6 +27,7 @@
 #include "GaudiKernel/IAlgTool.h"
 
 #include <memory>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -46,11 +47,11 @@ class ICalorimeterTool : virtual public IAlgTool {
 public:
   using CellID = dd4hep::DDSegmentation::CellID;
 
-  DeclareInterfaceID(ICalorimeterTool, 1, 0);
+  DeclareInterfaceID(ICalorimeterTool, 2, 0);
 
-  /** Fill vector with all existing cells for this geometry.
+  /** Return all existing cells for this geometry.
    */
-  virtual const std::vector<CellID>& cellIDs() const = 0;
+  virtual std::span<const CellID> cellIDs() const = 0;
 
   /** Prepare a map of all existing cells in current geometry.
    *   @param[out] aCells map of existing cells (and deposited energy, set to 0)
@@ -44,7 +44,9 @@
  *    identifier list.  This will be used to initialize the mapping.
  *
  * One can then call lookup() with an identifier key.  This will return
- * either the mapped value or the invalid value.
+ * either the mapped value or the invalid value.  There is also a batch
+ * version of lookup(), taking a span of keys and filling a span of values;
+ * this should be preferred when looking up many identifiers at once.
  *
  * In principle, it would be possible to allow inserting/changing mappings
  * after the map has been created, but I currently don't have a use-case
@@ -167,11 +169,33 @@
  *    as much memory (~15M for IDMap vs. ~50M for array).
  *
  * Overall, for most cases, IDMapN seems like a good option.
+ *
+ * Batch lookup:
+ *
+ * For the Allegro ECal barrel, the upper levels of the trie occupy
+ * well under 100kB and stay in cache, while the leaf nodes take ~15MB.
+ * For random access, the time is thus dominated by one cache miss per
+ * lookup, in the leaf.  The batch version of lookup() processes the keys
+ * in groups of BATCH.  A first pass over a group finds the leaf node for
+ * each key and prefetches the leaf entry; a second pass then reads
+ * the values.  The misses for a group are thus serviced in parallel.
+ * The first pass also remembers the last leaf node found, so that
+ * for sorted input most keys skip the walk of the upper levels entirely.
+ * The number of fields is a template parameter of the batch lookup,
+ * so this is also done for IDMap with a variable number of fields.
+ *
+ * This is measured by IDMap_test --perf, as the `batch' entries.
+ * In a test on a shared x86_64 machine, -O2, for random access
+ * the batch lookup took about 55-65% of the time of a loop calling
+ * IDMapN::lookup(), and about 40% of that of IDMap::lookup().  For
+ * sequential access the batch lookup was within ~20% of IDMapN::lookup(),
+ * and faster than IDMap::lookup().
  */
 
 #ifndef RECCALOCOMMON_IDMAP_H
 #define RECCALOCOMMON_IDMAP_H
 
+#include <algorithm>
 #include <concepts>
 #include <cstdint>
 #include <cstdlib>
@@ -252,6 +276,14 @@ public:
    */
   payload_t lookup(key_t k) const;
 
+  /**
+   * @brief Look up a set of values in the mapping.
+   * @param keys The values to look up.
+   * @param[out] out The mapped values, or the invalid value for
+   *                 keys not found.  Must be at least as large as @c keys.
+   */
+  void lookup(std::span<const key_t> keys, std::span<payload_t> out) const;
+
   /**
    * @brief Return the number of keys in the mapping.
    */
@@ -279,7 +311,22 @@ protected:
    */
   payload_t lookup(key_t k, size_t nfields) const;
 
+  /**
+   * @brief Look up a set of values in the mapping.
+   * @param keys The values to look up.
+   * @param[out] out The mapped values, or the invalid value for
+   *                 keys not found.
+   *
+   * NFIELDS is the number of fields in the mapping; this is a template
+   * parameter so that the loop over fields may be unrolled.
+   */
+  template <size_t NFIELDS>
+  void lookupBatch(std::span<const key_t> keys, std::span<payload_t> out) const;
+
 private:
+  /// Number of keys processed together by the batch lookup.
+  constexpr static size_t BATCH = 64;
+
   /// Type used for a node index.
   using index_t = uint32_t;
 
@@ -377,6 +424,16 @@ public:
    * @returns The mapped value, or the invalid value if not found.
    */
   payload_t lookup(key_t k) const { return base_class::lookup(k, NFIELDS); }
+
+  /**
+   * @brief Look up a set of values in the mapping.
+   * @param keys The values to look up.
+   * @param[out] out The mapped values, or the invalid value for
+   *                 keys not found.  Must be at least as large as @c keys.
+   */
+  void lookup(std::span<const key_t> keys, std::span<payload_t> out) const {
+    base_class::template lookupBatch<NFIELDS>(keys, out);
+  }
 };
 
 /**
@@ -449,6 +506,28 @@ inline auto IDMap<PAYLOAD>::lookup(key_t k) const -> payload_t {
   return lookup(k, m_nfields);
 }
 
+/**
+ * @brief Look up a set of values in the mapping.
+ */
+template <IDMapPayload PAYLOAD>
+void IDMap<PAYLOAD>::lookup(std::span<const key_t> keys, std::span<payload_t> out) const {
+  // Dispatch to a version with the number of fields fixed.
+  switch (m_nfields) {
+  case 1:
+    return lookupBatch<1>(keys, out);
+  case 2:
+    return lookupBatch<2>(keys, out);
+  case 3:
+    return lookupBatch<3>(keys, out);
+  case 4:
+    return lookupBatch<4>(keys, out);
+  case 5:
+    return lookupBatch<5>(keys, out);
+  default:
+    return lookupBatch<6>(keys, out);
+  }
+}
+
 /**
  * @brief Return the number of keys in the mapping.
  */
@@ -527,6 +606,68 @@ auto IDMap<PAYLOAD>::lookup(key_t k, size_t nfields) const -> payload_t {
   return leaf[ndx];
 }
 
+/**
+ * @brief Look up a set of values in the mapping.
+ */
+template <IDMapPayload PAYLOAD>
+template <size_t NFIELDS>
+void IDMap<PAYLOAD>::lookupBatch(std::span<const key_t> keys, std::span<payload_t> out) const {
+  // Copy what we need to locals, so that the compiler need not worry
+  // about them being changed by the stores to the output.
+  const char* data = m_data.data();
+  const Field lastField = m_fields[NFIELDS - 1];
+  const payload_t invalid = m_invalid;
+
+  // Mask for the fields selecting the leaf node.
+  key_t prefixMask = 0;
+  for (size_t ifield = 0; ifield < NFIELDS - 1; ++ifield)
+    prefixMask |= m_fields[ifield].m_mask;
+
+  // Leaf node found for the last key, and the fields that selected it.
+  // Position 0 means that there is no such leaf.
+  key_t lastPrefix = ~static_cast<key_t>(0);
+  index_t lastPos = 0;
+
+  const size_t nkeys = keys.size();
+  for (size_t start = 0; start < nkeys; start += BATCH) {
+    const size_t n = std::min(BATCH, nkeys - start);
+    const key_t* k = keys.data() + start;
+
+    // First pass: find the leaf node and the index within it for each key,
+    // and prefetch the leaf entry.  The upper levels of the trie
+    // are small and usually in cache; consecutive keys often share
+    // the same leaf node, in which case the walk is skipped.
+    index_t pos[BATCH];
+    unsigned ndx[BATCH];
+    for (size_t i = 0; i < n; ++i) {
+      const key_t prefix = k[i] & prefixMask;
+      if (prefix != lastPrefix) {
+        lastPrefix = prefix;
+        index_t p = 0;
+        for (size_t ifield = 0; ifield < NFIELDS - 1; ++ifield) {
+          p = reinterpret_cast<const index_t*>(data + p)[m_fields[ifield].extract(k[i])];
+          if (!p) [[unlikely]]
+            break;
+        }
+        lastPos = p;
+      }
+      pos[i] = lastPos;
+      ndx[i] = lastField.extract(k[i]);
+      __builtin_prefetch(data + pos[i] + ndx[i] * sizeof(payload_t));
+    }
+
+    // Second pass: read the values from the leaf nodes.
+    payload_t* o = out.data() + start;
+    for (size_t i = 0; i < n; ++i) {
+      if ((NFIELDS > 1 && pos[i] == 0) || ndx[i] >= lastField.size()) [[unlikely]] {
+        o[i] = invalid;
+      } else {
+        o[i] = reinterpret_cast<const payload_t*>(data + pos[i])[ndx[i]];
+      }
+    }
+  }
+}
+
 /**
  * @brief Insert a new value in the map.
  */
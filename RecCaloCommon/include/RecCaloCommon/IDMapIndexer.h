@@ -70,6 +70,16 @@ public:
    */
   virtual index_t index(uint64_t id) const override final;
 
+  /**
+   * @brief Return the indices of a set of identifiers.
+   * @param ids The identifiers to look for.
+   * @param[out] out The index of each identifier in @c cellIDs(),
+   *                 or @c INVALID.  Must be at least as large as @c ids.
+   *
+   * Uses the batch lookup of the mapping.
+   */
+  virtual void indices(std::span<const uint64_t> ids, std::span<index_t> out) const override final;
+
   /**
    * @brief Return the set of all identifiers that we index.
    */
@@ -155,6 +165,20 @@ inline auto IDMapIndexer<NFIELDS>::index(uint64_t id) const -> index_t {
   return m_map.lookup(id);
 }
 
+/**
+ * @brief Return the indices of a set of identifiers.
+ */
+template <unsigned NFIELDS>
+void IDMapIndexer<NFIELDS>::indices(std::span<const uint64_t> ids, std::span<index_t> out) const {
+  m_map.lookup(ids, out);
+  // Any identifier may be looked up in the mapping, so check the other
+  // fields afterwards, without branching.
+  const size_t n = ids.size();
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = (ids[i] & m_otherFieldsMask) == m_otherFieldsVal ? out[i] : INVALID;
+  }
+}
+
 /**
  * @brief Return the set of all identifiers that we index.
  */
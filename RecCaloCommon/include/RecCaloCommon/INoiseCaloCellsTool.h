@@ -24,6 +24,10 @@
 // from Gaudi
 #include "GaudiKernel/IAlgTool.h"
 
+#include <span>
+#include <unordered_map>
+#include <vector>
+
 namespace k4::recCalo {
 
 /** @class INoiseCaloCellsTool
@@ -38,13 +42,46 @@ class INoiseCaloCellsTool : virtual public IAlgTool {
 public:
   using CellID = dd4hep::DDSegmentation::CellID;
 
-  DeclareInterfaceID(INoiseCaloCellsTool, 1, 0);
+  DeclareInterfaceID(INoiseCaloCellsTool, 1, 2);
 
   virtual void addRandomCellNoise(std::unordered_map<CellID, double>& aCells) const = 0;
   virtual void filterCellNoise(std::unordered_map<CellID, double>& aCells) const = 0;
 
   virtual void addRandomCellNoise(std::vector<std::pair<CellID, double>>& aCells) const = 0;
   virtual void filterCellNoise(std::vector<std::pair<CellID, double>>& aCells) const = 0;
+
+  /** @brief Add noise to cells and filter them, as if done for all cells of the calorimeter.
+   *  @param aCells On input, the cells with energy deposits.  On output, the cells
+   *                passing the noise filter: cells from the input with noise added,
+   *                together with empty cells from @c allCells whose noise fluctuation
+   *                passes the filter.
+   *  @param allCells IDs of all cells in the calorimeter.
+   *
+   *  The result is statistically equivalent to adding all empty cells to @c aCells
+   *  and calling addRandomCellNoise and filterCellNoise, which is what the default
+   *  implementation does.  Tools may override this to sample only the empty cells
+   *  which pass the filter, so that the cost scales with the occupancy rather than
+   *  with the total number of cells.
+   */
+  virtual void addFilteredCellNoise(std::unordered_map<CellID, double>& aCells,
+                                    std::span<const CellID> allCells) const {
+    for (CellID id : allCells)
+      aCells.try_emplace(id, 0);
+    addRandomCellNoise(aCells);
+    filterCellNoise(aCells);
+  }
+
+  /** @brief Add noise to cells and filter them, as if done for all cells of the calorimeter.
+   *  @param aCells On input, the cells with energy deposits; each cell may appear only once.
+   *                On output, the cells passing the noise filter, as above.
+   *  @param allCells IDs of all cells in the calorimeter.
+   */
+  virtual void addFilteredCellNoise(std::vector<std::pair<CellID, double>>& aCells,
+                                    std::span<const CellID> allCells) const {
+    std::unordered_map<CellID, double> cells(aCells.begin(), aCells.end());
+    addFilteredCellNoise(cells, allCells);
+    aCells.assign(cells.begin(), cells.end());
+  }
 };
 
 } // namespace k4::recCalo
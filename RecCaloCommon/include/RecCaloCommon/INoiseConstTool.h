@@ -20,6 +20,7 @@
 #define RECCALOCOMMON_INOISECONSTTOOL_H
 
 #include "DDSegmentation/BitFieldCoder.h" // CellID
+#include "RecCaloCommon/IndexedNoiseTable.h"
 
 // from Gaudi
 #include "GaudiKernel/IAlgTool.h"
@@ -37,7 +38,7 @@ class INoiseConstTool : virtual public IAlgTool {
 public:
   using CellID = dd4hep::DDSegmentation::CellID;
 
-  DeclareInterfaceID(INoiseConstTool, 1, 0);
+  DeclareInterfaceID(INoiseConstTool, 1, 1);
 
   /** Expected noise per cell in terms of sigma of Gaussian distibution.
    *   @param[in] aCellId of the cell of interest.
@@ -56,6 +57,14 @@ public:
    *   return [rms, offset]
    */
   virtual std::pair<double, double> getNoisePerCell(CellID aCellID) const = 0;
+
+  /** Table of the noise of all cells, indexed by cell index.
+   *   Tools that precompute the noise of every cell may return it here,
+   *   so that clients can look up the noise by index rather than by cell ID.
+   *   Use IndexedNoiseTable::matches to check that the table is indexed like the client's indexer.
+   *   return the table, or nullptr if the tool does not provide one.
+   */
+  virtual const IndexedNoiseTable* indexedNoiseTable() const { return nullptr; }
 };
 
 } // namespace k4::recCalo
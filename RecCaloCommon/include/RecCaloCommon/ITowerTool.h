@@ -27,6 +27,8 @@
 #include "edm4hep/CalorimeterHitCollection.h"
 #include "edm4hep/Cluster.h"
 
+#include "RecCaloCommon/CaloTowers.h"
+
 namespace k4::recCalo {
 
 /** @class ITowerTool RecInterface/RecInterface/ITowerTool.h ITowerTool.h
@@ -37,7 +39,7 @@ namespace k4::recCalo {
  */
 class ITowerTool : virtual public IAlgTool {
 public:
-  DeclareInterfaceID(ITowerTool, 1, 0);
+  DeclareInterfaceID(ITowerTool, 2, 0);
 
   /**  Find number of calorimeter towers.
    *   @param[out] nEta number of towers in eta.
@@ -46,11 +48,11 @@ public:
   virtual void towersNumber(int& nEta, int& nPhi) = 0;
 
   /**  Build calorimeter towers.
-   *   @param[out] aTowers Calorimeter towers.
-   *   @param[in] fillTowersCells Whether to fill maps of cells into towers, for later use in attachCells
-   *   @return Size of the cell collection.
+   *   The towers are returned rather than kept by the tool, so that events may be processed concurrently.
+   *   @param[in] fillTowersCells Whether to fill the lists of cells in each tower, for later use in attachCells
+   *   @return Calorimeter towers of the event.
    */
-  virtual uint buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells = true) = 0;
+  virtual CaloTowers buildTowers(bool fillTowersCells = true) const = 0;
   /**  Get the radius for the position calculation.
    *   @return Radius
    */
@@ -76,6 +78,7 @@ public:
    */
   virtual float phi(int aIdPhi) const = 0;
   /**  Find cells belonging to a cluster.
+   *   @param[in] aTowers Calorimeter towers of the event, from buildTowers
    *   @param[in] aEta Position of the middle tower of a cluster in eta
    *   @param[in] aPhi Position of the middle tower of a cluster in phi
    *   @param[in] aHalfEtaFinal Half size of cluster in eta (in units of tower size). Cluster size is 2*aHalfEtaFinal+1
@@ -83,9 +86,9 @@ public:
    *   @param[out] aEdmCluster Cluster of interest
    *   @param[out] aEdmClusterCells Cluster cells which belong to the cluster of interest
    */
-  virtual void attachCells(float aEta, float aPhi, uint aHalfEtaFinal, uint aHalfPhiFinal,
+  virtual void attachCells(const CaloTowers& aTowers, float aEta, float aPhi, uint aHalfEtaFinal, uint aHalfPhiFinal,
                            edm4hep::MutableCluster& aEdmCluster, edm4hep::CalorimeterHitCollection* aEdmClusterCells,
-                           bool aEllipse) = 0;
+                           bool aEllipse) const = 0;
 };
 
 } // namespace k4::recCalo
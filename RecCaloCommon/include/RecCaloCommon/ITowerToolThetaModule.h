@@ -27,6 +27,8 @@
 #include "edm4hep/CalorimeterHitCollection.h"
 #include "edm4hep/Cluster.h"
 
+#include "RecCaloCommon/CaloTowers.h"
+
 namespace k4::recCalo {
 
 /** @class ITowerToolThetaModule RecInterface/RecInterface/ITowerToolThetaModule.h ITowerToolThetaModule.h
@@ -39,7 +41,7 @@ namespace k4::recCalo {
  */
 class ITowerToolThetaModule : virtual public IAlgTool {
 public:
-  DeclareInterfaceID(ITowerToolThetaModule, 1, 0);
+  DeclareInterfaceID(ITowerToolThetaModule, 2, 0);
 
   /**  Find number of calorimeter towers.
    *   @param[out] nTheta number of towers in theta.
@@ -47,15 +49,11 @@ public:
    */
   virtual void towersNumber(int& nTheta, int& nPhi) = 0;
   /**  Build calorimeter towers.
-   *   @param[out] aTowers Calorimeter towers.
-   *   @param[in] fillTowersCells Whether to fill maps of cells into towers, for later use in attachCells
-   *   @return Size of the cell collection.
-   */
-  virtual uint buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells = true) = 0;
-  /**  Get the map of cells contained within a tower.
-   *   @return Map of cells in a tower
+   *   The towers are returned rather than kept by the tool, so that events may be processed concurrently.
+   *   @param[in] fillTowersCells Whether to fill the lists of cells in each tower, for later use in attachCells
+   *   @return Calorimeter towers of the event.
    */
-  virtual std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> cellsInTowers() const = 0;
+  virtual CaloTowers buildTowers(bool fillTowersCells = true) const = 0;
   /**  Get the tower IDs in theta.
    *   @param[in] aTheta Position of the calorimeter cell in theta
    *   @return ID (theta) of a tower
@@ -77,6 +75,7 @@ public:
    */
   virtual float phi(int aIdPhi) const = 0;
   /**  Find cells belonging to a cluster.
+   *   @param[in] aTowers Calorimeter towers of the event, from buildTowers
    *   @param[in] aTheta Position of the middle tower of a cluster in theta
    *   @param[in] aPhi Position of the middle tower of a cluster in phi
    *   @param[in] aHalfThetaFinal Half size of cluster in theta (in units of tower size). Cluster size is
@@ -85,9 +84,9 @@ public:
    *   @param[out] aEdmCluster Cluster of interest
    *   @param[out] aEdmClusterCells Cluster cells which belong to the cluster of interest
    */
-  virtual void attachCells(float aTheta, float aPhi, uint aHalfThetaFinal, uint aHalfPhiFinal,
-                           edm4hep::MutableCluster& aEdmCluster, edm4hep::CalorimeterHitCollection* aEdmClusterCells,
-                           bool aEllipse) = 0;
+  virtual void attachCells(const CaloTowers& aTowers, float aTheta, float aPhi, uint aHalfThetaFinal,
+                           uint aHalfPhiFinal, edm4hep::MutableCluster& aEdmCluster,
+                           edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool aEllipse) const = 0;
 };
 
 } // namespace k4::recCalo
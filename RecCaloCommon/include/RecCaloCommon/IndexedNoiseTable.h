@@ -0,0 +1,155 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/IndexedNoiseTable.h
+ * @date Oct, 2026
+ * @brief Per-cell noise constants, indexed by an ICaloIndexer.
+ */
+
+#ifndef RECCALOCOMMON_INDEXEDNOISETABLE_H
+#define RECCALOCOMMON_INDEXEDNOISETABLE_H
+
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Per-cell noise constants, indexed by an ICaloIndexer.
+ *
+ * Holds the noise RMS and offset of every cell known to an indexer,
+ * as float arrays in the order of the indexer's @c cellIDs().  Looking
+ * up the noise of a cell is then just an array access, once the index
+ * of the cell is known.
+ *
+ * The table remembers the list of cell IDs for which it was made
+ * (which must outlive it), so that users may check that it is indexed
+ * the same way as their own indexer.
+ *
+ * The constants are stored as floats to halve the memory used;
+ * they are therefore rounded to single precision.
+ */
+class IndexedNoiseTable {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /**
+   * @brief Constructor.
+   * @param indexer The indexer for the cells.  Its list of cell IDs must
+   *                remain valid for the lifetime of the table.
+   * @param noise Callable returning the noise [rms, offset] for a cell ID.
+   *
+   * @c noise is called once for each cell of @c indexer.
+   */
+  template <class NOISE>
+  IndexedNoiseTable(const ICaloIndexer& indexer, NOISE&& noise);
+
+  /**
+   * @brief Number of cells in the table.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Return the noise RMS of the cell with index @c ndx.
+   */
+  float noiseRMS(index_t ndx) const;
+
+  /**
+   * @brief Return the noise offset of the cell with index @c ndx.
+   */
+  float noiseOffset(index_t ndx) const;
+
+  /**
+   * @brief Return the noise [rms, offset] of the cell with index @c ndx.
+   */
+  std::pair<double, double> noise(index_t ndx) const;
+
+  /**
+   * @brief Return the noise RMS values, indexed like @c cellIDs().
+   */
+  std::span<const float> noiseRMS() const;
+
+  /**
+   * @brief Return the noise offsets, indexed like @c cellIDs().
+   */
+  std::span<const float> noiseOffset() const;
+
+  /**
+   * @brief Return the cell IDs for which the table was made.
+   */
+  std::span<const CellID> cellIDs() const;
+
+  /**
+   * @brief Test if the table is indexed in the same way as an indexer.
+   * @param indexer The indexer to test.
+   *
+   * This is quick if the indexer shares its list of cell IDs with
+   * the one used to make the table; otherwise, the lists are compared.
+   */
+  bool matches(const ICaloIndexer& indexer) const;
+
+private:
+  /// The cell IDs for which the table was made.
+  std::span<const CellID> m_cellIDs;
+
+  std::vector<float> m_noiseRMS;
+  std::vector<float> m_noiseOffset;
+};
+
+/**
+ * @brief Constructor.
+ */
+template <class NOISE>
+IndexedNoiseTable::IndexedNoiseTable(const ICaloIndexer& indexer, NOISE&& noise) : m_cellIDs(indexer.cellIDs()) {
+  m_noiseRMS.reserve(m_cellIDs.size());
+  m_noiseOffset.reserve(m_cellIDs.size());
+  for (CellID id : m_cellIDs) {
+    std::pair<double, double> n = noise(id);
+    m_noiseRMS.push_back(n.first);
+    m_noiseOffset.push_back(n.second);
+  }
+}
+
+/**
+ * @brief Number of cells in the table.
+ */
+inline size_t IndexedNoiseTable::size() const { return m_cellIDs.size(); }
+
+/**
+ * @brief Return the noise RMS of the cell with index @c ndx.
+ */
+inline float IndexedNoiseTable::noiseRMS(index_t ndx) const { return m_noiseRMS[ndx]; }
+
+/**
+ * @brief Return the noise offset of the cell with index @c ndx.
+ */
+inline float IndexedNoiseTable::noiseOffset(index_t ndx) const { return m_noiseOffset[ndx]; }
+
+/**
+ * @brief Return the noise [rms, offset] of the cell with index @c ndx.
+ */
+inline std::pair<double, double> IndexedNoiseTable::noise(index_t ndx) const {
+  return std::make_pair(m_noiseRMS[ndx], m_noiseOffset[ndx]);
+}
+
+/**
+ * @brief Return the noise RMS values.
+ */
+inline std::span<const float> IndexedNoiseTable::noiseRMS() const { return m_noiseRMS; }
+
+/**
+ * @brief Return the noise offsets.
+ */
+inline std::span<const float> IndexedNoiseTable::noiseOffset() const { return m_noiseOffset; }
+
+/**
+ * @brief Return the cell IDs for which the table was made.
+ */
+inline auto IndexedNoiseTable::cellIDs() const -> std::span<const CellID> { return m_cellIDs; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_INDEXEDNOISETABLE_H
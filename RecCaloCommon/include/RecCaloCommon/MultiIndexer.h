@@ -55,6 +55,17 @@ public:
    */
   virtual index_t index(uint64_t id) const override final;
 
+  /**
+   * @brief Return the indices of a set of identifiers.
+   * @param ids The identifiers to look for.
+   * @param[out] out The index of each identifier in @c cellIDs(),
+   *                 or @c INVALID.  Must be at least as large as @c ids.
+   *
+   * Consecutive identifiers from the same detector are passed
+   * together to the batch lookup of that detector's indexer.
+   */
+  virtual void indices(std::span<const uint64_t> ids, std::span<index_t> out) const override final;
+
   /**
    * @brief Return the set of all identifiers that we index.
    */
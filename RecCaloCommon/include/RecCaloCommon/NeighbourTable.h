@@ -0,0 +1,260 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/NeighbourTable.h
+ * @date Oct, 2026
+ * @brief Compact table of cell neighbours.
+ */
+
+#ifndef RECCALOCOMMON_NEIGHBOURTABLE_H
+#define RECCALOCOMMON_NEIGHBOURTABLE_H
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Compact table of cell neighbours.
+ *
+ * The neighbour maps used for topological clustering were originally
+ * held as a std::unordered_map from cell ID to a std::vector of the
+ * neighbouring cell IDs.  For the roughly two million cells of the Allegro
+ * calorimeters, that requires a heap allocation per cell and several
+ * hundred MB of memory, with poor locality.
+ *
+ * Here, the table is instead stored in compressed-sparse-row form.
+ * All cell IDs appearing in the table (either as a cell or as a neighbour)
+ * are held in a sorted vector, and a cell is identified by its position
+ * in this vector (its index).  The neighbours of cell @c i are then
+ * the indices <code>neighbours[offsets[i]] .. neighbours[offsets[i+1]-1]</code>.
+ * The order of the neighbours of each cell is preserved from the input.
+ *
+ * The arrays may either be owned by the table, or be a view of externally
+ * held storage, such as a memory-mapped CaloMapFile.  In either case,
+ * the storage is held via a shared pointer, so tables may be cheaply copied.
+ *
+ * A table may also be re-indexed to follow an ICaloIndexer.  In that case,
+ * the cells known to the indexer come first, in the order of the indexer,
+ * followed by any other cells of the original table.  The indices
+ * of the table are then the same as those of the indexer, so that clients
+ * (such as TopoClusterEngine) may use the neighbour indices directly,
+ * without looking up the neighbour IDs.
+ *
+ * Objects of this type are meant to be held in the ICaloCellConstantsSvc,
+ * so that they can be shared between tools.
+ */
+class NeighbourTable {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+  static constexpr index_t INVALID = ICaloIndexer::INVALID;
+
+  /// Kind of CaloMapFile used to hold this table.
+  static constexpr CaloMapFile::Kind MAP_KIND = CaloMapFile::NEIGHBOURS;
+
+  /**
+   * @brief Constructor.
+   * @param cells IDs of cells for which neighbours are given, in any order.
+   * @param offsets Neighbours of @c cells[i] are given by
+   *                <code>neighbourIDs[offsets[i]] .. neighbourIDs[offsets[i+1]-1]</code>.
+   *                Must have one more element than @c cells.
+   * @param neighbourIDs Concatenated lists of neighbour IDs.
+   *
+   * If a cell ID is given more than once, the first entry is used.
+   * Throws NeighbourTableException if the inputs are inconsistent,
+   * or if the table is too large to be indexed with 32 bits.
+   */
+  NeighbourTable(std::span<const CellID> cells, std::span<const uint64_t> offsets,
+                 std::span<const CellID> neighbourIDs);
+
+  /**
+   * @brief Constructor from existing arrays.
+   * @param storage Object owning the arrays; it is kept alive as long
+   *                as the table (or any copy of it) exists.
+   * @param cellIDs Sorted list of cell IDs.
+   * @param offsets Offsets of the neighbours of each cell in @c neighbours.
+   *                Must have one more element than @c cellIDs.
+   * @param neighbours Concatenated lists of neighbour indices.
+   *
+   * The arrays are used in place.  Their structure is checked, in time
+   * linear in their size: the offsets must not decrease, the cell IDs
+   * must be sorted and unique, and the neighbour indices must be valid.
+   * Throws NeighbourTableException if any check fails.
+   */
+  NeighbourTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                 std::span<const uint32_t> offsets, std::span<const index_t> neighbours);
+
+  /**
+   * @brief Constructor, re-indexing another table.
+   * @param indexer The indexer whose indices the new table should use.
+   * @param table The table to re-index.
+   *
+   * Cell @c i of the new table is cell @c i of @c indexer, for all cells
+   * of the indexer; cells of @c table not known to the indexer follow.
+   * Indexer cells not in @c table have no neighbours.  The indexer is
+   * not referenced after the constructor returns.
+   * Throws NeighbourTableException if the table is too large.
+   */
+  NeighbourTable(const ICaloIndexer& indexer, const NeighbourTable& table);
+
+  /**
+   * @brief Number of cells in the table.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Total number of neighbour entries.
+   */
+  size_t nEntries() const;
+
+  /**
+   * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+   * @param id The cell ID to look for.
+   */
+  index_t index(CellID id) const;
+
+  /**
+   * @brief Return the IDs of all cells.  The index of a cell
+   *        is its position in this list.
+   *
+   * The list is sorted, unless the table was re-indexed to follow an indexer.
+   */
+  std::span<const CellID> cellIDs() const;
+
+  /**
+   * @brief Test if the table is indexed like an indexer.
+   * @param indexer The indexer to test.
+   *
+   * True if the first cells of the table are those of @c indexer, in the
+   * same order, so that an indexer index may be passed to @c neighbours.
+   * Neighbour indices not less than the size of the indexer are then
+   * cells not known to the indexer.
+   */
+  bool matches(const ICaloIndexer& indexer) const;
+
+  /**
+   * @brief Return the indices of the neighbours of a cell.
+   * @param ndx Index of the cell; must be less than @c size().
+   */
+  std::span<const index_t> neighbours(index_t ndx) const;
+
+  /**
+   * @brief Return the offsets array.
+   */
+  std::span<const uint32_t> offsets() const;
+
+  /**
+   * @brief Return the concatenated lists of neighbour indices.
+   */
+  std::span<const index_t> entries() const;
+
+  /**
+   * @brief Copy the IDs of the neighbours of a cell.
+   * @param id ID of the cell.
+   * @param[out] out Vector to receive the neighbour IDs.
+   *
+   * @c out will be empty if the cell is not known.
+   */
+  void neighbourIDs(CellID id, std::vector<CellID>& out) const;
+
+  /**
+   * @brief Map a table from a binary file.
+   * @param path Path of the file, written by @c writeMapFile.
+   * @param verifyChecksum If true, verify the checksum of the file contents.
+   *
+   * The table is used in place from the mapped file.
+   * Throws CaloMapFile::CaloMapFileException or NeighbourTableException
+   * on errors.
+   */
+  static NeighbourTable fromMapFile(const std::string& path, bool verifyChecksum = true);
+
+  /**
+   * @brief Make a table viewing an already-opened binary file.
+   * @param file The file, which is kept alive as long as the table exists.
+   */
+  static NeighbourTable fromMapFile(std::shared_ptr<const CaloMapFile> file);
+
+  /**
+   * @brief Write the table to a binary file (see CaloMapFile).
+   * @param path Path of the file to write.
+   * @param tag User tag to record in the file header.
+   *
+   * Tables re-indexed to follow an indexer cannot be written;
+   * throws NeighbourTableException in that case.
+   */
+  void writeMapFile(const std::string& path, uint64_t tag = 0) const;
+
+  /**
+   * @brief Exceptions thrown by the ctor.
+   */
+  class NeighbourTableException : public std::runtime_error {
+  public:
+    NeighbourTableException(const std::string& what);
+  };
+
+private:
+  /// Arrays owned by the table, if it was built from a list of IDs.
+  struct Storage {
+    std::vector<CellID> cellIDs;
+    std::vector<uint32_t> offsets;
+    std::vector<index_t> neighbours;
+    std::vector<index_t> order;
+  };
+
+  /// Object owning the arrays.
+  std::shared_ptr<const void> m_storage;
+
+  /// List of cell IDs; sorted unless re-indexed.
+  std::span<const CellID> m_cellIDs;
+
+  /// For a re-indexed table, the indices of the cells in order of increasing ID.
+  std::span<const index_t> m_order;
+
+  /// Offsets into m_neighbours, indexed by cell index.
+  std::span<const uint32_t> m_offsets;
+
+  /// Concatenated lists of neighbour indices.
+  std::span<const index_t> m_neighbours;
+};
+
+/**
+ * @brief Number of cells in the table.
+ */
+inline size_t NeighbourTable::size() const { return m_cellIDs.size(); }
+
+/**
+ * @brief Total number of neighbour entries.
+ */
+inline size_t NeighbourTable::nEntries() const { return m_neighbours.size(); }
+
+/**
+ * @brief Return the IDs of all cells.
+ */
+inline auto NeighbourTable::cellIDs() const -> std::span<const CellID> { return m_cellIDs; }
+
+/**
+ * @brief Return the indices of the neighbours of a cell.
+ */
+inline auto NeighbourTable::neighbours(index_t ndx) const -> std::span<const index_t> {
+  return m_neighbours.subspan(m_offsets[ndx], m_offsets[ndx + 1] - m_offsets[ndx]);
+}
+
+/**
+ * @brief Return the offsets array.
+ */
+inline std::span<const uint32_t> NeighbourTable::offsets() const { return m_offsets; }
+
+/**
+ * @brief Return the concatenated lists of neighbour indices.
+ */
+inline auto NeighbourTable::entries() const -> std::span<const index_t> { return m_neighbours; }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_NEIGHBOURTABLE_H
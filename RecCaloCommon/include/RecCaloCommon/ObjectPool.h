@@ -0,0 +1,129 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/ObjectPool.h
+ * @date Oct, 2026
+ * @brief Thread-safe pool of reusable objects.
+ */
+
+#ifndef RECCALOCOMMON_OBJECTPOOL_H
+#define RECCALOCOMMON_OBJECTPOOL_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Thread-safe pool of reusable objects.
+ *
+ * Re-entrant algorithms cannot keep per-event working storage as members.
+ * When that storage is expensive to create (for example, arrays sized by
+ * the number of cells in a calorimeter), it can instead be taken from
+ * a pool for the duration of one call.  @c acquire returns an object
+ * from the pool, creating a new one if the pool is empty; the object
+ * is returned to the pool when the returned pointer is destroyed.
+ * The number of objects created is thus the maximum number of
+ * concurrent calls.
+ *
+ * Objects are returned to the pool as they are; it is up to the caller
+ * to reset them as needed.  The pool must outlive any acquired objects.
+ */
+template <class T>
+class ObjectPool {
+public:
+  /// Returns an object to the pool.
+  class Releaser {
+  public:
+    Releaser(ObjectPool* pool = nullptr) : m_pool(pool) {}
+    void operator()(T* obj) const { m_pool->release(obj); }
+
+  private:
+    ObjectPool* m_pool;
+  };
+
+  /// Pointer to an object acquired from the pool.
+  using pointer = std::unique_ptr<T, Releaser>;
+
+  /**
+   * @brief Constructor.
+   * @param factory Called to make a new object when the pool is empty.
+   */
+  ObjectPool(std::function<std::unique_ptr<T>()> factory);
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /**
+   * @brief Take an object from the pool, creating one if needed.
+   */
+  pointer acquire();
+
+  /**
+   * @brief Number of objects created by this pool.
+   */
+  size_t nCreated() const;
+
+private:
+  /// Put an object back in the pool.
+  void release(T* obj);
+
+  /// Makes new objects.
+  std::function<std::unique_ptr<T>()> m_factory;
+
+  /// Objects not currently in use.
+  std::vector<std::unique_ptr<T>> m_free;
+
+  /// Number of objects created.
+  size_t m_nCreated = 0;
+
+  /// Protects m_free and m_nCreated.
+  mutable std::mutex m_mutex;
+};
+
+/**
+ * @brief Constructor.
+ */
+template <class T>
+ObjectPool<T>::ObjectPool(std::function<std::unique_ptr<T>()> factory) : m_factory(std::move(factory)) {}
+
+/**
+ * @brief Take an object from the pool, creating one if needed.
+ */
+template <class T>
+auto ObjectPool<T>::acquire() -> pointer {
+  {
+    std::lock_guard lock(m_mutex);
+    if (!m_free.empty()) {
+      T* obj = m_free.back().release();
+      m_free.pop_back();
+      return pointer(obj, Releaser(this));
+    }
+    ++m_nCreated;
+  }
+  // Make the new object outside of the lock.
+  return pointer(m_factory().release(), Releaser(this));
+}
+
+/**
+ * @brief Number of objects created by this pool.
+ */
+template <class T>
+size_t ObjectPool<T>::nCreated() const {
+  std::lock_guard lock(m_mutex);
+  return m_nCreated;
+}
+
+/**
+ * @brief Put an object back in the pool.
+ */
+template <class T>
+void ObjectPool<T>::release(T* obj) {
+  std::lock_guard lock(m_mutex);
+  m_free.emplace_back(obj);
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_OBJECTPOOL_H
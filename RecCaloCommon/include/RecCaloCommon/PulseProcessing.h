@@ -0,0 +1,139 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/PulseProcessing.h
+ * @date Oct, 2026
+ * @brief Kernels for processing digitized pulses in caller-provided buffers.
+ */
+
+#ifndef RECCALOCOMMON_PULSEPROCESSING_H
+#define RECCALOCOMMON_PULSEPROCESSING_H
+
+#include <cstddef>
+#include <span>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Position and height of the maximum of a filtered pulse.
+ */
+struct PulsePeak {
+  /// Index of the (first) maximum sample.
+  int index = -1;
+  /// Value of the maximum sample.
+  float energy = 0;
+};
+
+/**
+ * @brief Add the pulse of one energy deposit to a digitized pulse.
+ * @param[in,out] pulse The digitized pulse.
+ * @param energy Energy of the deposit.
+ * @param time Time of the deposit.
+ * @param samplingInterval Time between samples.
+ * @param shape The pulse shape, sampled at the same interval as @c pulse.
+ * @param shapeDeriv The derivative of the pulse shape.
+ *
+ * The deposit is shifted by the nearest whole number of samples, and the
+ * remainder is corrected to first order using the derivative of the shape
+ * (see the ATLAS LAr digitization note).  Samples before the deposit
+ * are unchanged.
+ */
+void addPulseContribution(std::span<float> pulse, float energy, float time, float samplingInterval,
+                          std::span<const float> shape, std::span<const float> shapeDeriv);
+
+/**
+ * @brief Subtract the noise mean from a pulse and apply a whitening matrix.
+ * @param pulse The input pulse.
+ * @param mean The noise mean per sample.
+ * @param whitening The whitening matrix, row-major, of size n*n
+ *                  for a pulse of n samples.
+ * @param[out] out The whitened pulse, of the same size as @c pulse.
+ *
+ * The computation is done in double precision.
+ */
+void whitenPulse(std::span<const float> pulse, std::span<const double> mean, std::span<const double> whitening,
+                 std::span<float> out);
+
+/**
+ * @brief Subtract the noise mean from a batch of pulses and apply a whitening matrix.
+ * @param pulses The input pulses, one after another, each of @c nSamples samples.
+ * @param nSamples Number of samples per pulse.
+ * @param mean The noise mean per sample.
+ * @param whitening The whitening matrix, row-major, of size @c nSamples*nSamples.
+ * @param[out] out The whitened pulses, laid out like @c pulses.
+ *
+ * This is one matrix-matrix product, whitening * (pulses - mean)^T, done
+ * in single precision over tiles of pulses that stay in the cache, with the
+ * mean subtracted as each tile is loaded.  As for @c matchedFilterBatch,
+ * versions for several instruction sets are compiled and chosen at run time.
+ */
+void whitenPulseBatch(std::span<const float> pulses, size_t nSamples, std::span<const float> mean,
+                      std::span<const float> whitening, std::span<float> out);
+
+/**
+ * @brief Compute the mean and covariance matrix of a set of samples.
+ * @param samples The observations, one after another, each of @c nVars values.
+ * @param nVars Number of variables per observation.
+ * @param[out] mean The mean of each variable, of size @c nVars.
+ * @param[out] cov The covariance matrix, row-major, of size @c nVars*nVars,
+ *                 normalized by the number of observations less one.
+ *
+ * The observations are centered a block at a time and accumulated into
+ * the upper triangle of the matrix one observation at a time, so that
+ * the inner loop runs over contiguous variables and is vectorized; as for
+ * @c matchedFilterBatch, versions for several instruction sets are compiled
+ * and chosen at run time.  The mean is summed over the observations in order.
+ */
+void sampleCovariance(std::span<const double> samples, size_t nVars, std::span<double> mean, std::span<double> cov);
+
+/**
+ * @brief Convolve a pulse with a filter and find the maximum.
+ * @param pulse The input pulse.
+ * @param reversedFilter The filter template, already time-reversed.
+ * @param[out] out The filtered pulse, of the same size as @c pulse.
+ *
+ * The convolution is the central part of the full convolution,
+ * of the same size as the pulse (as numpy's convolve with mode='same').
+ */
+PulsePeak matchedFilter(std::span<const float> pulse, std::span<const float> reversedFilter, std::span<float> out);
+
+/**
+ * @brief Apply a matched filter to a batch of pulses and find their maxima.
+ * @param pulses The input pulses, one after another, each of @c nSamples samples.
+ * @param nSamples Number of samples per pulse.
+ * @param reversedFilter The filter template, already time-reversed.
+ * @param[out] peaks The maximum of each filtered pulse; its size gives the number of pulses.
+ * @param[out] out The filtered pulses, laid out like @c pulses.
+ *                 May be empty if only the maxima are wanted.
+ *
+ * Gives the same results as calling @c matchedFilter for each pulse
+ * (up to the use of fused multiply-add instructions), but works on blocks
+ * of pulses side by side, so that the filter and the search for the maximum
+ * are vectorized over pulses.  Versions for AVX-512, AVX2 and baseline x86-64
+ * are compiled, and the best one for the CPU is chosen at run time.
+ */
+void matchedFilterBatch(std::span<const float> pulses, size_t nSamples, std::span<const float> reversedFilter,
+                        std::span<PulsePeak> peaks, std::span<float> out);
+
+/**
+ * @brief Compute optimal filtering coefficients for amplitude and time.
+ * @param shape The pulse shape g at each sample used.
+ * @param shapeDeriv The derivative g' of the pulse shape at the same samples.
+ * @param invCov The inverse of the noise covariance matrix between these samples, row-major.
+ * @param[out] a The amplitude coefficients, of the same size as @c shape.
+ * @param[out] b The time coefficients, of the same size as @c shape.
+ *
+ * For a pulse s = A g(t - tau) + noise, with the noise mean subtracted,
+ * sum_i a_i s_i estimates A and sum_i b_i s_i estimates A*tau, to first
+ * order in tau and with the least noise variance (Cleland and Stern,
+ * NIM A338 (1994) 467).  The coefficients satisfy a.g = 1, a.g' = 0,
+ * b.g = 0 and b.g' = -1.
+ *
+ * Returns false, leaving the outputs unchanged, if g and g' are
+ * degenerate with respect to the noise.
+ */
+bool optimalFilterCoefficients(std::span<const double> shape, std::span<const double> shapeDeriv,
+                               std::span<const double> invCov, std::span<double> a, std::span<double> b);
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_PULSEPROCESSING_H
@@ -0,0 +1,129 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/PulseShapeLibrary.h
+ * @date Oct, 2026
+ * @brief Pulse shape sampled at a set of sub-sample phases.
+ */
+
+#ifndef RECCALOCOMMON_PULSESHAPELIBRARY_H
+#define RECCALOCOMMON_PULSESHAPELIBRARY_H
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Gaussian pulse shape, normalized to unit area.
+ */
+struct GaussianPulseShape {
+  float mu;
+  float sigma;
+  float operator()(float t) const;
+};
+
+/**
+ * @brief Pulse shape sampled at a set of sub-sample phases.
+ *
+ * To digitize an energy deposit at time t, the pulse shape must be
+ * evaluated at the sample times less t.  Rather than doing this (or a
+ * first-order correction around the nearest sample) for each deposit,
+ * the shape is sampled once at initialization for @c nPhases equally
+ * spaced offsets within a sampling interval.  A deposit is then added
+ * to a pulse by choosing the nearest phase and doing a shifted, scaled
+ * add of that row of the table, without any allocation.
+ *
+ * The shape is given as a callable type, so that evaluating it when
+ * filling the table is resolved at compile time.
+ *
+ * As for the first-order method, the pulse of a deposit starts at the
+ * sample nearest to the deposit time; earlier samples are unchanged.
+ */
+class PulseShapeLibrary {
+public:
+  /**
+   * @brief Constructor.
+   * @param shape The pulse shape, a callable giving the pulse at a time
+   *              relative to the deposit.
+   * @param nSamples Number of samples in a pulse.
+   * @param samplingInterval Time between samples.
+   * @param nPhases Number of phases per sampling interval (at least 1).
+   */
+  template <class SHAPE>
+  PulseShapeLibrary(const SHAPE& shape, size_t nSamples, float samplingInterval, size_t nPhases);
+
+  /**
+   * @brief Add the pulse of one energy deposit to a digitized pulse.
+   * @param[in,out] pulse The digitized pulse.
+   * @param energy Energy of the deposit.
+   * @param time Time of the deposit.
+   */
+  void add(std::span<float> pulse, float energy, float time) const;
+
+  /// Number of samples in a pulse.
+  size_t nSamples() const;
+
+  /// Number of phases per sampling interval.
+  size_t nPhases() const;
+
+  /**
+   * @brief Return the shape for one phase.
+   * @param phase The phase, from 0 to nPhases()-1; the shape is sampled
+   *              at times (j - phase/nPhases) * samplingInterval.
+   */
+  std::span<const float> shape(size_t phase) const;
+
+private:
+  size_t m_nSamples;
+  size_t m_nPhases;
+  float m_samplingInterval;
+  /// Shapes for each phase, nPhases rows of nSamples.
+  std::vector<float> m_table;
+};
+
+/**
+ * @brief Evaluate the Gaussian pulse shape.
+ */
+inline float GaussianPulseShape::operator()(float t) const {
+  return (1.0 / (sigma * std::sqrt(2 * std::numbers::pi))) * std::exp(-0.5 * std::pow((t - mu) / sigma, 2));
+}
+
+/**
+ * @brief Constructor.
+ */
+template <class SHAPE>
+PulseShapeLibrary::PulseShapeLibrary(const SHAPE& shape, size_t nSamples, float samplingInterval, size_t nPhases)
+    : m_nSamples(nSamples), m_nPhases(nPhases > 0 ? nPhases : 1), m_samplingInterval(samplingInterval),
+      m_table(m_nPhases * nSamples) {
+  for (size_t p = 0; p < m_nPhases; ++p) {
+    const double offset = static_cast<double>(p) / m_nPhases;
+    // Sample 0 precedes the deposit; it is nearest only for offsets up to one half.
+    const size_t first = 2 * p > m_nPhases ? 1 : 0;
+    for (size_t j = first; j < m_nSamples; ++j)
+      m_table[p * m_nSamples + j] = shape((j - offset) * samplingInterval);
+  }
+}
+
+/**
+ * @brief Number of samples in a pulse.
+ */
+inline size_t PulseShapeLibrary::nSamples() const { return m_nSamples; }
+
+/**
+ * @brief Number of phases per sampling interval.
+ */
+inline size_t PulseShapeLibrary::nPhases() const { return m_nPhases; }
+
+/**
+ * @brief Return the shape for one phase.
+ */
+inline std::span<const float> PulseShapeLibrary::shape(size_t phase) const {
+  return std::span<const float>(m_table.data() + phase * m_nSamples, m_nSamples);
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_PULSESHAPELIBRARY_H
@@ -0,0 +1,744 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/TopoClusterEngine.h
+ * @date Oct, 2026
+ * @brief Index-based proto-cluster growth for topological clustering.
+ *
+ * The topo-clustering algorithms originally grew clusters using
+ * std::map's keyed on cell IDs, cloned every clustered cell into a per-cluster
+ * collection, and merged clusters by scanning the target collection for
+ * each moved cell.  For events with tens of thousands of active cells,
+ * this dominated the reconstruction time.
+ *
+ * TopoClusterEngine instead maps each active cell once to a dense `slot'
+ * (its position in the list of active cells for this event) via an
+ * ICaloIndexer, and keeps all clustering state in flat arrays indexed
+ * by slot.  Cluster ownership is tracked with a union-find structure,
+ * and the cells of each cluster are kept in an intrusive linked list,
+ * so that merging two clusters is O(1).  The clusters are only
+ * materialized once growth has finished.
+ *
+ * The growth follows exactly the same procedure as
+ * CaloTopoClusterFCCee::buildProtoClusters, so the resulting clusters,
+ * the order of the clusters, and the order of the cells within each
+ * cluster, are identical.  In particular:
+ *  - Seeds are cells with |E| > offset + seedSigma * rms, sorted in order
+ *    of decreasing energy.  Each seed which is not already clustered
+ *    starts a new cluster, with an ID given by the (1-based) position of the
+ *    seed in the sorted list.
+ *  - Neighbours passing |E| > offset + neighbourSigma * rms are added
+ *    iteratively.  If a neighbour is found which already belongs to another
+ *    cluster, the current cluster is merged into that one, and growth
+ *    continues under the ID of that cluster.
+ *  - Finally, neighbours of the seed and neighbour cells passing the
+ *    lastNeighbourSigma threshold are added, without merging.
+ *
+ * Optionally, the growth can be spread over several threads.  Growing
+ * a cluster only ever reads or modifies the state of cells which can
+ * be clustered (seeds, and cells passing either the neighbour or the
+ * last-neighbour threshold) and which are connected to the seed through
+ * a chain of such cells.  So we first find the connected components
+ * of the neighbour graph restricted to clusterable cells, and then process
+ * the components independently, each with its seeds in the global
+ * order.  Cluster IDs are still taken from the global seed order,
+ * so the result is identical to the sequential algorithm, independent
+ * of the number of threads.
+ *
+ * The engine allocates an array sized to the total number of cells
+ * known to the indexer, but it is reset in time proportional to the number
+ * of active cells.  It is therefore intended to be reused from event
+ * to event; it is not itself thread-safe, so one instance should be used
+ * for each concurrently-processed event.
+ *
+ * Usage:
+ *@code
+ *  engine.clear();
+ *  for (...) engine.addCell(cellID, energy, noiseRMS, noiseOffset);
+ *  if (engine.build(thresholds, true, neighboursFunc)) {
+ *    for (size_t i = 0; i < engine.nClusters(); ++i)
+ *      for (slot_t s : engine.clusterCells(i)) ...
+ *  }
+ @endcode
+ */
+
+#ifndef RECCALOCOMMON_TOPOCLUSTERENGINE_H
+#define RECCALOCOMMON_TOPOCLUSTERENGINE_H
+
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/NeighbourTable.h"
+#include "tbb/blocked_range.h"
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Index-based proto-cluster growth for topological clustering.
+ */
+class TopoClusterEngine {
+public:
+  using CellID = ICaloIndexer::CellID;
+  using index_t = ICaloIndexer::index_t;
+
+  /// Type of a slot: the position of a cell in the list of active cells.
+  using slot_t = uint32_t;
+  static constexpr slot_t NOSLOT = static_cast<slot_t>(-1);
+
+  /// Type of a cluster ID.  Valid IDs start at 1.
+  using clusterID_t = uint32_t;
+  static constexpr clusterID_t NOCLUSTER = 0;
+
+  /// Cell types assigned to clustered cells.
+  enum CellType : int8_t { UNCLUSTERED = 0, SEED = 1, NEIGHBOUR = 2, LASTNEIGHBOUR = 3 };
+
+  /// Clustering thresholds, in units of the noise RMS.
+  struct Thresholds {
+    int seedSigma;
+    int neighbourSigma;
+    int lastNeighbourSigma;
+  };
+
+  /**
+   * @brief Constructor.
+   * @param indexer Indexer used to map cell IDs to dense indices.
+   *                Must cover all cells which will be given to @c addCell.
+   *                Must remain valid for the lifetime of this object.
+   */
+  explicit TopoClusterEngine(const ICaloIndexer& indexer);
+
+  /**
+   * @brief Reset the engine for a new event.
+   *
+   * Takes time proportional to the number of active cells in the
+   * previous event.
+   */
+  void clear();
+
+  /**
+   * @brief Add an active cell.
+   * @param id The cell identifier.
+   * @param energy The cell energy.
+   * @param noiseRMS The noise RMS for this cell.
+   * @param noiseOffset The noise offset for this cell.
+   *
+   * Returns the slot number of this cell, or @c NOSLOT if the cell
+   * is not known to the indexer.  Slots are assigned sequentially
+   * starting from 0.  If a cell ID is added more than once, the first
+   * instance is used for neighbour searches, and the later instances
+   * are chained together (see @c nextDuplicate).
+   */
+  slot_t addCell(CellID id, float energy, double noiseRMS, double noiseOffset);
+
+  /**
+   * @brief Add an active cell whose index is already known.
+   * @param ndx The index of the cell, as given by the indexer, or @c INVALID.
+   * @param id The cell identifier.
+   * @param energy The cell energy.
+   * @param noiseRMS The noise RMS for this cell.
+   * @param noiseOffset The noise offset for this cell.
+   *
+   * As the other @c addCell, but avoids a second index lookup when the
+   * caller has already looked up the cell (for example to find its noise).
+   */
+  slot_t addCell(index_t ndx, CellID id, float energy, double noiseRMS, double noiseOffset);
+
+  /**
+   * @brief Build the proto-clusters.
+   * @param thresholds Clustering thresholds.
+   * @param failOnMissing If true, it is an error for a cell in the main
+   *                      growth phase to have no neighbours.
+   * @param neighbours Callable returning a range of the neighbouring
+   *                   cell IDs of a given cell ID.  The range must remain
+   *                   valid until the next call.
+   *                   May also be a NeighbourTable indexed like the indexer
+   *                   of the engine (see NeighbourTable::matches), in which
+   *                   case the neighbour indices are used directly.
+   * @param arena If non-null, spread the growth over the threads
+   *              of this arena.  In that case, a separate copy
+   *              of @c neighbours is made for each thread.
+   *
+   * Returns false on error, in which case the ID of the offending
+   * cell is available from @c failedCell.
+   */
+  template <class NEIGHBOURS>
+  bool build(const Thresholds& thresholds, bool failOnMissing, NEIGHBOURS&& neighbours,
+             tbb::task_arena* arena = nullptr);
+
+  /**
+   * @brief Number of active cells (slots) added.
+   */
+  size_t nCells() const;
+
+  /**
+   * @brief Number of seed cells found by the last @c build.
+   */
+  size_t nSeeds() const;
+
+  /**
+   * @brief Number of clusters made by the last @c build.
+   */
+  size_t nClusters() const;
+
+  /**
+   * @brief Return the ID of the i'th cluster.  Clusters are ordered
+   *        by increasing ID.
+   */
+  clusterID_t clusterID(size_t i) const;
+
+  /**
+   * @brief Return the slots of the cells in the i'th cluster.
+   *
+   * The cells are in the order in which they were added to the cluster.
+   */
+  std::span<const slot_t> clusterCells(size_t i) const;
+
+  /**
+   * @brief Return the ID of the cell in a slot.
+   */
+  CellID cellID(slot_t s) const;
+
+  /**
+   * @brief Return the type (@c CellType) assigned to the cell in a slot.
+   */
+  int cellType(slot_t s) const;
+
+  /**
+   * @brief Return the first slot holding the same cell ID as slot @c s.
+   */
+  slot_t canonical(slot_t s) const;
+
+  /**
+   * @brief Return the next slot holding the same cell ID as slot @c s,
+   *        or @c NOSLOT.
+   *
+   * Starting from @c canonical(s), this will iterate over all slots
+   * for a cell ID, in the order in which they were added.
+   */
+  slot_t nextDuplicate(slot_t s) const;
+
+  /**
+   * @brief The ID of the cell which caused @c build to fail.
+   */
+  CellID failedCell() const;
+
+  /**
+   * @brief Number of independent groups of cells processed by the last
+   *        multithreaded @c build.
+   */
+  size_t nComponents() const;
+
+private:
+  /// Scratch space for the growth iterations.
+  struct Scratch {
+    std::vector<slot_t> frontier;
+    std::vector<slot_t> nextFrontier;
+    /// Cell which caused a failure.
+    CellID failedCell = 0;
+  };
+
+  /**
+   * @brief Grow the cluster starting from one seed.
+   * @param iseed Index of the seed in @c m_seeds.
+   * @param thresholds Clustering thresholds.
+   * @param failOnMissing If true, it is an error for a cell in the main
+   *                      growth phase to have no neighbours.
+   * @param neighbours Callable returning neighbouring cell IDs.
+   * @param scratch Scratch space to use.
+   *
+   * Returns false if a cell with no neighbours was found and
+   * @c failOnMissing is set, with the offending cell in @c scratch.
+   */
+  template <class NEIGHBOURS>
+  bool growCluster(size_t iseed, const Thresholds& thresholds, bool failOnMissing, NEIGHBOURS& neighbours,
+                   Scratch& scratch);
+
+  /**
+   * @brief Multithreaded version of the cluster growth.
+   */
+  template <class NEIGHBOURS>
+  bool growParallel(const Thresholds& thresholds, bool failOnMissing, NEIGHBOURS& neighbours, tbb::task_arena& arena);
+
+  /// Test if a cell passes a threshold.
+  bool passes(slot_t s, int numSigma) const;
+
+  /// Find the root of a component of cells.
+  slot_t findComponent(slot_t s);
+
+  /// Join two components of cells.
+  void joinComponents(slot_t a, slot_t b);
+
+  /**
+   * @brief Group the seeds by connected component.
+   * @param edges Pairs of neighbouring clusterable cells.
+   *
+   * Fills @c m_componentSeeds and @c m_componentOffsets.
+   */
+  void groupSeeds(std::span<const std::pair<slot_t, slot_t>> edges);
+
+  /**
+   * @brief Find the current owner of a cluster ID.
+   * @param id The cluster ID to look up.
+   */
+  clusterID_t findCluster(clusterID_t id);
+
+  /**
+   * @brief Add a cell to the end of a cluster.
+   * @param id The cluster ID, which must be a root.
+   * @param s The slot of the cell to add.
+   * @param type The type to assign to the cell.
+   */
+  void addToCluster(clusterID_t id, slot_t s, CellType type);
+
+  /**
+   * @brief Merge one cluster into another.
+   * @param from ID of the cluster to merge; must be a root.
+   * @param to ID of the cluster into which to merge; must be a root.
+   *
+   * The cells of @c from are appended to those of @c to.
+   */
+  void mergeClusters(clusterID_t from, clusterID_t to);
+
+  /**
+   * @brief Search for neighbours of a cell and add them to a cluster.
+   * @param s The slot of the cell whose neighbours we examine.
+   * @param[inout] id The ID of the current cluster.  Will be changed
+   *                  if the cluster is merged.
+   * @param numSigma The threshold to apply, in units of noise RMS.
+   * @param type The type to assign to added cells.
+   * @param allowMerge If true, merge clusters when a neighbour
+   *                   belonging to another cluster is found.
+   * @param neighbours Callable returning neighbouring cell IDs.
+   * @param[out] added Slots of added neighbours are appended here.
+   *
+   * Returns false if the cell has no neighbours.
+   */
+  template <class NEIGHBOURS>
+  bool searchForNeighbours(slot_t s, clusterID_t& id, int numSigma, CellType type, bool allowMerge,
+                           NEIGHBOURS& neighbours, std::vector<slot_t>& added);
+
+  /**
+   * @brief Call a function for the indices of the neighbours of a cell.
+   * @param s The slot of the cell whose neighbours we examine.
+   * @param neighbours Callable returning neighbouring cell IDs,
+   *                   or a NeighbourTable indexed like @c m_indexer.
+   * @param f Called with the index of each neighbour, until it returns false.
+   *          Indices not less than the size of @c m_slotOfIndex are
+   *          cells unknown to the indexer.
+   *
+   * Returns false if the cell has no neighbours.
+   */
+  template <class NEIGHBOURS, class FUNC>
+  bool forEachNeighbour(slot_t s, NEIGHBOURS& neighbours, FUNC&& f) const;
+
+  /// Find and sort the seeds.
+  void findSeeds(int seedSigma);
+
+  /// Make the list of resulting clusters.
+  void collectClusters();
+
+  /// The indexer used to map cell IDs.
+  const ICaloIndexer& m_indexer;
+
+  /// Map from indexer index to slot.  Sized to the number of cells known
+  /// to the indexer; unused entries are @c NOSLOT.
+  std::vector<slot_t> m_slotOfIndex;
+
+  // Per-slot data.
+  std::vector<CellID> m_cellID;
+  std::vector<index_t> m_index;
+  std::vector<float> m_energy;
+  std::vector<double> m_noiseRMS;
+  std::vector<double> m_noiseOffset;
+  std::vector<slot_t> m_canonical;
+  std::vector<slot_t> m_nextDuplicate;
+  /// Cluster ID assigned to the cell, or NOCLUSTER.  This is the ID
+  /// at the time the cell was added; use @c findCluster to get the current
+  /// owner.  Only meaningful for canonical slots.
+  std::vector<clusterID_t> m_label;
+  std::vector<int8_t> m_type;
+  /// Next cell in the same cluster.
+  std::vector<slot_t> m_nextInCluster;
+
+  // Per-cluster data, indexed by cluster ID.
+  /// Union-find parent.  NOCLUSTER for IDs not in use.
+  std::vector<clusterID_t> m_parent;
+  std::vector<slot_t> m_head;
+  std::vector<slot_t> m_tail;
+
+  /// Seeds, sorted by decreasing energy.
+  std::vector<slot_t> m_seeds;
+
+  // Results: IDs of the final clusters, and their cells.
+  std::vector<clusterID_t> m_clusterIDs;
+  std::vector<size_t> m_clusterOffsets;
+  std::vector<slot_t> m_clusterCells;
+
+  /// Scratch space for sequential growth.
+  Scratch m_scratch;
+
+  // Used for multithreaded growth.
+  /// Union-find parent for components of cells, indexed by slot.
+  std::vector<slot_t> m_componentParent;
+  /// Size of each component, indexed by root slot.
+  std::vector<slot_t> m_componentSize;
+  /// Clusterable cells.
+  std::vector<slot_t> m_clusterable;
+  std::vector<uint8_t> m_isClusterable;
+  /// Number of each component containing seeds, indexed by root slot.
+  std::vector<uint32_t> m_componentNumber;
+  /// Seed positions (in @c m_seeds), grouped by component.
+  std::vector<uint32_t> m_componentSeeds;
+  std::vector<size_t> m_componentOffsets;
+  /// Components, in order of decreasing number of cells.
+  std::vector<uint32_t> m_componentOrder;
+
+  /// Cell which caused a failure.
+  CellID m_failedCell = 0;
+};
+
+/**
+ * @brief Build the proto-clusters.
+ */
+template <class NEIGHBOURS>
+bool TopoClusterEngine::build(const Thresholds& thresholds, bool failOnMissing, NEIGHBOURS&& neighbours,
+                              tbb::task_arena* arena /*= nullptr*/) {
+  m_failedCell = 0;
+  m_componentOffsets.clear();
+  findSeeds(thresholds.seedSigma);
+
+  if (arena && m_seeds.size() > 1) {
+    if (!growParallel(thresholds, failOnMissing, neighbours, *arena))
+      return false;
+  } else {
+    for (size_t iseed = 0; iseed < m_seeds.size(); ++iseed) {
+      if (!growCluster(iseed, thresholds, failOnMissing, neighbours, m_scratch)) {
+        m_failedCell = m_scratch.failedCell;
+        return false;
+      }
+    }
+  }
+
+  collectClusters();
+  return true;
+}
+
+/**
+ * @brief Grow the cluster starting from one seed.
+ */
+template <class NEIGHBOURS>
+bool TopoClusterEngine::growCluster(size_t iseed, const Thresholds& thresholds, bool failOnMissing,
+                                    NEIGHBOURS& neighbours, Scratch& scratch) {
+  slot_t seed = m_seeds[iseed];
+  if (m_label[m_canonical[seed]] != NOCLUSTER) {
+    // Seed is already assigned to another cluster.
+    return true;
+  }
+
+  // The original algorithm chooses the cell type by comparing the threshold
+  // with the last-neighbour threshold.
+  const CellType nextType =
+      thresholds.neighbourSigma == thresholds.lastNeighbourSigma ? LASTNEIGHBOUR : NEIGHBOUR;
+
+  // New cluster starts with the seed.  IDs start at 1.
+  clusterID_t id = iseed + 1;
+  m_parent[id] = id;
+  m_label[m_canonical[seed]] = id;
+  addToCluster(id, seed, SEED);
+
+  // Iteratively add neighbours.
+  scratch.frontier.assign(1, seed);
+  while (!scratch.frontier.empty()) {
+    scratch.nextFrontier.clear();
+    for (slot_t s : scratch.frontier) {
+      if (!searchForNeighbours(s, id, thresholds.neighbourSigma, nextType, true, neighbours, scratch.nextFrontier) &&
+          failOnMissing) {
+        scratch.failedCell = m_cellID[s];
+        return false;
+      }
+    }
+    scratch.frontier.swap(scratch.nextFrontier);
+  }
+
+  // Last round, with a different threshold and no merging,
+  // over the seed and neighbour cells of the cluster.
+  scratch.frontier.clear();
+  for (slot_t s = m_head[id]; s != NOSLOT; s = m_nextInCluster[s]) {
+    if (m_type[s] <= NEIGHBOUR)
+      scratch.frontier.push_back(s);
+  }
+  for (slot_t s : scratch.frontier) {
+    scratch.nextFrontier.clear();
+    searchForNeighbours(s, id, thresholds.lastNeighbourSigma, LASTNEIGHBOUR, false, neighbours, scratch.nextFrontier);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Multithreaded version of the cluster growth.
+ */
+template <class NEIGHBOURS>
+bool TopoClusterEngine::growParallel(const Thresholds& thresholds, bool failOnMissing, NEIGHBOURS& neighbours,
+                                     tbb::task_arena& arena) {
+  using NeighboursCopy = std::remove_cvref_t<NEIGHBOURS>;
+  using Edges = std::vector<std::pair<slot_t, slot_t>>;
+
+  // List the cells which could possibly be clustered: seeds, and cells
+  // passing either neighbour threshold.  Only canonical slots are used
+  // for neighbour searches; a seed may be a later duplicate of a cell.
+  size_t ncells = m_cellID.size();
+  m_isClusterable.assign(ncells, 0);
+  for (slot_t seed : m_seeds)
+    m_isClusterable[m_canonical[seed]] = 1;
+  for (slot_t s = 0; s < ncells; ++s) {
+    if (m_canonical[s] == s && (passes(s, thresholds.neighbourSigma) || passes(s, thresholds.lastNeighbourSigma)))
+      m_isClusterable[s] = 1;
+  }
+  m_clusterable.clear();
+  for (slot_t s = 0; s < ncells; ++s) {
+    if (m_isClusterable[s])
+      m_clusterable.push_back(s);
+  }
+
+  // Find the links between clusterable cells.  Done in parallel, since
+  // it requires the neighbour lookups.
+  tbb::enumerable_thread_specific<NeighboursCopy> threadNeighbours(neighbours);
+  tbb::enumerable_thread_specific<Edges> threadEdges;
+  arena.execute([&]() {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_clusterable.size(), 256),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        NeighboursCopy& nb = threadNeighbours.local();
+                        Edges& edges = threadEdges.local();
+                        for (size_t i = r.begin(); i != r.end(); ++i) {
+                          slot_t s = m_clusterable[i];
+                          forEachNeighbour(s, nb, [&](index_t ndx) {
+                            if (ndx >= m_slotOfIndex.size())
+                              return true;
+                            slot_t ns = m_slotOfIndex[ndx];
+                            if (ns != NOSLOT && m_isClusterable[ns])
+                              edges.emplace_back(s, ns);
+                            return true;
+                          });
+                        }
+                      });
+  });
+
+  Edges edges;
+  for (Edges& e : threadEdges)
+    edges.insert(edges.end(), e.begin(), e.end());
+  groupSeeds(edges);
+
+  // Now grow the clusters of each component in parallel.
+  // Components are processed in order of decreasing size for better
+  // load balancing.
+  tbb::enumerable_thread_specific<Scratch> threadScratch;
+  std::atomic<bool> failed = false;
+  arena.execute([&]() {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_componentOrder.size(), 1),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        NeighboursCopy& nb = threadNeighbours.local();
+                        Scratch& scratch = threadScratch.local();
+                        for (size_t i = r.begin(); i != r.end(); ++i) {
+                          uint32_t icomp = m_componentOrder[i];
+                          for (size_t j = m_componentOffsets[icomp]; j < m_componentOffsets[icomp + 1]; ++j) {
+                            if (failed.load(std::memory_order_relaxed))
+                              return;
+                            if (!growCluster(m_componentSeeds[j], thresholds, failOnMissing, nb, scratch)) {
+                              // Only record the first failure.
+                              if (!failed.exchange(true))
+                                m_failedCell = scratch.failedCell;
+                              return;
+                            }
+                          }
+                        }
+                      });
+  });
+
+  return !failed;
+}
+
+/**
+ * @brief Search for neighbours of a cell and add them to a cluster.
+ */
+template <class NEIGHBOURS>
+bool TopoClusterEngine::searchForNeighbours(slot_t s, clusterID_t& id, int numSigma, CellType type, bool allowMerge,
+                                            NEIGHBOURS& neighbours, std::vector<slot_t>& added) {
+  return forEachNeighbour(s, neighbours, [&](index_t ndx) {
+    // Is the neighbour an active cell?
+    if (ndx >= m_slotOfIndex.size()) [[unlikely]]
+      return true;
+    slot_t ns = m_slotOfIndex[ndx];
+    if (ns == NOSLOT)
+      return true;
+
+    if (m_label[ns] == NOCLUSTER) {
+      // Not yet clustered.  Add it if it passes the threshold.
+      if (numSigma == 0 || std::fabs(m_energy[ns]) > m_noiseOffset[ns] + m_noiseRMS[ns] * numSigma) {
+        m_label[ns] = id;
+        addToCluster(id, ns, type);
+        added.push_back(ns);
+      }
+    } else if (allowMerge) {
+      clusterID_t owner = findCluster(m_label[ns]);
+      if (owner != id) {
+        // Belongs to another cluster.  Merge the current cluster into it,
+        // and continue with the merged cluster.
+        mergeClusters(id, owner);
+        id = owner;
+        added.push_back(ns);
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+/**
+ * @brief Call a function for the indices of the neighbours of a cell.
+ */
+template <class NEIGHBOURS, class FUNC>
+bool TopoClusterEngine::forEachNeighbour(slot_t s, NEIGHBOURS& neighbours, FUNC&& f) const {
+  if constexpr (std::is_same_v<std::remove_cvref_t<NEIGHBOURS>, NeighbourTable>) {
+    // The table is indexed like our indexer, so no lookups are needed.
+    std::span<const index_t> ndxs = neighbours.neighbours(m_index[s]);
+    if (ndxs.empty())
+      return false;
+    for (index_t ndx : ndxs) {
+      if (!f(ndx))
+        break;
+    }
+  } else {
+    const auto& neighbourIDs = neighbours(m_cellID[s]);
+    if (std::empty(neighbourIDs))
+      return false;
+    for (CellID neighbourID : neighbourIDs) {
+      if (!f(m_indexer.index(neighbourID)))
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Number of active cells (slots) added.
+ */
+inline size_t TopoClusterEngine::nCells() const { return m_cellID.size(); }
+
+/**
+ * @brief Number of seed cells found by the last @c build.
+ */
+inline size_t TopoClusterEngine::nSeeds() const { return m_seeds.size(); }
+
+/**
+ * @brief Number of clusters made by the last @c build.
+ */
+inline size_t TopoClusterEngine::nClusters() const { return m_clusterIDs.size(); }
+
+/**
+ * @brief Return the ID of the i'th cluster.
+ */
+inline auto TopoClusterEngine::clusterID(size_t i) const -> clusterID_t { return m_clusterIDs[i]; }
+
+/**
+ * @brief Return the slots of the cells in the i'th cluster.
+ */
+inline auto TopoClusterEngine::clusterCells(size_t i) const -> std::span<const slot_t> {
+  return std::span<const slot_t>(m_clusterCells.data() + m_clusterOffsets[i],
+                                 m_clusterOffsets[i + 1] - m_clusterOffsets[i]);
+}
+
+/**
+ * @brief Return the ID of the cell in a slot.
+ */
+inline auto TopoClusterEngine::cellID(slot_t s) const -> CellID { return m_cellID[s]; }
+
+/**
+ * @brief Return the type assigned to the cell in a slot.
+ */
+inline int TopoClusterEngine::cellType(slot_t s) const { return m_type[s]; }
+
+/**
+ * @brief Return the first slot holding the same cell ID as slot @c s.
+ */
+inline auto TopoClusterEngine::canonical(slot_t s) const -> slot_t { return m_canonical[s]; }
+
+/**
+ * @brief Return the next slot holding the same cell ID as slot @c s.
+ */
+inline auto TopoClusterEngine::nextDuplicate(slot_t s) const -> slot_t { return m_nextDuplicate[s]; }
+
+/**
+ * @brief The ID of the cell which caused @c build to fail.
+ */
+inline auto TopoClusterEngine::failedCell() const -> CellID { return m_failedCell; }
+
+/**
+ * @brief Number of independent groups of cells processed by the last
+ *        multithreaded @c build.
+ */
+inline size_t TopoClusterEngine::nComponents() const {
+  return m_componentOffsets.empty() ? 0 : m_componentOffsets.size() - 1;
+}
+
+/**
+ * @brief Test if a cell passes a threshold.
+ */
+inline bool TopoClusterEngine::passes(slot_t s, int numSigma) const {
+  return numSigma == 0 || std::fabs(m_energy[s]) > m_noiseOffset[s] + m_noiseRMS[s] * numSigma;
+}
+
+/**
+ * @brief Find the current owner of a cluster ID.
+ */
+inline auto TopoClusterEngine::findCluster(clusterID_t id) -> clusterID_t {
+  clusterID_t root = id;
+  while (m_parent[root] != root)
+    root = m_parent[root];
+  // Path compression.
+  while (m_parent[id] != root) {
+    clusterID_t next = m_parent[id];
+    m_parent[id] = root;
+    id = next;
+  }
+  return root;
+}
+
+/**
+ * @brief Add a cell to the end of a cluster.
+ */
+inline void TopoClusterEngine::addToCluster(clusterID_t id, slot_t s, CellType type) {
+  m_type[s] = type;
+  if (m_tail[id] == NOSLOT)
+    m_head[id] = s;
+  else
+    m_nextInCluster[m_tail[id]] = s;
+  m_tail[id] = s;
+}
+
+/**
+ * @brief Merge one cluster into another.
+ */
+inline void TopoClusterEngine::mergeClusters(clusterID_t from, clusterID_t to) {
+  m_parent[from] = to;
+  if (m_head[from] != NOSLOT) {
+    if (m_tail[to] == NOSLOT)
+      m_head[to] = m_head[from];
+    else
+      m_nextInCluster[m_tail[to]] = m_head[from];
+    m_tail[to] = m_tail[from];
+  }
+  m_head[from] = m_tail[from] = NOSLOT;
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_TOPOCLUSTERENGINE_H
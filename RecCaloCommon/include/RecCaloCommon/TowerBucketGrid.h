@@ -0,0 +1,103 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/TowerBucketGrid.h
+ * @date Oct, 2026
+ * @brief Buckets of objects in tower index space, for neighbour queries.
+ */
+
+#ifndef RECCALOCOMMON_TOWERBUCKETGRID_H
+#define RECCALOCOMMON_TOWERBUCKETGRID_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Buckets of objects in tower index space, for neighbour queries.
+ *
+ * The sliding-window algorithms compare each pre-cluster with all the
+ * others, to remove duplicates and to share the energy of overlapping
+ * clusters, which is quadratic in the number of pre-clusters.
+ *
+ * Here, objects are placed by their (eta or theta, phi) tower indices
+ * into buckets of a fixed number of towers, the phi index wrapping around.
+ * The buckets are stored in compressed-sparse-row form, as for TowerGrid.
+ * A query returns the objects of all buckets touching a window around a
+ * tower; these include all the objects in the window, and the caller
+ * makes the exact test.  With buckets about as large as the window, a
+ * query looks at a few buckets, so that finding the neighbours of all
+ * objects is linear in their number for a bounded density.
+ *
+ * Rows outside of [0, nRows) are taken as the first or last row, which
+ * keeps the result of a query a superset of the objects in the window.
+ */
+class TowerBucketGrid {
+public:
+  /// Index of an object.
+  using index_t = uint32_t;
+
+  /**
+   * @brief Constructor.
+   * @param nRows Number of towers in eta (or theta).
+   * @param nPhi Number of towers in phi.
+   * @param bucketRows Number of towers in eta (or theta) in a bucket.
+   * @param bucketPhi Number of towers in phi in a bucket.
+   *
+   * The grid holds no objects.
+   */
+  TowerBucketGrid(int nRows, int nPhi, int bucketRows, int bucketPhi);
+
+  /**
+   * @brief Place objects into the buckets.
+   * @param rows The eta (or theta) tower index of each object.
+   * @param phis The phi tower index of each object; any value.
+   *
+   * Object @c i is the one at <code>(rows[i], phis[i])</code>.
+   * Replaces any objects placed before.
+   */
+  void fill(std::span<const int> rows, std::span<const int> phis);
+
+  /**
+   * @brief Find the objects that may be near a tower.
+   * @param iRow The eta (or theta) index of the tower.
+   * @param iPhi The phi index of the tower; any value.
+   * @param dRow Half size of the window in eta (or theta).
+   * @param dPhi Half size of the window in phi.
+   * @param[out] found The objects of the buckets touching the window,
+   *                   in increasing order.
+   *
+   * All objects within @c dRow rows and @c dPhi towers in phi (the
+   * shorter way round) of the tower are found, along with others.
+   * Negative half sizes are taken as zero.
+   */
+  void query(int iRow, int iPhi, int dRow, int dPhi, std::vector<index_t>& found) const;
+
+private:
+  /// Return the bucket index of a phi tower index.
+  int phiBucket(int iPhi) const;
+  /// Add the objects of a range of buckets in one row of buckets.
+  void addBuckets(int rowBucket, int phiBucketBegin, int phiBucketEnd, std::vector<index_t>& found) const;
+
+  /// Number of towers in eta (or theta).
+  int m_nRows;
+  /// Number of towers in phi.
+  int m_nPhi;
+  /// Number of towers in eta (or theta) in a bucket.
+  int m_bucketRows;
+  /// Number of towers in phi in a bucket.
+  int m_bucketPhi;
+  /// Number of buckets in eta (or theta).
+  int m_nRowBuckets;
+  /// Number of buckets in phi.
+  int m_nPhiBuckets;
+  /// Offsets into m_objects, indexed by bucket; one more than the number of buckets.
+  std::vector<index_t> m_offsets;
+  /// Concatenated lists of objects in each bucket.
+  std::vector<index_t> m_objects;
+};
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_TOWERBUCKETGRID_H
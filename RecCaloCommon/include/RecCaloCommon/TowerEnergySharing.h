@@ -0,0 +1,81 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/TowerEnergySharing.h
+ * @date Oct, 2026
+ * @brief Energy sharing correction between overlapping sliding-window clusters.
+ */
+
+#ifndef RECCALOCOMMON_TOWERENERGYSHARING_H
+#define RECCALOCOMMON_TOWERENERGYSHARING_H
+
+#include "RecCaloCommon/TowerBucketGrid.h"
+#include <span>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Energy sharing correction between overlapping sliding-window clusters.
+ *
+ * The final clusters of the sliding-window algorithms are windows of
+ * (2*halfRows+1) x (2*halfPhi+1) towers around a centre tower, so nearby
+ * clusters may include the same towers.  Each cluster gives up a part
+ * of the energy E of each of its towers which is also in other clusters:
+ * if S is the summed energy of the tower seen by the other clusters (E
+ * once per other cluster), the cluster loses E*S/(S+E).
+ *
+ * The clusters are placed in a TowerBucketGrid, so that the clusters
+ * overlapping a given one are found without comparing all pairs.  The
+ * phi index wraps around; rows outside of the grid are skipped.
+ */
+class TowerEnergySharing {
+public:
+  /**
+   * @brief Constructor.
+   * @param nRows Number of towers in eta (or theta).
+   * @param nPhi Number of towers in phi.
+   * @param halfRows Half size in eta (or theta) of the final clusters.
+   * @param halfPhi Half size in phi of the final clusters.
+   */
+  TowerEnergySharing(int nRows, int nPhi, int halfRows, int halfPhi);
+
+  /**
+   * @brief Set the positions of the clusters.
+   * @param rows The eta (or theta) tower index of each cluster.
+   * @param phis The phi tower index of each cluster; any value.
+   *
+   * The spans are referenced until the next call.
+   */
+  void fill(std::span<const int> rows, std::span<const int> phis);
+
+  /**
+   * @brief Return the energy of a cluster after the sharing correction.
+   * @param energies Energies of all towers, row by row.
+   * @param iCluster Index of the cluster, as passed to @c fill.
+   * @param energy Energy of the cluster before the correction.
+   */
+  float correct(std::span<const float> energies, size_t iCluster, float energy);
+
+private:
+  /// Number of towers in eta (or theta).
+  int m_nRows;
+  /// Number of towers in phi.
+  int m_nPhi;
+  /// Half size in eta (or theta) of the clusters.
+  int m_halfRows;
+  /// Half size in phi of the clusters.
+  int m_halfPhi;
+  /// Clusters, in buckets of the size of a cluster.
+  TowerBucketGrid m_grid;
+  /// Tower indices of the clusters.
+  std::span<const int> m_rows;
+  std::span<const int> m_phis;
+  /// Clusters which may overlap the current one.
+  std::vector<TowerBucketGrid::index_t> m_candidates;
+  /// Sum of the energies seen by other clusters in each tower of the current one, row by row.
+  std::vector<float> m_shared;
+};
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_TOWERENERGYSHARING_H
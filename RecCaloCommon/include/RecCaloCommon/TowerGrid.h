@@ -0,0 +1,203 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/TowerGrid.h
+ * @date Oct, 2026
+ * @brief Grid of calorimeter tower energies, with the cells in each tower.
+ */
+
+#ifndef RECCALOCOMMON_TOWERGRID_H
+#define RECCALOCOMMON_TOWERGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Grid of calorimeter tower energies, with the cells in each tower.
+ *
+ * The towers used for sliding-window clustering were held as a
+ * std::vector of std::vector of energies, filled by the tower tool,
+ * while the cells in each tower were kept in a std::map from the tower
+ * indices to a std::vector of cells, as a member of the tool.
+ *
+ * Here, the energies are held in one contiguous array, row by row, a row
+ * being all the towers in phi for one eta (or theta) index.  The cells
+ * in each tower are given by indices into a list of cells held by the
+ * caller, and are stored in compressed-sparse-row form: the cells of
+ * tower @c t are <code>cells[offsets[t]] .. cells[offsets[t+1]-1]</code>.
+ * While the grid is being filled, (tower, cell) pairs are accumulated
+ * with @c addCell; @c finalizeCells then builds the index in one pass,
+ * keeping the order in which the cells of each tower were added.
+ *
+ * A grid is meant to be made for each event, so that the tower tools
+ * hold no per-event state.
+ */
+class TowerGrid {
+public:
+  /// Index of a cell in the list held by the caller.
+  using index_t = uint32_t;
+
+  /**
+   * @brief Constructor.
+   * @param nRows Number of towers in eta (or theta).
+   * @param nPhi Number of towers in phi.
+   *
+   * All energies are zero and there are no cells.
+   */
+  TowerGrid(int nRows = 0, int nPhi = 0);
+
+  /// Number of towers in eta (or theta).
+  int nRows() const;
+
+  /// Number of towers in phi.
+  int nPhi() const;
+
+  /// Total number of towers.
+  size_t size() const;
+
+  /**
+   * @brief Return the energies of one row of towers.
+   * @param iRow The eta (or theta) index of the row.
+   *
+   * Allows writing <code>grid[iRow][iPhi]</code>.
+   */
+  std::span<float> operator[](int iRow);
+  std::span<const float> operator[](int iRow) const;
+
+  /**
+   * @brief Return the energies of all towers, row by row.
+   */
+  std::span<float> energies();
+  std::span<const float> energies() const;
+
+  /**
+   * @brief Return the flat index of a tower.
+   * @param iRow The eta (or theta) index of the tower.
+   * @param iPhi The phi index of the tower.
+   */
+  size_t tower(int iRow, int iPhi) const;
+
+  /**
+   * @brief Record that a cell belongs to a tower.
+   * @param iRow The eta (or theta) index of the tower.
+   * @param iPhi The phi index of the tower.
+   * @param cell Index of the cell.
+   *
+   * The cells of the towers are only available after @c finalizeCells.
+   */
+  void addCell(int iRow, int iPhi, index_t cell);
+
+  /**
+   * @brief Record that a cell belongs to a tower.
+   * @param tower The flat index of the tower, as given by @c tower.
+   * @param cell Index of the cell.
+   */
+  void addCell(size_t tower, index_t cell);
+
+  /**
+   * @brief Build the index of cells in each tower from the recorded pairs.
+   *
+   * Must be called once filling is done, even if no cells were added.
+   */
+  void finalizeCells();
+
+  /**
+   * @brief Add rows of empty towers.
+   * @param nRows The new number of rows; ignored if not more than @c nRows().
+   *
+   * The new rows come after the existing ones and hold no cells.
+   * May be called before or after @c finalizeCells.
+   */
+  void extendRows(int nRows);
+
+  /**
+   * @brief Return the cells in a tower.
+   * @param iRow The eta (or theta) index of the tower.
+   * @param iPhi The phi index of the tower.
+   */
+  std::span<const index_t> cells(int iRow, int iPhi) const;
+
+  /**
+   * @brief Return the total number of (tower, cell) entries.
+   */
+  size_t nEntries() const;
+
+private:
+  /// Number of towers in eta (or theta).
+  int m_nRows;
+  /// Number of towers in phi.
+  int m_nPhi;
+  /// Tower energies, row by row.
+  std::vector<float> m_energies;
+  /// (tower, cell) pairs recorded before @c finalizeCells.
+  std::vector<std::pair<uint32_t, index_t>> m_pending;
+  /// Offsets into m_cells, indexed by tower; one more than the number of towers.
+  std::vector<uint32_t> m_offsets;
+  /// Concatenated lists of cells.
+  std::vector<index_t> m_cells;
+};
+
+/**
+ * @brief Number of towers in eta (or theta).
+ */
+inline int TowerGrid::nRows() const { return m_nRows; }
+
+/**
+ * @brief Number of towers in phi.
+ */
+inline int TowerGrid::nPhi() const { return m_nPhi; }
+
+/**
+ * @brief Total number of towers.
+ */
+inline size_t TowerGrid::size() const { return m_energies.size(); }
+
+/**
+ * @brief Return the energies of one row of towers.
+ */
+inline std::span<float> TowerGrid::operator[](int iRow) {
+  return std::span<float>(m_energies.data() + static_cast<size_t>(iRow) * m_nPhi, m_nPhi);
+}
+inline std::span<const float> TowerGrid::operator[](int iRow) const {
+  return std::span<const float>(m_energies.data() + static_cast<size_t>(iRow) * m_nPhi, m_nPhi);
+}
+
+/**
+ * @brief Return the energies of all towers, row by row.
+ */
+inline std::span<float> TowerGrid::energies() { return m_energies; }
+inline std::span<const float> TowerGrid::energies() const { return m_energies; }
+
+/**
+ * @brief Return the flat index of a tower.
+ */
+inline size_t TowerGrid::tower(int iRow, int iPhi) const { return static_cast<size_t>(iRow) * m_nPhi + iPhi; }
+
+/**
+ * @brief Record that a cell belongs to a tower.
+ */
+inline void TowerGrid::addCell(int iRow, int iPhi, index_t cell) {
+  m_pending.emplace_back(static_cast<uint32_t>(tower(iRow, iPhi)), cell);
+}
+inline void TowerGrid::addCell(size_t tower, index_t cell) { m_pending.emplace_back(static_cast<uint32_t>(tower), cell); }
+
+/**
+ * @brief Return the cells in a tower.
+ */
+inline std::span<const TowerGrid::index_t> TowerGrid::cells(int iRow, int iPhi) const {
+  const size_t t = tower(iRow, iPhi);
+  return std::span<const index_t>(m_cells.data() + m_offsets[t], m_offsets[t + 1] - m_offsets[t]);
+}
+
+/**
+ * @brief Return the total number of (tower, cell) entries.
+ */
+inline size_t TowerGrid::nEntries() const { return m_cells.size(); }
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_TOWERGRID_H
@@ -0,0 +1,236 @@
+// This file's extension implies that it's C, but it's really -*- C++ -*-.
+/**
+ * @file RecCaloCommon/TowerSumTable.h
+ * @date Oct, 2026
+ * @brief Summed-area tables of tower quantities, for sliding-window clustering.
+ */
+
+#ifndef RECCALOCOMMON_TOWERSUMTABLE_H
+#define RECCALOCOMMON_TOWERSUMTABLE_H
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Summed-area tables of tower quantities, for sliding-window clustering.
+ *
+ * The sliding-window algorithms sum tower energies over rectangular
+ * windows in (eta or theta, phi), wrapping around in phi.  They used to
+ * do so by keeping running sums by hand, and by looping over the towers
+ * of each position and final-cluster window.
+ *
+ * Here, each quantity (a `plane') is copied into a grid padded in phi by
+ * @c nGhost ghost columns on each side, which repeat the towers at the
+ * other end of the range, and turned into a table of prefix sums in both
+ * directions, in double precision.  The sum over any window whose phi
+ * range lies within the padded grid is then four lookups, with no
+ * wrapping of indices.  A phi index @c iPhi outside of [0, nPhi) stands
+ * for the tower at @c iPhi modulo nPhi; rows outside of [0, nRows) hold
+ * no towers.
+ *
+ * A table is meant to be made for each event, from the TowerGrid of the
+ * event.
+ */
+class TowerSumTable {
+public:
+  /**
+   * @brief Constructor.
+   * @param nRows Number of towers in eta (or theta).
+   * @param nPhi Number of towers in phi.
+   * @param nGhost Number of ghost columns on each side in phi.
+   *
+   * The table has no planes.
+   */
+  TowerSumTable(int nRows = 0, int nPhi = 0, int nGhost = 0);
+
+  /// Number of towers in eta (or theta).
+  int nRows() const;
+
+  /// Number of towers in phi.
+  int nPhi() const;
+
+  /// Number of ghost columns on each side in phi.
+  int nGhost() const;
+
+  /// Number of planes.
+  int nPlanes() const;
+
+  /**
+   * @brief Add a plane from the values of the towers.
+   * @param values One value per tower, row by row, as TowerGrid::energies.
+   * @return The index of the plane.
+   */
+  int addPlane(std::span<const float> values);
+
+  /**
+   * @brief Add a plane from a function of the tower position.
+   * @param value Called as <code>value(iRow, iPhi)</code> for each row
+   *              and each iPhi in [-nGhost, nPhi + nGhost), to give the
+   *              value of the plane there.
+   * @return The index of the plane.
+   *
+   * As the function is called for the ghost columns too, the value
+   * may depend on the unwrapped phi index, as for the weighting of
+   * towers with their phi position.
+   */
+  template <class FUNC>
+    requires std::invocable<FUNC&, int, int>
+  int addPlane(FUNC&& value);
+
+  /**
+   * @brief Return the phi index, brought into [0, nPhi).
+   * @param iPhi A phi index.
+   */
+  int wrapPhi(int iPhi) const;
+
+  /**
+   * @brief Sum a plane over a window.
+   * @param plane Index of the plane.
+   * @param rowBegin First row of the window.
+   * @param rowEnd One past the last row of the window.
+   * @param phiBegin First phi index of the window, at least -nGhost.
+   * @param phiEnd One past the last phi index of the window, at most nPhi + nGhost.
+   *
+   * Rows outside of the grid are skipped.
+   */
+  double sum(int plane, int rowBegin, int rowEnd, int phiBegin, int phiEnd) const;
+
+  /**
+   * @brief Sum a plane over a window given by its centre.
+   * @param plane Index of the plane.
+   * @param iRow Central row of the window.
+   * @param iPhi Central phi index of the window; any value.
+   * @param halfRows Half size of the window in rows.
+   * @param halfPhi Half size of the window in phi, at most nGhost.
+   *
+   * The window holds (2*halfRows+1) x (2*halfPhi+1) towers, less those
+   * in rows outside of the grid.
+   */
+  double windowSum(int plane, int iRow, int iPhi, int halfRows, int halfPhi) const;
+
+  /**
+   * @brief Sum a plane over an ellipse given by its centre.
+   * @param plane Index of the plane.
+   * @param iRow Central row of the ellipse.
+   * @param iPhi Central phi index of the ellipse; any value.
+   * @param halfRows Half size of the enclosing window in rows.
+   * @param halfPhi Half size of the enclosing window in phi, at most nGhost.
+   * @param radiusRows Semi-axis of the ellipse in rows.
+   * @param radiusPhi Semi-axis of the ellipse in phi.
+   *
+   * Sums the towers of the window for which
+   * (dRow/radiusRows)^2 + (dPhi/radiusPhi)^2 < 1, with dRow and dPhi
+   * their distance to the centre in towers.
+   */
+  double ellipseSum(int plane, int iRow, int iPhi, int halfRows, int halfPhi, double radiusRows,
+                    double radiusPhi) const;
+
+  /**
+   * @brief Find the seeds of the sliding window in one row.
+   * @param plane Index of the plane.
+   * @param iRow Central row of the window; the window must be within the grid.
+   * @param halfRows Half size of the window in rows.
+   * @param halfPhi Half size of the window in phi, less than nGhost.
+   * @param threshold Threshold on the sum over the window.
+   * @param[out] seeds The phi indices of the seeds, in increasing order.
+   *
+   * A window centred on (iRow, iPhi) is a seed if its sum is above
+   * @c threshold and it is a local maximum: the column (row) leaving the
+   * window when it moves by one tower in phi (in rows) is not smaller
+   * than the one entering it.  In rows, the comparison is skipped if the
+   * window would leave the grid.
+   *
+   * The test is done for all phi of the row at once, so that it is
+   * vectorized.
+   */
+  void findSeeds(int plane, int iRow, int halfRows, int halfPhi, double threshold, std::vector<int>& seeds);
+
+private:
+  /// Return the prefix sums of a plane, row by row.
+  const double* table(int plane) const;
+
+  /// Number of towers in eta (or theta).
+  int m_nRows;
+  /// Number of towers in phi.
+  int m_nPhi;
+  /// Number of ghost columns on each side in phi.
+  int m_nGhost;
+  /// Number of entries in a row of a table: the padded columns, plus one.
+  size_t m_stride;
+  /// Number of planes.
+  int m_nPlanes = 0;
+  /// Prefix sums of the planes, each of (nRows+1) rows of m_stride entries.
+  std::vector<double> m_tables;
+  /// Work space for findSeeds: whether each phi is a seed.
+  /// Held as float, which cannot alias the tables, so that the test is vectorized without run-time alias checks.
+  std::vector<float> m_isSeed;
+};
+
+/**
+ * @brief Number of towers in eta (or theta).
+ */
+inline int TowerSumTable::nRows() const { return m_nRows; }
+
+/**
+ * @brief Number of towers in phi.
+ */
+inline int TowerSumTable::nPhi() const { return m_nPhi; }
+
+/**
+ * @brief Number of ghost columns on each side in phi.
+ */
+inline int TowerSumTable::nGhost() const { return m_nGhost; }
+
+/**
+ * @brief Number of planes.
+ */
+inline int TowerSumTable::nPlanes() const { return m_nPlanes; }
+
+/**
+ * @brief Return the phi index, brought into [0, nPhi).
+ */
+inline int TowerSumTable::wrapPhi(int iPhi) const {
+  const int i = iPhi % m_nPhi;
+  return i < 0 ? i + m_nPhi : i;
+}
+
+/**
+ * @brief Return the prefix sums of a plane, row by row.
+ */
+inline const double* TowerSumTable::table(int plane) const {
+  return m_tables.data() + static_cast<size_t>(plane) * (m_nRows + 1) * m_stride;
+}
+
+/**
+ * @brief Add a plane from a function of the tower position.
+ *
+ * Entry (r, c) of the table is the sum of the plane over the rows
+ * before r and the padded columns before c.
+ */
+template <class FUNC>
+  requires std::invocable<FUNC&, int, int>
+int TowerSumTable::addPlane(FUNC&& value) {
+  const size_t planeSize = (m_nRows + 1) * m_stride;
+  m_tables.resize(m_tables.size() + planeSize, 0);
+  double* t = m_tables.data() + static_cast<size_t>(m_nPlanes) * planeSize;
+  const int nColumns = m_stride - 1;
+  for (int iRow = 0; iRow < m_nRows; ++iRow) {
+    const double* prev = t + iRow * m_stride;
+    double* row = t + (iRow + 1) * m_stride;
+    double rowSum = 0;
+    row[0] = 0;
+    for (int c = 0; c < nColumns; ++c) {
+      rowSum += value(iRow, c - m_nGhost);
+      row[c + 1] = prev[c + 1] + rowSum;
+    }
+  }
+  return m_nPlanes++;
+}
+
+} // namespace k4::recCalo
+
+#endif // not RECCALOCOMMON_TOWERSUMTABLE_H
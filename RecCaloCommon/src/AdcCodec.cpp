@@ -0,0 +1,65 @@
+/**
+ * @file RecCaloCommon/src/AdcCodec.cpp
+ * @date Oct, 2026
+ * @brief Conversion of pulse amplitudes to and from integer ADC counts.
+ */
+
+#include "RecCaloCommon/AdcCodec.h"
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param gain ADC counts per unit of amplitude; must be positive.
+ * @param pedestal ADC count of a zero amplitude.
+ * @param nBits Number of bits of the ADC, from 1 to 31.
+ */
+AdcCodec::AdcCodec(float gain, float pedestal, unsigned nBits)
+    : m_gain(gain), m_invGain(1 / gain), m_pedestal(pedestal), m_nBits(nBits),
+      m_maxCount(nBits >= 1 && nBits <= 31 ? static_cast<int32_t>((1u << nBits) - 1) : 0) {
+  if (!(gain > 0) || !std::isfinite(gain))
+    throw std::invalid_argument(std::format("AdcCodec: bad gain {}", gain));
+  if (m_maxCount == 0)
+    throw std::invalid_argument(std::format("AdcCodec: bad number of bits {}", nBits));
+}
+
+/**
+ * @brief Convert amplitudes to ADC counts.
+ * @param amplitudes The amplitudes.
+ * @param[out] counts The counts, of the same size as @c amplitudes.
+ */
+size_t AdcCodec::encode(std::span<const float> amplitudes, std::span<int32_t> counts) const {
+  const size_t n = amplitudes.size();
+  const float maxCount = static_cast<float>(m_maxCount);
+  size_t nClipped = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const float v = std::nearbyint(m_pedestal + m_gain * amplitudes[i]);
+    // Also catches NaN.
+    if (!(v >= 0)) {
+      counts[i] = 0;
+      ++nClipped;
+    } else if (v >= maxCount) {
+      counts[i] = m_maxCount;
+      nClipped += v > maxCount;
+    } else {
+      counts[i] = static_cast<int32_t>(v);
+    }
+  }
+  return nClipped;
+}
+
+/**
+ * @brief Convert ADC counts to amplitudes.
+ * @param counts The counts.
+ * @param[out] amplitudes The amplitudes, of the same size as @c counts.
+ */
+void AdcCodec::decode(std::span<const int32_t> counts, std::span<float> amplitudes) const {
+  const size_t n = counts.size();
+  for (size_t i = 0; i < n; ++i)
+    amplitudes[i] = decode(counts[i]);
+}
+
+} // namespace k4::recCalo
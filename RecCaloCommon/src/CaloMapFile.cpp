@@ -0,0 +1,270 @@
+/**
+ * @file RecCaloCommon/src/CaloMapFile.cpp
+ * @date Oct, 2026
+ * @brief Memory-mappable binary file holding per-cell maps.
+ */
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace k4::recCalo {
+
+namespace {
+
+/// Magic string at the start of the file.
+constexpr char MAGIC[8] = {'K', '4', 'C', 'A', 'L', 'M', 'A', 'P'};
+
+/// Used to check the byte order.
+constexpr uint32_t ENDIAN_TAG = 0x01020304;
+
+/// Alignment of the sections.
+constexpr uint64_t ALIGNMENT = 64;
+
+/// File header.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t kind;
+  uint32_t endianTag;
+  uint32_t nSections;
+  uint64_t fileSize;
+  uint64_t payloadChecksum;
+  /// Checksum of the header (with this field set to zero) and the section table.
+  uint64_t headerChecksum;
+  /// User tag; zero if not used.
+  uint64_t tag;
+  uint64_t reserved;
+};
+static_assert(sizeof(Header) == 64);
+
+uint64_t alignUp(uint64_t x) { return (x + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+} // anonymous namespace
+
+/**
+ * @brief For reporting errors.
+ */
+CaloMapFile::CaloMapFileException::CaloMapFileException(const std::string& what)
+    : std::runtime_error("CaloMapFileException: " + what) {}
+
+/**
+ * @brief Compute the checksum used for the file contents.
+ * @param data Data over which to compute the checksum.
+ *
+ * This is a simple multiply-xorshift hash over 64-bit words, using four
+ * independent lanes so that it runs at close to memory bandwidth.
+ */
+uint64_t CaloMapFile::checksum(std::span<const std::byte> data) {
+  constexpr uint64_t PRIME1 = 0x9e3779b185ebca87ULL;
+  constexpr uint64_t PRIME2 = 0xc2b2ae3d27d4eb4fULL;
+  uint64_t h[4] = {PRIME1, PRIME2, PRIME1 ^ PRIME2, data.size()};
+  auto mix = [](uint64_t acc, uint64_t w) {
+    acc ^= w * PRIME2;
+    acc = (acc << 31) | (acc >> 33);
+    return acc * PRIME1;
+  };
+
+  const std::byte* p = data.data();
+  size_t n = data.size();
+  while (n >= 32) {
+    for (int i = 0; i < 4; ++i) {
+      uint64_t w;
+      std::memcpy(&w, p + 8 * i, 8);
+      h[i] = mix(h[i], w);
+    }
+    p += 32;
+    n -= 32;
+  }
+  uint64_t tail[4] = {0, 0, 0, 0};
+  if (n > 0) // p may be null for an empty section
+    std::memcpy(tail, p, n);
+  for (int i = 0; i < 4; ++i)
+    h[i] = mix(h[i], tail[i]);
+
+  uint64_t out = h[0] ^ mix(h[1], h[2]) ^ mix(h[3], n);
+  out ^= out >> 29;
+  out *= PRIME2;
+  out ^= out >> 32;
+  return out;
+}
+
+/**
+ * @brief Open and map a file.
+ * @param path Path of the file to open.
+ * @param kind Expected kind of map.
+ * @param verifyChecksum If true, verify the checksum of the payload.
+ */
+CaloMapFile::CaloMapFile(const std::string& path, Kind kind, bool verifyChecksum /*= true*/) : m_path(path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw CaloMapFileException(std::format("cannot open {}", path));
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    throw CaloMapFileException(std::format("{} is too short", path));
+  }
+  m_size = st.st_size;
+  m_addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (m_addr == MAP_FAILED) {
+    m_addr = nullptr;
+    throw CaloMapFileException(std::format("cannot map {}", path));
+  }
+
+  // From here on, we need to unmap on errors.
+  auto fail = [this](const std::string& what) {
+    ::munmap(m_addr, m_size);
+    m_addr = nullptr;
+    throw CaloMapFileException(std::format("{}: {}", m_path, what));
+  };
+
+  const std::byte* base = static_cast<const std::byte*>(m_addr);
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+    fail("not a calorimeter map file");
+  if (header.endianTag != ENDIAN_TAG)
+    fail("wrong byte order");
+  if (header.version != VERSION)
+    fail(std::format("unsupported version {}; expected {}", header.version, VERSION));
+  if (header.kind != kind)
+    fail(std::format("wrong kind of map {}; expected {}", header.kind, static_cast<uint32_t>(kind)));
+  if (header.fileSize != m_size)
+    fail(std::format("truncated file: size {}, expected {}", m_size, header.fileSize));
+  size_t tableEnd = sizeof(Header) + header.nSections * sizeof(SectionDesc);
+  if (tableEnd > m_size)
+    fail("bad section table");
+
+  // Verify the header checksum.
+  uint64_t headerChecksum = header.headerChecksum;
+  header.headerChecksum = 0;
+  std::vector<std::byte> headerBytes(base, base + tableEnd);
+  std::memcpy(headerBytes.data(), &header, sizeof(Header));
+  if (checksum(headerBytes) != headerChecksum)
+    fail("header checksum mismatch");
+  m_tag = header.tag;
+
+  m_sections = std::span<const SectionDesc>(reinterpret_cast<const SectionDesc*>(base + sizeof(Header)),
+                                            header.nSections);
+  for (const SectionDesc& desc : m_sections) {
+    if (desc.offset % ALIGNMENT != 0 || desc.elementSize == 0 || desc.offset > m_size ||
+        desc.count > (m_size - desc.offset) / desc.elementSize) {
+      fail(std::format("bad descriptor for section {}", desc.id));
+    }
+  }
+
+  if (verifyChecksum) {
+    size_t payloadStart = alignUp(tableEnd);
+    if (checksum(std::span<const std::byte>(base + payloadStart, m_size - payloadStart)) != header.payloadChecksum)
+      fail("payload checksum mismatch");
+  }
+}
+
+/**
+ * @brief Unmap the file.
+ */
+CaloMapFile::~CaloMapFile() {
+  if (m_addr)
+    ::munmap(m_addr, m_size);
+}
+
+/**
+ * @brief Return the data for a section, checking the element size.
+ */
+const void* CaloMapFile::getRaw(SectionID id, size_t elementSize, size_t& count) const {
+  for (const SectionDesc& desc : m_sections) {
+    if (desc.id == id) {
+      if (desc.elementSize != elementSize) {
+        throw CaloMapFileException(std::format("{}: section {} has element size {}; expected {}", m_path,
+                                               static_cast<uint32_t>(id), desc.elementSize, elementSize));
+      }
+      count = desc.count;
+      return static_cast<const std::byte*>(m_addr) + desc.offset;
+    }
+  }
+  throw CaloMapFileException(std::format("{}: missing section {}", m_path, static_cast<uint32_t>(id)));
+}
+
+/**
+ * @brief Test if a file starts with the magic string for this format.
+ * @param path Path of the file to test.
+ */
+bool CaloMapFile::isCaloMapFile(const std::string& path) {
+  std::ifstream f(path, std::ios::binary);
+  char magic[sizeof(MAGIC)];
+  if (!f.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * @brief Write a file.
+ * @param path Path of the file to write.
+ * @param kind Kind of map.
+ * @param sections Sections to write.
+ * @param tag User tag to record in the header.
+ */
+void CaloMapFile::write(const std::string& path, Kind kind, std::span<const Section> sections,
+                        uint64_t tag /*= 0*/) {
+  // Lay out the file.
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.kind = kind;
+  header.endianTag = ENDIAN_TAG;
+  header.nSections = sections.size();
+  header.tag = tag;
+
+  std::vector<SectionDesc> descs;
+  uint64_t tableEnd = sizeof(Header) + sections.size() * sizeof(SectionDesc);
+  uint64_t payloadStart = alignUp(tableEnd);
+  uint64_t offset = payloadStart;
+  for (const Section& s : sections) {
+    descs.push_back(SectionDesc{s.id, s.elementSize, s.count, offset});
+    offset = alignUp(offset + s.count * s.elementSize);
+  }
+  header.fileSize = offset;
+
+  // Assemble the payload, including padding.
+  std::vector<std::byte> payload(header.fileSize - payloadStart);
+  for (size_t i = 0; i < sections.size(); ++i) {
+    if (sections[i].count > 0) {
+      std::memcpy(payload.data() + (descs[i].offset - payloadStart), sections[i].data,
+                  sections[i].count * sections[i].elementSize);
+    }
+  }
+  header.payloadChecksum = checksum(payload);
+
+  // Header and section table, with padding.
+  std::vector<std::byte> head(payloadStart);
+  std::memcpy(head.data(), &header, sizeof(Header));
+  std::memcpy(head.data() + sizeof(Header), descs.data(), descs.size() * sizeof(SectionDesc));
+  header.headerChecksum = checksum(std::span<const std::byte>(head.data(), tableEnd));
+  std::memcpy(head.data(), &header, sizeof(Header));
+
+  // Several processes may be writing the same file at once, so the
+  // temporary name must be unique.
+  std::string tmpPath = path + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream f(tmpPath, std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char*>(head.data()), head.size());
+    f.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    if (!f) {
+      std::remove(tmpPath.c_str());
+      throw CaloMapFileException(std::format("error writing {}", tmpPath));
+    }
+  }
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    throw CaloMapFileException(std::format("cannot rename {} to {}", tmpPath, path));
+  }
+}
+
+} // namespace k4::recCalo
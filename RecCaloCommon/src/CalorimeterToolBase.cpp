@@ -7,9 +7,12 @@
 
 #include "RecCaloCommon/CalorimeterToolBase.h"
 #include "DD4hep/Detector.h"
+#include "RecCaloCommon/CaloMapFile.h"
 #include "k4FWCore/GaudiChecks.h"
 #include "k4Interface/IGeoSvc.h"
 #include <algorithm>
+#include <span>
+#include <stdexcept>
 #include <string>
 
 /** Standard Gaudi initialize method.
@@ -40,12 +43,16 @@ StatusCode CalorimeterToolBase::initialize() {
   return StatusCode::SUCCESS;
 }
 
-/** Return a vector of all existing cells in the current geometry.
+/** Return all existing cells in the current geometry.
  *
  * The result is sorted and unique.
- * Returns an empty vector on error.
+ * Returns an empty span on error.
  */
-auto CalorimeterToolBase::cellIDs() const -> const std::vector<CellID>& { return *m_cells; }
+auto CalorimeterToolBase::cellIDs() const -> std::span<const CellID> {
+  if (!m_cells)
+    return std::span<const CellID>();
+  return m_cells->cellIDs();
+}
 
 /** Prepare a map of all existing cells in current geometry.
  *   @param[out] aCells map of existing cells (and deposited energy, set to 0)
@@ -93,22 +100,31 @@ StatusCode CalorimeterToolBase::makeCells() {
   else
     keyName += "dummy";
 
-  m_cells = m_constantsSvc->getObj<std::vector<uint64_t>>(keyName);
-  if (m_cells) {
-    return StatusCode::SUCCESS;
-  }
-
-  std::vector<uint64_t> cells;
-  if (detid >= 0) {
-    K4_GAUDI_CHECK(collectCells(cells));
-    // Sort and make unique.
-    std::ranges::sort(cells);
-    const auto ret = std::ranges::unique(cells);
-    cells.erase(ret.begin(), ret.end());
+  // The list may be attached from another process sharing the constants.
+  // The geometry is identified by the constants service, so the version
+  // key only needs to describe how this tool selects the cells: its type
+  // and the values of its properties.
+  std::string config = type();
+  for (const Gaudi::Details::PropertyBase* prop : getProperties())
+    config += "\n" + prop->name() + "=" + prop->toString();
+  const uint64_t version = k4::recCalo::CaloMapFile::checksum(std::as_bytes(std::span(config)));
+  try {
+    m_cells = m_constantsSvc->getOrMakeObj<k4::recCalo::CellIDList>(keyName, version, [&]() {
+      std::vector<uint64_t> cells;
+      if (detid >= 0) {
+        if (collectCells(cells).isFailure())
+          throw std::runtime_error("cannot collect cells for " + keyName);
+        // Sort and make unique.
+        std::ranges::sort(cells);
+        const auto ret = std::ranges::unique(cells);
+        cells.erase(ret.begin(), ret.end());
+      }
+      return k4::recCalo::CellIDList(std::move(cells));
+    });
+  } catch (const std::exception& e) {
+    error() << e.what() << endmsg;
+    return StatusCode::FAILURE;
   }
-
-  K4_GAUDI_CHECK(m_constantsSvc->putObj(keyName, std::move(cells)));
-  m_cells = m_constantsSvc->getObj<std::vector<uint64_t>>(keyName);
   K4_GAUDI_CHECK(m_cells != nullptr);
 
   return StatusCode::SUCCESS;
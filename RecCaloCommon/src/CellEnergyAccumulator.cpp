@@ -0,0 +1,158 @@
+/**
+ * @file RecCaloCommon/src/CellEnergyAccumulator.cpp
+ * @date Oct, 2026
+ * @brief Per-event sum of energies per cell, using dense cell indices.
+ */
+
+#include "RecCaloCommon/CellEnergyAccumulator.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param indexer Indexer used to map cell IDs to indices.  May be null,
+ *                in which case all cells are held in the hash map.
+ */
+CellEnergyAccumulator::CellEnergyAccumulator(const ICaloIndexer* indexer) : m_indexer(indexer) {
+  if (m_indexer) {
+    m_cellIDs = m_indexer->cellIDs();
+    m_energies.resize(m_cellIDs.size());
+    m_gen.resize(m_cellIDs.size());
+  }
+}
+
+/**
+ * @brief Add energies to a set of cells.
+ * @param ids The cell IDs.
+ * @param e The energies to add, in the same order as @c ids.
+ */
+void CellEnergyAccumulator::add(std::span<const CellID> ids, std::span<const double> e) {
+  if (!m_indexer) {
+    for (size_t i = 0; i < ids.size(); ++i)
+      m_overflow[ids[i]] += e[i];
+    return;
+  }
+
+  // Look up the indices in chunks, to keep the buffer on the stack.
+  constexpr size_t CHUNK = 256;
+  index_t ndx[CHUNK];
+  for (size_t beg = 0; beg < ids.size(); beg += CHUNK) {
+    size_t n = std::min(CHUNK, ids.size() - beg);
+    m_indexer->indices(ids.subspan(beg, n), std::span(ndx, n));
+    for (size_t i = 0; i < n; ++i) {
+      if (ndx[i] != INVALID) {
+        addIndex(ndx[i], e[beg + i]);
+      } else {
+        m_overflow[ids[beg + i]] += e[beg + i];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Return the energy of a cell, or 0 if it has not been touched.
+ * @param id The cell ID.
+ */
+double CellEnergyAccumulator::energy(CellID id) const {
+  index_t ndx = m_indexer ? m_indexer->index(id) : INVALID;
+  if (ndx != INVALID) {
+    return m_gen[ndx] == m_curGen ? m_energies[ndx] : 0;
+  }
+  auto it = m_overflow.find(id);
+  return it != m_overflow.end() ? it->second : 0;
+}
+
+/**
+ * @brief Test if a cell has been touched since the last @c clear.
+ * @param id The cell ID.
+ */
+bool CellEnergyAccumulator::contains(CellID id) const {
+  index_t ndx = m_indexer ? m_indexer->index(id) : INVALID;
+  if (ndx != INVALID) {
+    return m_gen[ndx] == m_curGen;
+  }
+  return m_overflow.contains(id);
+}
+
+/**
+ * @brief Forget all cells.
+ */
+void CellEnergyAccumulator::clear() {
+  m_touched.clear();
+  m_overflow.clear();
+  if (++m_curGen == 0) {
+    // The generation counter wrapped around.  Reset all generations,
+    // so that no stale entry can match.
+    std::ranges::fill(m_gen, 0);
+    m_curGen = 1;
+  }
+}
+
+/**
+ * @brief Sort the touched cells known to the indexer by index.
+ */
+void CellEnergyAccumulator::sortByIndex() { std::ranges::sort(m_touched); }
+
+/**
+ * @brief Append the touched cells and their energies to a vector.
+ * @param[out] out The vector to which to append.
+ */
+void CellEnergyAccumulator::exportTo(std::vector<std::pair<CellID, double>>& out) const {
+  out.reserve(out.size() + size());
+  forEach([&](CellID id, double e) { out.emplace_back(id, e); });
+}
+
+/**
+ * @brief Append all cells of a list, and any other touched cells, to a vector.
+ * @param allCells The cells to export, whether or not they have been touched.
+ * @param[out] out The vector to which to append.
+ */
+void CellEnergyAccumulator::exportAll(std::span<const CellID> allCells,
+                                      std::vector<std::pair<CellID, double>>& out) const {
+  if (m_indexer && allCells.data() == m_cellIDs.data() && allCells.size() == m_cellIDs.size()) {
+    // Same cells as the indexer: we can walk the arrays directly.
+    out.reserve(out.size() + m_cellIDs.size() + m_overflow.size());
+    const size_t n = m_cellIDs.size();
+    for (size_t i = 0; i < n; ++i) {
+      out.emplace_back(m_cellIDs[i], m_gen[i] == m_curGen ? m_energies[i] : 0);
+    }
+    for (const auto& p : m_overflow) {
+      out.push_back(p);
+    }
+    return;
+  }
+
+  // General case.  Remember which touched cells we've seen, so that
+  // we can add the others at the end.
+  out.reserve(out.size() + allCells.size());
+  std::unordered_map<CellID, double> rest = m_overflow;
+  std::vector<index_t> restIndexed = m_touched;
+  std::ranges::sort(restIndexed);
+  std::vector<bool> seen(restIndexed.size());
+  for (CellID id : allCells) {
+    index_t ndx = m_indexer ? m_indexer->index(id) : INVALID;
+    if (ndx != INVALID) {
+      if (m_gen[ndx] == m_curGen) {
+        out.emplace_back(id, m_energies[ndx]);
+        seen[std::ranges::lower_bound(restIndexed, ndx) - restIndexed.begin()] = true;
+      } else {
+        out.emplace_back(id, 0);
+      }
+    } else if (auto it = rest.find(id); it != rest.end()) {
+      out.push_back(*it);
+      rest.erase(it);
+    } else {
+      out.emplace_back(id, 0);
+    }
+  }
+  for (size_t i = 0; i < restIndexed.size(); ++i) {
+    if (!seen[i])
+      out.emplace_back(m_cellIDs[restIndexed[i]], m_energies[restIndexed[i]]);
+  }
+  for (const auto& p : rest) {
+    out.push_back(p);
+  }
+}
+
+} // namespace k4::recCalo
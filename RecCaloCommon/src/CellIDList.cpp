@@ -0,0 +1,59 @@
+/**
+ * @file RecCaloCommon/src/CellIDList.cpp
+ * @date Oct, 2026
+ * @brief A list of cell IDs which may be shared between processes.
+ */
+
+#include "RecCaloCommon/CellIDList.h"
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param cells The cell IDs, passed via move.
+ */
+CellIDList::CellIDList(std::vector<CellID>&& cells) {
+  auto storage = std::make_shared<const std::vector<CellID>>(std::move(cells));
+  m_cellIDs = *storage;
+  m_storage = std::move(storage);
+}
+
+/**
+ * @brief Constructor from an existing array.
+ * @param storage Object owning the array.
+ * @param cellIDs The cell IDs.
+ */
+CellIDList::CellIDList(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs)
+    : m_storage(std::move(storage)), m_cellIDs(cellIDs) {}
+
+/**
+ * @brief Map a list from a binary file.
+ * @param path Path of the file, written by @c writeMapFile.
+ * @param verifyChecksum If true, verify the checksum of the file contents.
+ */
+CellIDList CellIDList::fromMapFile(const std::string& path, bool verifyChecksum /*= true*/) {
+  return fromMapFile(std::make_shared<const CaloMapFile>(path, MAP_KIND, verifyChecksum));
+}
+
+/**
+ * @brief Make a list viewing an already-opened binary file.
+ * @param file The file, which is kept alive as long as the list exists.
+ */
+CellIDList CellIDList::fromMapFile(std::shared_ptr<const CaloMapFile> file) {
+  std::span<const CellID> cellIDs = file->get<CellID>(CaloMapFile::CELLIDS);
+  return CellIDList(std::move(file), cellIDs);
+}
+
+/**
+ * @brief Write the list to a binary file (see CaloMapFile).
+ * @param path Path of the file to write.
+ * @param tag User tag to record in the file header.
+ */
+void CellIDList::writeMapFile(const std::string& path, uint64_t tag /*= 0*/) const {
+  const CaloMapFile::Section sections[] = {
+      {CaloMapFile::CELLIDS, m_cellIDs},
+  };
+  CaloMapFile::write(path, MAP_KIND, sections, tag);
+}
+
+} // namespace k4::recCalo
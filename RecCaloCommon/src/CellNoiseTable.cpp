@@ -0,0 +1,104 @@
+/**
+ * @file RecCaloCommon/src/CellNoiseTable.cpp
+ * @date Oct, 2026
+ * @brief Table of per-cell noise constants.
+ */
+
+#include "RecCaloCommon/CellNoiseTable.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include <format>
+#include <numeric>
+
+namespace k4::recCalo {
+
+/**
+ * @brief For reporting errors from the constructor.
+ */
+CellNoiseTable::CellNoiseTableException::CellNoiseTableException(const std::string& what)
+    : std::runtime_error("CellNoiseTableException: " + what) {}
+
+/**
+ * @brief Constructor.
+ * @param cells IDs of the cells, in any order.
+ * @param noiseRMS Noise RMS of each cell.
+ * @param noiseOffset Noise offset of each cell.
+ */
+CellNoiseTable::CellNoiseTable(std::span<const CellID> cells, std::span<const double> noiseRMS,
+                               std::span<const double> noiseOffset) {
+  if (noiseRMS.size() != cells.size() || noiseOffset.size() != cells.size()) {
+    throw CellNoiseTableException(std::format("inconsistent input sizes: {} cells, {} rms, {} offsets", cells.size(),
+                                              noiseRMS.size(), noiseOffset.size()));
+  }
+
+  // Sort by cell ID, keeping the first of any duplicates.
+  std::vector<size_t> order(cells.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](size_t a, size_t b) { return cells[a] < cells[b]; });
+
+  auto storage = std::make_shared<Storage>();
+  storage->cellIDs.reserve(cells.size());
+  storage->noiseRMS.reserve(cells.size());
+  storage->noiseOffset.reserve(cells.size());
+  for (size_t i : order) {
+    if (!storage->cellIDs.empty() && storage->cellIDs.back() == cells[i])
+      continue;
+    storage->cellIDs.push_back(cells[i]);
+    storage->noiseRMS.push_back(noiseRMS[i]);
+    storage->noiseOffset.push_back(noiseOffset[i]);
+  }
+
+  m_cellIDs = storage->cellIDs;
+  m_noiseRMS = storage->noiseRMS;
+  m_noiseOffset = storage->noiseOffset;
+  m_storage = std::move(storage);
+}
+
+/**
+ * @brief Constructor from existing arrays.
+ * @param storage Object owning the arrays.
+ * @param cellIDs Sorted list of cell IDs.
+ * @param noiseRMS Noise RMS of each cell.
+ * @param noiseOffset Noise offset of each cell.
+ */
+CellNoiseTable::CellNoiseTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                               std::span<const double> noiseRMS, std::span<const double> noiseOffset)
+    : m_storage(std::move(storage)), m_cellIDs(cellIDs), m_noiseRMS(noiseRMS), m_noiseOffset(noiseOffset) {
+  if (noiseRMS.size() != cellIDs.size() || noiseOffset.size() != cellIDs.size()) {
+    throw CellNoiseTableException(std::format("inconsistent table sizes: {} cells, {} rms, {} offsets",
+                                              cellIDs.size(), noiseRMS.size(), noiseOffset.size()));
+  }
+}
+
+/**
+ * @brief Map a table from a binary file.
+ * @param path Path of the file, written by @c writeMapFile.
+ * @param verifyChecksum If true, verify the checksum of the file contents.
+ */
+CellNoiseTable CellNoiseTable::fromMapFile(const std::string& path, bool verifyChecksum /*= true*/) {
+  return fromMapFile(std::make_shared<const CaloMapFile>(path, MAP_KIND, verifyChecksum));
+}
+
+/**
+ * @brief Make a table viewing an already-opened binary file.
+ * @param file The file, which is kept alive as long as the table exists.
+ */
+CellNoiseTable CellNoiseTable::fromMapFile(std::shared_ptr<const CaloMapFile> file) {
+  return CellNoiseTable(file, file->get<CellID>(CaloMapFile::CELLIDS), file->get<double>(CaloMapFile::NOISE_RMS),
+                        file->get<double>(CaloMapFile::NOISE_OFFSET));
+}
+
+/**
+ * @brief Write the table to a binary file (see CaloMapFile).
+ * @param path Path of the file to write.
+ * @param tag User tag to record in the file header.
+ */
+void CellNoiseTable::writeMapFile(const std::string& path, uint64_t tag /*= 0*/) const {
+  const CaloMapFile::Section sections[] = {
+      {CaloMapFile::CELLIDS, m_cellIDs},
+      {CaloMapFile::NOISE_RMS, m_noiseRMS},
+      {CaloMapFile::NOISE_OFFSET, m_noiseOffset},
+  };
+  CaloMapFile::write(path, MAP_KIND, sections, tag);
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,108 @@
+/**
+ * @file RecCaloCommon/src/CounterRng.cpp
+ * @date Oct, 2026
+ * @brief Counter-based random numbers, reproducible per event and cell.
+ */
+
+#include "RecCaloCommon/CounterRng.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Evaluate the generator for LANES counters in place.
+ *
+ * The same computation as @c philox, but written as loops over the lanes
+ * so that the compiler can vectorize the multiplications.
+ */
+void CounterRng::philoxLanes(uint32_t* c0, uint32_t* c1, uint32_t* c2, uint32_t* c3) const {
+  uint32_t k0 = m_k0;
+  uint32_t k1 = m_k1;
+  for (int round = 0; round < 10; ++round) {
+    for (size_t l = 0; l < LANES; ++l) {
+      uint64_t p0 = static_cast<uint64_t>(0xD2511F53) * c0[l];
+      uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57) * c2[l];
+      uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+      uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+      c1[l] = static_cast<uint32_t>(p1);
+      c3[l] = static_cast<uint32_t>(p0);
+      c0[l] = n0;
+      c2[l] = n2;
+    }
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+}
+
+/**
+ * @brief Return uniform deviates in (0, 1) for a set of items.
+ * @param items The item numbers.
+ * @param[out] out The deviates; must be at least as large as @c items.
+ * @param block Block number, for items needing several draws.
+ */
+void CounterRng::flat(std::span<const uint64_t> items, std::span<double> out, uint32_t block /*= 0*/) const {
+  alignas(32) uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+  size_t n = items.size();
+  for (size_t i = 0; i < n; i += LANES) {
+    size_t nl = std::min(LANES, n - i);
+    for (size_t l = 0; l < LANES; ++l) {
+      uint64_t item = l < nl ? items[i + l] : 0;
+      c0[l] = block;
+      c1[l] = static_cast<uint32_t>(item);
+      c2[l] = static_cast<uint32_t>(item >> 32);
+      c3[l] = ITEM_DRAW;
+    }
+    philoxLanes(c0, c1, c2, c3);
+    for (size_t l = 0; l < nl; ++l)
+      out[i + l] = toFlat(c0[l], c1[l]);
+  }
+}
+
+/**
+ * @brief Return standard Gaussian deviates for a set of items.
+ * @param items The item numbers.
+ * @param[out] out The deviates; must be at least as large as @c items.
+ * @param block Block number, for items needing several draws.
+ */
+void CounterRng::gauss(std::span<const uint64_t> items, std::span<double> out, uint32_t block /*= 0*/) const {
+  alignas(32) uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+  size_t n = items.size();
+  for (size_t i = 0; i < n; i += LANES) {
+    size_t nl = std::min(LANES, n - i);
+    for (size_t l = 0; l < LANES; ++l) {
+      uint64_t item = l < nl ? items[i + l] : 0;
+      c0[l] = block;
+      c1[l] = static_cast<uint32_t>(item);
+      c2[l] = static_cast<uint32_t>(item >> 32);
+      c3[l] = ITEM_DRAW;
+    }
+    philoxLanes(c0, c1, c2, c3);
+    for (size_t l = 0; l < nl; ++l)
+      out[i + l] = toGauss(toFlat(c0[l], c1[l]), toFlat(c2[l], c3[l]));
+  }
+}
+
+/**
+ * @brief Return standard Gaussian deviates for successive blocks of one item.
+ * @param item Item number, typically a cell ID.
+ * @param[out] out The deviates; deviate @c i uses block @c firstBlock+i.
+ * @param firstBlock Block number of the first deviate.
+ */
+void CounterRng::gauss(uint64_t item, std::span<double> out, uint32_t firstBlock /*= 0*/) const {
+  alignas(32) uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+  size_t n = out.size();
+  for (size_t i = 0; i < n; i += LANES) {
+    size_t nl = std::min(LANES, n - i);
+    for (size_t l = 0; l < LANES; ++l) {
+      c0[l] = firstBlock + static_cast<uint32_t>(i + l);
+      c1[l] = static_cast<uint32_t>(item);
+      c2[l] = static_cast<uint32_t>(item >> 32);
+      c3[l] = ITEM_DRAW;
+    }
+    philoxLanes(c0, c1, c2, c3);
+    for (size_t l = 0; l < nl; ++l)
+      out[i + l] = toGauss(toFlat(c0[l], c1[l]), toFlat(c2[l], c3[l]));
+  }
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,138 @@
+/**
+ * @file RecCaloCommon/src/CrosstalkTable.cpp
+ * @date Oct, 2026
+ * @brief Table of crosstalk neighbours and coefficients.
+ */
+
+#include "RecCaloCommon/CrosstalkTable.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include <format>
+#include <limits>
+#include <numeric>
+
+namespace k4::recCalo {
+
+/**
+ * @brief For reporting errors from the constructor.
+ */
+CrosstalkTable::CrosstalkTableException::CrosstalkTableException(const std::string& what)
+    : std::runtime_error("CrosstalkTableException: " + what) {}
+
+/**
+ * @brief Constructor.
+ * @param cells IDs of cells for which crosstalk is given, in any order.
+ * @param offsets Offsets of the neighbours of each cell in @c neighbourIDs.
+ * @param neighbourIDs Concatenated lists of neighbour IDs.
+ * @param coefficients Crosstalk coefficients, parallel to @c neighbourIDs.
+ */
+CrosstalkTable::CrosstalkTable(std::span<const CellID> cells, std::span<const uint64_t> offsets,
+                               std::span<const CellID> neighbourIDs, std::span<const double> coefficients) {
+  if (offsets.size() != cells.size() + 1 || offsets.front() != 0 || offsets.back() != neighbourIDs.size() ||
+      coefficients.size() != neighbourIDs.size()) {
+    throw CrosstalkTableException(
+        std::format("inconsistent input sizes: {} cells, {} offsets, {} neighbours, {} coefficients", cells.size(),
+                    offsets.size(), neighbourIDs.size(), coefficients.size()));
+  }
+  if (neighbourIDs.size() > std::numeric_limits<uint32_t>::max()) {
+    throw CrosstalkTableException(std::format("too many neighbour entries: {}", neighbourIDs.size()));
+  }
+
+  // Sort by cell ID, keeping the first of any duplicates.
+  std::vector<size_t> order(cells.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](size_t a, size_t b) { return cells[a] < cells[b]; });
+
+  auto storage = std::make_shared<Storage>();
+  storage->cellIDs.reserve(cells.size());
+  storage->offsets.reserve(cells.size() + 1);
+  storage->neighbourIDs.reserve(neighbourIDs.size());
+  storage->coefficients.reserve(coefficients.size());
+  storage->offsets.push_back(0);
+  for (size_t i : order) {
+    if (!storage->cellIDs.empty() && storage->cellIDs.back() == cells[i])
+      continue;
+    storage->cellIDs.push_back(cells[i]);
+    storage->neighbourIDs.insert(storage->neighbourIDs.end(), neighbourIDs.begin() + offsets[i],
+                                 neighbourIDs.begin() + offsets[i + 1]);
+    storage->coefficients.insert(storage->coefficients.end(), coefficients.begin() + offsets[i],
+                                 coefficients.begin() + offsets[i + 1]);
+    storage->offsets.push_back(storage->neighbourIDs.size());
+  }
+
+  m_cellIDs = storage->cellIDs;
+  m_offsets = storage->offsets;
+  m_neighbourIDs = storage->neighbourIDs;
+  m_coefficients = storage->coefficients;
+  m_storage = std::move(storage);
+}
+
+/**
+ * @brief Constructor from existing arrays.
+ * @param storage Object owning the arrays.
+ * @param cellIDs Sorted list of cell IDs.
+ * @param offsets Offsets of the neighbours of each cell.
+ * @param neighbourIDs Concatenated lists of neighbour IDs.
+ * @param coefficients Crosstalk coefficients, parallel to @c neighbourIDs.
+ */
+CrosstalkTable::CrosstalkTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                               std::span<const uint32_t> offsets, std::span<const CellID> neighbourIDs,
+                               std::span<const double> coefficients)
+    : m_storage(std::move(storage)),
+      m_cellIDs(cellIDs),
+      m_offsets(offsets),
+      m_neighbourIDs(neighbourIDs),
+      m_coefficients(coefficients) {
+  if (offsets.size() != cellIDs.size() + 1 || offsets.front() != 0 || offsets.back() != neighbourIDs.size() ||
+      coefficients.size() != neighbourIDs.size()) {
+    throw CrosstalkTableException(
+        std::format("inconsistent table sizes: {} cells, {} offsets, {} neighbours, {} coefficients", cellIDs.size(),
+                    offsets.size(), neighbourIDs.size(), coefficients.size()));
+  }
+
+  // The arrays may come from a file whose checksum was not verified,
+  // and lookups do not check bounds, so check the structure fully.
+  for (size_t i = 0; i < cellIDs.size(); ++i) {
+    if (offsets[i] > offsets[i + 1]) {
+      throw CrosstalkTableException(std::format("offsets decrease at cell {}", i));
+    }
+    if (i > 0 && cellIDs[i - 1] >= cellIDs[i]) {
+      throw CrosstalkTableException(std::format("cell IDs not sorted at cell {}", i));
+    }
+  }
+}
+
+/**
+ * @brief Map a table from a binary file.
+ * @param path Path of the file, written by @c writeMapFile.
+ * @param verifyChecksum If true, verify the checksum of the file contents.
+ */
+CrosstalkTable CrosstalkTable::fromMapFile(const std::string& path, bool verifyChecksum /*= true*/) {
+  return fromMapFile(std::make_shared<const CaloMapFile>(path, MAP_KIND, verifyChecksum));
+}
+
+/**
+ * @brief Make a table viewing an already-opened binary file.
+ * @param file The file, which is kept alive as long as the table exists.
+ */
+CrosstalkTable CrosstalkTable::fromMapFile(std::shared_ptr<const CaloMapFile> file) {
+  return CrosstalkTable(file, file->get<CellID>(CaloMapFile::CELLIDS), file->get<uint32_t>(CaloMapFile::OFFSETS),
+                        file->get<CellID>(CaloMapFile::NEIGHBOUR_IDS),
+                        file->get<double>(CaloMapFile::COEFFICIENTS));
+}
+
+/**
+ * @brief Write the table to a binary file (see CaloMapFile).
+ * @param path Path of the file to write.
+ * @param tag User tag to record in the file header.
+ */
+void CrosstalkTable::writeMapFile(const std::string& path, uint64_t tag /*= 0*/) const {
+  const CaloMapFile::Section sections[] = {
+      {CaloMapFile::CELLIDS, m_cellIDs},
+      {CaloMapFile::OFFSETS, m_offsets},
+      {CaloMapFile::NEIGHBOUR_IDS, m_neighbourIDs},
+      {CaloMapFile::COEFFICIENTS, m_coefficients},
+  };
+  CaloMapFile::write(path, MAP_KIND, sections, tag);
+}
+
+} // namespace k4::recCalo
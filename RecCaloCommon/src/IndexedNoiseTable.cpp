@@ -0,0 +1,25 @@
+/**
+ * @file RecCaloCommon/src/IndexedNoiseTable.cpp
+ * @date Oct, 2026
+ * @brief Per-cell noise constants, indexed by an ICaloIndexer.
+ */
+
+#include "RecCaloCommon/IndexedNoiseTable.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Test if the table is indexed in the same way as an indexer.
+ * @param indexer The indexer to test.
+ */
+bool IndexedNoiseTable::matches(const ICaloIndexer& indexer) const {
+  std::span<const CellID> ids = indexer.cellIDs();
+  if (ids.size() != m_cellIDs.size())
+    return false;
+  if (ids.data() == m_cellIDs.data())
+    return true;
+  return std::ranges::equal(ids, m_cellIDs);
+}
+
+} // namespace k4::recCalo
@@ -6,6 +6,8 @@
  */
 
 #include "RecCaloCommon/MultiIndexer.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/CellIDList.h"
 #include <format>
 #include <string>
 
@@ -78,9 +80,16 @@ MultiIndexer::MultiIndexer(size_t detIDBits, std::span<const ICaloIndexer* const
   if (totcells == 0)
     return;
 
-  // See if we've already made this combination.
-  const std::vector<uint64_t>* cellsptr = constsSvc.getObj<std::vector<uint64_t>>(keyName);
-  if (!cellsptr) {
+  // The combined list depends only on the lists of the indexers,
+  // so use their checksums as the version key.
+  std::string inputs;
+  for (const ICaloIndexer* indexer : indexers)
+    inputs += std::format("{:016x}\n", CaloMapFile::checksum(std::as_bytes(indexer->cellIDs())));
+  const uint64_t version = CaloMapFile::checksum(std::as_bytes(std::span(inputs)));
+
+  // See if we've already made this combination, either in this process
+  // or in another one sharing the constants.
+  const CellIDList* cellsptr = constsSvc.getOrMakeObj<CellIDList>(keyName, version, [&]() {
     // Nope.  Concatenate the cell ID lists from each indexer.
     std::vector<uint64_t> cells;
     cells.reserve(totcells);
@@ -92,11 +101,8 @@ MultiIndexer::MultiIndexer(size_t detIDBits, std::span<const ICaloIndexer* const
       cells.insert(cells.end(), ids.begin(), ids.end());
 #endif
     }
-
-    // And store in the constants service.
-    constsSvc.putObj(keyName, std::move(cells));
-    cellsptr = constsSvc.getObj<std::vector<uint64_t>>(keyName);
-  }
+    return CellIDList(std::move(cells));
+  });
 
   // Some validity checking.
   if (!cellsptr) {
@@ -108,7 +114,33 @@ MultiIndexer::MultiIndexer(size_t detIDBits, std::span<const ICaloIndexer* const
   }
 
   // Save the span over cells.
-  m_cellIDs = *cellsptr;
+  m_cellIDs = cellsptr->cellIDs();
+}
+
+/**
+ * @brief Return the indices of a set of identifiers.
+ * @param ids The identifiers to look for.
+ * @param[out] out The index of each identifier in @c cellIDs(),
+ *                 or @c INVALID.
+ */
+void MultiIndexer::indices(std::span<const uint64_t> ids, std::span<index_t> out) const {
+  const size_t n = ids.size();
+  size_t start = 0;
+  while (start < n) {
+    // Find the run of identifiers from the same detector.
+    const uint64_t detID = ids[start] & m_detIDMask;
+    size_t end = start + 1;
+    while (end < n && (ids[end] & m_detIDMask) == detID)
+      ++end;
+
+    const auto& [indexer, offset] = m_indexers[detID];
+    std::span<index_t> runOut = out.subspan(start, end - start);
+    indexer->indices(ids.subspan(start, end - start), runOut);
+    for (index_t& ndx : runOut) {
+      ndx = ndx != INVALID ? ndx + offset : INVALID;
+    }
+    start = end;
+  }
 }
 
 } // namespace k4::recCalo
@@ -0,0 +1,254 @@
+/**
+ * @file RecCaloCommon/src/NeighbourTable.cpp
+ * @date Oct, 2026
+ * @brief Compact table of cell neighbours.
+ */
+
+#include "RecCaloCommon/NeighbourTable.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <numeric>
+
+namespace k4::recCalo {
+
+/**
+ * @brief For reporting errors from the constructor.
+ */
+NeighbourTable::NeighbourTableException::NeighbourTableException(const std::string& what)
+    : std::runtime_error("NeighbourTableException: " + what) {}
+
+/**
+ * @brief Constructor.
+ * @param cells IDs of cells for which neighbours are given, in any order.
+ * @param offsets Offsets of the neighbours of each cell in @c neighbourIDs.
+ * @param neighbourIDs Concatenated lists of neighbour IDs.
+ */
+NeighbourTable::NeighbourTable(std::span<const CellID> cells, std::span<const uint64_t> offsets,
+                               std::span<const CellID> neighbourIDs) {
+  if (offsets.size() != cells.size() + 1 || offsets.front() != 0 || offsets.back() != neighbourIDs.size()) {
+    throw NeighbourTableException(std::format("inconsistent input sizes: {} cells, {} offsets, {} neighbours",
+                                              cells.size(), offsets.size(), neighbourIDs.size()));
+  }
+  if (neighbourIDs.size() > std::numeric_limits<uint32_t>::max()) {
+    throw NeighbourTableException(std::format("too many neighbour entries: {}", neighbourIDs.size()));
+  }
+
+  auto storage = std::make_shared<Storage>();
+
+  // All IDs appearing in the table, sorted and unique.
+  std::vector<CellID>& cellIDs = storage->cellIDs;
+  cellIDs.reserve(cells.size());
+  cellIDs.assign(cells.begin(), cells.end());
+  cellIDs.insert(cellIDs.end(), neighbourIDs.begin(), neighbourIDs.end());
+  std::ranges::sort(cellIDs);
+  const auto ret = std::ranges::unique(cellIDs);
+  cellIDs.erase(ret.begin(), ret.end());
+  cellIDs.shrink_to_fit();
+  if (cellIDs.size() >= INVALID) {
+    throw NeighbourTableException(std::format("too many cells: {}", cellIDs.size()));
+  }
+  m_cellIDs = cellIDs;
+
+  // Find which input entry gives the neighbours for each index.
+  // The first entry for a given ID wins.
+  static constexpr size_t NOENTRY = static_cast<size_t>(-1);
+  std::vector<size_t> entry(cellIDs.size(), NOENTRY);
+  for (size_t i = 0; i < cells.size(); ++i) {
+    size_t& e = entry[index(cells[i])];
+    if (e == NOENTRY)
+      e = i;
+  }
+
+  // Fill the table in index order.
+  std::vector<uint32_t>& tabOffsets = storage->offsets;
+  std::vector<index_t>& tabNeighbours = storage->neighbours;
+  tabOffsets.reserve(cellIDs.size() + 1);
+  tabOffsets.push_back(0);
+  tabNeighbours.reserve(neighbourIDs.size());
+  for (size_t e : entry) {
+    if (e != NOENTRY) {
+      for (size_t j = offsets[e]; j < offsets[e + 1]; ++j)
+        tabNeighbours.push_back(index(neighbourIDs[j]));
+    }
+    tabOffsets.push_back(tabNeighbours.size());
+  }
+  tabNeighbours.shrink_to_fit();
+
+  m_offsets = tabOffsets;
+  m_neighbours = tabNeighbours;
+  m_storage = std::move(storage);
+}
+
+/**
+ * @brief Constructor from existing arrays.
+ * @param storage Object owning the arrays.
+ * @param cellIDs Sorted list of cell IDs.
+ * @param offsets Offsets of the neighbours of each cell in @c neighbours.
+ * @param neighbours Concatenated lists of neighbour indices.
+ */
+NeighbourTable::NeighbourTable(std::shared_ptr<const void> storage, std::span<const CellID> cellIDs,
+                               std::span<const uint32_t> offsets, std::span<const index_t> neighbours)
+    : m_storage(std::move(storage)), m_cellIDs(cellIDs), m_offsets(offsets), m_neighbours(neighbours) {
+  if (offsets.size() != cellIDs.size() + 1 || offsets.front() != 0 || offsets.back() != neighbours.size()) {
+    throw NeighbourTableException(std::format("inconsistent table sizes: {} cells, {} offsets, {} neighbours",
+                                              cellIDs.size(), offsets.size(), neighbours.size()));
+  }
+
+  // The arrays may come from a file whose checksum was not verified,
+  // and lookups do not check bounds, so check the structure fully.
+  for (size_t i = 0; i < cellIDs.size(); ++i) {
+    if (offsets[i] > offsets[i + 1]) {
+      throw NeighbourTableException(std::format("offsets decrease at cell {}", i));
+    }
+    if (i > 0 && cellIDs[i - 1] >= cellIDs[i]) {
+      throw NeighbourTableException(std::format("cell IDs not sorted at cell {}", i));
+    }
+  }
+  for (size_t j = 0; j < neighbours.size(); ++j) {
+    if (neighbours[j] >= cellIDs.size()) {
+      throw NeighbourTableException(std::format("neighbour index {} out of range at entry {}", neighbours[j], j));
+    }
+  }
+}
+
+/**
+ * @brief Constructor, re-indexing another table.
+ * @param indexer The indexer whose indices the new table should use.
+ * @param table The table to re-index.
+ */
+NeighbourTable::NeighbourTable(const ICaloIndexer& indexer, const NeighbourTable& table) {
+  auto storage = std::make_shared<Storage>();
+
+  // New index of each cell of the input table: its index in the indexer,
+  // or else a new index following all cells of the indexer.
+  std::span<const CellID> indexerIDs = indexer.cellIDs();
+  std::vector<CellID>& cellIDs = storage->cellIDs;
+  cellIDs.assign(indexerIDs.begin(), indexerIDs.end());
+  std::vector<index_t> remap(table.size());
+  indexer.indices(table.cellIDs(), remap);
+  for (size_t i = 0; i < remap.size(); ++i) {
+    if (remap[i] == INVALID) {
+      remap[i] = cellIDs.size();
+      cellIDs.push_back(table.m_cellIDs[i]);
+    }
+  }
+  cellIDs.shrink_to_fit();
+  if (cellIDs.size() >= INVALID) {
+    throw NeighbourTableException(std::format("too many cells: {}", cellIDs.size()));
+  }
+  m_cellIDs = cellIDs;
+
+  // Input cell for each new index.
+  std::vector<index_t> source(cellIDs.size(), INVALID);
+  for (size_t i = 0; i < remap.size(); ++i)
+    source[remap[i]] = i;
+
+  // Fill the table in index order.
+  std::vector<uint32_t>& tabOffsets = storage->offsets;
+  std::vector<index_t>& tabNeighbours = storage->neighbours;
+  tabOffsets.reserve(cellIDs.size() + 1);
+  tabOffsets.push_back(0);
+  tabNeighbours.reserve(table.nEntries());
+  for (index_t src : source) {
+    if (src != INVALID) {
+      for (index_t n : table.neighbours(src))
+        tabNeighbours.push_back(remap[n]);
+    }
+    tabOffsets.push_back(tabNeighbours.size());
+  }
+
+  // The cells are no longer sorted, so keep their order for ID lookups.
+  std::vector<index_t>& order = storage->order;
+  order.resize(cellIDs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::sort(order, {}, [&cellIDs](index_t i) { return cellIDs[i]; });
+
+  m_order = order;
+  m_offsets = tabOffsets;
+  m_neighbours = tabNeighbours;
+  m_storage = std::move(storage);
+}
+
+/**
+ * @brief Return the index of a cell ID, or @c INVALID if it is not known.
+ * @param id The cell ID to look for.
+ */
+auto NeighbourTable::index(CellID id) const -> index_t {
+  if (m_order.empty()) {
+    auto it = std::lower_bound(m_cellIDs.begin(), m_cellIDs.end(), id);
+    if (it != m_cellIDs.end() && *it == id)
+      return it - m_cellIDs.begin();
+    return INVALID;
+  }
+  auto it = std::ranges::lower_bound(m_order, id, {}, [this](index_t i) { return m_cellIDs[i]; });
+  if (it != m_order.end() && m_cellIDs[*it] == id)
+    return *it;
+  return INVALID;
+}
+
+/**
+ * @brief Test if the table is indexed like an indexer.
+ * @param indexer The indexer to test.
+ */
+bool NeighbourTable::matches(const ICaloIndexer& indexer) const {
+  std::span<const CellID> ids = indexer.cellIDs();
+  if (ids.size() > m_cellIDs.size())
+    return false;
+  if (ids.data() == m_cellIDs.data())
+    return true;
+  return std::ranges::equal(ids, m_cellIDs.first(ids.size()));
+}
+
+/**
+ * @brief Copy the IDs of the neighbours of a cell.
+ * @param id ID of the cell.
+ * @param[out] out Vector to receive the neighbour IDs.
+ */
+void NeighbourTable::neighbourIDs(CellID id, std::vector<CellID>& out) const {
+  out.clear();
+  index_t ndx = index(id);
+  if (ndx == INVALID)
+    return;
+  for (index_t n : neighbours(ndx))
+    out.push_back(m_cellIDs[n]);
+}
+
+/**
+ * @brief Map a table from a binary file.
+ * @param path Path of the file, written by @c writeMapFile.
+ * @param verifyChecksum If true, verify the checksum of the file contents.
+ */
+NeighbourTable NeighbourTable::fromMapFile(const std::string& path, bool verifyChecksum /*= true*/) {
+  return fromMapFile(std::make_shared<const CaloMapFile>(path, MAP_KIND, verifyChecksum));
+}
+
+/**
+ * @brief Make a table viewing an already-opened binary file.
+ * @param file The file, which is kept alive as long as the table exists.
+ */
+NeighbourTable NeighbourTable::fromMapFile(std::shared_ptr<const CaloMapFile> file) {
+  return NeighbourTable(file, file->get<CellID>(CaloMapFile::CELLIDS), file->get<uint32_t>(CaloMapFile::OFFSETS),
+                        file->get<index_t>(CaloMapFile::NEIGHBOUR_INDICES));
+}
+
+/**
+ * @brief Write the table to a binary file (see CaloMapFile).
+ * @param path Path of the file to write.
+ * @param tag User tag to record in the file header.
+ */
+void NeighbourTable::writeMapFile(const std::string& path, uint64_t tag /*= 0*/) const {
+  // The file format requires the cell IDs to be sorted.
+  if (!m_order.empty()) {
+    throw NeighbourTableException("cannot write a re-indexed table to " + path);
+  }
+  const CaloMapFile::Section sections[] = {
+      {CaloMapFile::CELLIDS, m_cellIDs},
+      {CaloMapFile::OFFSETS, m_offsets},
+      {CaloMapFile::NEIGHBOUR_INDICES, m_neighbours},
+  };
+  CaloMapFile::write(path, MAP_KIND, sections, tag);
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,329 @@
+/**
+ * @file RecCaloCommon/src/PulseProcessing.cpp
+ * @date Oct, 2026
+ * @brief Kernels for processing digitized pulses in caller-provided buffers.
+ */
+
+#include "RecCaloCommon/PulseProcessing.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Compile the batch kernels for several instruction sets, with the best one
+// for the CPU chosen when the library is loaded.
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+#define K4RECCALO_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define K4RECCALO_SIMD_CLONES
+#endif
+
+namespace k4::recCalo {
+
+/**
+ * @brief Add the pulse of one energy deposit to a digitized pulse.
+ * @param[in,out] pulse The digitized pulse.
+ * @param energy Energy of the deposit.
+ * @param time Time of the deposit.
+ * @param samplingInterval Time between samples.
+ * @param shape The pulse shape, sampled at the same interval as @c pulse.
+ * @param shapeDeriv The derivative of the pulse shape.
+ */
+void addPulseContribution(std::span<float> pulse, float energy, float time, float samplingInterval,
+                          std::span<const float> shape, std::span<const float> shapeDeriv) {
+  const float shift = std::rint(time / samplingInterval);
+  const float deltaT = time - samplingInterval * shift;
+  const long n = static_cast<long>(pulse.size());
+  const long nShape = static_cast<long>(std::min(shape.size(), shapeDeriv.size()));
+  // Also rejects NaN.
+  if (!(shift < n && shift > -nShape))
+    return;
+  const long ishift = static_cast<long>(shift);
+  const long last = std::min(n, nShape + ishift);
+  for (long i = std::max(0L, ishift); i < last; ++i) {
+    const long j = i - ishift;
+    pulse[i] += energy * (shape[j] - deltaT * shapeDeriv[j]);
+  }
+}
+
+/**
+ * @brief Subtract the noise mean from a pulse and apply a whitening matrix.
+ * @param pulse The input pulse.
+ * @param mean The noise mean per sample.
+ * @param whitening The whitening matrix, row-major, of size n*n
+ *                  for a pulse of n samples.
+ * @param[out] out The whitened pulse, of the same size as @c pulse.
+ */
+void whitenPulse(std::span<const float> pulse, std::span<const double> mean, std::span<const double> whitening,
+                 std::span<float> out) {
+  const size_t n = pulse.size();
+  for (size_t i = 0; i < n; ++i) {
+    const double* row = whitening.data() + i * n;
+    double sum = 0;
+    for (size_t j = 0; j < n; ++j)
+      sum += row[j] * (pulse[j] - mean[j]);
+    out[i] = sum;
+  }
+}
+
+/**
+ * @brief Subtract the noise mean from a batch of pulses and apply a whitening matrix.
+ * @param pulses The input pulses, one after another, each of @c nSamples samples.
+ * @param nSamples Number of samples per pulse.
+ * @param mean The noise mean per sample.
+ * @param whitening The whitening matrix, row-major, of size @c nSamples*nSamples.
+ * @param[out] out The whitened pulses, laid out like @c pulses.
+ */
+K4RECCALO_SIMD_CLONES
+void whitenPulseBatch(std::span<const float> pulses, size_t nSamples, std::span<const float> mean,
+                      std::span<const float> whitening, std::span<float> out) {
+  const size_t n = nSamples;
+  if (n == 0)
+    return;
+  const size_t nCells = pulses.size() / n;
+
+  // Pulses are done in tiles of TILE, transposed so that each sample is a
+  // row of TILE pulses; the tile then stays in the cache while all rows
+  // of the output are made, and the inner loops have a fixed length.
+  constexpr size_t TILE = 64;
+  std::vector<float> tile(n * TILE);
+  float acc[TILE];
+
+  for (size_t c0 = 0; c0 < nCells; c0 += TILE) {
+    const size_t nc = std::min(TILE, nCells - c0);
+    const float* in = pulses.data() + c0 * n;
+    for (size_t c = 0; c < TILE; ++c) {
+      for (size_t j = 0; j < n; ++j)
+        tile[j * TILE + c] = c < nc ? in[c * n + j] - mean[j] : 0.0f;
+    }
+
+    // out[c][i] = sum_j whitening[i][j] * tile[j][c]
+    float* res = out.data() + c0 * n;
+    for (size_t i = 0; i < n; ++i) {
+      const float* w = whitening.data() + i * n;
+      std::fill_n(acc, TILE, 0.0f);
+      for (size_t j = 0; j < n; ++j) {
+        const float a = w[j];
+        const float* t = tile.data() + j * TILE;
+        for (size_t c = 0; c < TILE; ++c)
+          acc[c] += a * t[c];
+      }
+      for (size_t c = 0; c < nc; ++c)
+        res[c * n + i] = acc[c];
+    }
+  }
+}
+
+/**
+ * @brief Compute the mean and covariance matrix of a set of samples.
+ * @param samples The observations, one after another, each of @c nVars values.
+ * @param nVars Number of variables per observation.
+ * @param[out] mean The mean of each variable, of size @c nVars.
+ * @param[out] cov The covariance matrix, row-major, of size @c nVars*nVars.
+ */
+K4RECCALO_SIMD_CLONES
+void sampleCovariance(std::span<const double> samples, size_t nVars, std::span<double> mean, std::span<double> cov) {
+  const size_t n = nVars;
+  if (n == 0)
+    return;
+  const size_t nObs = samples.size() / n;
+
+  std::fill_n(mean.data(), n, 0.0);
+  for (size_t k = 0; k < nObs; ++k) {
+    const double* x = samples.data() + k * n;
+    for (size_t i = 0; i < n; ++i)
+      mean[i] += x[i];
+  }
+  for (size_t i = 0; i < n; ++i)
+    mean[i] /= nObs;
+
+  // Observations are centered BLOCK at a time, then added
+  // to the upper triangle of the matrix.
+  constexpr size_t BLOCK = 64;
+  std::vector<double> centered(BLOCK * n);
+  double* c = cov.data();
+  std::fill_n(c, n * n, 0.0);
+  for (size_t k0 = 0; k0 < nObs; k0 += BLOCK) {
+    const size_t nk = std::min(BLOCK, nObs - k0);
+    for (size_t k = 0; k < nk; ++k) {
+      const double* x = samples.data() + (k0 + k) * n;
+      for (size_t i = 0; i < n; ++i)
+        centered[k * n + i] = x[i] - mean[i];
+    }
+    // Four observations at a time, to save loads and stores of the matrix.
+    size_t k = 0;
+    for (; k + 4 <= nk; k += 4) {
+      const double* x0 = centered.data() + k * n;
+      const double* x1 = x0 + n;
+      const double* x2 = x1 + n;
+      const double* x3 = x2 + n;
+      for (size_t i = 0; i < n; ++i) {
+        const double a0 = x0[i], a1 = x1[i], a2 = x2[i], a3 = x3[i];
+        double* row = c + i * n;
+        for (size_t j = i; j < n; ++j)
+          row[j] += (a0 * x0[j] + a1 * x1[j]) + (a2 * x2[j] + a3 * x3[j]);
+      }
+    }
+    for (; k < nk; ++k) {
+      const double* x = centered.data() + k * n;
+      for (size_t i = 0; i < n; ++i) {
+        const double a = x[i];
+        double* row = c + i * n;
+        for (size_t j = i; j < n; ++j)
+          row[j] += a * x[j];
+      }
+    }
+  }
+
+  const double norm = nObs > 1 ? 1.0 / (nObs - 1) : 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i; j < n; ++j) {
+      c[i * n + j] *= norm;
+      c[j * n + i] = c[i * n + j];
+    }
+  }
+}
+
+/**
+ * @brief Convolve a pulse with a filter and find the maximum.
+ * @param pulse The input pulse.
+ * @param reversedFilter The filter template, already time-reversed.
+ * @param[out] out The filtered pulse, of the same size as @c pulse.
+ *                 May be empty if only the maximum is wanted.
+ */
+PulsePeak matchedFilter(std::span<const float> pulse, std::span<const float> reversedFilter, std::span<float> out) {
+  const long n = static_cast<long>(pulse.size());
+  const long m = static_cast<long>(reversedFilter.size());
+  const long start = (m - 1) / 2;
+  PulsePeak peak;
+  for (long k = 0; k < n; ++k) {
+    // Output k is element k+start of the full convolution.
+    // Sum in the same order as the full convolution loop over the pulse.
+    const long kk = k + start;
+    float sum = 0;
+    for (long i = std::max(0L, kk - m + 1); i <= std::min(n - 1, kk); ++i)
+      sum += pulse[i] * reversedFilter[kk - i];
+    if (!out.empty())
+      out[k] = sum;
+    if (peak.index < 0 || sum > peak.energy) {
+      peak.index = k;
+      peak.energy = sum;
+    }
+  }
+  return peak;
+}
+
+/**
+ * @brief Apply a matched filter to a batch of pulses and find their maxima.
+ * @param pulses The input pulses, one after another, each of @c nSamples samples.
+ * @param nSamples Number of samples per pulse.
+ * @param reversedFilter The filter template, already time-reversed.
+ * @param[out] peaks The maximum of each filtered pulse; its size gives the number of pulses.
+ * @param[out] out The filtered pulses, laid out like @c pulses.
+ *                 May be empty if only the maxima are wanted.
+ */
+K4RECCALO_SIMD_CLONES
+void matchedFilterBatch(std::span<const float> pulses, size_t nSamples, std::span<const float> reversedFilter,
+                        std::span<PulsePeak> peaks, std::span<float> out) {
+  const size_t n = nSamples;
+  const size_t m = reversedFilter.size();
+  if (n == 0 || m == 0) {
+    std::fill(peaks.begin(), peaks.end(), PulsePeak{});
+    return;
+  }
+  const size_t start = (m - 1) / 2;
+  const size_t nCells = peaks.size();
+
+  // Pulses are processed in blocks of LANES, transposed so that each lane
+  // holds one pulse; all loops below then run over contiguous lanes.
+  // Each pulse is put between m-1 zeros on each side, so that the
+  // loops have no bounds checks.
+  constexpr size_t LANES = 16;
+  std::vector<float> padded((n + 2 * (m - 1)) * LANES, 0.0f);
+  std::vector<float> acc(n * LANES);
+
+  for (size_t c0 = 0; c0 < nCells; c0 += LANES) {
+    const size_t nl = std::min(LANES, nCells - c0);
+    for (size_t l = 0; l < LANES; ++l) {
+      for (size_t k = 0; k < n; ++k)
+        padded[(m - 1 + k) * LANES + l] = l < nl ? pulses[(c0 + l) * n + k] : 0.0f;
+    }
+
+    // Output k is the sum over j of filter[j] * pulse[k+start-j].
+    // Going down in j sums in the same order as matchedFilter.
+    std::fill(acc.begin(), acc.end(), 0.0f);
+    for (size_t j = m; j-- > 0;) {
+      const float f = reversedFilter[j];
+      const float* q = padded.data() + (start + m - 1 - j) * LANES;
+      for (size_t i = 0; i < n * LANES; ++i)
+        acc[i] += f * q[i];
+    }
+
+    // First maximum of each lane
+    float best[LANES];
+    int bestIndex[LANES];
+    for (size_t l = 0; l < LANES; ++l) {
+      best[l] = acc[l];
+      bestIndex[l] = 0;
+    }
+    for (size_t k = 1; k < n; ++k) {
+      for (size_t l = 0; l < LANES; ++l) {
+        const float v = acc[k * LANES + l];
+        const bool higher = v > best[l];
+        best[l] = higher ? v : best[l];
+        bestIndex[l] = higher ? static_cast<int>(k) : bestIndex[l];
+      }
+    }
+
+    for (size_t l = 0; l < nl; ++l) {
+      peaks[c0 + l] = PulsePeak{bestIndex[l], best[l]};
+      if (!out.empty()) {
+        for (size_t k = 0; k < n; ++k)
+          out[(c0 + l) * n + k] = acc[k * LANES + l];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Compute optimal filtering coefficients for amplitude and time.
+ * @param shape The pulse shape g at each sample used.
+ * @param shapeDeriv The derivative g' of the pulse shape at the same samples.
+ * @param invCov The inverse of the noise covariance matrix between these samples, row-major.
+ * @param[out] a The amplitude coefficients, of the same size as @c shape.
+ * @param[out] b The time coefficients, of the same size as @c shape.
+ */
+bool optimalFilterCoefficients(std::span<const double> shape, std::span<const double> shapeDeriv,
+                               std::span<const double> invCov, std::span<double> a, std::span<double> b) {
+  const size_t n = shape.size();
+
+  // Vg = V g and Vd = V g', with V the inverse covariance.
+  std::vector<double> Vg(n), Vd(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double* row = invCov.data() + i * n;
+    double sg = 0, sd = 0;
+    for (size_t j = 0; j < n; ++j) {
+      sg += row[j] * shape[j];
+      sd += row[j] * shapeDeriv[j];
+    }
+    Vg[i] = sg;
+    Vd[i] = sd;
+  }
+
+  double Q1 = 0, Q2 = 0, Q3 = 0;
+  for (size_t i = 0; i < n; ++i) {
+    Q1 += shape[i] * Vg[i];
+    Q2 += shapeDeriv[i] * Vd[i];
+    Q3 += shapeDeriv[i] * Vg[i];
+  }
+  const double delta = Q1 * Q2 - Q3 * Q3;
+  if (!(std::abs(delta) > 1e-12 * std::abs(Q1 * Q2)))
+    return false;
+
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = (Q2 * Vg[i] - Q3 * Vd[i]) / delta;
+    b[i] = (Q3 * Vg[i] - Q1 * Vd[i]) / delta;
+  }
+  return true;
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,39 @@
+/**
+ * @file RecCaloCommon/src/PulseShapeLibrary.cpp
+ * @date Oct, 2026
+ * @brief Pulse shape sampled at a set of sub-sample phases.
+ */
+
+#include "RecCaloCommon/PulseShapeLibrary.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Add the pulse of one energy deposit to a digitized pulse.
+ * @param[in,out] pulse The digitized pulse.
+ * @param energy Energy of the deposit.
+ * @param time Time of the deposit.
+ */
+void PulseShapeLibrary::add(std::span<float> pulse, float energy, float time) const {
+  // Time in units of phase steps, rounded to the nearest phase.
+  const double steps = std::rint(static_cast<double>(time) / m_samplingInterval * m_nPhases);
+  const long n = static_cast<long>(std::min(pulse.size(), m_nSamples));
+  const long nPhases = static_cast<long>(m_nPhases);
+  // Also rejects NaN.
+  if (!(steps < static_cast<double>(n) * nPhases && steps > -static_cast<double>(n) * nPhases))
+    return;
+  const long q = static_cast<long>(steps);
+  // Sample at which the shape starts, and phase: q = shift*nPhases + phase, 0 <= phase < nPhases.
+  const long shift = q >= 0 ? q / nPhases : -((-q + nPhases - 1) / nPhases);
+  const long phase = q - shift * nPhases;
+
+  const float* row = m_table.data() + phase * m_nSamples;
+  const long first = std::max(0L, shift);
+  const long last = std::min(n, static_cast<long>(m_nSamples) + shift);
+  float* out = pulse.data();
+  for (long i = first; i < last; ++i)
+    out[i] += energy * row[i - shift];
+}
+
+} // namespace k4::recCalo
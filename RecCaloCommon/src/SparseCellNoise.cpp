@@ -0,0 +1,78 @@
+/**
+ * @file RecCaloCommon/src/SparseCellNoise.cpp
+ * @date Oct, 2026
+ * @brief Sample the noise of empty cells that passes a filter threshold.
+ */
+
+#include "RecCaloCommon/SparseCellNoise.h"
+#include <algorithm>
+#include <format>
+#include <numeric>
+
+namespace k4::recCalo {
+
+/**
+ * @brief For reporting errors from the constructor.
+ */
+SparseCellNoise::SparseCellNoiseException::SparseCellNoiseException(const std::string& what)
+    : std::runtime_error("SparseCellNoiseException: " + what) {}
+
+/**
+ * @brief Constructor.
+ * @param cells IDs of all cells to consider.
+ * @param noiseRMS Noise RMS of each cell.
+ * @param threshold Filter threshold, in units of the noise RMS.
+ * @param useAbs If true, cells survive if |E| >= threshold * sigma,
+ *               otherwise if E >= threshold * sigma.
+ */
+SparseCellNoise::SparseCellNoise(std::span<const CellID> cells, std::span<const double> noiseRMS, double threshold,
+                                 bool useAbs)
+    : m_threshold(threshold), m_useAbs(useAbs) {
+  if (noiseRMS.size() != cells.size()) {
+    throw SparseCellNoiseException(
+        std::format("inconsistent input sizes: {} cells, {} rms", cells.size(), noiseRMS.size()));
+  }
+  if (!(threshold > 0)) {
+    throw SparseCellNoiseException(std::format("threshold {} should be positive", threshold));
+  }
+
+  // Upper tail probability of the standard normal distribution.
+  m_prob = 0.5 * std::erfc(threshold / std::sqrt(2.));
+  if (useAbs)
+    m_prob *= 2;
+  m_log1mProb = std::log1p(-m_prob);
+
+  // Group the cells by noise RMS.  The order within a class is kept
+  // as given, so that results are reproducible.
+  std::vector<size_t> order(cells.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](size_t a, size_t b) { return noiseRMS[a] < noiseRMS[b]; });
+
+  m_cells.reserve(cells.size());
+  m_offsets.push_back(0);
+  for (size_t i : order) {
+    double sigma = std::max(noiseRMS[i], 0.);
+    if (m_sigma.empty() || m_sigma.back() != sigma) {
+      if (!m_sigma.empty())
+        m_offsets.push_back(m_cells.size());
+      m_sigma.push_back(sigma);
+    }
+    m_cells.push_back(cells[i]);
+  }
+  if (!m_sigma.empty())
+    m_offsets.push_back(m_cells.size());
+}
+
+/**
+ * @brief Expected number of cells returned by @c sample.
+ */
+double SparseCellNoise::expectedCount() const {
+  double count = 0;
+  for (size_t icl = 0; icl < m_sigma.size(); ++icl) {
+    size_t n = m_offsets[icl + 1] - m_offsets[icl];
+    count += m_sigma[icl] == 0 ? n : n * m_prob;
+  }
+  return count;
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,221 @@
+/**
+ * @file RecCaloCommon/src/TopoClusterEngine.cpp
+ * @date Oct, 2026
+ * @brief Index-based proto-cluster growth for topological clustering.
+ */
+
+#include "RecCaloCommon/TopoClusterEngine.h"
+#include <algorithm>
+#include <numeric>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param indexer Indexer used to map cell IDs to dense indices.
+ */
+TopoClusterEngine::TopoClusterEngine(const ICaloIndexer& indexer)
+    : m_indexer(indexer), m_slotOfIndex(indexer.cellIDs().size(), NOSLOT) {}
+
+/**
+ * @brief Reset the engine for a new event.
+ */
+void TopoClusterEngine::clear() {
+  for (index_t ndx : m_index)
+    m_slotOfIndex[ndx] = NOSLOT;
+
+  m_cellID.clear();
+  m_index.clear();
+  m_energy.clear();
+  m_noiseRMS.clear();
+  m_noiseOffset.clear();
+  m_canonical.clear();
+  m_nextDuplicate.clear();
+  m_label.clear();
+  m_type.clear();
+  m_nextInCluster.clear();
+  m_seeds.clear();
+  m_clusterIDs.clear();
+  m_clusterOffsets.clear();
+  m_clusterCells.clear();
+}
+
+/**
+ * @brief Add an active cell.
+ * @param id The cell identifier.
+ * @param energy The cell energy.
+ * @param noiseRMS The noise RMS for this cell.
+ * @param noiseOffset The noise offset for this cell.
+ */
+auto TopoClusterEngine::addCell(CellID id, float energy, double noiseRMS, double noiseOffset) -> slot_t {
+  return addCell(m_indexer.index(id), id, energy, noiseRMS, noiseOffset);
+}
+
+/**
+ * @brief Add an active cell whose index is already known.
+ * @param ndx The index of the cell, as given by the indexer, or @c INVALID.
+ * @param id The cell identifier.
+ * @param energy The cell energy.
+ * @param noiseRMS The noise RMS for this cell.
+ * @param noiseOffset The noise offset for this cell.
+ */
+auto TopoClusterEngine::addCell(index_t ndx, CellID id, float energy, double noiseRMS, double noiseOffset) -> slot_t {
+  if (ndx == ICaloIndexer::INVALID)
+    return NOSLOT;
+
+  slot_t s = m_cellID.size();
+  m_cellID.push_back(id);
+  m_index.push_back(ndx);
+  m_energy.push_back(energy);
+  m_noiseRMS.push_back(noiseRMS);
+  m_noiseOffset.push_back(noiseOffset);
+  m_nextDuplicate.push_back(NOSLOT);
+  m_label.push_back(NOCLUSTER);
+  m_type.push_back(UNCLUSTERED);
+  m_nextInCluster.push_back(NOSLOT);
+
+  slot_t& first = m_slotOfIndex[ndx];
+  if (first == NOSLOT) {
+    first = s;
+    m_canonical.push_back(s);
+  } else {
+    // Duplicated cell ID: chain it after the previous instances.
+    m_canonical.push_back(first);
+    slot_t last = first;
+    while (m_nextDuplicate[last] != NOSLOT)
+      last = m_nextDuplicate[last];
+    m_nextDuplicate[last] = s;
+  }
+
+  return s;
+}
+
+/**
+ * @brief Find and sort the seeds.
+ * @param seedSigma The seed threshold, in units of noise RMS.
+ */
+void TopoClusterEngine::findSeeds(int seedSigma) {
+  // Reset any clustering state from a previous build.
+  std::ranges::fill(m_label, NOCLUSTER);
+  std::ranges::fill(m_type, UNCLUSTERED);
+  std::ranges::fill(m_nextInCluster, NOSLOT);
+
+  m_seeds.clear();
+  size_t ncells = m_cellID.size();
+  for (slot_t s = 0; s < ncells; ++s) {
+    double threshold = m_noiseOffset[s] + m_noiseRMS[s] * seedSigma;
+    if (std::fabs(m_energy[s]) > threshold)
+      m_seeds.push_back(s);
+  }
+
+  // Sort the seeds in decreasing order of energy.
+  // This uses the same comparisons as the original algorithm, so the
+  // order of seeds with identical energies is also preserved.
+  std::sort(m_seeds.begin(), m_seeds.end(), [this](slot_t lhs, slot_t rhs) { return m_energy[lhs] > m_energy[rhs]; });
+
+  // Cluster IDs run from 1 to the number of seeds.
+  size_t nid = m_seeds.size() + 1;
+  m_parent.assign(nid, NOCLUSTER);
+  m_head.assign(nid, NOSLOT);
+  m_tail.assign(nid, NOSLOT);
+}
+
+/**
+ * @brief Make the list of resulting clusters.
+ */
+void TopoClusterEngine::collectClusters() {
+  m_clusterIDs.clear();
+  m_clusterOffsets.clear();
+  m_clusterCells.clear();
+  m_clusterCells.reserve(m_cellID.size());
+
+  m_clusterOffsets.push_back(0);
+  for (clusterID_t id = 1; id < m_parent.size(); ++id) {
+    // Skip IDs which were never used or were merged into another cluster.
+    if (m_parent[id] != id)
+      continue;
+    m_clusterIDs.push_back(id);
+    for (slot_t s = m_head[id]; s != NOSLOT; s = m_nextInCluster[s])
+      m_clusterCells.push_back(s);
+    m_clusterOffsets.push_back(m_clusterCells.size());
+  }
+}
+
+/**
+ * @brief Find the root of a component of cells.
+ * @param s Slot of a cell in the component.
+ */
+auto TopoClusterEngine::findComponent(slot_t s) -> slot_t {
+  slot_t root = s;
+  while (m_componentParent[root] != root)
+    root = m_componentParent[root];
+  while (m_componentParent[s] != root) {
+    slot_t next = m_componentParent[s];
+    m_componentParent[s] = root;
+    s = next;
+  }
+  return root;
+}
+
+/**
+ * @brief Join two components of cells.
+ * @param a Slot of a cell in the first component.
+ * @param b Slot of a cell in the second component.
+ */
+void TopoClusterEngine::joinComponents(slot_t a, slot_t b) {
+  a = findComponent(a);
+  b = findComponent(b);
+  if (a == b)
+    return;
+  if (m_componentSize[a] < m_componentSize[b])
+    std::swap(a, b);
+  m_componentParent[b] = a;
+  m_componentSize[a] += m_componentSize[b];
+}
+
+/**
+ * @brief Group the seeds by connected component.
+ * @param edges Pairs of neighbouring clusterable cells.
+ */
+void TopoClusterEngine::groupSeeds(std::span<const std::pair<slot_t, slot_t>> edges) {
+  static constexpr uint32_t NOCOMPONENT = static_cast<uint32_t>(-1);
+
+  size_t ncells = m_cellID.size();
+  m_componentParent.resize(ncells);
+  std::iota(m_componentParent.begin(), m_componentParent.end(), 0);
+  m_componentSize.assign(ncells, 1);
+  for (const auto& [a, b] : edges)
+    joinComponents(a, b);
+
+  // Number the components containing seeds, and count the seeds in each.
+  m_componentNumber.assign(ncells, NOCOMPONENT);
+  std::vector<slot_t> roots;
+  m_componentOffsets.assign(1, 0);
+  for (slot_t seed : m_seeds) {
+    slot_t root = findComponent(m_canonical[seed]);
+    if (m_componentNumber[root] == NOCOMPONENT) {
+      m_componentNumber[root] = roots.size();
+      roots.push_back(root);
+      m_componentOffsets.push_back(0);
+    }
+    ++m_componentOffsets[m_componentNumber[root] + 1];
+  }
+  std::partial_sum(m_componentOffsets.begin(), m_componentOffsets.end(), m_componentOffsets.begin());
+
+  // List the seeds of each component, keeping the global seed order.
+  m_componentSeeds.resize(m_seeds.size());
+  std::vector<size_t> fill(m_componentOffsets.begin(), m_componentOffsets.end() - 1);
+  for (uint32_t iseed = 0; iseed < m_seeds.size(); ++iseed) {
+    uint32_t icomp = m_componentNumber[findComponent(m_canonical[m_seeds[iseed]])];
+    m_componentSeeds[fill[icomp]++] = iseed;
+  }
+
+  // Process the largest components first.
+  m_componentOrder.resize(roots.size());
+  std::iota(m_componentOrder.begin(), m_componentOrder.end(), 0);
+  std::stable_sort(m_componentOrder.begin(), m_componentOrder.end(), [&](uint32_t lhs, uint32_t rhs) {
+    return m_componentSize[roots[lhs]] > m_componentSize[roots[rhs]];
+  });
+}
+
+} // namespace k4::recCalo
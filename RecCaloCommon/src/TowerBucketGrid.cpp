@@ -0,0 +1,123 @@
+/**
+ * @file RecCaloCommon/src/TowerBucketGrid.cpp
+ * @date Oct, 2026
+ * @brief Buckets of objects in tower index space, for neighbour queries.
+ */
+
+#include "RecCaloCommon/TowerBucketGrid.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param nRows Number of towers in eta (or theta).
+ * @param nPhi Number of towers in phi.
+ * @param bucketRows Number of towers in eta (or theta) in a bucket.
+ * @param bucketPhi Number of towers in phi in a bucket.
+ */
+TowerBucketGrid::TowerBucketGrid(int nRows, int nPhi, int bucketRows, int bucketPhi)
+    : m_nRows(std::max(nRows, 1)), m_nPhi(std::max(nPhi, 1)), m_bucketRows(std::max(bucketRows, 1)),
+      m_bucketPhi(std::max(bucketPhi, 1)), m_nRowBuckets((m_nRows + m_bucketRows - 1) / m_bucketRows),
+      m_nPhiBuckets((m_nPhi + m_bucketPhi - 1) / m_bucketPhi),
+      m_offsets(static_cast<size_t>(m_nRowBuckets) * m_nPhiBuckets + 1, 0) {}
+
+/**
+ * @brief Return the bucket index of a phi tower index.
+ * @param iPhi A phi index; any value.
+ */
+int TowerBucketGrid::phiBucket(int iPhi) const {
+  int i = iPhi % m_nPhi;
+  if (i < 0)
+    i += m_nPhi;
+  return i / m_bucketPhi;
+}
+
+/**
+ * @brief Place objects into the buckets.
+ * @param rows The eta (or theta) tower index of each object.
+ * @param phis The phi tower index of each object; any value.
+ *
+ * A counting sort on the bucket index, as for TowerGrid::finalizeCells,
+ * so that the objects of each bucket are in increasing order.
+ */
+void TowerBucketGrid::fill(std::span<const int> rows, std::span<const int> phis) {
+  const size_t nObjects = rows.size();
+  std::vector<index_t> bucket(nObjects);
+  for (size_t i = 0; i < nObjects; ++i) {
+    const int rowBucket = std::clamp(rows[i], 0, m_nRows - 1) / m_bucketRows;
+    bucket[i] = rowBucket * m_nPhiBuckets + phiBucket(phis[i]);
+  }
+
+  const size_t nBuckets = m_offsets.size() - 1;
+  m_offsets.assign(nBuckets + 1, 0);
+  for (index_t b : bucket) {
+    ++m_offsets[b + 1];
+  }
+  for (size_t b = 0; b < nBuckets; ++b) {
+    m_offsets[b + 1] += m_offsets[b];
+  }
+  m_objects.resize(nObjects);
+  std::vector<index_t> next(m_offsets.begin(), m_offsets.end() - 1);
+  for (size_t i = 0; i < nObjects; ++i) {
+    m_objects[next[bucket[i]]++] = i;
+  }
+}
+
+/**
+ * @brief Add the objects of a range of buckets in one row of buckets.
+ * @param rowBucket The row of buckets.
+ * @param phiBucketBegin First bucket in phi.
+ * @param phiBucketEnd One past the last bucket in phi.
+ * @param[out] found The list to which the objects are added.
+ */
+void TowerBucketGrid::addBuckets(int rowBucket, int phiBucketBegin, int phiBucketEnd,
+                                 std::vector<index_t>& found) const {
+  const size_t first = static_cast<size_t>(rowBucket) * m_nPhiBuckets;
+  found.insert(found.end(), m_objects.begin() + m_offsets[first + phiBucketBegin],
+               m_objects.begin() + m_offsets[first + phiBucketEnd]);
+}
+
+/**
+ * @brief Find the objects that may be near a tower.
+ * @param iRow The eta (or theta) index of the tower.
+ * @param iPhi The phi index of the tower; any value.
+ * @param dRow Half size of the window in eta (or theta).
+ * @param dPhi Half size of the window in phi.
+ * @param[out] found The objects of the buckets touching the window, in increasing order.
+ */
+void TowerBucketGrid::query(int iRow, int iPhi, int dRow, int dPhi, std::vector<index_t>& found) const {
+  found.clear();
+  dRow = std::max(dRow, 0);
+  dPhi = std::max(dPhi, 0);
+  const int rowBucketBegin = std::clamp(iRow - dRow, 0, m_nRows - 1) / m_bucketRows;
+  const int rowBucketEnd = std::clamp(iRow + dRow, 0, m_nRows - 1) / m_bucketRows + 1;
+
+  // Range of buckets in phi, as one or two contiguous ranges.
+  int phiBegin1 = 0, phiEnd1 = m_nPhiBuckets;
+  int phiBegin2 = 0, phiEnd2 = 0;
+  if (2 * dPhi + 1 < m_nPhi) {
+    const int b0 = phiBucket(iPhi - dPhi);
+    const int b1 = phiBucket(iPhi + dPhi);
+    const bool wraps = ((iPhi - dPhi) % m_nPhi + m_nPhi) % m_nPhi > ((iPhi + dPhi) % m_nPhi + m_nPhi) % m_nPhi;
+    if (!wraps) {
+      phiBegin1 = b0;
+      phiEnd1 = b1 + 1;
+    } else if (b0 > b1) {
+      phiBegin1 = b0;
+      phiEnd1 = m_nPhiBuckets;
+      phiBegin2 = 0;
+      phiEnd2 = b1 + 1;
+    }
+    // otherwise, the window wraps around and its ends share a bucket: all buckets are needed
+  }
+
+  for (int rowBucket = rowBucketBegin; rowBucket < rowBucketEnd; ++rowBucket) {
+    addBuckets(rowBucket, phiBegin1, phiEnd1, found);
+    if (phiEnd2 > phiBegin2)
+      addBuckets(rowBucket, phiBegin2, phiEnd2, found);
+  }
+  std::sort(found.begin(), found.end());
+}
+
+} // namespace k4::recCalo
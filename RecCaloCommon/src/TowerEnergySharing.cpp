@@ -0,0 +1,95 @@
+/**
+ * @file RecCaloCommon/src/TowerEnergySharing.cpp
+ * @date Oct, 2026
+ * @brief Energy sharing correction between overlapping sliding-window clusters.
+ */
+
+#include "RecCaloCommon/TowerEnergySharing.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param nRows Number of towers in eta (or theta).
+ * @param nPhi Number of towers in phi.
+ * @param halfRows Half size in eta (or theta) of the final clusters.
+ * @param halfPhi Half size in phi of the final clusters.
+ */
+TowerEnergySharing::TowerEnergySharing(int nRows, int nPhi, int halfRows, int halfPhi)
+    : m_nRows(nRows), m_nPhi(std::max(nPhi, 1)), m_halfRows(std::max(halfRows, 0)), m_halfPhi(std::max(halfPhi, 0)),
+      m_grid(nRows, nPhi, 2 * m_halfRows + 1, 2 * m_halfPhi + 1),
+      m_shared(static_cast<size_t>(2 * m_halfRows + 1) * (2 * m_halfPhi + 1)) {}
+
+/**
+ * @brief Set the positions of the clusters.
+ * @param rows The eta (or theta) tower index of each cluster.
+ * @param phis The phi tower index of each cluster; any value.
+ */
+void TowerEnergySharing::fill(std::span<const int> rows, std::span<const int> phis) {
+  m_rows = rows;
+  m_phis = phis;
+  m_grid.fill(rows, phis);
+}
+
+/**
+ * @brief Return the energy of a cluster after the sharing correction.
+ * @param energies Energies of all towers, row by row.
+ * @param iCluster Index of the cluster, as passed to @c fill.
+ * @param energy Energy of the cluster before the correction.
+ *
+ * Two clusters overlap if their centres are within twice the half sizes
+ * of each other.  The phi offset of the other cluster is taken the
+ * shorter way round, so that clusters on either side of phi = 0 share
+ * their towers.
+ */
+float TowerEnergySharing::correct(std::span<const float> energies, size_t iCluster, float energy) {
+  const int nPhiCluster = 2 * m_halfPhi + 1;
+  const int iRow = m_rows[iCluster];
+  const int iPhi = m_phis[iCluster];
+  auto tower = [&](int row, int dPhi) {
+    int phi = (iPhi + dPhi) % m_nPhi;
+    if (phi < 0)
+      phi += m_nPhi;
+    return energies[static_cast<size_t>(row) * m_nPhi + phi];
+  };
+
+  // Add the energy of the towers shared with each other cluster,
+  // in the coordinates of the towers relative to the corner of this one.
+  std::fill(m_shared.begin(), m_shared.end(), 0);
+  m_grid.query(iRow, iPhi, 2 * m_halfRows, 2 * m_halfPhi, m_candidates);
+  for (auto iShare : m_candidates) {
+    if (iShare == iCluster)
+      continue;
+    const int dRow = m_rows[iShare] - iRow;
+    int dPhi = (m_phis[iShare] - iPhi) % m_nPhi;
+    if (dPhi > m_nPhi / 2)
+      dPhi -= m_nPhi;
+    else if (dPhi < -(m_nPhi - 1) / 2)
+      dPhi += m_nPhi;
+    if (std::abs(dRow) > 2 * m_halfRows || std::abs(dPhi) > 2 * m_halfPhi)
+      continue;
+    for (int r = std::max(0, dRow) - m_halfRows; r <= std::min(0, dRow) + m_halfRows; ++r) {
+      if (iRow + r < 0 || iRow + r >= m_nRows)
+        continue;
+      for (int p = std::max(0, dPhi) - m_halfPhi; p <= std::min(0, dPhi) + m_halfPhi; ++p) {
+        m_shared[(r + m_halfRows) * nPhiCluster + p + m_halfPhi] += tower(iRow + r, p);
+      }
+    }
+  }
+
+  // Subtract the part of each shared tower seen by the other clusters.
+  for (int r = -m_halfRows; r <= m_halfRows; ++r) {
+    for (int p = -m_halfPhi; p <= m_halfPhi; ++p) {
+      const float sumButOne = m_shared[(r + m_halfRows) * nPhiCluster + p + m_halfPhi];
+      if (sumButOne != 0) {
+        const float towerEnergy = tower(iRow + r, p);
+        energy -= towerEnergy * sumButOne / (sumButOne + towerEnergy);
+      }
+    }
+  }
+  return energy;
+}
+
+} // namespace k4::recCalo
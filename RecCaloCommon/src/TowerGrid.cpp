@@ -0,0 +1,61 @@
+/**
+ * @file RecCaloCommon/src/TowerGrid.cpp
+ * @date Oct, 2026
+ * @brief Grid of calorimeter tower energies, with the cells in each tower.
+ */
+
+#include "RecCaloCommon/TowerGrid.h"
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param nRows Number of towers in eta (or theta).
+ * @param nPhi Number of towers in phi.
+ */
+TowerGrid::TowerGrid(int nRows /*= 0*/, int nPhi /*= 0*/)
+    : m_nRows(nRows), m_nPhi(nPhi), m_energies(static_cast<size_t>(nRows) * nPhi, 0),
+      m_offsets(static_cast<size_t>(nRows) * nPhi + 1, 0) {}
+
+/**
+ * @brief Build the index of cells in each tower from the recorded pairs.
+ *
+ * A counting sort on the tower index: count the cells per tower, turn
+ * the counts into offsets, then place each cell.  Pairs are placed in
+ * the order in which they were added.
+ */
+void TowerGrid::finalizeCells() {
+  const size_t nTowers = size();
+  m_offsets.assign(nTowers + 1, 0);
+  for (const auto& p : m_pending) {
+    ++m_offsets[p.first + 1];
+  }
+  for (size_t t = 0; t < nTowers; ++t) {
+    m_offsets[t + 1] += m_offsets[t];
+  }
+
+  m_cells.resize(m_pending.size());
+  std::vector<uint32_t> next(m_offsets.begin(), m_offsets.end() - 1);
+  for (const auto& p : m_pending) {
+    m_cells[next[p.first]++] = p.second;
+  }
+
+  m_pending.clear();
+  m_pending.shrink_to_fit();
+}
+
+/**
+ * @brief Add rows of empty towers.
+ * @param nRows The new number of rows.
+ */
+void TowerGrid::extendRows(int nRows) {
+  if (nRows <= m_nRows)
+    return;
+  m_nRows = nRows;
+  const size_t nTowers = static_cast<size_t>(m_nRows) * m_nPhi;
+  m_energies.resize(nTowers, 0);
+  // Tower indices of pending pairs are unchanged, since rows are added at the end.
+  m_offsets.resize(nTowers + 1, m_offsets.back());
+}
+
+} // namespace k4::recCalo
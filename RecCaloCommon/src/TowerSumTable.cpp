@@ -0,0 +1,150 @@
+/**
+ * @file RecCaloCommon/src/TowerSumTable.cpp
+ * @date Oct, 2026
+ * @brief Summed-area tables of tower quantities, for sliding-window clustering.
+ */
+
+#include "RecCaloCommon/TowerSumTable.h"
+#include <algorithm>
+
+namespace k4::recCalo {
+
+/**
+ * @brief Constructor.
+ * @param nRows Number of towers in eta (or theta).
+ * @param nPhi Number of towers in phi.
+ * @param nGhost Number of ghost columns on each side in phi.
+ */
+TowerSumTable::TowerSumTable(int nRows /*= 0*/, int nPhi /*= 0*/, int nGhost /*= 0*/)
+    : m_nRows(nRows), m_nPhi(nPhi), m_nGhost(nGhost), m_stride(nPhi + 2 * nGhost + 1) {}
+
+/**
+ * @brief Add a plane from the values of the towers.
+ * @param values One value per tower, row by row, as TowerGrid::energies.
+ */
+int TowerSumTable::addPlane(std::span<const float> values) {
+  return addPlane([&](int iRow, int iPhi) { return values[static_cast<size_t>(iRow) * m_nPhi + wrapPhi(iPhi)]; });
+}
+
+/**
+ * @brief Sum a plane over a window.
+ * @param plane Index of the plane.
+ * @param rowBegin First row of the window.
+ * @param rowEnd One past the last row of the window.
+ * @param phiBegin First phi index of the window, at least -nGhost.
+ * @param phiEnd One past the last phi index of the window, at most nPhi + nGhost.
+ */
+double TowerSumTable::sum(int plane, int rowBegin, int rowEnd, int phiBegin, int phiEnd) const {
+  rowBegin = std::max(rowBegin, 0);
+  rowEnd = std::min(rowEnd, m_nRows);
+  if (rowBegin >= rowEnd)
+    return 0;
+  const double* lo = table(plane) + rowBegin * m_stride;
+  const double* hi = table(plane) + rowEnd * m_stride;
+  const int a = phiBegin + m_nGhost;
+  const int b = phiEnd + m_nGhost;
+  return (hi[b] - lo[b]) - (hi[a] - lo[a]);
+}
+
+/**
+ * @brief Sum a plane over a window given by its centre.
+ * @param plane Index of the plane.
+ * @param iRow Central row of the window.
+ * @param iPhi Central phi index of the window; any value.
+ * @param halfRows Half size of the window in rows.
+ * @param halfPhi Half size of the window in phi, at most nGhost.
+ *
+ * The centre is brought into [0, nPhi) first.
+ */
+double TowerSumTable::windowSum(int plane, int iRow, int iPhi, int halfRows, int halfPhi) const {
+  const int c = wrapPhi(iPhi);
+  return sum(plane, iRow - halfRows, iRow + halfRows + 1, c - halfPhi, c + halfPhi + 1);
+}
+
+/**
+ * @brief Sum a plane over an ellipse given by its centre.
+ *
+ * In each row, the towers in the ellipse are those within some distance
+ * of the centre in phi, found by testing increasing distances; the row
+ * is then summed from the table.
+ */
+double TowerSumTable::ellipseSum(int plane, int iRow, int iPhi, int halfRows, int halfPhi, double radiusRows,
+                                 double radiusPhi) const {
+  const int c = wrapPhi(iPhi);
+  double s = 0;
+  for (int r = std::max(iRow - halfRows, 0); r <= std::min(iRow + halfRows, m_nRows - 1); ++r) {
+    const double dRow = (r - iRow) / radiusRows;
+    int k = -1;
+    while (k < halfPhi) {
+      const double dPhi = (k + 1) / radiusPhi;
+      if (!(dRow * dRow + dPhi * dPhi < 1))
+        break;
+      ++k;
+    }
+    if (k >= 0)
+      s += sum(plane, r, r + 1, c - k, c + k + 1);
+  }
+  return s;
+}
+
+/**
+ * @brief Find the seeds of the sliding window in one row.
+ *
+ * For the window centred on each phi, the window sum, the sums of the
+ * columns just inside and outside of it, and the sums of the rows just
+ * inside and outside of it are all differences of table entries at
+ * fixed offsets from the phi index.
+ */
+void TowerSumTable::findSeeds(int plane, int iRow, int halfRows, int halfPhi, double threshold,
+                              std::vector<int>& seeds) {
+  seeds.clear();
+  const int r0 = iRow - halfRows;
+  const int r1 = iRow + halfRows + 1;
+  const bool hasPrev = r0 > 0;
+  const bool hasNext = r1 < m_nRows;
+
+  // Rows bounding the window, its first and last rows, and the rows just
+  // outside of it (or the window itself if there are none).
+  const double* t = table(plane);
+  const double* rowPrev = t + (hasPrev ? r0 - 1 : r0) * m_stride;
+  const double* rowLo = t + r0 * m_stride;
+  const double* rowFirst = t + (r0 + 1) * m_stride;
+  const double* rowLast = t + (r1 - 1) * m_stride;
+  const double* rowHi = t + r1 * m_stride;
+  const double* rowNext = t + (hasNext ? r1 + 1 : r1) * m_stride;
+
+  // Padded columns of the window centred on phi index i are [i + a, i + b).
+  const int a = m_nGhost - halfPhi;
+  const int b = m_nGhost + halfPhi + 1;
+  const int nPhi = m_nPhi;
+  m_isSeed.resize(nPhi);
+  float* isSeed = m_isSeed.data();
+  for (int i = 0; i < nPhi; ++i) {
+    // Sums over the rows of the window, of the columns [0, i + a - 1) ... [0, i + b + 1).
+    const double c0 = rowHi[i + a - 1] - rowLo[i + a - 1];
+    const double c1 = rowHi[i + a] - rowLo[i + a];
+    const double c2 = rowHi[i + a + 1] - rowLo[i + a + 1];
+    const double c3 = rowHi[i + b - 1] - rowLo[i + b - 1];
+    const double c4 = rowHi[i + b] - rowLo[i + b];
+    const double c5 = rowHi[i + b + 1] - rowLo[i + b + 1];
+    const double window = c4 - c1;
+    const double colPrev = c1 - c0;
+    const double colFirst = c2 - c1;
+    const double colLast = c4 - c3;
+    const double colNext = c5 - c4;
+    const double sumPrev = (rowLo[i + b] - rowPrev[i + b]) - (rowLo[i + a] - rowPrev[i + a]);
+    const double sumFirst = (rowFirst[i + b] - rowLo[i + b]) - (rowFirst[i + a] - rowLo[i + a]);
+    const double sumLast = (rowHi[i + b] - rowLast[i + b]) - (rowHi[i + a] - rowLast[i + a]);
+    const double sumNext = (rowNext[i + b] - rowHi[i + b]) - (rowNext[i + a] - rowHi[i + a]);
+    isSeed[i] = ((window > threshold) & !(colFirst < colNext) & !(colLast < colPrev) &
+                 !(hasPrev & (sumPrev > sumLast)) & !(hasNext & (sumNext > sumFirst)))
+                    ? 1
+                    : 0;
+  }
+  for (int i = 0; i < nPhi; ++i) {
+    if (isSeed[i])
+      seeds.push_back(i);
+  }
+}
+
+} // namespace k4::recCalo
@@ -0,0 +1,80 @@
+/**
+ * @file RecCaloCommon/tests/AdcCodec_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for AdcCodec.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/AdcCodec.h"
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using k4::recCalo::AdcCodec;
+
+// Round trip and clipping.
+void test1() {
+  AdcCodec codec(1000, 100, 12);
+  assert(codec.gain() == 1000);
+  assert(codec.pedestal() == 100);
+  assert(codec.nBits() == 12);
+  assert(codec.maxCount() == 4095);
+
+  std::vector<float> amps{0, 0.0123f, -0.05f, 1.5f, 3.9949f, -0.2f, 5, NAN, 3.996f};
+  std::vector<int32_t> counts(amps.size());
+  assert(codec.encode(amps, counts) == 4);
+  std::vector<int32_t> exp{100, 112, 50, 1600, 4095, 0, 4095, 0, 4095};
+  assert(counts == exp);
+
+  std::vector<float> back(amps.size());
+  codec.decode(counts, back);
+  for (size_t i = 0; i < 5; i++)
+    assert(std::abs(back[i] - amps[i]) <= 0.5f / 1000 + 1e-6f);
+  assert(back[5] == -0.1f);
+  for (size_t i = 0; i < amps.size(); i++)
+    assert(codec.decode(counts[i]) == back[i]);
+
+  // 16 bits; nothing clipped.
+  AdcCodec codec16(1000, 1000, 16);
+  assert(codec16.maxCount() == 65535);
+  std::vector<float> amps16{-1, 0, 64.535f};
+  std::vector<int32_t> counts16(3);
+  assert(codec16.encode(amps16, counts16) == 0);
+  assert(counts16[0] == 0 && counts16[1] == 1000 && counts16[2] == 65535);
+
+  // 31 bits, at the top of the range.
+  AdcCodec codec31(1, 0, 31);
+  std::vector<float> big{3e9f, 2e9f};
+  std::vector<int32_t> bigCounts(2);
+  assert(codec31.encode(big, bigCounts) == 1);
+  assert(bigCounts[0] == 2147483647 && bigCounts[1] == 2000000000);
+}
+
+// Bad arguments.
+void test2() {
+  for (float gain : {0.f, -1.f, NAN, INFINITY}) {
+    bool caught = false;
+    try {
+      AdcCodec(gain, 0, 12);
+    } catch (const std::invalid_argument&) {
+      caught = true;
+    }
+    assert(caught);
+  }
+  for (unsigned nBits : {0u, 32u}) {
+    bool caught = false;
+    try {
+      AdcCodec(1, 0, nBits);
+    } catch (const std::invalid_argument&) {
+      caught = true;
+    }
+    assert(caught);
+  }
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file RecCaloCommon/tests/CaloMapFile_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for CaloMapFile and the tables stored with it.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/CellIDList.h"
+#include "RecCaloCommon/CellNoiseTable.h"
+#include "RecCaloCommon/CrosstalkTable.h"
+#include "RecCaloCommon/NeighbourTable.h"
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using k4::recCalo::CaloMapFile;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+std::string tmpName(const std::string& base) {
+  return (std::filesystem::temp_directory_path() / (base + "-" + std::to_string(getpid()) + ".bin")).string();
+}
+
+// Expect that opening a file fails.
+template <class FUNC>
+void expectFail(FUNC&& f) {
+  bool caught = false;
+  try {
+    f();
+  } catch (const CaloMapFile::CaloMapFileException&) {
+    caught = true;
+  }
+  assert(caught);
+}
+
+void test_neighbours() {
+  std::vector<mapkey_t> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<mapkey_t> nbrs;
+  uint32_t seed = 1234;
+  for (int i = 0; i < 3000; i++) {
+    cells.push_back(static_cast<mapkey_t>(rng_seed(seed)) << 8);
+    unsigned n = rng_seed(seed) % 10;
+    for (unsigned j = 0; j < n; j++)
+      nbrs.push_back(static_cast<mapkey_t>(rng_seed(seed) % 4000) << 8);
+    offsets.push_back(nbrs.size());
+  }
+  k4::recCalo::NeighbourTable table(cells, offsets, nbrs);
+
+  std::string path = tmpName("neighbours");
+  table.writeMapFile(path);
+  assert(CaloMapFile::isCaloMapFile(path));
+  {
+    k4::recCalo::NeighbourTable mapped = k4::recCalo::NeighbourTable::fromMapFile(path);
+    assert(mapped.size() == table.size());
+    assert(mapped.nEntries() == table.nEntries());
+    std::vector<mapkey_t> out1, out2;
+    for (mapkey_t id : table.cellIDs()) {
+      table.neighbourIDs(id, out1);
+      mapped.neighbourIDs(id, out2);
+      assert(out1 == out2);
+    }
+  }
+
+  // Wrong kind of map.
+  expectFail([&]() { CaloMapFile f(path, CaloMapFile::NOISE); });
+
+  // Corrupt one byte of the payload.
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(-20, std::ios::end);
+    char c = 0x55;
+    f.write(&c, 1);
+  }
+  expectFail([&]() { CaloMapFile f(path, CaloMapFile::NEIGHBOURS); });
+  // ... which is not seen if the payload checksum is not verified.
+  { CaloMapFile f(path, CaloMapFile::NEIGHBOURS, false); }
+
+  // Corrupt the header.
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(70);
+    char c = 0x55;
+    f.write(&c, 1);
+  }
+  expectFail([&]() { CaloMapFile f(path, CaloMapFile::NEIGHBOURS, false); });
+
+  // Truncated file.
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 64);
+  expectFail([&]() { CaloMapFile f(path, CaloMapFile::NEIGHBOURS, false); });
+
+  std::filesystem::remove(path);
+  expectFail([&]() { CaloMapFile f(path, CaloMapFile::NEIGHBOURS); });
+
+  // Not one of our files.
+  {
+    std::ofstream f(path);
+    f << "root\n";
+  }
+  assert(!CaloMapFile::isCaloMapFile(path));
+  std::filesystem::remove(path);
+}
+
+void test_noise() {
+  std::vector<mapkey_t> cells{40, 10, 30, 10, 20};
+  std::vector<double> rms{4, 1, 3, 5, 2};
+  std::vector<double> offset{0.4, 0.1, 0.3, 0.5, 0.2};
+  k4::recCalo::CellNoiseTable table(cells, rms, offset);
+  assert(table.size() == 4);
+  assert(table.noise(10) == std::make_pair(1., 0.1));
+  assert(table.noise(40) == std::make_pair(4., 0.4));
+  assert(table.noise(15) == std::make_pair(0., 0.));
+
+  std::string path = tmpName("noise");
+  table.writeMapFile(path);
+  {
+    k4::recCalo::CellNoiseTable mapped = k4::recCalo::CellNoiseTable::fromMapFile(path);
+    assert(mapped.size() == 4);
+    for (mapkey_t id : {10, 15, 20, 30, 40})
+      assert(mapped.noise(id) == table.noise(id));
+  }
+  expectFail([&]() { k4::recCalo::CrosstalkTable::fromMapFile(path); });
+  std::filesystem::remove(path);
+}
+
+void test_crosstalk() {
+  std::vector<mapkey_t> cells{30, 10, 20};
+  std::vector<uint64_t> offsets{0, 2, 3, 3};
+  std::vector<mapkey_t> nbrs{10, 20, 30};
+  std::vector<double> coeffs{0.1, 0.2, 0.3};
+  k4::recCalo::CrosstalkTable table(cells, offsets, nbrs, coeffs);
+  assert(table.size() == 3);
+  assert(table.neighbours(30).size() == 2);
+  assert(table.neighbours(30)[1] == 20);
+  assert(table.crosstalks(30)[1] == 0.2);
+  assert(table.neighbours(10).size() == 1);
+  assert(table.neighbours(20).empty());
+  assert(table.neighbours(25).empty());
+  assert(table.crosstalks(25).empty());
+
+  std::string path = tmpName("crosstalk");
+  table.writeMapFile(path);
+  {
+    k4::recCalo::CrosstalkTable mapped = k4::recCalo::CrosstalkTable::fromMapFile(path);
+    for (mapkey_t id : {10, 20, 25, 30}) {
+      assert(std::ranges::equal(mapped.neighbours(id), table.neighbours(id)));
+      assert(std::ranges::equal(mapped.crosstalks(id), table.crosstalks(id)));
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+// Structural checks of a crosstalk table made from existing arrays.
+void test_crosstalk_structure() {
+  using Table = k4::recCalo::CrosstalkTable;
+  auto fails = [](std::vector<mapkey_t> ids, std::vector<uint32_t> offsets) {
+    std::vector<mapkey_t> nbrs{10, 20, 30};
+    std::vector<double> coeffs{0.1, 0.2, 0.3};
+    try {
+      Table table(nullptr, ids, offsets, nbrs, coeffs);
+    } catch (const Table::CrosstalkTableException&) {
+      return true;
+    }
+    return false;
+  };
+  assert(!fails({10, 20, 30}, {0, 2, 3, 3}));
+  assert(fails({10, 20, 30}, {0, 2, 3}));
+  assert(fails({10, 20, 30}, {0, 3, 2, 3}));
+  assert(fails({10, 30, 20}, {0, 2, 3, 3}));
+  assert(fails({10, 10, 30}, {0, 2, 3, 3}));
+}
+
+void test_celllist() {
+  std::vector<mapkey_t> cells{50, 10, 30};
+  k4::recCalo::CellIDList list{std::vector<mapkey_t>(cells)};
+  assert(std::ranges::equal(list.cellIDs(), cells));
+
+  std::string path = tmpName("celllist");
+  list.writeMapFile(path, 0x1234);
+  {
+    k4::recCalo::CellIDList mapped = k4::recCalo::CellIDList::fromMapFile(path);
+    assert(std::ranges::equal(mapped.cellIDs(), cells));
+    CaloMapFile f(path, CaloMapFile::CELLLIST);
+    assert(f.tag() == 0x1234);
+  }
+  expectFail([&]() { k4::recCalo::NeighbourTable::fromMapFile(path); });
+
+  // Files written without a tag have zero.
+  k4::recCalo::CellIDList(std::vector<mapkey_t>()).writeMapFile(path);
+  {
+    auto f = std::make_shared<const CaloMapFile>(path, CaloMapFile::CELLLIST);
+    assert(f->tag() == 0);
+    assert(k4::recCalo::CellIDList::fromMapFile(f).size() == 0);
+  }
+  std::filesystem::remove(path);
+}
+
+int main() {
+  test_neighbours();
+  test_noise();
+  test_crosstalk();
+  test_crosstalk_structure();
+  test_celllist();
+  return 0;
+}
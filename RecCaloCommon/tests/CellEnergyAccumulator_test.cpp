@@ -0,0 +1,162 @@
+/**
+ * @file RecCaloCommon/tests/CellEnergyAccumulator_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for CellEnergyAccumulator and ObjectPool.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/CellEnergyAccumulator.h"
+#include "RecCaloCommon/ObjectPool.h"
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using k4::recCalo::CellEnergyAccumulator;
+using k4::recCalo::ICaloIndexer;
+
+// Simple indexer for testing: the index is the position in the list of cells.
+class TestIndexer : public ICaloIndexer {
+public:
+  TestIndexer(std::vector<mapkey_t> ids) : m_ids(std::move(ids)) {
+    for (size_t i = 0; i < m_ids.size(); i++)
+      m_map[m_ids[i]] = i;
+  }
+  virtual index_t index(CellID id) const override {
+    auto it = m_map.find(id);
+    return it != m_map.end() ? it->second : INVALID;
+  }
+  virtual std::span<const CellID> cellIDs() const override { return m_ids; }
+  virtual std::span<const int> detIDs() const override { return m_detIDs; }
+  virtual size_t detIDBits() const override { return 4; }
+
+private:
+  std::vector<mapkey_t> m_ids;
+  std::unordered_map<mapkey_t, index_t> m_map;
+  std::vector<int> m_detIDs{1};
+};
+
+using Result_t = std::map<mapkey_t, double>;
+
+Result_t toMap(const std::vector<std::pair<mapkey_t, double>>& v) {
+  Result_t m;
+  for (const auto& [id, e] : v) {
+    assert(!m.contains(id));
+    m[id] = e;
+  }
+  return m;
+}
+
+void check(const CellEnergyAccumulator& acc, const Result_t& expected) {
+  assert(acc.size() == expected.size());
+  assert(acc.empty() == expected.empty());
+  std::vector<std::pair<mapkey_t, double>> out;
+  acc.exportTo(out);
+  assert(toMap(out) == expected);
+  for (const auto& [id, e] : expected) {
+    assert(acc.contains(id));
+    assert(acc.energy(id) == e);
+  }
+}
+
+void test1(const ICaloIndexer* indexer) {
+  CellEnergyAccumulator acc(indexer);
+  assert(acc.indexer() == indexer);
+  check(acc, {});
+  assert(!acc.contains(30));
+  assert(acc.energy(30) == 0);
+
+  // 35 and 99 are not known to the indexer.
+  acc.add(10, 2);
+  acc.add(30, 1);
+  acc.add(35, 3);
+  acc.add(30, 4);
+  acc.add(99, 5);
+  acc.add(35, 1);
+  check(acc, {{10, 2}, {30, 5}, {35, 4}, {99, 5}});
+
+  // Iteration order.
+  std::vector<mapkey_t> order;
+  acc.forEach([&](mapkey_t id, double) { order.push_back(id); });
+  assert(order.size() == 4);
+  if (indexer) {
+    assert(order[0] == 10 && order[1] == 30);
+    acc.sortByIndex();
+    order.clear();
+    acc.forEach([&](mapkey_t id, double) { order.push_back(id); });
+    assert(order[0] == 30 && order[1] == 10);
+  }
+
+  // Export of all cells.
+  std::vector<mapkey_t> allCells{10, 20, 30, 40};
+  std::vector<std::pair<mapkey_t, double>> out;
+  acc.exportAll(allCells, out);
+  assert(toMap(out) == (Result_t{{10, 2}, {20, 0}, {30, 5}, {35, 4}, {40, 0}, {99, 5}}));
+  if (indexer) {
+    // Using the cells of the indexer.
+    out.clear();
+    acc.exportAll(indexer->cellIDs(), out);
+    assert(toMap(out) == (Result_t{{10, 2}, {20, 0}, {30, 5}, {35, 4}, {40, 0}, {99, 5}}));
+    assert(out[0].first == 40 && out[1].first == 30);
+  }
+  // A list missing some touched cells.
+  out.clear();
+  std::vector<mapkey_t> someCells{20, 35};
+  acc.exportAll(someCells, out);
+  assert(toMap(out) == (Result_t{{10, 2}, {20, 0}, {30, 5}, {35, 4}, {99, 5}}));
+
+  // Clearing.
+  acc.clear();
+  check(acc, {});
+  assert(!acc.contains(30));
+  acc.add(20, 1);
+  acc.add(30, 2);
+  check(acc, {{20, 1}, {30, 2}});
+
+  // Batch add.
+  std::vector<mapkey_t> ids;
+  std::vector<double> e;
+  Result_t expected{{20, 1}, {30, 2}};
+  for (int i = 0; i < 1000; i++) {
+    mapkey_t id = (i % 7) * 10;
+    ids.push_back(id);
+    e.push_back(i);
+    expected[id] += i;
+  }
+  acc.add(ids, e);
+  check(acc, expected);
+}
+
+void test2() {
+  TestIndexer indexer({40, 30, 20, 10});
+  k4::recCalo::ObjectPool<CellEnergyAccumulator> pool(
+      [&]() { return std::make_unique<CellEnergyAccumulator>(&indexer); });
+  assert(pool.nCreated() == 0);
+  CellEnergyAccumulator* p1 = nullptr;
+  {
+    auto a1 = pool.acquire();
+    auto a2 = pool.acquire();
+    assert(a1.get() != a2.get());
+    assert(pool.nCreated() == 2);
+    p1 = a1.get();
+    a1->add(10, 1);
+    a1->clear();
+  }
+  {
+    auto a3 = pool.acquire();
+    assert(pool.nCreated() == 2);
+    assert(a3.get() == p1 || pool.acquire().get() == p1);
+    assert(a3->empty());
+  }
+  assert(pool.nCreated() == 2);
+}
+
+int main() {
+  TestIndexer indexer({40, 30, 20, 10});
+  test1(&indexer);
+  test1(nullptr);
+  test2();
+  return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file RecCaloCommon/tests/CellMarks_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for CellMarks.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/CellMarks.h"
+#include <cassert>
+#include <cstdint>
+#include <set>
+
+using k4::recCalo::CellMarks;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+// Marks compared with a std::set, over many clears and growing sizes.
+void test1() {
+  uint32_t seed = 4321;
+  CellMarks marks;
+  for (int iter = 0; iter < 300; iter++) {
+    const size_t n = 1 + rng_seed(seed) % (10 + iter);
+    marks.clear(n);
+    std::set<size_t> ref;
+    for (int i = 0; i < 50; i++) {
+      const size_t ndx = rng_seed(seed) % n;
+      assert(marks.marked(ndx) == ref.contains(ndx));
+      assert(marks.mark(ndx) == ref.insert(ndx).second);
+      assert(marks.marked(ndx));
+    }
+    for (size_t ndx = 0; ndx < n; ndx++)
+      assert(marks.marked(ndx) == ref.contains(ndx));
+  }
+}
+
+int main() {
+  test1();
+  return 0;
+}
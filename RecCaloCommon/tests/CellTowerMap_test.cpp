@@ -0,0 +1,77 @@
+/**
+ * @file RecCaloCommon/tests/CellTowerMap_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for CellTowerMap.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/CellTowerMap.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using k4::recCalo::CellTowerMap;
+using k4::recCalo::ICaloIndexer;
+
+// Simple indexer over a list of IDs.
+class TestIndexer : public ICaloIndexer {
+public:
+  TestIndexer(const std::vector<mapkey_t>& ids) : m_ids(ids) {}
+  virtual index_t index(CellID id) const override {
+    auto it = std::ranges::find(m_ids, id);
+    return it == m_ids.end() ? INVALID : it - m_ids.begin();
+  }
+  virtual std::span<const CellID> cellIDs() const override { return m_ids; }
+  virtual std::span<const int> detIDs() const override { return {}; }
+  virtual size_t detIDBits() const override { return 0; }
+
+private:
+  const std::vector<mapkey_t>& m_ids;
+};
+
+// Cell i covers i % 4 towers, from tower i, with weights i + k/4.
+void towersOf(mapkey_t id, std::vector<CellTowerMap::Entry>& entries) {
+  for (mapkey_t k = 0; k < id % 4; k++)
+    entries.push_back({static_cast<uint32_t>(id + k), id + k * 0.25f});
+}
+
+void test1() {
+  std::vector<mapkey_t> ids;
+  for (mapkey_t i = 0; i < 1000; i++)
+    ids.push_back((i * 7919) % 1000 + 10);
+  TestIndexer indexer(ids);
+
+  size_t ncall = 0;
+  CellTowerMap map(indexer, [&](mapkey_t id, std::vector<CellTowerMap::Entry>& entries) {
+    ++ncall;
+    towersOf(id, entries);
+  });
+  assert(ncall == ids.size());
+  assert(map.size() == ids.size());
+  assert(map.cellIDs().data() == ids.data());
+
+  size_t nEntries = 0;
+  for (mapkey_t id : ids) {
+    std::vector<CellTowerMap::Entry> ref;
+    towersOf(id, ref);
+    auto entries = map.entries(indexer.index(id));
+    assert(entries.size() == ref.size());
+    for (size_t k = 0; k < ref.size(); k++) {
+      assert(entries[k].tower == ref[k].tower);
+      assert(entries[k].weight == ref[k].weight);
+    }
+    nEntries += ref.size();
+  }
+  assert(map.nEntries() == nEntries);
+
+  // Empty map.
+  CellTowerMap empty;
+  assert(empty.size() == 0);
+  assert(empty.nEntries() == 0);
+}
+
+int main() {
+  test1();
+  return 0;
+}
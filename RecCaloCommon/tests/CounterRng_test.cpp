@@ -0,0 +1,166 @@
+/**
+ * @file RecCaloCommon/tests/CounterRng_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for CounterRng.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/CounterRng.h"
+#include <cassert>
+#include <cmath>
+#include <set>
+#include <vector>
+
+using k4::recCalo::CounterRng;
+
+// Known-answer tests for Philox-4x32-10, from Random123.
+void test1() {
+  CounterRng::Bits b = CounterRng::philox4x32(0, 0, 0, 0, 0, 0);
+  assert((b == CounterRng::Bits{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+  b = CounterRng::philox4x32(0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff);
+  assert((b == CounterRng::Bits{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+  b = CounterRng::philox4x32(0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0);
+  assert((b == CounterRng::Bits{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+// Reproducibility and independence.
+void test2() {
+  constexpr uint64_t stream = CounterRng::streamID("CreateCaloCells.noiseTool");
+  static_assert(stream != CounterRng::streamID("CreateCaloCells.noiseTool2"));
+
+  CounterRng rng(123, stream, 1, 42);
+  CounterRng rng2(123, stream, 1, 42);
+  assert(rng.gauss(1000) == rng2.gauss(1000));
+  assert(rng.flat(1000, 3) == rng2.flat(1000, 3));
+
+  // Different event, run, seed, stream, block, or item give different numbers.
+  double g = rng.gauss(1000);
+  assert(CounterRng(123, stream, 1, 43).gauss(1000) != g);
+  assert(CounterRng(123, stream, 2, 42).gauss(1000) != g);
+  assert(CounterRng(124, stream, 1, 42).gauss(1000) != g);
+  assert(CounterRng(123, stream + 1, 1, 42).gauss(1000) != g);
+  assert(rng.gauss(1000, 1) != g);
+  assert(rng.gauss(1001) != g);
+  assert(rng.gauss(1000 + (1ULL << 32)) != g);
+
+  // Sequences are reproducible and differ from per-item draws.
+  auto seq = rng.sequence(1000);
+  auto seq2 = rng2.sequence(1000);
+  std::set<double> seen;
+  for (int i = 0; i < 100; i++) {
+    double u = seq();
+    assert(u == seq2());
+    assert(u > 0 && u < 1);
+    assert(seen.insert(u).second);
+  }
+  assert(!seen.contains(rng.flat(1000)));
+}
+
+// Batch versions give the same results as the scalar ones.
+void test3() {
+  CounterRng rng(5, CounterRng::streamID("test3"), 0, 7);
+  std::vector<uint64_t> items;
+  for (uint64_t i = 0; i < 1003; i++)
+    items.push_back(i * 0x9e3779b97f4a7c15ULL);
+
+  std::vector<double> out(items.size());
+  rng.gauss(items, out, 2);
+  for (size_t i = 0; i < items.size(); i++)
+    assert(out[i] == rng.gauss(items[i], 2));
+
+  rng.flat(items, out, 2);
+  for (size_t i = 0; i < items.size(); i++)
+    assert(out[i] == rng.flat(items[i], 2));
+
+  std::vector<double> blocks(37);
+  rng.gauss(items[5], blocks, 10);
+  for (size_t i = 0; i < blocks.size(); i++)
+    assert(blocks[i] == rng.gauss(items[5], 10 + i));
+}
+
+// Distribution moments.
+void test4() {
+  CounterRng rng(1, 2, 3, 4);
+  const size_t n = 1000000;
+  std::vector<uint64_t> items(n);
+  for (size_t i = 0; i < n; i++)
+    items[i] = i;
+  std::vector<double> g(n);
+  rng.gauss(items, g);
+  double sum = 0, sum2 = 0, sum4 = 0;
+  size_t n2 = 0;
+  for (double x : g) {
+    sum += x;
+    sum2 += x * x;
+    sum4 += x * x * x * x;
+    if (std::abs(x) > 2)
+      ++n2;
+  }
+  double mean = sum / n;
+  double var = sum2 / n - mean * mean;
+  assert(std::abs(mean) < 5 / std::sqrt(n));
+  assert(std::abs(var - 1) < 0.01);
+  assert(std::abs(sum4 / n - 3) < 0.05);
+  double expected = n * std::erfc(2 / std::sqrt(2.));
+  assert(std::abs(n2 - expected) < 5 * std::sqrt(expected));
+
+  std::vector<double> u(n);
+  rng.flat(items, u);
+  double usum = 0;
+  for (double x : u) {
+    assert(x > 0 && x < 1);
+    usum += x;
+  }
+  assert(std::abs(usum / n - 0.5) < 0.002);
+}
+
+// Sequences keyed by sub-item, and their Gaussian and Poisson deviates.
+void test5() {
+  CounterRng rng(9, CounterRng::streamID("test5"), 1, 2);
+
+  // Sub-item 0 is the plain sequence; other sub-items differ.
+  auto seq = rng.sequence(77);
+  auto seq0 = rng.sequence(77, 0);
+  auto seq1 = rng.sequence(77, 1);
+  auto seq2 = rng.sequence(77, 2);
+  for (int i = 0; i < 10; i++) {
+    double u = seq();
+    assert(u == seq0());
+    double u1 = seq1();
+    assert(u1 != u);
+    assert(seq2() != u1);
+  }
+
+  const int n = 200000;
+  double sum = 0, sum2 = 0;
+  for (int i = 0; i < n; i++) {
+    double x = rng.sequence(i, 3).gauss();
+    sum += x;
+    sum2 += x * x;
+  }
+  assert(std::abs(sum / n) < 5 / std::sqrt(n));
+  assert(std::abs(sum2 / n - 1) < 0.02);
+
+  for (double mean : {0.5, 3.0, 9.5}) {
+    double psum = 0, psum2 = 0;
+    auto pseq = rng.sequence(5, 4);
+    for (int i = 0; i < n; i++) {
+      double k = pseq.poisson(mean);
+      psum += k;
+      psum2 += k * k;
+    }
+    double pmean = psum / n;
+    assert(std::abs(pmean - mean) < 5 * std::sqrt(mean / n));
+    assert(std::abs((psum2 / n - pmean * pmean) / mean - 1) < 0.03);
+  }
+  assert(rng.sequence(6).poisson(0) == 0);
+}
+
+int main() {
+  test1();
+  test2();
+  test3();
+  test4();
+  test5();
+  return 0;
+}
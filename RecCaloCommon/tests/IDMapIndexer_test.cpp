@@ -63,6 +63,18 @@ void test1() {
   assert(map.index(0) == Indexer_t::INVALID);
   assert(map.index(ids[0] + 1) == Indexer_t::INVALID);
 
+  // Batch lookup, through the base interface.
+  std::vector<mapkey_t> batchIDs(ids.rbegin(), ids.rend());
+  batchIDs.push_back(0);
+  batchIDs.push_back(ids[0] + 1);
+  std::vector<Indexer_t::index_t> out(batchIDs.size());
+  static_cast<const k4::recCalo::ICaloIndexer&>(map).indices(batchIDs, out);
+  for (size_t i = 0; i < ncell; i++) {
+    assert(out[i] == ncell - 1 - i);
+  }
+  assert(out[ncell] == Indexer_t::INVALID);
+  assert(out[ncell + 1] == Indexer_t::INVALID);
+
   std::vector<mapkey_t> ids2(ids.begin(), ids.end());
   ids2[10] += 1;
   EXPECT_EXCEPTION(std::runtime_error, Indexer_t map2(4, 6, fieldDescs, ids2));
@@ -98,6 +110,12 @@ void test2() {
     assert(map.cellIDs()[i] == ids[i]);
     assert(map.index(ids[i]) == i);
   }
+
+  std::vector<Indexer_t::index_t> out(ncell);
+  map.indices(ids, out);
+  for (size_t i = 0; i < ncell; i++) {
+    assert(out[i] == i);
+  }
 }
 
 int main() {
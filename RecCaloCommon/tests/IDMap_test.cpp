@@ -69,6 +69,20 @@ void test1(mapkey_span ids) {
     assert(map.lookup(ids[i]) == i + 3);
   }
 
+  // Batch lookup, for both the variable and fixed number of fields.
+  using Map3_t = k4::recCalo::IDMapN<payload_t, 3>;
+  Map3_t map3(fielddescs, INVALID, ids, [](size_t i) { return i + 3; });
+  std::vector<payload_t> out(ids.size());
+  map.lookup(ids, out);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    assert(out[i] == i + 3);
+  }
+  std::ranges::fill(out, 0);
+  map3.lookup(ids, out);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    assert(out[i] == i + 3);
+  }
+
   // Test lookup failure for keys not in the input list.
   uint32_t seed = 1234;
   dd4hep::BitFieldCoder* decoder = desc.decoder();
@@ -78,6 +92,8 @@ void test1(mapkey_span ids) {
   unsigned nmodule = 1 << desc.field("module")->width();
   unsigned ntheta = 1 << desc.field("theta")->width();
   unsigned ntry = 0;
+  std::vector<mapkey_t> mixed;
+  std::vector<payload_t> expected;
   for (size_t i = 0; i < 1000; i++) {
     mapkey_t id = ids[0];
     decoder->set(id, layer_index, randi_seed(seed, ecalb_numLayers + 2));
@@ -86,9 +102,23 @@ void test1(mapkey_span ids) {
     if (!std::ranges::binary_search(ids, id)) {
       assert(map.lookup(id) == INVALID);
       ++ntry;
+      expected.push_back(INVALID);
+    } else {
+      expected.push_back(map.lookup(id));
     }
+    mixed.push_back(id);
   }
   assert(ntry > 0);
+
+  // Batch lookup of a mixture of valid and invalid keys,
+  // with a length that is not a multiple of the batch size.
+  out.assign(mixed.size(), 0);
+  map.lookup(mixed, out);
+  assert(out == expected);
+  std::ranges::fill(out, 0);
+  map3.lookup(mixed, out);
+  assert(out == expected);
+  map3.lookup(std::span<const mapkey_t>(), std::span<payload_t>());
 }
 
 //*******************************************************************
@@ -408,6 +438,74 @@ void Tester<LOOKUP>::test_rand(size_t n) {
   }
 }
 
+// Test jig for batch lookups.  For the random test, the keys are first
+// selected into a buffer, as a caller would have them in a hit collection.
+template <class LOOKUP>
+class BatchTester : public TesterBase {
+public:
+  BatchTester(const std::string& name, mapkey_span ids);
+  size_t test(size_t n);
+  void test_seq(size_t n);
+  void test_rand(size_t n);
+
+private:
+  static constexpr size_t CHUNK = 4096;
+  LOOKUP m_lookup;
+  std::vector<payload_t> m_out;
+};
+
+template <class LOOKUP>
+BatchTester<LOOKUP>::BatchTester(const std::string& name, mapkey_span ids) : TesterBase(name, ids), m_lookup(ids) {
+  m_byteSize = m_lookup.byteSize();
+}
+
+template <class LOOKUP>
+size_t BatchTester<LOOKUP>::test(size_t n) {
+  test_seq(n);
+  test_rand(n);
+  return 0;
+}
+
+template <class LOOKUP>
+void BatchTester<LOOKUP>::test_seq(size_t n) {
+  size_t sz = m_ids.size();
+  m_out.resize(sz);
+  auto timer = m_seq_timer.run();
+  for (size_t j = 0; j < n; ++j) {
+    m_lookup.lookup(m_ids, m_out);
+    for (size_t i = 0; i < sz; ++i) {
+      if (m_out[i] != i) [[unlikely]] {
+        std::cout << m_name << " seq " << i << " " << m_ids[i] << " " << m_out[i] << "\n";
+        std::abort();
+      }
+    }
+  }
+}
+
+template <class LOOKUP>
+void BatchTester<LOOKUP>::test_rand(size_t n) {
+  size_t sz = m_ids.size();
+  uint32_t seed = 1234;
+  std::vector<mapkey_t> keys(CHUNK);
+  std::vector<size_t> pos(CHUNK);
+  m_out.resize(CHUNK);
+  auto timer = m_rand_timer.run();
+  for (size_t i = 0; i < n * sz; i += CHUNK) {
+    size_t nchunk = std::min(CHUNK, n * sz - i);
+    for (size_t j = 0; j < nchunk; j++) {
+      pos[j] = randi_seed(seed, sz - 1);
+      keys[j] = m_ids[pos[j]];
+    }
+    m_lookup.lookup(mapkey_span(keys.data(), nchunk), m_out);
+    for (size_t j = 0; j < nchunk; j++) {
+      if (m_out[j] != pos[j]) [[unlikely]] {
+        std::cout << m_name << " rand " << pos[j] << " " << keys[j] << " " << m_out[j] << "\n";
+        std::abort();
+      }
+    }
+  }
+}
+
 template <class TESTER>
 size_t dotest(const char* name, mapkey_span ids, size_t n) {
   TESTER t(name, ids);
@@ -426,9 +524,13 @@ size_t perftest(bool barrel, mapkey_span ids, size_t n) {
   if (barrel) {
     ret += dotest<Tester<IDMapLookupB<IDMap_t>>>("IDMapB", ids, n);
     ret += dotest<Tester<IDMapLookupB<IDMap3_t>>>("IDMapB3", ids, n);
+    ret += dotest<BatchTester<IDMapLookupB<IDMap_t>>>("IDMapB batch", ids, n);
+    ret += dotest<BatchTester<IDMapLookupB<IDMap3_t>>>("IDMapB3 batch", ids, n);
   } else {
     ret += dotest<Tester<IDMapLookupE<IDMap_t>>>("IDMapE", ids, n);
     ret += dotest<Tester<IDMapLookupE<IDMap4_t>>>("IDMapE4", ids, n);
+    ret += dotest<BatchTester<IDMapLookupE<IDMap_t>>>("IDMapE batch", ids, n);
+    ret += dotest<BatchTester<IDMapLookupE<IDMap4_t>>>("IDMapE4 batch", ids, n);
   }
   ret += dotest<Tester<MapLookup>>("std::map", ids, n);
   ret += dotest<Tester<UOMapLookup>>("std::unordered_map", ids, n);
@@ -0,0 +1,78 @@
+/**
+ * @file RecCaloCommon/tests/IndexedNoiseTable_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for IndexedNoiseTable.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/IndexedNoiseTable.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using k4::recCalo::ICaloIndexer;
+using k4::recCalo::IndexedNoiseTable;
+
+// Simple indexer over a list of IDs.
+class TestIndexer : public ICaloIndexer {
+public:
+  TestIndexer(const std::vector<mapkey_t>& ids) : m_ids(ids) {}
+  virtual index_t index(CellID id) const override {
+    auto it = std::ranges::find(m_ids, id);
+    return it == m_ids.end() ? INVALID : it - m_ids.begin();
+  }
+  virtual std::span<const CellID> cellIDs() const override { return m_ids; }
+  virtual std::span<const int> detIDs() const override { return {}; }
+  virtual size_t detIDBits() const override { return 0; }
+
+private:
+  const std::vector<mapkey_t>& m_ids;
+};
+
+void test1() {
+  std::vector<mapkey_t> ids;
+  for (mapkey_t i = 0; i < 1000; i++)
+    ids.push_back((i * 7919) % 1000 + 10);
+  TestIndexer indexer(ids);
+
+  size_t ncall = 0;
+  IndexedNoiseTable table(indexer, [&](mapkey_t id) {
+    ++ncall;
+    return std::make_pair(id * 0.5, id * 0.25);
+  });
+  assert(ncall == ids.size());
+  assert(table.size() == ids.size());
+  assert(table.noiseRMS().size() == ids.size());
+  assert(table.noiseOffset().size() == ids.size());
+
+  for (mapkey_t id : ids) {
+    auto ndx = indexer.index(id);
+    assert(table.noiseRMS(ndx) == static_cast<float>(id * 0.5));
+    assert(table.noiseOffset(ndx) == static_cast<float>(id * 0.25));
+    auto [rms, offset] = table.noise(ndx);
+    assert(rms == table.noiseRMS(ndx));
+    assert(offset == table.noiseOffset(ndx));
+  }
+
+  // Same list of IDs.
+  assert(table.matches(indexer));
+
+  // Equal, but separate, list of IDs.
+  std::vector<mapkey_t> ids2 = ids;
+  assert(table.matches(TestIndexer(ids2)));
+
+  // Different order.
+  std::swap(ids2[0], ids2[1]);
+  assert(!table.matches(TestIndexer(ids2)));
+
+  // Different size.
+  ids2 = ids;
+  ids2.pop_back();
+  assert(!table.matches(TestIndexer(ids2)));
+}
+
+int main() {
+  test1();
+  return 0;
+}
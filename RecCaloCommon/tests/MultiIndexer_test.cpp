@@ -11,6 +11,7 @@
 #include "RecCaloCommon/IDMapIndexer.h"
 #include "RecCaloCommon/MultiIndexer.h"
 #include <algorithm>
+#include <cassert>
 #include <vector>
 
 using mapkey_t = uint64_t; // libc defines key_t...
@@ -91,6 +92,21 @@ void test1(mapkey_span ecalb_ids, mapkey_span hcalb_ids) {
   }
   assert(map.index(0) == Indexer_t::INVALID);
 
+  // Batch lookup, with the detectors both in runs and interleaved,
+  // plus an unknown detector.
+  std::vector<uint64_t> batchIDs(cell_ids.begin(), cell_ids.end());
+  for (size_t i = 0; i < 1000; i++) {
+    batchIDs.push_back(cell_ids[i]);
+    batchIDs.push_back(cell_ids[ncell - 1 - i]);
+  }
+  batchIDs.push_back(0);
+  std::vector<k4::recCalo::ICaloIndexer::index_t> out(batchIDs.size());
+  map.indices(batchIDs, out);
+  for (size_t i = 0; i < batchIDs.size(); i++) {
+    assert(out[i] == map.index(batchIDs[i]));
+  }
+  assert(out.back() == Indexer_t::INVALID);
+
   //***************************************************
   // Testing for errors during construction.
   using MultiIndexerException = k4::recCalo::MultiIndexer::MultiIndexerException;
@@ -0,0 +1,205 @@
+/**
+ * @file RecCaloCommon/tests/NeighbourTable_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for NeighbourTable.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/NeighbourTable.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using Table = k4::recCalo::NeighbourTable;
+using k4::recCalo::ICaloIndexer;
+
+//************************************************************************
+
+// Simple indexer over a list of IDs.
+class TestIndexer : public ICaloIndexer {
+public:
+  TestIndexer(const std::vector<mapkey_t>& ids) : m_ids(ids) {}
+  virtual index_t index(CellID id) const override {
+    auto it = std::ranges::find(m_ids, id);
+    return it == m_ids.end() ? INVALID : it - m_ids.begin();
+  }
+  virtual std::span<const CellID> cellIDs() const override { return m_ids; }
+  virtual std::span<const int> detIDs() const override { return {}; }
+  virtual size_t detIDBits() const override { return 0; }
+
+private:
+  const std::vector<mapkey_t>& m_ids;
+};
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+void test1() {
+  // Small hand-made table.  Neighbour 70 is not itself a cell,
+  // and cell 10 appears twice; the second entry is ignored.
+  std::vector<mapkey_t> cells{30, 10, 20, 10};
+  std::vector<uint64_t> offsets{0, 2, 4, 4, 5};
+  std::vector<mapkey_t> nbrs{20, 10, 30, 70, 99};
+  Table table(cells, offsets, nbrs);
+
+  assert(table.size() == 5);
+  assert(table.nEntries() == 4);
+  assert((std::vector<mapkey_t>(table.cellIDs().begin(), table.cellIDs().end()) ==
+          std::vector<mapkey_t>{10, 20, 30, 70, 99}));
+  assert(table.index(10) == 0);
+  assert(table.index(70) == 3);
+  assert(table.index(15) == Table::INVALID);
+
+  // Order of neighbours is preserved.
+  auto n30 = table.neighbours(table.index(30));
+  assert(n30.size() == 2);
+  assert(n30[0] == table.index(20));
+  assert(n30[1] == table.index(10));
+  assert(table.neighbours(table.index(20)).empty());
+  assert(table.neighbours(table.index(70)).empty());
+  assert(table.neighbours(table.index(99)).empty());
+
+  std::vector<mapkey_t> out{1, 2};
+  table.neighbourIDs(10, out);
+  assert((out == std::vector<mapkey_t>{30, 70}));
+  table.neighbourIDs(15, out);
+  assert(out.empty());
+
+  // Inconsistent input.
+  bool caught = false;
+  try {
+    std::vector<uint64_t> badOffsets{0, 2, 4, 4};
+    Table bad(cells, badOffsets, nbrs);
+  } catch (const Table::NeighbourTableException&) {
+    caught = true;
+  }
+  assert(caught);
+}
+
+// Compare with a map-based table on random input.
+void test2() {
+  std::map<mapkey_t, std::vector<mapkey_t>> ref;
+  std::vector<mapkey_t> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<mapkey_t> nbrs;
+  uint32_t seed = 4321;
+  for (int i = 0; i < 5000; i++) {
+    mapkey_t id = (static_cast<mapkey_t>(rng_seed(seed)) << 20) | 5;
+    std::vector<mapkey_t> v;
+    unsigned n = rng_seed(seed) % 12;
+    for (unsigned j = 0; j < n; j++)
+      v.push_back((static_cast<mapkey_t>(rng_seed(seed) % 100000) << 20) | 5);
+    cells.push_back(id);
+    nbrs.insert(nbrs.end(), v.begin(), v.end());
+    offsets.push_back(nbrs.size());
+    ref.emplace(id, v);
+  }
+  Table table(cells, offsets, nbrs);
+
+  std::vector<mapkey_t> out;
+  for (const auto& [id, v] : ref) {
+    table.neighbourIDs(id, out);
+    assert(out == v);
+  }
+  for (size_t i = 0; i + 1 < table.size(); i++)
+    assert(table.cellIDs()[i] < table.cellIDs()[i + 1]);
+}
+
+// Re-indexing to follow an indexer.
+void test3() {
+  std::vector<mapkey_t> cells{30, 10, 20};
+  std::vector<uint64_t> offsets{0, 2, 4, 4};
+  std::vector<mapkey_t> nbrs{20, 10, 30, 70};
+  Table table(cells, offsets, nbrs);
+
+  // The indexer knows 40, which is not in the table, but not 10 or 70.
+  std::vector<mapkey_t> ids{40, 30, 20};
+  TestIndexer indexer(ids);
+  assert(!table.matches(indexer));
+  Table itable(indexer, table);
+  assert(itable.matches(indexer));
+  assert(!itable.matches(TestIndexer(cells)));
+  assert(itable.size() == 5);
+  assert(itable.nEntries() == table.nEntries());
+  for (size_t i = 0; i < ids.size(); i++) {
+    assert(itable.cellIDs()[i] == ids[i]);
+    assert(itable.index(ids[i]) == i);
+  }
+  assert(itable.index(10) >= ids.size());
+  assert(itable.index(70) >= ids.size());
+  assert(itable.index(15) == Table::INVALID);
+
+  // Neighbour indices are those of the indexer, where known.
+  assert(itable.neighbours(indexer.index(40)).empty());
+  auto n30 = itable.neighbours(indexer.index(30));
+  assert(n30.size() == 2);
+  assert(n30[0] == indexer.index(20));
+  assert(n30[1] == itable.index(10));
+
+  // Lookups by ID are unchanged.
+  std::vector<mapkey_t> out, iout;
+  for (mapkey_t id : {10, 20, 30, 40, 70, 15}) {
+    table.neighbourIDs(id, out);
+    itable.neighbourIDs(id, iout);
+    assert(out == iout);
+  }
+
+  // Re-indexed tables cannot be written.
+  bool caught = false;
+  try {
+    itable.writeMapFile("NeighbourTable_test.map");
+  } catch (const Table::NeighbourTableException&) {
+    caught = true;
+  }
+  assert(caught);
+}
+
+// Structural checks of existing arrays.
+void test4() {
+  auto make = [](std::vector<mapkey_t> ids, std::vector<uint32_t> offsets, std::vector<Table::index_t> nbrs) {
+    auto storage = std::make_shared<std::tuple<std::vector<mapkey_t>, std::vector<uint32_t>,
+                                               std::vector<Table::index_t>>>(ids, offsets, nbrs);
+    return Table(storage, std::get<0>(*storage), std::get<1>(*storage), std::get<2>(*storage));
+  };
+  auto fails = [&](std::vector<mapkey_t> ids, std::vector<uint32_t> offsets, std::vector<Table::index_t> nbrs) {
+    try {
+      make(ids, offsets, nbrs);
+    } catch (const Table::NeighbourTableException&) {
+      return true;
+    }
+    return false;
+  };
+
+  Table table = make({10, 20, 30}, {0, 2, 2, 3}, {1, 2, 0});
+  assert(table.size() == 3);
+  assert(table.neighbours(table.index(10)).size() == 2);
+  assert(table.neighbours(table.index(20)).empty());
+
+  // Inconsistent sizes.
+  assert(fails({10, 20, 30}, {0, 2, 3}, {1, 2, 0}));
+  assert(fails({10, 20, 30}, {0, 2, 2, 4}, {1, 2, 0}));
+  // Decreasing offsets.
+  assert(fails({10, 20, 30}, {0, 3, 2, 3}, {1, 2, 0}));
+  // Unsorted or duplicate cell IDs.
+  assert(fails({10, 30, 20}, {0, 2, 2, 3}, {1, 2, 0}));
+  assert(fails({10, 20, 20}, {0, 2, 2, 3}, {1, 2, 0}));
+  // Neighbour index out of range.
+  assert(fails({10, 20, 30}, {0, 2, 2, 3}, {1, 3, 0}));
+  assert(fails({10, 20, 30}, {0, 2, 2, 3}, {1, Table::INVALID, 0}));
+}
+
+int main() {
+  test1();
+  test2();
+  test3();
+  test4();
+  return 0;
+}
@@ -0,0 +1,431 @@
+/**
+ * @file RecCaloCommon/tests/PulseProcessing_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for the pulse processing kernels.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/PulseProcessing.h"
+#include "boost/timer/timer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using k4::recCalo::PulsePeak;
+
+// Reference: CaloDigitizerFunc::Hit2DigitFloat.
+std::vector<float> refHit2Digit(float Energy, float time, float dt, const std::vector<float>& pulseShape,
+                                const std::vector<float>& pulseShapeDeriv) {
+  std::vector<float> DigitVector(pulseShape.size(), 0.0f);
+  for (unsigned int i = 0; i < DigitVector.size(); ++i) {
+    int j = i - std::rint(time / dt);
+    if (j >= 0) {
+      float DeltaT = time - dt * std::rint(time / dt);
+      DigitVector[i] = Energy * (pulseShape[j] - DeltaT * pulseShapeDeriv[j]);
+    }
+  }
+  return DigitVector;
+}
+
+// Reference: CaloFilterFunc::ConvolveSame.
+std::vector<float> refConvolveSame(const std::vector<float>& pulse, const std::vector<float>& filter) {
+  int n = pulse.size();
+  int m = filter.size();
+  int start = (m - 1) / 2;
+  std::vector<float> result(n + m - 1, 0.0);
+  for (size_t i = 0; i < pulse.size(); ++i)
+    for (size_t j = 0; j < filter.size(); ++j)
+      result[i + j] += pulse[i] * filter[j];
+  return std::vector<float>(result.begin() + start, result.begin() + start + n);
+}
+
+float gaussian(float x, float mu, float sigma) {
+  return (1.0 / (sigma * sqrt(2 * M_PI))) * exp(-0.5 * pow((x - mu) / sigma, 2));
+}
+
+// Pulse synthesis.
+void test1() {
+  const int n = 31;
+  const float dt = 25;
+  std::vector<float> shape, deriv;
+  for (int i = 0; i < n; i++) {
+    shape.push_back(gaussian(i * dt, 100, 20));
+    deriv.push_back(-(i * dt - 100) / (20 * 20) * shape.back());
+  }
+
+  const float hits[][2] = {{1.5, 0.3}, {0.25, 12.6}, {2, 100.1}, {0.1, 700}, {3, 2000}, {1, -30}, {1, -1e6}};
+  std::vector<float> pulse(n, 0), ref(n, 0);
+  for (auto [e, t] : hits) {
+    k4::recCalo::addPulseContribution(pulse, e, t, dt, shape, deriv);
+    if (t >= 0) {
+      std::vector<float> d = refHit2Digit(e, t, dt, shape, deriv);
+      for (int i = 0; i < n; i++)
+        ref[i] += d[i];
+    }
+  }
+  // The reference reads past the shape for negative times; the kernel
+  // adds the part of the shape that falls in the window.
+  std::vector<float> neg(n, 0);
+  k4::recCalo::addPulseContribution(neg, 1, -30, dt, shape, deriv);
+  for (int i = 0; i < n; i++) {
+    float delta = -30 - dt * -1;
+    assert(neg[i] == (i + 1 < n ? shape[i + 1] - delta * deriv[i + 1] : 0));
+    ref[i] += neg[i];
+  }
+  for (int i = 0; i < n; i++)
+    assert(std::abs(pulse[i] - ref[i]) <= 1e-6f * std::abs(ref[i]));
+
+  // NaN time is ignored.
+  std::vector<float> pulse2 = pulse;
+  k4::recCalo::addPulseContribution(pulse2, 1, NAN, dt, shape, deriv);
+  assert(pulse2 == pulse);
+}
+
+// Whitening.
+void test2() {
+  const size_t n = 7;
+  std::vector<float> pulse;
+  std::vector<double> mean, w;
+  for (size_t i = 0; i < n; i++) {
+    pulse.push_back(0.5 + 0.1 * i);
+    mean.push_back(0.01 * i);
+  }
+  for (size_t i = 0; i < n * n; i++)
+    w.push_back(std::sin(i + 1.));
+  std::vector<float> out(n);
+  k4::recCalo::whitenPulse(pulse, mean, w, out);
+  for (size_t i = 0; i < n; i++) {
+    double sum = 0;
+    for (size_t j = 0; j < n; j++)
+      sum += w[i * n + j] * (pulse[j] - mean[j]);
+    assert(std::abs(out[i] - sum) <= 1e-6 * std::abs(sum));
+  }
+}
+
+// Batched whitening.
+void test2b() {
+  for (size_t n : {1, 7, 31}) {
+    const size_t nCells = 150;
+    std::vector<float> pulses;
+    for (size_t c = 0; c < nCells; c++)
+      for (size_t i = 0; i < n; i++)
+        pulses.push_back(std::cos(0.3 * i + 0.1 * c) + 1);
+    std::vector<double> mean, w;
+    std::vector<float> meanf, wf;
+    for (size_t i = 0; i < n; i++) {
+      mean.push_back(0.9 + 0.01 * i);
+      meanf.push_back(mean.back());
+    }
+    for (size_t i = 0; i < n * n; i++) {
+      wf.push_back((i % (n + 1) == 0 ? 1 : 0) + 0.1 * std::sin(i + 1.));
+      w.push_back(wf.back());
+    }
+
+    std::vector<float> out(pulses.size());
+    k4::recCalo::whitenPulseBatch(pulses, n, meanf, wf, out);
+    for (size_t c = 0; c < nCells; c++) {
+      std::vector<float> ref(n);
+      k4::recCalo::whitenPulse(std::span(pulses.data() + c * n, n), mean, w, ref);
+      for (size_t i = 0; i < n; i++)
+        assert(std::abs(out[c * n + i] - ref[i]) <= 1e-5f * (1 + std::abs(ref[i])));
+    }
+  }
+  k4::recCalo::whitenPulseBatch({}, 0, {}, {}, {});
+}
+
+// Matched filter.
+void test3() {
+  std::vector<float> pulse;
+  for (int i = 0; i < 31; i++)
+    pulse.push_back(std::cos(0.3 * i) + 0.01 * i);
+  for (int m : {1, 4, 5, 9}) {
+    std::vector<float> filter;
+    for (int j = 0; j < m; j++)
+      filter.push_back(0.2 * (j + 1));
+    std::vector<float> ref = refConvolveSame(pulse, filter);
+    std::vector<float> out(pulse.size());
+    PulsePeak peak = k4::recCalo::matchedFilter(pulse, filter, out);
+    for (size_t i = 0; i < ref.size(); i++)
+      assert(std::abs(out[i] - ref[i]) <= 1e-6f * (1 + std::abs(ref[i])));
+    auto it = std::max_element(out.begin(), out.end());
+    assert(peak.index == std::distance(out.begin(), it));
+    assert(peak.energy == *it);
+
+    PulsePeak peak2 = k4::recCalo::matchedFilter(pulse, filter, {});
+    assert(peak2.index == peak.index && peak2.energy == peak.energy);
+  }
+
+  // First maximum wins.
+  std::vector<float> flat(5, 1.0f);
+  std::vector<float> one{1.0f};
+  PulsePeak peak = k4::recCalo::matchedFilter(flat, one, {});
+  assert(peak.index == 0 && peak.energy == 1);
+}
+
+// Batched matched filter.
+void test4() {
+  const size_t n = 31;
+  const size_t nCells = 37;
+  std::vector<float> pulses;
+  for (size_t c = 0; c < nCells; c++)
+    for (size_t i = 0; i < n; i++)
+      pulses.push_back(std::cos(0.3 * i + 0.1 * c) + 0.01 * c);
+  for (int m : {1, 4, 5, 9}) {
+    std::vector<float> filter;
+    for (int j = 0; j < m; j++)
+      filter.push_back(0.2 * (j + 1) - 0.3);
+    std::vector<float> out(pulses.size());
+    std::vector<PulsePeak> peaks(nCells);
+    k4::recCalo::matchedFilterBatch(pulses, n, filter, peaks, out);
+    std::vector<PulsePeak> peaks2(nCells);
+    k4::recCalo::matchedFilterBatch(pulses, n, filter, peaks2, {});
+    for (size_t c = 0; c < nCells; c++) {
+      std::span<const float> pulse(pulses.data() + c * n, n);
+      std::vector<float> ref(n);
+      PulsePeak peak = k4::recCalo::matchedFilter(pulse, filter, ref);
+      for (size_t i = 0; i < n; i++)
+        assert(std::abs(out[c * n + i] - ref[i]) <= 1e-6f * (1 + std::abs(ref[i])));
+      assert(std::abs(peaks[c].energy - peak.energy) <= 1e-6f * (1 + std::abs(peak.energy)));
+      assert(out[c * n + peaks[c].index] == peaks[c].energy);
+      assert(peaks2[c].index == peaks[c].index && peaks2[c].energy == peaks[c].energy);
+    }
+  }
+
+  // No pulses, or an empty filter.
+  std::vector<PulsePeak> none;
+  k4::recCalo::matchedFilterBatch({}, n, std::vector<float>{1}, none, {});
+  std::vector<PulsePeak> peaks(2);
+  k4::recCalo::matchedFilterBatch(std::span(pulses.data(), 2 * n), n, {}, peaks, {});
+  assert(peaks[0].index == -1 && peaks[1].index == -1);
+  peaks[0].index = 3;
+  k4::recCalo::matchedFilterBatch({}, 0, std::vector<float>{1}, peaks, {});
+  assert(peaks[0].index == -1 && peaks[1].index == -1);
+}
+
+// Reference: the triple loop that CaloAddNoise2Digits used.
+void refCovariance(const std::vector<double>& data, size_t nObs, size_t n, std::vector<double>& mean,
+                   std::vector<double>& cov) {
+  for (size_t j = 0; j < n; j++) {
+    double sum = 0;
+    for (size_t i = 0; i < nObs; i++)
+      sum += data[i * n + j];
+    mean[j] = sum / nObs;
+  }
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = i; j < n; j++) {
+      double sum = 0;
+      for (size_t k = 0; k < nObs; k++)
+        sum += (data[k * n + i] - mean[i]) * (data[k * n + j] - mean[j]);
+      cov[i * n + j] = cov[j * n + i] = sum / (nObs - 1);
+    }
+  }
+}
+
+// Sample covariance.
+void test5() {
+  const size_t n = 7;
+  for (size_t nObs : {2, 63, 64, 200}) {
+    std::vector<double> data;
+    for (size_t k = 0; k < nObs; k++)
+      for (size_t i = 0; i < n; i++)
+        data.push_back(0.1 + std::sin(1.3 * k + 0.7 * i * i) + 0.5 * std::cos(2.1 * k + i));
+    std::vector<double> mean(n), cov(n * n), refMean(n), refCov(n * n);
+    k4::recCalo::sampleCovariance(data, n, mean, cov);
+    refCovariance(data, nObs, n, refMean, refCov);
+    for (size_t i = 0; i < n; i++)
+      assert(std::abs(mean[i] - refMean[i]) <= 1e-14);
+    for (size_t i = 0; i < n * n; i++)
+      assert(std::abs(cov[i] - refCov[i]) <= 1e-12 * (1 + std::abs(refCov[i])));
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        assert(cov[i * n + j] == cov[j * n + i]);
+  }
+
+  // No variables.
+  std::vector<double> none;
+  k4::recCalo::sampleCovariance(none, 0, none, none);
+}
+
+// Optimal filtering coefficients.
+void test6() {
+  const size_t n = 5;
+  std::vector<double> g, dg;
+  for (size_t i = 0; i < n; i++) {
+    const double t = (i + 2.0) * 25 - 100;
+    g.push_back(std::exp(-0.5 * t * t / 400));
+    dg.push_back(-t / 400 * g.back());
+  }
+
+  // White noise, and noise with a diagonal covariance.
+  for (double corr : {0.0, 1.0}) {
+    std::vector<double> invCov(n * n, 0);
+    for (size_t i = 0; i < n; i++)
+      invCov[i * n + i] = 1 + corr * i;
+    std::vector<double> a(n), b(n);
+    assert(k4::recCalo::optimalFilterCoefficients(g, dg, invCov, a, b));
+
+    double ag = 0, adg = 0, bg = 0, bdg = 0;
+    for (size_t i = 0; i < n; i++) {
+      ag += a[i] * g[i];
+      adg += a[i] * dg[i];
+      bg += b[i] * g[i];
+      bdg += b[i] * dg[i];
+    }
+    assert(std::abs(ag - 1) < 1e-12 && std::abs(adg) < 1e-12);
+    assert(std::abs(bg) < 1e-12 && std::abs(bdg + 1) < 1e-12);
+
+    // A pulse of amplitude 3 shifted by 0.5 ns, to first order.
+    double e = 0, et = 0;
+    for (size_t i = 0; i < n; i++) {
+      const double s = 3 * (g[i] - 0.5 * dg[i]);
+      e += a[i] * s;
+      et += b[i] * s;
+    }
+    assert(std::abs(e - 3) < 1e-12 && std::abs(et / e - 0.5) < 1e-12);
+  }
+
+  // Degenerate shapes leave the outputs alone.
+  std::vector<double> identity(n * n, 0);
+  for (size_t i = 0; i < n; i++)
+    identity[i * n + i] = 1;
+  std::vector<double> a(n, 7), b(n, 7);
+  assert(!k4::recCalo::optimalFilterCoefficients(g, g, identity, a, b));
+  assert(a[0] == 7 && b[0] == 7);
+}
+
+// Timing of the matched filter: the per-pulse path that CaloFilterFunc
+// used (copy and reverse the template, full convolution, two max_element)
+// against the batched kernel.
+void perftest(size_t nCells, size_t nIter) {
+  const size_t n = 31;
+  std::vector<float> filter{0.1, 0.5, 1.0, 0.5, 0.1};
+  std::vector<std::vector<float>> pulseVecs(nCells);
+  std::vector<float> pulses;
+  for (size_t c = 0; c < nCells; c++) {
+    for (size_t i = 0; i < n; i++)
+      pulseVecs[c].push_back(std::sin(0.2 * i + 0.01 * c));
+    pulses.insert(pulses.end(), pulseVecs[c].begin(), pulseVecs[c].end());
+  }
+
+  double sum1 = 0;
+  boost::timer::cpu_timer timer;
+  for (size_t it = 0; it < nIter; it++) {
+    for (const auto& pulse : pulseVecs) {
+      std::vector<float> rev = filter;
+      std::reverse(rev.begin(), rev.end());
+      std::vector<float> out = refConvolveSame(pulse, rev);
+      auto maxIdx = std::distance(out.begin(), std::max_element(out.begin(), out.end()));
+      sum1 += *std::max_element(out.begin(), out.end()) + maxIdx;
+    }
+  }
+  timer.stop();
+  std::cout << "per pulse: " << timer.format(3);
+
+  std::vector<float> rev(filter.rbegin(), filter.rend());
+  std::vector<float> out(pulses.size());
+  std::vector<PulsePeak> peaks(nCells);
+  double sum2 = 0;
+  timer.start();
+  for (size_t it = 0; it < nIter; it++) {
+    k4::recCalo::matchedFilterBatch(pulses, n, rev, peaks, out);
+    for (const PulsePeak& p : peaks)
+      sum2 += p.energy + p.index;
+  }
+  timer.stop();
+  std::cout << "batch:     " << timer.format(3);
+
+  timer.start();
+  for (size_t it = 0; it < nIter; it++) {
+    k4::recCalo::matchedFilterBatch(pulses, n, rev, peaks, {});
+    for (const PulsePeak& p : peaks)
+      sum2 += p.energy + p.index;
+  }
+  timer.stop();
+  std::cout << "batch, peaks only: " << timer.format(3);
+  std::cout << sum1 << " " << sum2 / 2 << "\n";
+}
+
+// Timing of the whitening: one pulse at a time in double precision
+// (as CaloWhitening did, less the ROOT vector allocations) against
+// the batched kernel.
+void perftestWhitening(size_t nCells, size_t nIter) {
+  const size_t n = 31;
+  std::vector<float> pulses;
+  for (size_t c = 0; c < nCells; c++)
+    for (size_t i = 0; i < n; i++)
+      pulses.push_back(std::sin(0.2 * i + 0.01 * c));
+  std::vector<double> mean(n, 0.1), w(n * n);
+  std::vector<float> meanf(n, 0.1), wf(n * n);
+  for (size_t i = 0; i < n * n; i++) {
+    w[i] = std::cos(i + 0.5);
+    wf[i] = w[i];
+  }
+  std::vector<float> out(pulses.size());
+
+  boost::timer::cpu_timer timer;
+  for (size_t it = 0; it < nIter; it++) {
+    for (size_t c = 0; c < nCells; c++)
+      k4::recCalo::whitenPulse(std::span(pulses.data() + c * n, n), mean, w, std::span(out.data() + c * n, n));
+  }
+  timer.stop();
+  std::cout << "whitening per pulse: " << timer.format(3);
+  double sum1 = std::accumulate(out.begin(), out.end(), 0.0);
+
+  timer.start();
+  for (size_t it = 0; it < nIter; it++)
+    k4::recCalo::whitenPulseBatch(pulses, n, meanf, wf, out);
+  timer.stop();
+  std::cout << "whitening batch:     " << timer.format(3);
+  std::cout << sum1 << " " << std::accumulate(out.begin(), out.end(), 0.0) << "\n";
+}
+
+// Timing of the noise covariance, for the default noise simulation
+// of CaloAddNoise2Digits.
+void perftestCovariance(size_t nIter) {
+  const size_t n = 30;
+  const size_t nObs = 1000;
+  std::vector<double> data;
+  for (size_t k = 0; k < nObs; k++)
+    for (size_t i = 0; i < n; i++)
+      data.push_back(std::sin(1.3 * k + 0.7 * i));
+  std::vector<double> mean(n), cov(n * n);
+
+  boost::timer::cpu_timer timer;
+  for (size_t it = 0; it < nIter; it++)
+    refCovariance(data, nObs, n, mean, cov);
+  timer.stop();
+  std::cout << "covariance, triple loop: " << timer.format(3);
+  double sum1 = std::accumulate(cov.begin(), cov.end(), 0.0);
+
+  timer.start();
+  for (size_t it = 0; it < nIter; it++)
+    k4::recCalo::sampleCovariance(data, n, mean, cov);
+  timer.stop();
+  std::cout << "covariance, kernel:      " << timer.format(3);
+  std::cout << sum1 << " " << std::accumulate(cov.begin(), cov.end(), 0.0) << "\n";
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && std::string(argv[1]) == "--perf") {
+    size_t n = argc >= 3 ? atoi(argv[2]) : 0;
+    if (n == 0)
+      n = 100;
+    perftest(100000, n);
+    perftestWhitening(100000, n);
+    perftestCovariance(n);
+    return 0;
+  }
+  test1();
+  test2();
+  test2b();
+  test3();
+  test4();
+  test5();
+  test6();
+  return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file RecCaloCommon/tests/PulseShapeLibrary_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for PulseShapeLibrary.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/PulseShapeLibrary.h"
+#include "RecCaloCommon/PulseProcessing.h"
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using k4::recCalo::GaussianPulseShape;
+using k4::recCalo::PulseShapeLibrary;
+
+const size_t n = 31;
+const float dt = 25;
+
+// Table contents.
+void test1() {
+  GaussianPulseShape shape{100, 20};
+  PulseShapeLibrary lib(shape, n, dt, 8);
+  assert(lib.nSamples() == n);
+  assert(lib.nPhases() == 8);
+  for (size_t p = 0; p < 8; p++) {
+    auto row = lib.shape(p);
+    assert(row.size() == n);
+    for (size_t j = 0; j < n; j++) {
+      if (j == 0 && p > 4)
+        assert(row[j] == 0);
+      else
+        assert(row[j] == shape((j - p / 8.) * dt));
+    }
+  }
+
+  // At least one phase.
+  PulseShapeLibrary lib0(shape, n, dt, 0);
+  assert(lib0.nPhases() == 1);
+}
+
+// Adding deposits.
+void test2() {
+  GaussianPulseShape shape{100, 20};
+  PulseShapeLibrary lib(shape, n, dt, 10);
+
+  // Times on the phase grid give the exact shape, from the nearest sample on.
+  for (float t : {0.f, 2.5f, 10.f, 15.f, 100.f, 617.5f, 750.f}) {
+    std::vector<float> pulse(n, 0);
+    lib.add(pulse, 2, t);
+    long first = std::lround(t / dt - 0.01);
+    for (long i = 0; i < (long)n; i++) {
+      float expected = i >= first ? 2 * shape(i * dt - t) : 0;
+      assert(std::abs(pulse[i] - expected) <= 1e-6f * (1 + std::abs(expected)));
+    }
+  }
+
+  // Agrees with the first-order correction for deposits close to a sample.
+  std::vector<float> deriv, samples;
+  for (size_t i = 0; i < n; i++) {
+    samples.push_back(shape(i * dt));
+    deriv.push_back(-(i * dt - 100) / (20 * 20) * samples.back());
+  }
+  PulseShapeLibrary fine(shape, n, dt, 256);
+  for (float t : {0.3f, 24.6f, 100.1f, 350.2f}) {
+    std::vector<float> p1(n, 0), p2(n, 0);
+    fine.add(p1, 1, t);
+    k4::recCalo::addPulseContribution(p2, 1, t, dt, samples, deriv);
+    for (size_t i = 0; i < n; i++)
+      assert(std::abs(p1[i] - p2[i]) < 1e-5);
+  }
+
+  // Deposits are added to what is there; out-of-range times add nothing
+  // or only the part of the pulse in the window.
+  std::vector<float> pulse(n, 1);
+  lib.add(pulse, 1, 1e6);
+  lib.add(pulse, 1, -1e6);
+  lib.add(pulse, 1, NAN);
+  lib.add(pulse, 1, INFINITY);
+  for (float x : pulse)
+    assert(x == 1);
+  lib.add(pulse, 1, -2 * dt);
+  for (size_t i = 0; i < n; i++) {
+    float expected = 1 + (i + 2 < n ? shape((i + 2) * dt) : 0);
+    assert(std::abs(pulse[i] - expected) <= 1e-6f);
+  }
+
+  // A shorter pulse buffer.
+  std::vector<float> shortPulse(5, 0);
+  lib.add(shortPulse, 1, 0);
+  for (size_t i = 0; i < 5; i++)
+    assert(shortPulse[i] == shape(i * dt));
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
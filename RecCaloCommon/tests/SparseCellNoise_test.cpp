@@ -0,0 +1,116 @@
+/**
+ * @file RecCaloCommon/tests/SparseCellNoise_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for SparseCellNoise.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/SparseCellNoise.h"
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+using k4::recCalo::SparseCellNoise;
+
+// Check that a count is consistent with a Poisson expectation.
+void checkCount(double count, double expected) { assert(std::abs(count - expected) < 5 * std::sqrt(expected) + 1); }
+
+void test1(bool useAbs) {
+  const double threshold = 2;
+  std::vector<mapkey_t> cells;
+  std::vector<double> rms;
+  for (mapkey_t i = 0; i < 400000; i++) {
+    cells.push_back(i << 4);
+    rms.push_back(i < 100000 ? 2 : (i < 399990 ? 0.5 : 0));
+  }
+  SparseCellNoise noise(cells, rms, threshold, useAbs);
+  assert(noise.size() == cells.size());
+  assert(noise.nClasses() == 3);
+
+  double prob = 0.5 * std::erfc(threshold / std::sqrt(2.)) * (useAbs ? 2 : 1);
+  assert(std::abs(noise.expectedCount() - (10 + 399990 * prob)) < 1e-6);
+
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> dist(0, 1);
+  auto flat = [&]() { return dist(gen); };
+
+  std::vector<std::pair<mapkey_t, double>> out;
+  const int nevt = 5;
+  double n2 = 0, n05 = 0, n0 = 0, nneg = 0, sumx = 0;
+  for (int ievt = 0; ievt < nevt; ievt++) {
+    out.clear();
+    noise.sample(flat, out);
+    std::set<mapkey_t> seen;
+    for (const auto& [id, e] : out) {
+      // Each cell appears at most once.
+      assert(seen.insert(id).second);
+      mapkey_t i = id >> 4;
+      double sigma = rms[i];
+      assert(cells[i] == id);
+      if (sigma == 0) {
+        assert(e == 0);
+        ++n0;
+        continue;
+      }
+      assert(std::abs(e) >= threshold * sigma);
+      if (!useAbs)
+        assert(e > 0);
+      if (e < 0)
+        ++nneg;
+      (sigma == 2 ? n2 : n05) += 1;
+      sumx += std::abs(e) / sigma;
+    }
+  }
+
+  // Zero-noise cells are always kept.
+  assert(n0 == 10 * nevt);
+  checkCount(n2, nevt * 100000 * prob);
+  checkCount(n05, nevt * 299990 * prob);
+  if (useAbs)
+    checkCount(2 * nneg, n2 + n05);
+
+  // Mean of the normal tail above the threshold.
+  double ntail = n2 + n05;
+  double phi = std::exp(-threshold * threshold / 2) / std::sqrt(2 * M_PI);
+  double tailMean = phi / (0.5 * std::erfc(threshold / std::sqrt(2.)));
+  assert(std::abs(sumx / ntail - tailMean) < 0.02);
+}
+
+// Errors from the constructor.
+void test2() {
+  std::vector<mapkey_t> cells{1, 2, 3};
+  std::vector<double> rms{1, 1};
+  bool caught = false;
+  try {
+    SparseCellNoise noise(cells, rms, 3, false);
+  } catch (const SparseCellNoise::SparseCellNoiseException&) {
+    caught = true;
+  }
+  assert(caught);
+
+  rms.push_back(1);
+  caught = false;
+  try {
+    SparseCellNoise noise(cells, rms, 0, false);
+  } catch (const SparseCellNoise::SparseCellNoiseException&) {
+    caught = true;
+  }
+  assert(caught);
+
+  // Empty input.
+  SparseCellNoise noise({}, {}, 3, false);
+  assert(noise.nClasses() == 0);
+  std::vector<std::pair<mapkey_t, double>> out;
+  noise.sample([]() { return 0.5; }, out);
+  assert(out.empty());
+}
+
+int main() {
+  test1(false);
+  test1(true);
+  test2();
+  return 0;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file RecCaloCommon/tests/TopoClusterEngine_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for TopoClusterEngine.
+ *
+ * Compares the clusters built by TopoClusterEngine with those from
+ * a reference implementation following the original map-based
+ * CaloTopoClusterFCCee algorithm, on a toy two-dimensional calorimeter.
+ * This is done both with sequential and with multithreaded growth,
+ * and with neighbours given either by cell ID or by a NeighbourTable.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/IDMapIndexer.h"
+#include "RecCaloCommon/TopoClusterEngine.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+using mapkey_t = uint64_t; // libc defines key_t...
+
+//************************************************************************
+// Toy calorimeter: system:4,x:8,y:8, with a grid of NX x NY cells.
+//
+
+static const unsigned NX = 60;
+static const unsigned NY = 40;
+static const mapkey_t SYSTEM = 5;
+
+mapkey_t makeID(unsigned x, unsigned y) {
+  return SYSTEM | (static_cast<mapkey_t>(x) << 4) | (static_cast<mapkey_t>(y) << 12);
+}
+unsigned getX(mapkey_t id) { return (id >> 4) & 0xff; }
+unsigned getY(mapkey_t id) { return (id >> 12) & 0xff; }
+
+std::vector<mapkey_t> makeIDs() {
+  std::vector<mapkey_t> ids;
+  for (unsigned y = 0; y < NY; y++)
+    for (unsigned x = 0; x < NX; x++)
+      ids.push_back(makeID(x, y));
+  std::ranges::sort(ids);
+  return ids;
+}
+
+// 8-fold neighbours, in a fixed order.  Cells on the edge of the grid
+// have fewer neighbours.  Cell (0,0) has no neighbours, to test
+// the missing-neighbours error.
+class Neighbours {
+public:
+  Neighbours(bool isolateCorner) : m_isolateCorner(isolateCorner) {}
+  const std::vector<mapkey_t>& operator()(mapkey_t id) {
+    m_out.clear();
+    int x0 = getX(id);
+    int y0 = getY(id);
+    if (m_isolateCorner && x0 == 0 && y0 == 0)
+      return m_out;
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dx = -1; dx <= 1; dx++) {
+        int x = x0 + dx;
+        int y = y0 + dy;
+        if ((dx || dy) && x >= 0 && y >= 0 && x < static_cast<int>(NX) && y < static_cast<int>(NY))
+          m_out.push_back(makeID(x, y));
+      }
+    }
+    return m_out;
+  }
+
+private:
+  bool m_isolateCorner;
+  std::vector<mapkey_t> m_out;
+};
+
+//************************************************************************
+// Very simple RNG that should be repeatable across architectures.
+//
+
+static const uint32_t rngmax = static_cast<uint32_t>(-1);
+
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+inline float randf_seed(uint32_t& seed, float rmax, float rmin = 0) {
+  return static_cast<float>(rng_seed(seed)) / static_cast<float>(rngmax) * (rmax - rmin) + rmin;
+}
+
+//************************************************************************
+// Reference implementation, following the original map-based algorithm.
+//
+
+struct Cell {
+  mapkey_t id;
+  float energy;
+  double rms;
+  double offset;
+};
+
+// Cluster ID -> list of (input position, type).
+using RefClusters = std::map<uint32_t, std::vector<std::pair<size_t, int>>>;
+
+class Reference {
+public:
+  Reference(const std::vector<Cell>& cells, int seedSigma, int neighbourSigma, int lastNeighbourSigma)
+      : m_cells(cells), m_neighbourSigma(neighbourSigma), m_lastNeighbourSigma(lastNeighbourSigma) {
+    for (size_t i = 0; i < cells.size(); i++)
+      m_allCells.emplace(cells[i].id, i);
+
+    std::vector<size_t> seeds;
+    for (size_t i = 0; i < cells.size(); i++) {
+      double threshold = cells[i].offset + cells[i].rms * seedSigma;
+      if (std::fabs(cells[i].energy) > threshold)
+        seeds.push_back(i);
+    }
+    std::sort(seeds.begin(), seeds.end(), [&](size_t a, size_t b) { return cells[a].energy > cells[b].energy; });
+    m_nseeds = seeds.size();
+
+    Neighbours neighbours(false);
+    uint32_t seedCounter = 0;
+    for (size_t seed : seeds) {
+      seedCounter++;
+      if (m_used.contains(cells[seed].id))
+        continue;
+      uint32_t clusterId = seedCounter;
+      m_clusters[clusterId].emplace_back(seed, 1);
+      m_used[cells[seed].id] = clusterId;
+
+      std::vector<mapkey_t> next = search(cells[seed].id, clusterId, m_neighbourSigma, neighbours, true);
+      while (!next.empty()) {
+        std::vector<mapkey_t> more;
+        for (mapkey_t id : next) {
+          std::vector<mapkey_t> add = search(id, clusterId, m_neighbourSigma, neighbours, true);
+          more.insert(more.end(), add.begin(), add.end());
+        }
+        next.swap(more);
+      }
+
+      const auto& clus = m_clusters[clusterId];
+      size_t n = clus.size();
+      for (size_t i = 0; i < n; i++) {
+        if (clus[i].second <= 2)
+          search(m_cells[clus[i].first].id, clusterId, m_lastNeighbourSigma, neighbours, false);
+      }
+    }
+  }
+
+  const RefClusters& clusters() const { return m_clusters; }
+  size_t nseeds() const { return m_nseeds; }
+
+private:
+  std::vector<mapkey_t> search(mapkey_t cellId, uint32_t& clusterId, int numSigma, Neighbours& neighbours,
+                               bool allowMerge) {
+    std::vector<mapkey_t> added;
+    for (mapkey_t nid : neighbours(cellId)) {
+      auto itAll = m_allCells.find(nid);
+      auto itUsed = m_used.find(nid);
+      if (itAll != m_allCells.end() && itUsed == m_used.end()) {
+        const Cell& c = m_cells[itAll->second];
+        bool add = std::fabs(c.energy) > c.offset + c.rms * numSigma;
+        int type = numSigma == m_lastNeighbourSigma ? 3 : 2;
+        if (numSigma == 0)
+          add = true;
+        if (add) {
+          m_clusters[clusterId].emplace_back(itAll->second, type);
+          m_used[nid] = clusterId;
+          added.push_back(nid);
+        }
+      } else if (itUsed != m_used.end() && itUsed->second != clusterId && allowMerge) {
+        uint32_t to = itUsed->second;
+        for (const auto& p : m_clusters[clusterId]) {
+          m_used[m_cells[p.first].id] = to;
+          m_clusters[to].push_back(p);
+        }
+        m_clusters.erase(clusterId);
+        clusterId = to;
+        added.push_back(nid);
+        break;
+      }
+    }
+    return added;
+  }
+
+  const std::vector<Cell>& m_cells;
+  int m_neighbourSigma;
+  int m_lastNeighbourSigma;
+  size_t m_nseeds = 0;
+  std::map<mapkey_t, size_t> m_allCells;
+  std::map<mapkey_t, uint32_t> m_used;
+  RefClusters m_clusters;
+};
+
+//************************************************************************
+
+// Make a random event.  Cells have either a `shower' deposit or noise.
+std::vector<Cell> makeEvent(uint32_t& seed, float occupancy, bool withDuplicate) {
+  std::vector<Cell> cells;
+  for (unsigned y = 0; y < NY; y++) {
+    for (unsigned x = 0; x < NX; x++) {
+      if (randf_seed(seed, 1) > occupancy)
+        continue;
+      Cell c;
+      c.id = makeID(x, y);
+      c.rms = randf_seed(seed, 0.02, 0.005);
+      c.offset = randf_seed(seed, 0.002);
+      // Mostly noise, with some high deposits; quantize energies so that
+      // we get some ties in the seed ordering.
+      float e = randf_seed(seed, 0.05, -0.05);
+      if (randf_seed(seed, 1) < 0.05)
+        e += std::round(randf_seed(seed, 20) * 4) / 4;
+      c.energy = e;
+      cells.push_back(c);
+    }
+  }
+  // Shuffle the order a bit.
+  for (size_t i = 0; i + 1 < cells.size(); i += 2) {
+    if (randf_seed(seed, 1) < 0.5)
+      std::swap(cells[i], cells[i + 1]);
+  }
+  if (withDuplicate && cells.size() > 10) {
+    Cell dup = cells[3];
+    dup.energy += 1;
+    cells.push_back(dup);
+  }
+  return cells;
+}
+
+// Table of the neighbours, indexed like the indexer.  Cell (0,0) has
+// an extra neighbour not known to the indexer, which should be ignored.
+k4::recCalo::NeighbourTable makeTable(const k4::recCalo::ICaloIndexer& indexer) {
+  Neighbours neighbours(false);
+  std::vector<mapkey_t> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<mapkey_t> nbrs;
+  for (mapkey_t id : indexer.cellIDs()) {
+    cells.push_back(id);
+    const std::vector<mapkey_t>& v = neighbours(id);
+    nbrs.insert(nbrs.end(), v.begin(), v.end());
+    if (id == makeID(0, 0))
+      nbrs.push_back(makeID(NX + 5, 0));
+    offsets.push_back(nbrs.size());
+  }
+  k4::recCalo::NeighbourTable table(indexer, k4::recCalo::NeighbourTable(cells, offsets, nbrs));
+  assert(table.matches(indexer));
+  assert(table.size() == indexer.cellIDs().size() + 1);
+  return table;
+}
+
+void compare(k4::recCalo::TopoClusterEngine& engine, const std::vector<Cell>& cells, int seedSigma,
+             int neighbourSigma, int lastNeighbourSigma, tbb::task_arena* arena = nullptr,
+             const k4::recCalo::NeighbourTable* table = nullptr) {
+  using Engine = k4::recCalo::TopoClusterEngine;
+  engine.clear();
+  for (size_t i = 0; i < cells.size(); i++) {
+    Engine::slot_t s = engine.addCell(cells[i].id, cells[i].energy, cells[i].rms, cells[i].offset);
+    assert(s == i);
+  }
+  Engine::Thresholds thresholds{seedSigma, neighbourSigma, lastNeighbourSigma};
+  if (table) {
+    assert(engine.build(thresholds, true, *table, arena));
+  } else {
+    Neighbours neighbours(false);
+    assert(engine.build(thresholds, true, neighbours, arena));
+  }
+  if (arena && engine.nSeeds() > 1)
+    assert(engine.nComponents() > 0);
+
+  Reference ref(cells, seedSigma, neighbourSigma, lastNeighbourSigma);
+  assert(engine.nSeeds() == ref.nseeds());
+  assert(engine.nClusters() == ref.clusters().size());
+  size_t i = 0;
+  for (const auto& [id, refCells] : ref.clusters()) {
+    assert(engine.clusterID(i) == id);
+    std::span<const Engine::slot_t> slots = engine.clusterCells(i);
+    assert(slots.size() == refCells.size());
+    for (size_t j = 0; j < slots.size(); j++) {
+      assert(slots[j] == refCells[j].first);
+      assert(engine.cellType(slots[j]) == refCells[j].second);
+    }
+    ++i;
+  }
+}
+
+void test1(std::span<const mapkey_t> ids) {
+  using Indexer_t = k4::recCalo::IDMapIndexer<2>;
+  std::vector<Indexer_t::FieldDesc_t> fields{{4, 8}, {12, 8}};
+  Indexer_t indexer(SYSTEM, 4, fields, ids);
+
+  k4::recCalo::TopoClusterEngine engine(indexer);
+
+  // Cells not known to the indexer are rejected.
+  engine.clear();
+  assert(engine.addCell(makeID(NX + 5, 0), 1, 1, 0) == k4::recCalo::TopoClusterEngine::NOSLOT);
+  assert(engine.nCells() == 0);
+
+  tbb::task_arena arena(4);
+  k4::recCalo::NeighbourTable table = makeTable(indexer);
+  const k4::recCalo::NeighbourTable* tables[] = {nullptr, &table};
+  uint32_t seed = 1234;
+  for (int iev = 0; iev < 20; iev++) {
+    std::vector<Cell> cells = makeEvent(seed, iev % 2 ? 0.9 : 0.3, iev % 5 == 0);
+    for (tbb::task_arena* a : {static_cast<tbb::task_arena*>(nullptr), &arena}) {
+      for (const k4::recCalo::NeighbourTable* t : tables) {
+        compare(engine, cells, 4, 2, 0, a, t);
+        compare(engine, cells, 4, 2, 2, a, t);
+        compare(engine, cells, 3, 1, 1, a, t);
+        compare(engine, cells, 5, 0, 0, a, t);
+      }
+    }
+  }
+
+  // Duplicated cell IDs are chained.
+  engine.clear();
+  assert(engine.addCell(makeID(1, 1), 1, 1, 0) == 0);
+  assert(engine.addCell(makeID(2, 1), 1, 1, 0) == 1);
+  assert(engine.addCell(makeID(1, 1), 1, 1, 0) == 2);
+  assert(engine.canonical(2) == 0);
+  assert(engine.nextDuplicate(0) == 2);
+  assert(engine.nextDuplicate(2) == k4::recCalo::TopoClusterEngine::NOSLOT);
+  assert(engine.nextDuplicate(1) == k4::recCalo::TopoClusterEngine::NOSLOT);
+
+  // Missing neighbours are reported.
+  engine.clear();
+  engine.addCell(makeID(1, 1), 10, 1, 0);
+  engine.addCell(makeID(0, 0), 3, 1, 0);
+  Neighbours isolated(true);
+  assert(!engine.build(k4::recCalo::TopoClusterEngine::Thresholds{4, 2, 0}, true, isolated));
+  assert(engine.failedCell() == makeID(0, 0));
+  assert(engine.build(k4::recCalo::TopoClusterEngine::Thresholds{4, 2, 0}, false, isolated));
+  assert(engine.nClusters() == 1);
+
+  // Also with multithreaded growth.
+  engine.addCell(makeID(30, 30), 12, 1, 0);
+  assert(!engine.build(k4::recCalo::TopoClusterEngine::Thresholds{4, 2, 0}, true, isolated, &arena));
+  assert(engine.failedCell() == makeID(0, 0));
+  assert(engine.build(k4::recCalo::TopoClusterEngine::Thresholds{4, 2, 0}, false, isolated, &arena));
+  assert(engine.nClusters() == 2);
+  assert(engine.nComponents() == 2);
+}
+
+int main() {
+  std::vector<mapkey_t> ids = makeIDs();
+  test1(ids);
+  return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file RecCaloCommon/tests/TowerBucketGrid_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for TowerBucketGrid.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/TowerBucketGrid.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+using k4::recCalo::TowerBucketGrid;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+// Distance between two phi indices, the shorter way round.
+int phiDistance(int iPhi1, int iPhi2, int nPhi) {
+  const int d = ((iPhi1 - iPhi2) % nPhi + nPhi) % nPhi;
+  return std::min(d, nPhi - d);
+}
+
+// Queries compared with direct searches, for random objects and windows.
+void test1() {
+  uint32_t seed = 12345;
+  std::vector<TowerBucketGrid::index_t> found;
+  for (int iter = 0; iter < 200; iter++) {
+    const int nRows = 1 + rng_seed(seed) % 30;
+    const int nPhi = 1 + rng_seed(seed) % 40;
+    const int bucketRows = 1 + rng_seed(seed) % 6;
+    const int bucketPhi = 1 + rng_seed(seed) % 6;
+    const int nObjects = rng_seed(seed) % 50;
+    std::vector<int> rows(nObjects), phis(nObjects);
+    for (int i = 0; i < nObjects; i++) {
+      rows[i] = static_cast<int>(rng_seed(seed) % (nRows + 6)) - 3;
+      phis[i] = static_cast<int>(rng_seed(seed) % (3 * nPhi)) - nPhi;
+    }
+    TowerBucketGrid grid(nRows, nPhi, bucketRows, bucketPhi);
+    grid.fill(rows, phis);
+
+    for (int q = 0; q < 20; q++) {
+      const int iRow = static_cast<int>(rng_seed(seed) % (nRows + 6)) - 3;
+      const int iPhi = static_cast<int>(rng_seed(seed) % (3 * nPhi)) - nPhi;
+      const int dRow = rng_seed(seed) % 5;
+      const int dPhi = rng_seed(seed) % 5;
+      grid.query(iRow, iPhi, dRow, dPhi, found);
+      assert(std::is_sorted(found.begin(), found.end()));
+      assert(std::adjacent_find(found.begin(), found.end()) == found.end());
+      for (int i = 0; i < nObjects; i++) {
+        const bool near = std::abs(rows[i] - iRow) <= dRow && phiDistance(phis[i], iPhi, nPhi) <= dPhi;
+        const bool isFound = std::binary_search(found.begin(), found.end(), static_cast<TowerBucketGrid::index_t>(i));
+        if (near)
+          assert(isFound);
+        // Objects far from the buckets of the window are not returned.
+        const int rowFar = std::abs(std::clamp(rows[i], 0, nRows - 1) - std::clamp(iRow, 0, nRows - 1));
+        if (rowFar > dRow + bucketRows || phiDistance(phis[i], iPhi, nPhi) > dPhi + bucketPhi)
+          assert(!isFound);
+      }
+    }
+  }
+}
+
+// Buckets at the ends of the ranges, and refilling.
+void test2() {
+  TowerBucketGrid grid(10, 12, 3, 4);
+  std::vector<TowerBucketGrid::index_t> found;
+  grid.query(5, 5, 1, 1, found);
+  assert(found.empty());
+
+  const std::vector<int> rows = {0, 9, 5, 5, -4, 14};
+  const std::vector<int> phis = {0, 11, 6, 12, 23, 6};
+  grid.fill(rows, phis);
+  // Across the wrap in phi.
+  grid.query(0, 11, 1, 1, found);
+  assert(found == std::vector<TowerBucketGrid::index_t>({0, 4}));
+  // Rows beyond the grid are in its first and last rows.
+  grid.query(9, 6, 1, 1, found);
+  assert(found == std::vector<TowerBucketGrid::index_t>({5}));
+  grid.query(5, 0, 0, 0, found);
+  assert(found == std::vector<TowerBucketGrid::index_t>({3}));
+  // A window spanning all of phi.
+  grid.query(5, 0, 0, 6, found);
+  assert(found == std::vector<TowerBucketGrid::index_t>({2, 3}));
+
+  grid.fill(std::vector<int>({5}), std::vector<int>({6}));
+  grid.query(5, 6, 0, 0, found);
+  assert(found == std::vector<TowerBucketGrid::index_t>({0}));
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
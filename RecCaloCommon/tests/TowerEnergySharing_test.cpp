@@ -0,0 +1,117 @@
+/**
+ * @file RecCaloCommon/tests/TowerEnergySharing_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for TowerEnergySharing.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/TowerEnergySharing.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+using k4::recCalo::TowerEnergySharing;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+// Distance between two phi indices, the shorter way round.
+int phiDistance(int iPhi1, int iPhi2, int nPhi) {
+  const int d = ((iPhi1 - iPhi2) % nPhi + nPhi) % nPhi;
+  return std::min(d, nPhi - d);
+}
+
+// Two clusters side by side in phi, across phi = 0, and above each other in eta.
+void test1() {
+  const int nRows = 5;
+  const int nPhi = 12;
+  std::vector<float> energies(nRows * nPhi);
+  for (int i = 0; i < nRows * nPhi; i++)
+    energies[i] = 1 + i;
+  auto e = [&](int row, int phi) { return energies[row * nPhi + phi]; };
+  auto share = [](float energy) { return energy * energy / (energy + energy); };
+
+  // 3x3 clusters, overlapping in the two columns in phi between them.
+  TowerEnergySharing sharing(nRows, nPhi, 1, 1);
+  std::vector<int> rows = {2, 2};
+  std::vector<int> phis = {0, 11};
+  sharing.fill(rows, phis);
+  float expected = 100;
+  for (int row = 1; row <= 3; row++)
+    expected -= share(e(row, 0)) + share(e(row, 11));
+  assert(std::abs(sharing.correct(energies, 0, 100) - expected) < 1e-4);
+  assert(std::abs(sharing.correct(energies, 1, 100) - expected) < 1e-4);
+
+  // Clusters in the same column, overlapping in one row, at the edge of the grid.
+  rows = {0, 2};
+  phis = {5, 5};
+  sharing.fill(rows, phis);
+  expected = 100;
+  for (int phi = 4; phi <= 6; phi++)
+    expected -= share(e(1, phi));
+  assert(std::abs(sharing.correct(energies, 0, 100) - expected) < 1e-4);
+  assert(std::abs(sharing.correct(energies, 1, 100) - expected) < 1e-4);
+
+  // Clusters too far apart do not share.
+  rows = {1, 4};
+  phis = {3, 3};
+  sharing.fill(rows, phis);
+  assert(sharing.correct(energies, 0, 100) == 100);
+  assert(sharing.correct(energies, 1, 100) == 100);
+}
+
+// Corrections compared with a direct computation, for random clusters,
+// including windows of even size (whose half size is rounded down).
+void test2() {
+  uint32_t seed = 2468;
+  for (int iter = 0; iter < 300; iter++) {
+    const int halfRows = rng_seed(seed) % 3;
+    const int halfPhi = rng_seed(seed) % 3;
+    const int nRows = 1 + rng_seed(seed) % 20;
+    const int nPhi = 4 * halfPhi + 2 + rng_seed(seed) % 20;
+    const int nClusters = rng_seed(seed) % 30;
+    std::vector<float> energies(nRows * nPhi);
+    for (float& energy : energies)
+      energy = (rng_seed(seed) % 1000) / 100.;
+    std::vector<int> rows(nClusters), phis(nClusters);
+    for (int i = 0; i < nClusters; i++) {
+      rows[i] = rng_seed(seed) % nRows;
+      phis[i] = rng_seed(seed) % nPhi;
+    }
+
+    TowerEnergySharing sharing(nRows, nPhi, halfRows, halfPhi);
+    sharing.fill(rows, phis);
+    for (int i = 0; i < nClusters; i++) {
+      double expected = 50;
+      for (int row = rows[i] - halfRows; row <= rows[i] + halfRows; row++) {
+        if (row < 0 || row >= nRows)
+          continue;
+        for (int phi = phis[i] - halfPhi; phi <= phis[i] + halfPhi; phi++) {
+          const int wrapped = (phi + nPhi) % nPhi;
+          int nOthers = 0;
+          for (int j = 0; j < nClusters; j++) {
+            if (j != i && std::abs(rows[j] - row) <= halfRows && phiDistance(phis[j], wrapped, nPhi) <= halfPhi)
+              ++nOthers;
+          }
+          const double energy = energies[row * nPhi + wrapped];
+          const double sumButOne = nOthers * energy;
+          if (sumButOne != 0)
+            expected -= energy * sumButOne / (sumButOne + energy);
+        }
+      }
+      assert(std::abs(sharing.correct(energies, i, 50) - expected) < 1e-3);
+    }
+  }
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file RecCaloCommon/tests/TowerGrid_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for TowerGrid.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/TowerGrid.h"
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+using k4::recCalo::TowerGrid;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+// Energies.
+void test1() {
+  TowerGrid grid(3, 4);
+  assert(grid.nRows() == 3);
+  assert(grid.nPhi() == 4);
+  assert(grid.size() == 12);
+  for (float e : grid.energies())
+    assert(e == 0);
+
+  grid[1][2] += 5;
+  grid[2][0] = 3;
+  assert(grid.energies()[grid.tower(1, 2)] == 5);
+  assert(grid.energies()[6] == 5);
+  assert(grid.energies()[8] == 3);
+  const TowerGrid& cgrid = grid;
+  assert(cgrid[1][2] == 5);
+  assert(cgrid[1].size() == 4);
+
+  grid.extendRows(5);
+  assert(grid.nRows() == 5);
+  assert(grid.size() == 20);
+  assert(grid[1][2] == 5);
+  assert(grid[4][3] == 0);
+  grid.extendRows(2);
+  assert(grid.nRows() == 5);
+
+  TowerGrid empty;
+  assert(empty.size() == 0);
+}
+
+// Cells in towers.
+void test2() {
+  // No cells.
+  TowerGrid grid0(2, 3);
+  grid0.finalizeCells();
+  assert(grid0.nEntries() == 0);
+  assert(grid0.cells(1, 2).empty());
+
+  // Random assignment, compared with a map; a cell may be in several towers.
+  const int nRows = 7, nPhi = 11;
+  TowerGrid grid(nRows, nPhi);
+  std::map<std::pair<int, int>, std::vector<TowerGrid::index_t>> ref;
+  uint32_t seed = 1234;
+  for (TowerGrid::index_t cell = 0; cell < 500; cell++) {
+    int nTowers = 1 + rng_seed(seed) % 3;
+    for (int i = 0; i < nTowers; i++) {
+      int iRow = rng_seed(seed) % nRows;
+      int iPhi = rng_seed(seed) % nPhi;
+      grid.addCell(iRow, iPhi, cell);
+      ref[{iRow, iPhi}].push_back(cell);
+    }
+  }
+  grid.finalizeCells();
+
+  size_t nEntries = 0;
+  for (int iRow = 0; iRow < nRows; iRow++) {
+    for (int iPhi = 0; iPhi < nPhi; iPhi++) {
+      auto cells = grid.cells(iRow, iPhi);
+      const auto& r = ref[{iRow, iPhi}];
+      assert(std::vector<TowerGrid::index_t>(cells.begin(), cells.end()) == r);
+      nEntries += r.size();
+    }
+  }
+  assert(grid.nEntries() == nEntries);
+
+  // Extending keeps the cells, and the new towers are empty.
+  grid.extendRows(nRows + 2);
+  assert(grid.cells(nRows + 1, nPhi - 1).empty());
+  auto cells = grid.cells(3, 4);
+  assert(std::vector<TowerGrid::index_t>(cells.begin(), cells.end()) == ref[std::make_pair(3, 4)]);
+
+  // Extending before finalizing.
+  TowerGrid grid2(1, 2);
+  grid2.addCell(0, 1, 7);
+  grid2.extendRows(3);
+  grid2.addCell(2, 0, 8);
+  // By flat tower index.
+  grid2.addCell(grid2.tower(1, 1), 9);
+  grid2.finalizeCells();
+  assert(grid2.cells(0, 1).size() == 1 && grid2.cells(0, 1)[0] == 7);
+  assert(grid2.cells(2, 0).size() == 1 && grid2.cells(2, 0)[0] == 8);
+  assert(grid2.cells(1, 1).size() == 1 && grid2.cells(1, 1)[0] == 9);
+  assert(grid2.nEntries() == 3);
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
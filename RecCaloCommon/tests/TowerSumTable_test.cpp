@@ -0,0 +1,203 @@
+/**
+ * @file RecCaloCommon/tests/TowerSumTable_test.cpp
+ * @date Oct, 2026
+ * @brief Unit test for TowerSumTable.
+ */
+
+#undef NDEBUG
+#include "RecCaloCommon/TowerGrid.h"
+#include "RecCaloCommon/TowerSumTable.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using k4::recCalo::TowerGrid;
+using k4::recCalo::TowerSumTable;
+
+// Very simple RNG that should be repeatable across architectures.
+inline uint32_t rng_seed(uint32_t& seed) {
+  seed = (1664525 * seed + 1013904223);
+  return seed;
+}
+
+// Fill a grid with small multiples of 1/4, some negative, so that all sums are exact.
+void fillGrid(TowerGrid& grid, uint32_t& seed) {
+  for (float& e : grid.energies()) {
+    const int r = rng_seed(seed) >> 24;
+    e = r < 160 ? 0 : (r - 200) * 0.25f;
+  }
+}
+
+// Wrap a phi index, as the sliding-window algorithms did.
+int phiNeighbour(int aIPhi, int nPhi) {
+  if (aIPhi < 0) {
+    return nPhi + aIPhi;
+  } else if (aIPhi >= nPhi) {
+    return aIPhi % nPhi;
+  }
+  return aIPhi;
+}
+
+// Seeds of the sliding window, with running sums as in CreateCaloClustersSlidingWindow.
+std::vector<std::vector<int>> refSeeds(const TowerGrid& towers, int halfRows, int halfPhi, float threshold) {
+  const int nRows = towers.nRows();
+  const int nPhi = towers.nPhi();
+  std::vector<std::vector<int>> seeds(nRows);
+  std::vector<float> sumOverRows(nPhi, 0);
+  for (int iRow = 0; iRow < 2 * halfRows + 1; iRow++) {
+    std::transform(sumOverRows.begin(), sumOverRows.end(), towers[iRow].begin(), sumOverRows.begin(),
+                   std::plus<float>());
+  }
+  for (int iRow = halfRows; iRow < nRows - halfRows; iRow++) {
+    float sumWindow = 0;
+    for (int iPhiWindow = -halfPhi; iPhiWindow <= halfPhi; iPhiWindow++) {
+      sumWindow += sumOverRows[phiNeighbour(iPhiWindow, nPhi)];
+    }
+    for (int iPhi = 0; iPhi < nPhi; iPhi++) {
+      if (sumWindow > threshold) {
+        bool toRemove = false;
+        if (sumOverRows[phiNeighbour(iPhi - halfPhi, nPhi)] < sumOverRows[phiNeighbour(iPhi + halfPhi + 1, nPhi)])
+          toRemove = true;
+        if (sumOverRows[phiNeighbour(iPhi + halfPhi, nPhi)] < sumOverRows[phiNeighbour(iPhi - halfPhi - 1, nPhi)])
+          toRemove = true;
+        float sumPrev = 0, sumNext = 0, sumFirst = 0, sumLast = 0;
+        if (iRow > halfRows) {
+          for (int i = iPhi - halfPhi; i <= iPhi + halfPhi; i++) {
+            sumPrev += towers[iRow - halfRows - 1][phiNeighbour(i, nPhi)];
+            sumLast += towers[iRow + halfRows][phiNeighbour(i, nPhi)];
+          }
+          if (sumPrev > sumLast)
+            toRemove = true;
+        }
+        if (iRow < nRows - halfRows - 1) {
+          for (int i = iPhi - halfPhi; i <= iPhi + halfPhi; i++) {
+            sumNext += towers[iRow + halfRows + 1][phiNeighbour(i, nPhi)];
+            sumFirst += towers[iRow - halfRows][phiNeighbour(i, nPhi)];
+          }
+          if (sumNext > sumFirst)
+            toRemove = true;
+        }
+        if (!toRemove)
+          seeds[iRow].push_back(iPhi);
+      }
+      sumWindow -= sumOverRows[phiNeighbour(iPhi - halfPhi, nPhi)];
+      sumWindow += sumOverRows[phiNeighbour(iPhi + halfPhi + 1, nPhi)];
+    }
+    if (iRow < nRows - halfRows - 1) {
+      std::transform(sumOverRows.begin(), sumOverRows.end(), towers[iRow - halfRows].begin(), sumOverRows.begin(),
+                     std::minus<float>());
+      std::transform(sumOverRows.begin(), sumOverRows.end(), towers[iRow + halfRows + 1].begin(),
+                     sumOverRows.begin(), std::plus<float>());
+    }
+  }
+  return seeds;
+}
+
+// Sums over windows and ellipses, compared with direct sums.
+void test1() {
+  uint32_t seed = 12345;
+  TowerGrid towers(7, 10);
+  fillGrid(towers, seed);
+  TowerSumTable table(7, 10, 4);
+  assert(table.nRows() == 7);
+  assert(table.nPhi() == 10);
+  assert(table.nGhost() == 4);
+  assert(table.nPlanes() == 0);
+  const int e = table.addPlane(towers.energies());
+  // Energy weighted by the unwrapped phi index.
+  const int w = table.addPlane([&](int iRow, int iPhi) { return iPhi * towers[iRow][phiNeighbour(iPhi, 10)]; });
+  assert(e == 0 && w == 1 && table.nPlanes() == 2);
+
+  assert(table.wrapPhi(-1) == 9);
+  assert(table.wrapPhi(-10) == 0);
+  assert(table.wrapPhi(23) == 3);
+  assert(table.wrapPhi(4) == 4);
+
+  for (int r0 = -2; r0 <= 8; r0++) {
+    for (int r1 = r0; r1 <= 9; r1++) {
+      for (int p0 = -4; p0 <= 14; p0++) {
+        for (int p1 = p0; p1 <= 14; p1++) {
+          double s = 0, sw = 0;
+          for (int r = std::max(r0, 0); r < std::min(r1, 7); r++) {
+            for (int p = p0; p < p1; p++) {
+              s += towers[r][phiNeighbour(p, 10)];
+              sw += p * towers[r][phiNeighbour(p, 10)];
+            }
+          }
+          assert(table.sum(e, r0, r1, p0, p1) == s);
+          assert(table.sum(w, r0, r1, p0, p1) == sw);
+        }
+      }
+    }
+  }
+
+  for (int iRow = -2; iRow <= 8; iRow++) {
+    for (int iPhi = -12; iPhi <= 22; iPhi++) {
+      for (int hr = 0; hr <= 3; hr++) {
+        for (int hp = 0; hp <= 4; hp++) {
+          const int c = (iPhi % 10 + 10) % 10;
+          double s = 0;
+          double se = 0;
+          for (int r = iRow - hr; r <= iRow + hr; r++) {
+            for (int p = c - hp; p <= c + hp; p++) {
+              if (r >= 0 && r < 7) {
+                s += towers[r][phiNeighbour(p, 10)];
+                if (std::pow((r - iRow) / ((2 * hr + 1) / 2.), 2) + std::pow((p - c) / ((2 * hp + 1) / 2.), 2) < 1)
+                  se += towers[r][phiNeighbour(p, 10)];
+              }
+            }
+          }
+          assert(table.windowSum(e, iRow, iPhi, hr, hp) == s);
+          assert(table.ellipseSum(e, iRow, iPhi, hr, hp, (2 * hr + 1) / 2., (2 * hp + 1) / 2.) == se);
+        }
+      }
+    }
+  }
+}
+
+// Seeds, compared with the running sums of the sliding-window algorithms.
+void test2() {
+  uint32_t seed = 54321;
+  for (int iter = 0; iter < 50; iter++) {
+    const int nRows = 5 + rng_seed(seed) % 20;
+    const int nPhi = 3 + rng_seed(seed) % 30;
+    const int halfRows = rng_seed(seed) % 3;
+    const int halfPhi = rng_seed(seed) % 4;
+    if (nRows < 2 * halfRows + 1)
+      continue;
+    TowerGrid towers(nRows, nPhi);
+    fillGrid(towers, seed);
+    const float threshold = (static_cast<int>(rng_seed(seed) % 20) - 5) * 0.5f;
+
+    TowerSumTable table(nRows, nPhi, halfPhi + 1);
+    const int e = table.addPlane(towers.energies());
+    const auto ref = refSeeds(towers, halfRows, halfPhi, threshold);
+    std::vector<int> seeds;
+    for (int iRow = halfRows; iRow < nRows - halfRows; iRow++) {
+      table.findSeeds(e, iRow, halfRows, halfPhi, threshold, seeds);
+      assert(seeds == ref[iRow]);
+    }
+  }
+
+  // A single tower above threshold makes seeds of all the windows holding it, also across the wrap in phi.
+  TowerGrid towers(9, 12);
+  towers[4][11] = 10;
+  TowerSumTable table(9, 12, 3);
+  table.addPlane(towers.energies());
+  std::vector<int> seeds;
+  for (int iRow = 1; iRow < 8; iRow++) {
+    table.findSeeds(0, iRow, 1, 2, 5, seeds);
+    if (iRow >= 3 && iRow <= 5)
+      assert(seeds == std::vector<int>({0, 1, 9, 10, 11}));
+    else
+      assert(seeds.empty());
+  }
+}
+
+int main() {
+  test1();
+  test2();
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include "CachedNoiseConstTool.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/MultiIndexer.h"
+#include "RecCaloCommon/k4RecCalorimeter_check.h"
+
+#include "DDSegmentation/BitFieldCoder.h"
+
+#include "GaudiKernel/IProperty.h"
+
+#include <format>
+
+DECLARE_COMPONENT(CachedNoiseConstTool)
+
+StatusCode CachedNoiseConstTool::initialize() {
+  K4RECCALORIMETER_CHECK(AlgTool::initialize());
+
+  if (!m_noiseTool.retrieve()) {
+    error() << "Unable to retrieve the wrapped noise tool!!!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (m_caloTools.empty()) {
+    error() << "No calorimeter tools given; nothing to cache!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  if (!m_caloTools.retrieve()) {
+    error() << "Unable to retrieve the calorimeter tools!!!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  K4RECCALORIMETER_CHECK(m_constantsSvc.retrieve());
+
+  // Set up the indexer for all cells of the calorimeters
+  std::vector<const k4::recCalo::ICaloIndexer*> indexers;
+  for (auto& caloTool : m_caloTools) {
+    std::unique_ptr<k4::recCalo::ICaloIndexer> indexer = caloTool->indexer();
+    if (!indexer) {
+      error() << "Calorimeter tool " << caloTool.name() << " does not provide an indexer!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    indexers.push_back(indexer.get());
+    m_caloIndexers.push_back(std::move(indexer));
+  }
+  if (indexers.size() == 1) {
+    m_indexer = indexers[0];
+  } else {
+    dd4hep::DDSegmentation::BitFieldCoder decoder(m_systemEncoding);
+    try {
+      m_multiIndexer = std::make_unique<k4::recCalo::MultiIndexer>(decoder[decoder.index("system")].width(), indexers,
+                                                                   *m_constantsSvc);
+    } catch (const std::exception& e) {
+      error() << "Unable to combine the calorimeter indexers: " << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_indexer = m_multiIndexer.get();
+  }
+
+  // The table may have already been made by another instance of this tool.
+  // By default, the key identifies the wrapped tool by its full name (including its parent, for private tools)
+  // and by its type and the values of its properties, so that differently-configured tools do not share a table.
+  std::string keyName = "cachedNoise-" + m_cacheKey.value();
+  if (m_cacheKey.empty()) {
+    std::string config = m_noiseTool->type();
+    SmartIF<IProperty> noiseProps(m_noiseTool.get());
+    if (noiseProps) {
+      for (const Gaudi::Details::PropertyBase* prop : noiseProps->getProperties())
+        config += "\n" + prop->name() + "=" + prop->toString();
+    }
+    keyName = std::format("cachedNoise-{}-{:016x}", m_noiseTool->name(),
+                          k4::recCalo::CaloMapFile::checksum(std::as_bytes(std::span(config))));
+  }
+  m_table = m_constantsSvc->getObj<k4::recCalo::IndexedNoiseTable>(keyName);
+  if (m_table) {
+    if (!m_table->matches(*m_indexer)) {
+      error() << "Noise table " << keyName << " was made for different cells; set a distinct cacheKey" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    info() << "Using the cached noise table " << keyName << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+  info() << "Caching the noise of " << m_indexer->cellIDs().size() << " cells from " << m_noiseTool.name() << endmsg;
+  m_constantsSvc->putObj(keyName, k4::recCalo::IndexedNoiseTable(*m_indexer, [&](CellID id) {
+                           return m_noiseTool->getNoisePerCell(id);
+                         }));
+  m_table = m_constantsSvc->getObj<k4::recCalo::IndexedNoiseTable>(keyName);
+  K4RECCALORIMETER_CHECK(m_table != nullptr);
+
+  return StatusCode::SUCCESS;
+}
+
+double CachedNoiseConstTool::getNoiseRMSPerCell(CellID aCellId) const { return getNoisePerCell(aCellId).first; }
+
+double CachedNoiseConstTool::getNoiseOffsetPerCell(CellID aCellId) const { return getNoisePerCell(aCellId).second; }
+
+std::pair<double, double> CachedNoiseConstTool::getNoisePerCell(CellID aCellId) const {
+  k4::recCalo::ICaloIndexer::index_t ndx = m_indexer->index(aCellId);
+  if (ndx != k4::recCalo::ICaloIndexer::INVALID)
+    return m_table->noise(ndx);
+  return m_noiseTool->getNoisePerCell(aCellId);
+}
+
+const k4::recCalo::IndexedNoiseTable* CachedNoiseConstTool::indexedNoiseTable() const { return m_table; }
@@ -0,0 +1,97 @@
+#ifndef RECCALORIMETER_CACHEDNOISECONSTTOOL_H
+#define RECCALORIMETER_CACHEDNOISECONSTTOOL_H
+
+// from Gaudi
+#include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ServiceHandle.h"
+#include "GaudiKernel/ToolHandle.h"
+
+// k4FWCore
+#include "RecCaloCommon/ICaloCellConstantsSvc.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
+#include "RecCaloCommon/INoiseConstTool.h"
+#include "RecCaloCommon/IndexedNoiseTable.h"
+
+#include <memory>
+#include <vector>
+
+/** @class CachedNoiseConstTool Reconstruction/RecCalorimeter/src/components/CachedNoiseConstTool.h
+ *CachedNoiseConstTool.h
+ *
+ *  Tool that caches the noise constants given by another noise tool.
+ *  At initialize, the noise of every cell of the calorimeters given by "calorimeterTools" is
+ *  evaluated once with the wrapped "noiseTool", and stored in float arrays indexed by the cell
+ *  indexers of those tools (combined if there are several calorimeters).
+ *  Later lookups are then an index lookup plus an array access, rather than a hash-map lookup
+ *  or an evaluation of histograms and cell positions.  Cells not known to the calorimeter tools
+ *  are passed to the wrapped tool.
+ *
+ *  The table is held in the CaloCellConstantsSvc under the key "cachedNoise-<cacheKey>".  By
+ *  default, the key is made from the full name of the wrapped tool and a hash of its type and
+ *  properties, so only instances wrapping the same tool share a table.  Instances configured
+ *  with the same "cacheKey" share one table, so they must wrap equivalently-configured tools.
+ *  The noise constants are rounded to single precision.
+ *
+ *  The table is also available through indexedNoiseTable(), so that clients indexing the same
+ *  cells (such as CaloTopoClusterFCCee with the same "calorimeterTools") can use it directly.
+ */
+
+class CachedNoiseConstTool : public extends<AlgTool, k4::recCalo::INoiseConstTool> {
+public:
+  using base_class::base_class;
+  virtual ~CachedNoiseConstTool() = default;
+  /** Retrieve the tools and fill the noise table.
+   * return StatusCode
+   */
+  virtual StatusCode initialize() override final;
+
+  /** Expected noise per cell in terms of sigma of Gaussian distibution.
+   *   @param[in] aCellId of the cell of interest.
+   *   return double.
+   */
+  virtual double getNoiseRMSPerCell(CellID aCellId) const override final;
+
+  /** Expected noise per cell in terms of mean of distibution.
+   *   @param[in] aCellId of the cell of interest.
+   *   return double.
+   */
+  virtual double getNoiseOffsetPerCell(CellID aCellId) const override final;
+
+  /** Expected noise per cell.
+   *   @param[in] aCellId of the cell of interest.
+   *   return [rms, offset]
+   */
+  virtual std::pair<double, double> getNoisePerCell(CellID aCellId) const override final;
+
+  /** Table of the noise of all cells, indexed like the indexer of the calorimeter tools.
+   */
+  virtual const k4::recCalo::IndexedNoiseTable* indexedNoiseTable() const override final;
+
+private:
+  /// Wrapped noise tool, called once per cell at initialize.
+  ToolHandle<k4::recCalo::INoiseConstTool> m_noiseTool{this, "noiseTool", "TopoCaloNoisyCells",
+                                                       "Noise tool whose constants are cached"};
+  /// Geometry tools of the calorimeters, providing the cells and their indexers.
+  ToolHandleArray<k4::recCalo::ICalorimeterTool> m_caloTools{
+      this, "calorimeterTools", {}, "Geometry tools of the calorimeters whose cell noise is cached"};
+  /// Key under which the table is shared; defaults to the name and configuration of the wrapped tool.
+  Gaudi::Property<std::string> m_cacheKey{
+      this, "cacheKey", "",
+      "Key for sharing the table between instances (default: wrapped tool full name and properties)"};
+  /// System encoding string, used to combine the indexers of several calorimeters.
+  Gaudi::Property<std::string> m_systemEncoding{this, "systemEncoding", "system:4", "System encoding string"};
+  /// Handle to the cell constants service, which holds the noise table.
+  ServiceHandle<k4::recCalo::ICaloCellConstantsSvc> m_constantsSvc{this, "CaloCellConstantsSvc",
+                                                                   "k4::recCalo::CaloCellConstantsSvc", ""};
+
+  /// Indexers of the individual calorimeters.
+  std::vector<std::unique_ptr<k4::recCalo::ICaloIndexer>> m_caloIndexers;
+  /// Indexer covering all calorimeters, if there are several.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_multiIndexer;
+  const k4::recCalo::ICaloIndexer* m_indexer = nullptr;
+  /// Table of noise constants, owned by the constants service.
+  const k4::recCalo::IndexedNoiseTable* m_table = nullptr;
+};
+
+#endif /* RECCALORIMETER_CACHEDNOISECONSTTOOL_H */
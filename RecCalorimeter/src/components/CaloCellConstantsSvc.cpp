@@ -6,11 +6,121 @@
  */
 
 #include "CaloCellConstantsSvc.h"
+#include "DD4hep/Detector.h"
+#include "DD4hep/IDDescriptor.h"
+#include "DD4hep/Readout.h"
+#include "DDSegmentation/Segmentation.h"
+#include "k4FWCore/GaudiChecks.h"
+#include <cctype>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <span>
+#include <string>
+#include <sys/file.h>
+#include <unistd.h>
+#include <vector>
 
 DECLARE_COMPONENT(k4::recCalo::CaloCellConstantsSvc);
 
+namespace {
+
+/**
+ * @brief Hold an exclusive lock on a file for the lifetime of the object.
+ */
+class FileLock {
+public:
+  FileLock(const std::string& path) : m_fd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666)) {
+    if (m_fd >= 0 && ::flock(m_fd, LOCK_EX) != 0) {
+      ::close(m_fd);
+      m_fd = -1;
+    }
+  }
+  ~FileLock() {
+    if (m_fd >= 0)
+      ::close(m_fd);
+  }
+  FileLock(const FileLock&) = delete;
+  FileLock& operator=(const FileLock&) = delete;
+
+  bool locked() const { return m_fd >= 0; }
+
+private:
+  int m_fd;
+};
+
+} // anonymous namespace
+
 namespace k4::recCalo {
 
+/**
+ * @brief Standard Gaudi initialize method.
+ */
+StatusCode CaloCellConstantsSvc::initialize() {
+  K4_GAUDI_CHECK(base_class::initialize());
+  if (!m_sharedDir.empty()) {
+    if (m_hashGeometry) {
+      K4_GAUDI_CHECK(hashGeometry());
+    } else if (m_geometryKey.empty()) {
+      error() << "geometryKey must be set when sharing cell constants via sharedDir without hashGeometry" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(m_sharedDir.value(), ec);
+    if (ec) {
+      error() << "Cannot create shared directory " << m_sharedDir.value() << ": " << ec.message() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    info() << "Sharing cell constants in " << m_sharedDir.value()
+           << std::format(" for geometry {:016x} {}", m_geometryHash, m_geometryKey.value()) << endmsg;
+  }
+  return StatusCode::SUCCESS;
+}
+
+/**
+ * @brief Hash the loaded geometry into m_geometryHash.
+ *
+ * The cell lists and maps are derived from the ID specifications and
+ * segmentations of the readouts, so these are hashed directly.  The compact
+ * files (with their sizes and modification times) are also included,
+ * to catch other changes to the detector description.
+ */
+StatusCode CaloCellConstantsSvc::hashGeometry() {
+  if (!m_geoSvc.retrieve()) {
+    error() << "Unable to retrieve the geometry service; set hashGeometry=False and a geometryKey to share "
+            << "cell constants without it" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  std::string desc;
+  Gaudi::Property<std::vector<std::string>> compactFiles("detectors", {});
+  SmartIF<IProperty> geoProps(m_geoSvc.get());
+  if (geoProps && geoProps->getProperty(&compactFiles).isSuccess()) {
+    for (const std::string& path : compactFiles.value())
+      desc += std::format("compact {} {}\n", path, fileVersion(path));
+  } else {
+    warning() << "Cannot find the compact files of " << m_geoSvc.name() << "; hashing only the readouts" << endmsg;
+  }
+
+  const dd4hep::Detector* det = m_geoSvc->getDetector();
+  for (const auto& [name, handle] : det->readouts()) {
+    dd4hep::Readout readout = handle;
+    desc += std::format("readout {}\n", name);
+    if (readout.idSpec().isValid())
+      desc += std::format(" ids {}\n", readout.idSpec().fieldDescription());
+    if (readout.segmentation().isValid()) {
+      const dd4hep::DDSegmentation::Segmentation* seg = readout.segmentation().segmentation();
+      desc += std::format(" segmentation {}\n", seg->type());
+      for (const dd4hep::DDSegmentation::SegmentationParameter* par : seg->parameters())
+        desc += std::format("  {}={}\n", par->name(), par->value());
+    }
+  }
+
+  m_geometryHash = CaloMapFile::checksum(std::as_bytes(std::span(desc)));
+  debug() << "Geometry description for shared files:\n" << desc << endmsg;
+  return StatusCode::SUCCESS;
+}
+
 /**
  * @brief Retrieve an object from the store, as a @c std::any.
  * @param key Key of the object.
@@ -33,4 +143,80 @@ bool CaloCellConstantsSvc::putAnyObj(const std::string& key, std::any&& obj) {
   return m_objs.try_emplace(key, std::move(obj)).second;
 }
 
+/**
+ * @brief Attach to a file in the shared area, publishing it if needed.
+ * @param key Key of the object held in the file.
+ * @param kind Kind of the file.
+ * @param version Version key of the object.
+ * @param publish Called to write the file, if no current version has
+ *                been published.
+ */
+std::shared_ptr<const CaloMapFile> CaloCellConstantsSvc::attachShared(const std::string& key, CaloMapFile::Kind kind,
+                                                                      uint64_t version, const PublishFn& publish) {
+  if (m_sharedDir.empty())
+    return nullptr;
+
+  // The tag identifies the contents of the file.
+  std::string tagString = std::format("{:016x}\n{}\n{}\n{}\n{}", m_geometryHash, m_geometryKey.value(), key,
+                                      static_cast<uint32_t>(kind), version);
+  uint64_t tag = CaloMapFile::checksum(std::as_bytes(std::span(tagString)));
+  if (tag == 0)
+    tag = 1;
+
+  // The file name is derived from the key, made safe for the filesystem,
+  // together with the tag.
+  std::string name;
+  for (char c : key.substr(0, 64))
+    name += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '.') ? c : '_';
+  std::string path = std::format("{}/{}-{:016x}.k4map", m_sharedDir.value(), name, tag);
+
+  // Already published?
+  if (auto file = openShared(path, kind, tag)) {
+    debug() << "Attached shared " << key << " from " << path << endmsg;
+    return file;
+  }
+
+  // Take the lock and look again, in case another process published
+  // the file while we were waiting.
+  FileLock lock(path + ".lock");
+  if (!lock.locked()) {
+    warning() << "Cannot lock " << path << ".lock; not sharing " << key << endmsg;
+    return nullptr;
+  }
+  if (auto file = openShared(path, kind, tag)) {
+    debug() << "Attached shared " << key << " from " << path << endmsg;
+    return file;
+  }
+
+  try {
+    publish(path, tag);
+  } catch (const std::exception& e) {
+    warning() << "Cannot publish " << key << " to " << path << ": " << e.what() << endmsg;
+    return nullptr;
+  }
+  info() << "Published shared " << key << " to " << path << endmsg;
+  return openShared(path, kind, tag);
+}
+
+/**
+ * @brief Open a published file, returning nullptr if it is missing or unusable.
+ * @param path Path of the file.
+ * @param kind Expected kind of the file.
+ * @param tag Expected tag of the file.
+ */
+std::shared_ptr<const CaloMapFile> CaloCellConstantsSvc::openShared(const std::string& path, CaloMapFile::Kind kind,
+                                                                    uint64_t tag) {
+  if (!std::filesystem::exists(path))
+    return nullptr;
+  try {
+    auto file = std::make_shared<const CaloMapFile>(path, kind, m_verifyChecksum.value());
+    if (file->tag() == tag)
+      return file;
+    warning() << "Ignoring stale shared file " << path << endmsg;
+  } catch (const std::exception& e) {
+    warning() << "Ignoring unusable shared file: " << e.what() << endmsg;
+  }
+  return nullptr;
+}
+
 } // namespace k4::recCalo
@@ -10,7 +10,10 @@
 #define RECCALORIMETER_CALOCELLCONSTANTSSVC_H
 
 #include "GaudiKernel/Service.h"
+#include "GaudiKernel/ServiceHandle.h"
 #include "RecCaloCommon/ICaloCellConstantsSvc.h"
+#include "k4Interface/IGeoSvc.h"
+#include <map>
 #include <mutex>
 
 namespace k4::recCalo {
@@ -34,11 +37,31 @@ namespace k4::recCalo {
  * does not allow for storing arbitrary types, and in general does not
  * really seem intended for the storage of data which is not meant
  * to be persistent.
+ *
+ * Sharing between processes: when many single-threaded jobs run on
+ * the same node, each would otherwise build and hold its own copy of the
+ * cell lists and maps.  If @c sharedDir is set, objects retrieved via
+ * @c getOrMakeObj are published there as CaloMapFiles; other processes
+ * map the same files read-only, so that the pages are shared
+ * through the page cache (use a directory under /dev/shm to keep them
+ * in memory).  Each file is tagged with a hash of its key, its version key,
+ * and the geometry, and files with the wrong tag are rebuilt.  The geometry
+ * is identified by a hash of the compact files loaded by the GeoSvc
+ * (with their sizes and modification times) and of the ID specification
+ * and segmentation parameters of each readout, salted with the
+ * @c geometryKey property.
+ * A lock file serializes the building of each object, so that
+ * processes starting together build it only once.
  */
 class CaloCellConstantsSvc : public extends<Service, ICaloCellConstantsSvc> {
 public:
   using base_class::base_class;
 
+  /**
+   * @brief Standard Gaudi initialize method.
+   */
+  virtual StatusCode initialize() override;
+
   /**
    * @brief Retrieve an object from the store, as a @c std::any.
    * @param key Key of the object.
@@ -59,7 +82,50 @@ public:
    */
   virtual bool putAnyObj(const std::string& key, std::any&& obj) override;
 
+  /**
+   * @brief Attach to a file in the shared area, publishing it if needed.
+   * @param key Key of the object held in the file.
+   * @param kind Kind of the file.
+   * @param version Version key of the object.
+   * @param publish Called to write the file, if no current version has
+   *                been published.
+   *
+   * Returns the mapped file, or @c nullptr if no shared area
+   * is configured or if the file could not be published.
+   */
+  virtual std::shared_ptr<const CaloMapFile> attachShared(const std::string& key, CaloMapFile::Kind kind,
+                                                          uint64_t version, const PublishFn& publish) override;
+
 private:
+  /// Hash the loaded geometry into m_geometryHash.
+  StatusCode hashGeometry();
+
+  /// Open a published file, returning nullptr if it is missing or unusable.
+  std::shared_ptr<const CaloMapFile> openShared(const std::string& path, CaloMapFile::Kind kind, uint64_t tag);
+
+  /// Directory for files shared between processes.
+  Gaudi::Property<std::string> m_sharedDir{
+      this, "sharedDir", "",
+      "Directory in which to share cell constants between processes; sharing is disabled if empty"};
+
+  /// Extra key identifying the geometry; must be set if sharing without hashing the geometry.
+  Gaudi::Property<std::string> m_geometryKey{
+      this, "geometryKey", "", "Extra key identifying the detector geometry, used to reject stale shared files"};
+
+  /// Identify the geometry by hashing the geometry loaded by the GeoSvc?
+  Gaudi::Property<bool> m_hashGeometry{this, "hashGeometry", true,
+                                       "Identify the geometry of shared files by hashing the loaded geometry"};
+
+  /// Handle to the geometry service, used to identify the geometry.
+  ServiceHandle<IGeoSvc> m_geoSvc{this, "GeoSvc", "GeoSvc"};
+
+  /// Hash of the loaded geometry, or 0 if not hashed.
+  uint64_t m_geometryHash = 0;
+
+  /// Verify checksums of shared files?
+  Gaudi::Property<bool> m_verifyChecksum{this, "verifyChecksum", true,
+                                         "Verify the checksum of the contents of shared files when attaching"};
+
   /// The stored objects.
   std::map<std::string, std::any> m_objs;
 
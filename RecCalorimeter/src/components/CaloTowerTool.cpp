@@ -99,6 +99,49 @@ StatusCode CaloTowerTool::initialize() {
     return StatusCode::FAILURE;
   }
 
+  // precompute the towers of the cells of the calorimeters whose tools are given
+  if (!m_caloTools.empty()) {
+    if (!m_caloTools.retrieve()) {
+      error() << "Unable to retrieve the calorimeter tools!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    // the towers of the cells depend on the tower numbers
+    int nEta = 0, nPhi = 0;
+    towersNumber(nEta, nPhi);
+    const std::vector<std::tuple<std::string, dd4hep::DDSegmentation::Segmentation*, SegmentationType>> readouts = {
+        {m_ecalBarrelReadoutName, m_ecalBarrelSegmentation, m_ecalBarrelSegmentationType},
+        {m_ecalEndcapReadoutName, m_ecalEndcapSegmentation, m_ecalEndcapSegmentationType},
+        {m_ecalFwdReadoutName, m_ecalFwdSegmentation, m_ecalFwdSegmentationType},
+        {m_hcalBarrelReadoutName, m_hcalBarrelSegmentation, m_hcalBarrelSegmentationType},
+        {m_hcalExtBarrelReadoutName, m_hcalExtBarrelSegmentation, m_hcalExtBarrelSegmentationType},
+        {m_hcalEndcapReadoutName, m_hcalEndcapSegmentation, m_hcalEndcapSegmentationType},
+        {m_hcalFwdReadoutName, m_hcalFwdSegmentation, m_hcalFwdSegmentationType}};
+    for (const auto& caloTool : m_caloTools) {
+      auto readout = std::find_if(readouts.begin(), readouts.end(),
+                                  [&](const auto& r) { return std::get<0>(r) == caloTool->readoutName(); });
+      if (readout == readouts.end() || std::get<1>(*readout) == nullptr) {
+        error() << "Readout " << caloTool->readoutName() << " of calorimeter tool " << caloTool.name()
+                << " is not one of the input readouts" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      const std::string& readoutName = std::get<0>(*readout);
+      dd4hep::DDSegmentation::Segmentation* segmentation = std::get<1>(*readout);
+      const SegmentationType type = std::get<2>(*readout);
+      PrecomputedTowers towers{segmentation, caloTool->indexer(), {}};
+      if (!towers.indexer) {
+        error() << "Calorimeter tool " << caloTool.name() << " does not provide an indexer!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      towers.map = k4::recCalo::CellTowerMap(
+          *towers.indexer,
+          [&](dd4hep::DDSegmentation::CellID aCellId, std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) {
+            cellTowers(segmentation, type, aCellId, aEntries);
+          });
+      info() << "Precomputed the towers of " << towers.map.size() << " cells of " << readoutName << endmsg;
+      m_precomputedTowers.push_back(std::move(towers));
+    }
+  }
+
   return StatusCode::SUCCESS;
 }
 
@@ -195,18 +238,16 @@ void CaloTowerTool::towersNumber(int& nEta, int& nPhi) {
   nPhi = m_nPhiTower;
 }
 
-uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells) {
+k4::recCalo::CaloTowers CaloTowerTool::buildTowers(bool fillTowersCells) const {
+  k4::recCalo::CaloTowers towers(m_nEtaTower, m_nPhiTower);
   uint totalNumberOfCells = 0;
-  for (auto& towerInMap : m_cellsInTowers) {
-    towerInMap.second.clear();
-  }
   // 1. ECAL barrel
   // Get the input collection with calorimeter cells
   const edm4hep::CalorimeterHitCollection* ecalBarrelCells = m_ecalBarrelCells.get();
   debug() << "Input Ecal barrel cell collection size: " << ecalBarrelCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_ecalBarrelSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, ecalBarrelCells, m_ecalBarrelSegmentation, m_ecalBarrelSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, ecalBarrelCells, m_ecalBarrelSegmentation, m_ecalBarrelSegmentationType, fillTowersCells);
     totalNumberOfCells += ecalBarrelCells->size();
   }
 
@@ -215,7 +256,7 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input Ecal endcap cell collection size: " << ecalEndcapCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_ecalEndcapSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, ecalEndcapCells, m_ecalEndcapSegmentation, m_ecalEndcapSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, ecalEndcapCells, m_ecalEndcapSegmentation, m_ecalEndcapSegmentationType, fillTowersCells);
     totalNumberOfCells += ecalEndcapCells->size();
   }
 
@@ -224,7 +265,7 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input Ecal forward cell collection size: " << ecalFwdCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_ecalFwdSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, ecalFwdCells, m_ecalFwdSegmentation, m_ecalFwdSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, ecalFwdCells, m_ecalFwdSegmentation, m_ecalFwdSegmentationType, fillTowersCells);
     totalNumberOfCells += ecalFwdCells->size();
   }
 
@@ -233,7 +274,7 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input hadronic barrel cell collection size: " << hcalBarrelCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_hcalBarrelSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, hcalBarrelCells, m_hcalBarrelSegmentation, m_hcalBarrelSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, hcalBarrelCells, m_hcalBarrelSegmentation, m_hcalBarrelSegmentationType, fillTowersCells);
     totalNumberOfCells += hcalBarrelCells->size();
   }
 
@@ -242,7 +283,7 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input hadronic extended barrel cell collection size: " << hcalExtBarrelCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_hcalExtBarrelSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, hcalExtBarrelCells, m_hcalExtBarrelSegmentation, m_hcalExtBarrelSegmentationType,
+    CellsIntoTowers(towers, hcalExtBarrelCells, m_hcalExtBarrelSegmentation, m_hcalExtBarrelSegmentationType,
                     fillTowersCells);
     totalNumberOfCells += hcalExtBarrelCells->size();
   }
@@ -252,7 +293,7 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input Hcal endcap cell collection size: " << hcalEndcapCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_hcalEndcapSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, hcalEndcapCells, m_hcalEndcapSegmentation, m_hcalEndcapSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, hcalEndcapCells, m_hcalEndcapSegmentation, m_hcalEndcapSegmentationType, fillTowersCells);
     totalNumberOfCells += hcalEndcapCells->size();
   }
 
@@ -261,10 +302,12 @@ uint CaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, bool f
   debug() << "Input Hcal forward cell collection size: " << hcalFwdCells->size() << endmsg;
   // Loop over a collection of calorimeter cells and build calo towers
   if (m_hcalFwdSegmentation != nullptr) {
-    CellsIntoTowers(aTowers, hcalFwdCells, m_hcalFwdSegmentation, m_hcalFwdSegmentationType, fillTowersCells);
+    CellsIntoTowers(towers, hcalFwdCells, m_hcalFwdSegmentation, m_hcalFwdSegmentationType, fillTowersCells);
     totalNumberOfCells += hcalFwdCells->size();
   }
-  return totalNumberOfCells;
+  towers.grid.finalizeCells();
+  towers.nCells = totalNumberOfCells;
+  return towers;
 }
 
 uint CaloTowerTool::idEta(float aEta) const {
@@ -296,13 +339,19 @@ uint CaloTowerTool::phiNeighbour(int aIPhi) const {
   return aIPhi;
 }
 
+std::span<const k4::recCalo::TowerGrid::index_t>
+CaloTowerTool::towerCells(const k4::recCalo::CaloTowers& aTowers, int aIEta, int aIPhi) const {
+  if (aIEta < 0 || aIEta >= aTowers.grid.nRows()) {
+    return {};
+  }
+  return aTowers.grid.cells(aIEta, phiNeighbour(aIPhi));
+}
+
 float CaloTowerTool::radiusForPosition() const { return m_radius; }
 
-void CaloTowerTool::CellsIntoTowers(std::vector<std::vector<float>>& aTowers,
-                                    const edm4hep::CalorimeterHitCollection* aCells,
-                                    dd4hep::DDSegmentation::Segmentation* aSegmentation, SegmentationType aType,
-                                    bool fillTowersCells) {
-  // Loop over a collection of calorimeter cells and build calo towers
+void CaloTowerTool::cellTowers(const dd4hep::DDSegmentation::Segmentation* aSegmentation, SegmentationType aType,
+                               dd4hep::DDSegmentation::CellID aCellId,
+                               std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) const {
   // borders of the cell in eta/phi
   float etaCellMin = 0, etaCellMax = 0;
   float phiCellMin = 0, phiCellMax = 0;
@@ -317,95 +366,125 @@ void CaloTowerTool::CellsIntoTowers(std::vector<std::vector<float>>& aTowers,
   float fracEtaMin = 1.0, fracEtaMax = 1.0, fracEtaMiddle = 1.0;
   float fracPhiMin = 1.0, fracPhiMax = 1.0, fracPhiMiddle = 1.0;
   float epsilon = 0.0001;
+  if (m_useHalfTower) {
+    uint layerId = m_decoder->get(aCellId, "layer");
+    if (layerId > m_max_layer) {
+      return;
+    }
+  }
+  // if multisegmentation is used - first find out which segmentation to use
   const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo* segmentation = nullptr;
-  const dd4hep::DDSegmentation::MultiSegmentation* multisegmentation = nullptr;
   if (aType == SegmentationType::kPhiEta) {
     segmentation = dynamic_cast<const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo*>(aSegmentation);
   } else if (aType == SegmentationType::kMulti) {
-    multisegmentation = dynamic_cast<const dd4hep::DDSegmentation::MultiSegmentation*>(aSegmentation);
+    segmentation = dynamic_cast<const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo*>(
+        &dynamic_cast<const dd4hep::DDSegmentation::MultiSegmentation*>(aSegmentation)->subsegmentation(aCellId));
   }
-  bool pass = true;
-  for (const auto& cell : *aCells) {
-    pass = true;
-    // if multisegmentation is used - first find out which segmentation to use
-    if (aType == SegmentationType::kMulti) {
-      segmentation = dynamic_cast<const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo*>(
-          &multisegmentation->subsegmentation(cell.getCellID()));
+  // find to which tower(s) the cell belongs
+  float cellEta = segmentation->eta(aCellId);
+  float cellPhi = segmentation->phi(aCellId);
+  etaCellMin = cellEta - segmentation->gridSizeEta() * 0.5;
+  etaCellMax = cellEta + segmentation->gridSizeEta() * 0.5;
+  phiCellMin = cellPhi - M_PI / (double)segmentation->phiBins();
+  phiCellMax = cellPhi + M_PI / (double)segmentation->phiBins();
+  iEtaMin = idEta(etaCellMin + epsilon);
+  iPhiMin = idPhi(phiCellMin + epsilon);
+  iEtaMax = idEta(etaCellMax - epsilon);
+  iPhiMax = idPhi(phiCellMax - epsilon);
+  // if a cell is larger than a tower in eta/phi, calculate the fraction of
+  // the cell area belonging to the first/last/middle towers
+  if (iEtaMin != iEtaMax) {
+    fracEtaMin = fabs(eta(iEtaMin) + 0.5 * m_deltaEtaTower - etaCellMin) / segmentation->gridSizeEta();
+    fracEtaMax = fabs(etaCellMax - eta(iEtaMax) + 0.5 * m_deltaEtaTower) / segmentation->gridSizeEta();
+    if ((iEtaMax - iEtaMin - 1) != 0) {
+      fracEtaMiddle = (1 - fracEtaMin - fracEtaMax) / float(iEtaMax - iEtaMin - 1);
+    } else {
+      fracEtaMiddle = 0.0;
     }
-    if (m_useHalfTower) {
-      uint layerId = m_decoder->get(cell.getCellID(), "layer");
-      if (layerId > m_max_layer) {
-        pass = false;
-      }
+  }
+  if (iPhiMin != iPhiMax) {
+    fracPhiMin = fabs(phi(iPhiMin) + 0.5 * m_deltaPhiTower - phiCellMin) / (2 * M_PI / (double)segmentation->phiBins());
+    fracPhiMax = fabs(phiCellMax - phi(iPhiMax) + 0.5 * m_deltaPhiTower) / (2 * M_PI / (double)segmentation->phiBins());
+    if ((iPhiMax - iPhiMin - 1) != 0) {
+      fracPhiMiddle = (1 - fracPhiMin - fracPhiMax) / float(iPhiMax - iPhiMin - 1);
+    } else {
+      fracPhiMiddle = 0.0;
     }
-    if (pass) {
-      // find to which tower(s) the cell belongs
-      float cellEta = segmentation->eta(cell.getCellID());
-      float cellPhi = segmentation->phi(cell.getCellID());
-      etaCellMin = cellEta - segmentation->gridSizeEta() * 0.5;
-      etaCellMax = cellEta + segmentation->gridSizeEta() * 0.5;
-      phiCellMin = cellPhi - M_PI / (double)segmentation->phiBins();
-      phiCellMax = cellPhi + M_PI / (double)segmentation->phiBins();
-      iEtaMin = idEta(etaCellMin + epsilon);
-      iPhiMin = idPhi(phiCellMin + epsilon);
-      iEtaMax = idEta(etaCellMax - epsilon);
-      iPhiMax = idPhi(phiCellMax - epsilon);
-      // if a cell is larger than a tower in eta/phi, calculate the fraction of
-      // the cell area belonging to the first/last/middle towers
-      fracEtaMin = 1.0;
-      fracEtaMax = 1.0;
-      fracEtaMiddle = 1.0;
-      if (iEtaMin != iEtaMax) {
-        fracEtaMin = fabs(eta(iEtaMin) + 0.5 * m_deltaEtaTower - etaCellMin) / segmentation->gridSizeEta();
-        fracEtaMax = fabs(etaCellMax - eta(iEtaMax) + 0.5 * m_deltaEtaTower) / segmentation->gridSizeEta();
-        if ((iEtaMax - iEtaMin - 1) != 0) {
-          fracEtaMiddle = (1 - fracEtaMin - fracEtaMax) / float(iEtaMax - iEtaMin - 1);
-        } else {
-          fracEtaMiddle = 0.0;
-        }
-      }
-      fracPhiMin = 1.0;
-      fracPhiMax = 1.0;
-      fracPhiMiddle = 1.0;
-      if (iPhiMin != iPhiMax) {
-        fracPhiMin =
-            fabs(phi(iPhiMin) + 0.5 * m_deltaPhiTower - phiCellMin) / (2 * M_PI / (double)segmentation->phiBins());
-        fracPhiMax =
-            fabs(phiCellMax - phi(iPhiMax) + 0.5 * m_deltaPhiTower) / (2 * M_PI / (double)segmentation->phiBins());
-        if ((iPhiMax - iPhiMin - 1) != 0) {
-          fracPhiMiddle = (1 - fracPhiMin - fracPhiMax) / float(iPhiMax - iPhiMin - 1);
-        } else {
-          fracPhiMiddle = 0.0;
-        }
+  }
+
+  // transverse energy per unit of cell energy
+  const double sinTheta = 1 / cosh(segmentation->eta(aCellId));
+  for (auto iEta = iEtaMin; iEta <= iEtaMax; iEta++) {
+    if (iEta == iEtaMin) {
+      ratioEta = fracEtaMin;
+    } else if (iEta == iEtaMax) {
+      ratioEta = fracEtaMax;
+    } else {
+      ratioEta = fracEtaMiddle;
+    }
+    for (auto iPhi = iPhiMin; iPhi <= iPhiMax; iPhi++) {
+      if (iPhi == iPhiMin) {
+        ratioPhi = fracPhiMin;
+      } else if (iPhi == iPhiMax) {
+        ratioPhi = fracPhiMax;
+      } else {
+        ratioPhi = fracPhiMiddle;
       }
+      // flat index of the tower, as in TowerGrid
+      aEntries.push_back({static_cast<uint32_t>(iEta * m_nPhiTower + phiNeighbour(iPhi)),
+                          static_cast<float>(sinTheta * ratioEta * ratioPhi)});
+    }
+  }
+}
 
-      // Loop through the appropriate towers and add transverse energy
-      for (auto iEta = iEtaMin; iEta <= iEtaMax; iEta++) {
-        if (iEta == iEtaMin) {
-          ratioEta = fracEtaMin;
-        } else if (iEta == iEtaMax) {
-          ratioEta = fracEtaMax;
-        } else {
-          ratioEta = fracEtaMiddle;
-        }
-        for (auto iPhi = iPhiMin; iPhi <= iPhiMax; iPhi++) {
-          if (iPhi == iPhiMin) {
-            ratioPhi = fracPhiMin;
-          } else if (iPhi == iPhiMax) {
-            ratioPhi = fracPhiMax;
-          } else {
-            ratioPhi = fracPhiMiddle;
-          }
-          aTowers[iEta][phiNeighbour(iPhi)] +=
-              cell.getEnergy() / cosh(segmentation->eta(cell.getCellID())) * ratioEta * ratioPhi;
-          if (fillTowersCells) {
-            m_cellsInTowers[std::make_pair(iEta, phiNeighbour(iPhi))].push_back(cell.clone());
-            if (fabs(etaCellMin) < 1.5 && m_cellsInTowers[std::make_pair(iEta, phiNeighbour(iPhi))].size() > 8)
-              verbose() << "NUM CELLs IN TOWER : " << m_cellsInTowers[std::make_pair(iEta, phiNeighbour(iPhi))].size()
-                        << endmsg;
-          }
-        }
+void CaloTowerTool::CellsIntoTowers(k4::recCalo::CaloTowers& aTowers,
+                                    const edm4hep::CalorimeterHitCollection* aCells,
+                                    dd4hep::DDSegmentation::Segmentation* aSegmentation, SegmentationType aType,
+                                    bool fillTowersCells) const {
+  // indices of the cells in the precomputed towers, if any
+  const PrecomputedTowers* precomputed = nullptr;
+  for (const auto& towers : m_precomputedTowers) {
+    if (towers.segmentation == aSegmentation) {
+      precomputed = &towers;
+    }
+  }
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices;
+  if (precomputed) {
+    std::vector<dd4hep::DDSegmentation::CellID> ids;
+    ids.reserve(aCells->size());
+    for (const auto& cell : *aCells) {
+      ids.push_back(cell.getCellID());
+    }
+    indices.resize(ids.size());
+    precomputed->indexer->indices(ids, indices);
+  }
+
+  // Loop over a collection of calorimeter cells and build calo towers
+  std::span<float> energies = aTowers.grid.energies();
+  std::vector<k4::recCalo::CellTowerMap::Entry> cellEntries;
+  for (size_t i = 0; i < aCells->size(); i++) {
+    const auto cell = (*aCells)[i];
+    std::span<const k4::recCalo::CellTowerMap::Entry> towers;
+    if (precomputed && indices[i] != k4::recCalo::ICaloIndexer::INVALID) {
+      towers = precomputed->map.entries(indices[i]);
+    } else {
+      cellEntries.clear();
+      cellTowers(aSegmentation, aType, cell.getCellID(), cellEntries);
+      towers = cellEntries;
+    }
+    if (towers.empty()) {
+      continue;
+    }
+    // Add transverse energy to the towers
+    // a cell spanning several towers is only stored once
+    for (const auto& tower : towers) {
+      energies[tower.tower] += cell.getEnergy() * tower.weight;
+    }
+    if (fillTowersCells) {
+      for (const auto& tower : towers) {
+        aTowers.grid.addCell(tower.tower, aTowers.cells.size());
       }
+      aTowers.cells.push_back(cell);
     }
   }
 }
@@ -446,22 +525,23 @@ CaloTowerTool::retrieveSegmentation(std::string aReadoutName) {
   return std::make_pair(segmentation, SegmentationType::kWrong);
 }
 
-void CaloTowerTool::attachCells(float eta, float phi, uint halfEtaFin, uint halfPhiFin,
-                                edm4hep::MutableCluster& aEdmCluster,
-                                edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool aEllipse) {
+void CaloTowerTool::attachCells(const k4::recCalo::CaloTowers& aTowers, float eta, float phi, uint halfEtaFin,
+                                uint halfPhiFin, edm4hep::MutableCluster& aEdmCluster,
+                                edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool aEllipse) const {
   int etaId = idEta(eta);
   int phiId = idPhi(phi);
-  std::vector<dd4hep::DDSegmentation::CellID> seen_cellIDs;
+  // cells already attached to this cluster, by index in aTowers.cells
+  aTowers.attachedCells.clear(aTowers.cells.size());
   if (aEllipse) {
     for (int iEta = etaId - halfEtaFin; iEta <= int(etaId + halfEtaFin); iEta++) {
       for (int iPhi = phiId - halfPhiFin; iPhi <= int(phiId + halfPhiFin); iPhi++) {
         if (pow((etaId - iEta) / (halfEtaFin + 0.5), 2) + pow((phiId - iPhi) / (halfPhiFin + 0.5), 2) < 1) {
-          for (auto cell : m_cellsInTowers[std::make_pair(iEta, phiNeighbour(iPhi))]) {
-            if (std::find(seen_cellIDs.begin(), seen_cellIDs.end(), cell.getCellID()) !=
-                seen_cellIDs.end()) { // towers can be smaller than cells in which case a cell belongs to several towers
+          for (auto iCell : towerCells(aTowers, iEta, iPhi)) {
+            const auto& cell = aTowers.cells[iCell];
+            // towers can be smaller than cells in which case a cell belongs to several towers
+            if (!aTowers.attachedCells.mark(iCell)) {
               continue;
             }
-            seen_cellIDs.push_back(cell.getCellID());
             auto cellclone = cell.clone();
             aEdmClusterCells->push_back(cellclone);
             aEdmCluster.addToHits(cellclone);
@@ -472,12 +552,12 @@ void CaloTowerTool::attachCells(float eta, float phi, uint halfEtaFin, uint half
   } else {
     for (int iEta = etaId - halfEtaFin; iEta <= int(etaId + halfEtaFin); iEta++) {
       for (int iPhi = phiId - halfPhiFin; iPhi <= int(phiId + halfPhiFin); iPhi++) {
-        for (auto cell : m_cellsInTowers[std::make_pair(iEta, phiNeighbour(iPhi))]) {
-          if (std::find(seen_cellIDs.begin(), seen_cellIDs.end(), cell.getCellID()) !=
-              seen_cellIDs.end()) { // towers can be smaller than cells in which case a cell belongs to several towers
+        for (auto iCell : towerCells(aTowers, iEta, iPhi)) {
+          const auto& cell = aTowers.cells[iCell];
+          // towers can be smaller than cells in which case a cell belongs to several towers
+          if (!aTowers.attachedCells.mark(iCell)) {
             continue;
           }
-          seen_cellIDs.push_back(cell.getCellID());
           auto cellclone = cell.clone();
           aEdmClusterCells->push_back(cellclone);
           aEdmCluster.addToHits(cellclone);
@@ -3,6 +3,7 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ToolHandle.h"
 
 // k4geo
 #include "detectorSegmentations/FCCSWGridPhiEta_k4geo.h"
@@ -11,12 +12,19 @@
 #include "k4FWCore/DataHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/CellTowerMap.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/ITowerTool.h"
 class IGeoSvc;
 
 // dd4hep
 #include "DDSegmentation/MultiSegmentation.h"
 
+#include <memory>
+#include <span>
+#include <vector>
+
 namespace dd4hep {
 namespace DDSegmentation {
   class Segmentation;
@@ -43,6 +51,11 @@ class Cluster;
  *  Distance in r plays no role, however `\b radiusForPosition` needs to be defined
  *  (e.g. to inner radius of the detector) for the cluster position calculation. By default the radius is equal to 1.
  *
+ *  If '\b calorimeterTools' are given, the towers of every cell of their readouts, with the fractions of the cell in
+ *  each tower, are computed once at initialize, and tower building is then a lookup and a scatter-add.  Each tool
+ *  must have the readout of one of the input collections.  Cells not known to the tools are placed from their
+ *  segmentation in each event, as without the tools.
+ *
  *  For more explanation please [see reconstruction documentation](@ref md_reconstruction_doc_reccalorimeter).
  *
  *  @author Anna Zaborowska
@@ -67,11 +80,10 @@ public:
   virtual void towersNumber(int& nEta, int& nPhi) final override;
   /**  Build calorimeter towers.
    *   Tower is defined by a segment in eta and phi, with the energy from all layers (no r segmentation).
-   *   @param[out] aTowers Calorimeter towers.
-   *   @param[in] fillTowersCells Whether to fill maps of cells into towers, for later use in attachCells
-   *   @return Size of the cell collection.
+   *   @param[in] fillTowersCells Whether to fill the lists of cells in each tower, for later use in attachCells
+   *   @return Calorimeter towers; the number of cells is the size of the cell collections.
    */
-  virtual uint buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells = true) final override;
+  virtual k4::recCalo::CaloTowers buildTowers(bool fillTowersCells = true) const final override;
 
   /**  Get the radius for the position calculation.
    *   @return Radius
@@ -98,15 +110,17 @@ public:
    */
   virtual float phi(int aIdPhi) const final override;
   /**  Find cells belonging to a cluster.
+   *   @param[in] aTowers Calorimeter towers of the event, from buildTowers
    *   @param[in] aEta Position of the middle tower of a cluster in eta
    *   @param[in] aPhi Position of the middle tower of a cluster in phi
    *   @param[in] aHalfEtaFinal Half size of cluster in eta (in units of tower size). Cluster size is 2*aHalfEtaFinal+1
    *   @param[in] aHalfPhiFinal Half size of cluster in phi (in units of tower size). Cluster size is 2*aHalfPhiFinal+1
    *   @param[out] aEdmCluster Cluster where cells are attached to
    */
-  virtual void attachCells(float aEta, float aPhi, uint aHalfEtaFinal, uint aHalfPhiFinal,
-                           edm4hep::MutableCluster& aEdmCluster, edm4hep::CalorimeterHitCollection* aEdmClusterCells,
-                           bool aEllipse = false) final override;
+  virtual void attachCells(const k4::recCalo::CaloTowers& aTowers, float aEta, float aPhi, uint aHalfEtaFinal,
+                           uint aHalfPhiFinal, edm4hep::MutableCluster& aEdmCluster,
+                           edm4hep::CalorimeterHitCollection* aEdmClusterCells,
+                           bool aEllipse = false) const final override;
 
 private:
   /// Type of the segmentation
@@ -121,14 +135,32 @@ private:
    * (in [0, m_nPhiTower) range)
    */
   uint phiNeighbour(int aIPhi) const;
+  /**  Get the cells in a tower, taking into account the full coverage in phi.
+   *   @param[in] aTowers Calorimeter towers of the event.
+   *   @param[in] aIEta ID of an eta tower; there are no cells outside of [0, m_nEtaTower)
+   *   @param[in] aIPhi ID of a phi tower, may be < 0 or >=m_nPhiTower
+   *   @return Indices of the cells in aTowers.cells
+   */
+  std::span<const k4::recCalo::TowerGrid::index_t> towerCells(const k4::recCalo::CaloTowers& aTowers, int aIEta,
+                                                              int aIPhi) const;
+  /**  Find the towers covered by a cell, and the weights of its energy in the towers.
+   *   The weight is the fraction of the cell in the tower divided by cosh(eta).
+   *   @param[in] aSegmentation Segmentation of the calorimeter
+   *   @param[in] aType Type of the segmentation
+   *   @param[in] aCellId ID of the cell
+   *   @param[out] aEntries List to which the towers are added; none are added for layers not used ('\b halfTower')
+   */
+  void cellTowers(const dd4hep::DDSegmentation::Segmentation* aSegmentation, SegmentationType aType,
+                  dd4hep::DDSegmentation::CellID aCellId,
+                  std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) const;
   /**  This is where the cell info is filled into towers
-   *   @param[in] aTowers Calorimeter towers.
+   *   @param[in,out] aTowers Calorimeter towers.
    *   @param[in] aCells Calorimeter cells collection.
    *   @param[in] aSegmentation Segmentation of the calorimeter
    */
-  void CellsIntoTowers(std::vector<std::vector<float>>& aTowers, const edm4hep::CalorimeterHitCollection* aCells,
+  void CellsIntoTowers(k4::recCalo::CaloTowers& aTowers, const edm4hep::CalorimeterHitCollection* aCells,
                        dd4hep::DDSegmentation::Segmentation* aSegmentation, SegmentationType aType,
-                       bool fillTowersCells);
+                       bool fillTowersCells) const;
   /**  Check if the readout name exists. If so, it returns the eta-phi segmentation.
    *   @param[in] aReadoutName Readout name to be retrieved
    */
@@ -205,6 +237,20 @@ private:
   SegmentationType m_hcalEndcapSegmentationType;
   /// Type of segmentation of the hcal forward calorimeter
   SegmentationType m_hcalFwdSegmentationType;
+  /// Geometry tools of the calorimeters; the towers of their cells are precomputed at initialize
+  ToolHandleArray<k4::recCalo::ICalorimeterTool> m_caloTools{
+      this, "calorimeterTools", {}, "Geometry tools of the input readouts, to precompute the cell towers"};
+  /// Towers of the cells of one calorimeter, precomputed at initialize
+  struct PrecomputedTowers {
+    /// Segmentation of the calorimeter (owned by DD4hep)
+    const dd4hep::DDSegmentation::Segmentation* segmentation;
+    /// Indexer of the cells
+    std::unique_ptr<k4::recCalo::ICaloIndexer> indexer;
+    /// Towers of the cells, indexed by indexer
+    k4::recCalo::CellTowerMap map;
+  };
+  /// Precomputed towers, one entry per calorimeter tool
+  std::vector<PrecomputedTowers> m_precomputedTowers;
   /// decoder: only for barrel
   dd4hep::DDSegmentation::BitFieldCoder* m_decoder;
   /// Radius used to calculate cluster position from eta and phi (in mm)
@@ -222,9 +268,6 @@ private:
   int m_nEtaTower;
   /// Number of towers in phi (calculated from m_deltaPhiTower)
   int m_nPhiTower;
-  /// map to cells contained within a tower so they can be attached to a reconstructed cluster (note that fraction of
-  /// their energy assigned to a cluster is not acknowledged)
-  std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> m_cellsInTowers;
   /// Use only a part of the calorimeter (in depth)
   Gaudi::Property<bool> m_useHalfTower{this, "halfTower", false, "Use half tower"};
   Gaudi::Property<uint> m_max_layer{
@@ -16,6 +16,8 @@
 // edm4hep
 #include "edm4hep/CalorimeterHit.h"
 
+#include <vector>
+
 DECLARE_COMPONENT(CreateCaloCells)
 
 CreateCaloCells::CreateCaloCells(const std::string& name, ISvcLocator* svcLoc)
@@ -40,6 +42,7 @@ StatusCode CreateCaloCells::initialize() {
   info() << "remove cells below threshold : " << m_filterCellNoise << endmsg;
   info() << "add position information to the cell : " << m_addPosition << endmsg;
   info() << "emulate crosstalk : " << m_addCrosstalk << endmsg;
+  info() << "sparse noise sampling : " << m_sparseNoise << endmsg;
 
   // Initialization of tools
   // Cell crosstalk tool
@@ -62,24 +65,29 @@ StatusCode CreateCaloCells::initialize() {
       error() << "Unable to retrieve the calo cells noise tool!!!" << endmsg;
       return StatusCode::FAILURE;
     }
-    // Geometry settings
+  }
+  // Geometry settings.  Needed for noise, and used if given to index the cells.
+  if (m_addCellNoise || m_filterCellNoise || !m_geoTool.empty()) {
     if (!m_geoTool.retrieve()) {
       error() << "Unable to retrieve the geometry tool!!!" << endmsg;
       return StatusCode::FAILURE;
     }
-    // Prepare map of all existing cells in calorimeter to add noise to all
-    StatusCode sc_prepareCells = m_geoTool->prepareEmptyCells(m_cellsMap);
-    if (sc_prepareCells.isFailure()) {
+    if (m_addCellNoise && m_geoTool->cellIDs().empty()) {
       error() << "Unable to create empty cells!" << endmsg;
       return StatusCode::FAILURE;
     }
-    verbose() << "Initialised empty cell map with size " << m_cellsMap.size() << endmsg;
-    // noise filtering erases cells from the cell map after each event, so we need
-    // to backup the empty cell map for later reuse
-    if (m_addCellNoise && m_filterCellNoise) {
-      m_emptyCellsMap = m_cellsMap;
+    if (m_addCellNoise && m_filterCellNoise && m_sparseNoise) {
+      info() << "sparse noise sampling for " << m_geoTool->cellIDs().size() << " cells" << endmsg;
     }
+    m_indexer = m_geoTool->indexer();
   }
+  if (!m_indexer) {
+    info() << "No cell indexer available; cell energies will be summed using a hash map" << endmsg;
+  }
+  // Per-event working storage.
+  m_accumulators = std::make_unique<k4::recCalo::ObjectPool<k4::recCalo::CellEnergyAccumulator>>(
+      [this]() { return std::make_unique<k4::recCalo::CellEnergyAccumulator>(m_indexer.get()); });
+
   if (m_addPosition) {
     m_volman = m_geoSvc->getDetector()->volumeManager();
   }
@@ -119,37 +127,36 @@ StatusCode CreateCaloCells::execute(const EventContext&) const {
     }
   }
 
-  // 0. Clear all cells
-  if (m_addCellNoise) {
-    // if cells are not filtered, the map has same size in each event, equal to the total number
-    // of cells in the calorimeter, so we can just reset the values to 0
-    // if cells are filtered, during each event they are removed from the cellsMap, so one has to
-    // restore the initial map of all empty cells
-    if (!m_filterCellNoise)
-      std::for_each(m_cellsMap.begin(), m_cellsMap.end(), [](std::pair<const uint64_t, double>& p) { p.second = 0; });
-    else
-      m_cellsMap = m_emptyCellsMap;
-  } else {
-    m_cellsMap.clear();
-  }
+  // With sparse noise, only empty cells passing the filter are added in step 4.
+  const bool sparseNoise = m_addCellNoise && m_filterCellNoise && m_sparseNoise;
+
+  // Accumulator for the cell energies, reused between events.
+  auto acc = m_accumulators->acquire();
+  acc->clear();
 
   // 1. Merge energy deposits into cells
-  // If running with noise map already was prepared. Otherwise it is being
-  // created below
-  for (const auto& hit : *hits) {
-    verbose() << "CellID : " << hit.getCellID() << endmsg;
-    m_cellsMap[hit.getCellID()] += hit.getEnergy();
+  {
+    std::vector<uint64_t> ids;
+    std::vector<double> energies;
+    ids.reserve(hits->size());
+    energies.reserve(hits->size());
+    for (const auto& hit : *hits) {
+      verbose() << "CellID : " << hit.getCellID() << endmsg;
+      ids.push_back(hit.getCellID());
+      energies.push_back(hit.getEnergy());
+    }
+    acc->add(ids, energies);
   }
-  debug() << "Number of calorimeter cells after merging of hits: " << m_cellsMap.size() << endmsg;
+  debug() << "Number of calorimeter cells after merging of hits: " << acc->size() << endmsg;
 
   // 2. Emulate cross-talk (if asked)
   if (m_addCrosstalk) {
-    // Derive the cross-talk contributions without affecting yet the nominal energy
-    // (one has to emulate crosstalk based on cells free from any cross-talk contributions)
-    m_CrosstalkCellsMap.clear(); // this is a temporary map to hold energy exchange due to cross-talk, without affecting
-                                 // yet the nominal energy
+    // Derive the cross-talk contributions from the nominal energies,
+    // free from any cross-talk contributions
+    std::vector<std::pair<uint64_t, double>> nominalCells;
+    acc->exportTo(nominalCells);
     // loop over cells with nominal energies
-    for (const auto& this_cell : m_cellsMap) {
+    for (const auto& this_cell : nominalCells) {
       uint64_t this_cellId = this_cell.first;
       auto vec_neighbours = m_crosstalksTool->getNeighbours(this_cellId); // a span of neighbour IDs
       auto vec_crosstalks = m_crosstalksTool->getCrosstalks(this_cellId); // a span of crosstalk coefficients
@@ -157,37 +164,45 @@ StatusCode CreateCaloCells::execute(const EventContext&) const {
       for (unsigned int i_cell = 0; i_cell < vec_neighbours.size(); i_cell++) {
         // signal transfer = energy deposit brought by EM shower hits * crosstalk coefficient
         double signal_transfer = this_cell.second * vec_crosstalks[i_cell];
-        // for the cell under study, record the signal transfer that will be subtracted from its final cell energy
-        m_CrosstalkCellsMap[this_cellId] -= signal_transfer;
-        // for the crosstalk neighbour, record the signal transfer that will be added to its final cell energy
-        m_CrosstalkCellsMap[vec_neighbours[i_cell]] += signal_transfer;
+        // for the cell under study, subtract the signal transfer from its final cell energy
+        acc->add(this_cellId, -signal_transfer);
+        // for the crosstalk neighbour, add the signal transfer to its final cell energy
+        acc->add(vec_neighbours[i_cell], signal_transfer);
       }
     }
+  }
 
-    // apply the cross-talk contributions on the nominal cell-energy map
-    for (const auto& this_cell : m_CrosstalkCellsMap) {
-      m_cellsMap[this_cell.first] += this_cell.second;
-    }
+  // Take all cells of the calorimeter if adding noise to them (unless using sparse noise),
+  // or only those with deposits otherwise.
+  std::vector<std::pair<uint64_t, double>> cells;
+  if (m_addCellNoise && !sparseNoise) {
+    acc->exportAll(m_geoTool->cellIDs(), cells);
+  } else {
+    acc->sortByIndex();
+    acc->exportTo(cells);
   }
 
   // 3. Calibrate simulation energy to EM scale
   if (m_doCellCalibration) {
-    m_calibTool->calibrate(m_cellsMap);
+    m_calibTool->calibrate(cells);
   }
 
   // 4. Add noise to all cells
-  if (m_addCellNoise) {
-    m_noiseTool->addRandomCellNoise(m_cellsMap);
-  }
-
   // 5. Filter cells
-  if (m_filterCellNoise) {
-    m_noiseTool->filterCellNoise(m_cellsMap);
+  if (sparseNoise) {
+    m_noiseTool->addFilteredCellNoise(cells, m_geoTool->cellIDs());
+  } else {
+    if (m_addCellNoise) {
+      m_noiseTool->addRandomCellNoise(cells);
+    }
+    if (m_filterCellNoise) {
+      m_noiseTool->filterCellNoise(cells);
+    }
   }
 
   // 6. Copy information to CaloHitCollection
   edm4hep::CalorimeterHitCollection* edmCellsCollection = new edm4hep::CalorimeterHitCollection();
-  for (const auto& cell : m_cellsMap) {
+  for (const auto& cell : cells) {
     if (m_addCellNoise || (!m_addCellNoise && cell.second != 0)) {
       auto newCell = edmCellsCollection->create();
       newCell.setEnergy(cell.second);
@@ -5,10 +5,12 @@
 #include "k4FWCore/DataHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/CellEnergyAccumulator.h"
 #include "RecCaloCommon/ICalibrateCaloHitsTool.h"
 #include "RecCaloCommon/ICaloReadCrosstalkMap.h"
 #include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/INoiseCaloCellsTool.h"
+#include "RecCaloCommon/ObjectPool.h"
 
 // Gaudi
 #include "Gaudi/Algorithm.h"
@@ -32,12 +34,15 @@ class IGeoSvc;
  *  Tube geometry with PhiEta segmentation expected.
  *
  *  Flow of the program:
- *  1/ Merge Geant4 energy deposits with same cellID
+ *  1/ Merge Geant4 energy deposits with same cellID (see CellEnergyAccumulator;
+ *     this uses the cell indexer of the geometry tool, if it has one)
  *  2/ Emulate cross-talk (if switched on)
  *  3/ Calibrate to electromagnetic scale (if calibration switched on)
  *  4/ Add random noise to each cell (if noise switched on)
  *  5/ Filter cells and remove those with energy below threshold (if noise +
- * filtering switched on)
+ * filtering switched on).  With sparseNoise set, steps 4 and 5 are done
+ * together: cells with deposits get the full noise, while for the empty
+ * cells only those passing the filter are sampled.
  *
  *  Tools called:
  *    - CalibrateCaloHitsTool
@@ -60,6 +65,9 @@ public:
 
   virtual StatusCode execute(const EventContext&) const override;
 
+  /// All per-event state is local to execute(), so events may be processed concurrently.
+  bool isReEntrant() const override { return true; }
+
 private:
   /// Build m_caloTypes, giving calorimeter type per system ID.
   void findCaloTypes();
@@ -82,6 +90,10 @@ private:
   /// Save only cells with energy above threshold?
   Gaudi::Property<bool> m_filterCellNoise{this, "filterCellNoise", false,
                                           "Save only cells with energy above threshold?"};
+  /// Sample only the empty cells passing the noise filter? (if addCellNoise and filterCellNoise are both set)
+  Gaudi::Property<bool> m_sparseNoise{this, "sparseNoise", false,
+                                      "Sample noise only for empty cells passing the filter (statistically "
+                                      "equivalent to adding noise to all cells and filtering)"};
   // Add position information to the cells? (based on Volumes, not cells, could be improved)
   Gaudi::Property<bool> m_addPosition{this, "addPosition", false, "Add position information to the cells?"};
 
@@ -96,12 +108,10 @@ private:
   /// Pointer to the geometry service
   ServiceHandle<IGeoSvc> m_geoSvc;
   dd4hep::VolumeManager m_volman;
-  /// Maps of cell IDs (corresponding to DD4hep IDs) on final energies to be used for clustering
-  mutable std::unordered_map<uint64_t, double> m_cellsMap;
-  /// Maps of cell IDs (corresponding to DD4hep IDs) on transfer of signals due to crosstalk
-  mutable std::unordered_map<uint64_t, double> m_CrosstalkCellsMap;
-  /// Maps of cell IDs with zero energy, for all cells in calo (needed if addCellNoise and filterCellNoise are both set)
-  mutable std::unordered_map<uint64_t, double> m_emptyCellsMap;
+  /// Indexer for the cells of the geometry tool, if available.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_indexer;
+  /// Accumulators for the per-event cell energies, one per concurrent call.
+  std::unique_ptr<k4::recCalo::ObjectPool<k4::recCalo::CellEnergyAccumulator>> m_accumulators;
 
   /// Indexed by system ID, giving the calorimeter type word.
   /// Non-calorimeter system IDs are set to 0.
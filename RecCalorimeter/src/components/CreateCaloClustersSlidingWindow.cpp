@@ -7,6 +7,12 @@
 #include "edm4hep/ClusterCollection.h"
 #include "edm4hep/Vector3f.h"
 
+#include "RecCaloCommon/TowerBucketGrid.h"
+#include "RecCaloCommon/TowerEnergySharing.h"
+#include "RecCaloCommon/TowerSumTable.h"
+
+#include <algorithm>
+
 DECLARE_COMPONENT(CreateCaloClustersSlidingWindow)
 
 CreateCaloClustersSlidingWindow::CreateCaloClustersSlidingWindow(const std::string& name, ISvcLocator* svcLoc)
@@ -38,26 +44,22 @@ StatusCode CreateCaloClustersSlidingWindow::initialize() {
 }
 
 StatusCode CreateCaloClustersSlidingWindow::execute(const EventContext&) const {
-  // 1. Create calorimeter towers (calorimeter grid in eta phi, all layers merged)
-  m_towers.assign(m_nEtaTower, std::vector<float>(m_nPhiTower, 0));
   // Create an output collection
   auto edmClusters = m_clusters.createAndPut();
   auto edmClusterCells = m_clusterCells.createAndPut();
+  // 1. Create calorimeter towers (calorimeter grid in eta phi, all layers merged)
+  k4::recCalo::CaloTowers caloTowers = m_towerTool->buildTowers(m_attachCells);
   // Check if the tower building succeeded
-  if (m_towerTool->buildTowers(m_towers, m_attachCells) == 0) {
+  if (caloTowers.nCells == 0) {
     debug() << "Empty cell collection." << endmsg;
     return StatusCode::SUCCESS;
   }
+  // the grid has at least as many towers in eta as the sliding window
+  caloTowers.grid.extendRows(m_nEtaTower);
+  const k4::recCalo::TowerGrid& towers = caloTowers.grid;
   // 2. Find local maxima with sliding window, build preclusters, calculate their barycentre position
-  // calculate the sum of first m_nEtaWindow bins in eta, for each phi tower
-  std::vector<float> sumOverEta(m_nPhiTower, 0);
-  for (int iEta = 0; iEta < m_nEtaWindow; iEta++) {
-    std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta].begin(), sumOverEta.begin(),
-                   std::plus<float>());
-  }
-
   // preclusters with phi, eta weighted position and transverse energy
-  m_preClusters.clear();
+  std::vector<cluster> preClusters;
   int halfEtaPos = floor(m_nEtaPosition / 2.);
   int halfPhiPos = floor(m_nPhiPosition / 2.);
   float posEta = 0;
@@ -71,216 +73,141 @@ StatusCode CreateCaloClustersSlidingWindow::execute(const EventContext&) const {
   int idEtaFin = 0;
   int idPhiFin = 0;
 
-  // loop over all Eta slices starting at the half of the first window
+  // sliding window
   int halfEtaWin = floor(m_nEtaWindow / 2.);
   int halfPhiWin = floor(m_nPhiWindow / 2.);
-  float sumWindow = 0;
-  float sumPhiSlicePrevEtaWin = 0;
-  float sumPhiSliceNextEtaWin = 0;
-  float sumFirstPhiSlice = 0;
-  float sumLastPhiSlice = 0;
-  bool toRemove = false;
-  // one slice in eta = window, now only sum over window elements in phi
+
+  // summed-area tables of the towers, with enough ghost columns in phi for all the windows,
+  // so that the sum over any window takes constant time
+  k4::recCalo::TowerSumTable sums(m_nEtaTower, m_nPhiTower, std::max({halfPhiWin + 1, halfPhiPos, halfPhiFin}));
+  const int energyPlane = sums.addPlane(towers.energies());
+  // towers weighted with their position, for the barycentre (in phi, with the position of the unwrapped index)
+  std::vector<float> etaTowers(m_nEtaTower);
+  for (int iEta = 0; iEta < m_nEtaTower; iEta++) {
+    etaTowers[iEta] = m_towerTool->eta(iEta);
+  }
+  std::vector<float> phiTowers(m_nPhiTower + 2 * sums.nGhost());
+  for (int iPhi = -sums.nGhost(); iPhi < m_nPhiTower + sums.nGhost(); iPhi++) {
+    phiTowers[iPhi + sums.nGhost()] = m_towerTool->phi(iPhi);
+  }
+  const int etaPlane =
+      sums.addPlane([&](int iEta, int iPhi) { return etaTowers[iEta] * towers[iEta][sums.wrapPhi(iPhi)]; });
+  const int phiPlane = sums.addPlane(
+      [&](int iEta, int iPhi) { return phiTowers[iPhi + sums.nGhost()] * towers[iEta][sums.wrapPhi(iPhi)]; });
+
+  // loop over all Eta slices starting at the half of the first window
+  std::vector<int> seeds;
   for (int iEta = halfEtaWin; iEta < m_nEtaTower - halfEtaWin; iEta++) {
-    // sum the first window in phi
-    for (int iPhiWindow = -halfPhiWin; iPhiWindow <= halfPhiWin; iPhiWindow++) {
-      sumWindow += sumOverEta[phiNeighbour(iPhiWindow)];
-    }
-    // loop over all the phi slices
-    for (int iPhi = 0; iPhi < m_nPhiTower; iPhi++) {
-      // if energy is above threshold, it may be a precluster
-      if (sumWindow > m_energyThreshold) {
-        // test local maximum in phi
-        // check closest neighbour on the right
-        if (sumOverEta[phiNeighbour(iPhi - halfPhiWin)] < sumOverEta[phiNeighbour(iPhi + halfPhiWin + 1)]) {
-          toRemove = true;
-        }
-        // check closest neighbour on the left
-        if (sumOverEta[phiNeighbour(iPhi + halfPhiWin)] < sumOverEta[phiNeighbour(iPhi - halfPhiWin - 1)]) {
-          toRemove = true;
-        }
-        // test local maximum in eta
-        // check closest neighbour on the right (if it is not the first window)
-        if (iEta > halfEtaWin) {
-          for (int iPhiWindowLocalCheck = iPhi - halfPhiWin; iPhiWindowLocalCheck <= iPhi + halfPhiWin;
-               iPhiWindowLocalCheck++) {
-            sumPhiSlicePrevEtaWin += m_towers[iEta - halfEtaWin - 1][phiNeighbour(iPhiWindowLocalCheck)];
-            sumLastPhiSlice += m_towers[iEta + halfEtaWin][phiNeighbour(iPhiWindowLocalCheck)];
-          }
-          if (sumPhiSlicePrevEtaWin > sumLastPhiSlice) {
-            toRemove = true;
-          }
-        }
-        // check closest neighbour on the left (if it is not the last window)
-        if (iEta < m_nEtaTower - halfEtaWin - 1) {
-          for (int iPhiWindowLocalCheck = iPhi - halfPhiWin; iPhiWindowLocalCheck <= iPhi + halfPhiWin;
-               iPhiWindowLocalCheck++) {
-            sumPhiSliceNextEtaWin += m_towers[iEta + halfEtaWin + 1][phiNeighbour(iPhiWindowLocalCheck)];
-            sumFirstPhiSlice += m_towers[iEta - halfEtaWin][phiNeighbour(iPhiWindowLocalCheck)];
-          }
-          if (sumPhiSliceNextEtaWin > sumFirstPhiSlice) {
-            toRemove = true;
-          }
-        }
-        sumFirstPhiSlice = 0;
-        sumLastPhiSlice = 0;
-        sumPhiSlicePrevEtaWin = 0;
-        sumPhiSliceNextEtaWin = 0;
-        // Build precluster
-        if (!toRemove) {
-          // Calculate barycentre position (usually smaller window used to reduce noise influence)
-          posEta = 0;
-          posPhi = 0;
-          sumEnergyPos = 0;
-          // weighted mean for position in eta and phi
-          for (int ipEta = iEta - halfEtaPos; ipEta <= iEta + halfEtaPos; ipEta++) {
-            for (int ipPhi = iPhi - halfPhiPos; ipPhi <= iPhi + halfPhiPos; ipPhi++) {
-              posEta += m_towerTool->eta(ipEta) * m_towers[ipEta][phiNeighbour(ipPhi)];
-              posPhi += m_towerTool->phi(ipPhi) * m_towers[ipEta][phiNeighbour(ipPhi)];
-              sumEnergyPos += m_towers[ipEta][phiNeighbour(ipPhi)];
-            }
-          }
-          // If too small energy in the position window, calculate the position in the whole sliding window
-          // Assigns correct position for cases with maximum energy deposits close to the border in eta
-          if (sumEnergyPos > m_energyThresholdFraction * m_energyThreshold) {
-            posEta /= sumEnergyPos;
-            posPhi /= sumEnergyPos;
-          } else {
-            posEta = 0;
-            posPhi = 0;
-            sumEnergyPos = 0;
-            for (int ipEta = iEta - halfEtaWin; ipEta <= iEta + halfEtaWin; ipEta++) {
-              for (int ipPhi = iPhi - halfPhiWin; ipPhi <= iPhi + halfPhiWin; ipPhi++) {
-                posEta += m_towerTool->eta(ipEta) * m_towers[ipEta][phiNeighbour(ipPhi)];
-                posPhi += m_towerTool->phi(ipPhi) * m_towers[ipEta][phiNeighbour(ipPhi)];
-                sumEnergyPos += m_towers[ipEta][phiNeighbour(ipPhi)];
-              }
-            }
-            posEta /= sumEnergyPos;
-            posPhi /= sumEnergyPos;
-          }
-          if (fabs(posPhi) > M_PI) {
-            posPhi += -2 * M_PI * posPhi / fabs(posPhi);
-          }
-          // Calculate final cluster energy
-          sumEnergyFin = 0;
-          // Final cluster position
-          idEtaFin = m_towerTool->idEta(posEta);
-          idPhiFin = m_towerTool->idPhi(posPhi);
-          // Recalculating the energy within the final cluster size
-          for (int ipEta = idEtaFin - halfEtaFin; ipEta <= idEtaFin + halfEtaFin; ipEta++) {
-            for (int ipPhi = idPhiFin - halfPhiFin; ipPhi <= idPhiFin + halfPhiFin; ipPhi++) {
-              if (ipEta >= 0 && ipEta < m_nEtaTower) { // check if we are not outside of map in eta
-                if (m_ellipseFinalCluster) {
-                  if (pow((ipEta - idEtaFin) / (m_nEtaFinal / 2.), 2) +
-                          pow((ipPhi - idPhiFin) / (m_nPhiFinal / 2.), 2) <
-                      1) {
-                    sumEnergyFin += m_towers[ipEta][phiNeighbour(ipPhi)];
-                  }
-                } else {
-                  sumEnergyFin += m_towers[ipEta][phiNeighbour(ipPhi)];
-                }
-              }
-            }
-          }
-          // check if changing the barycentre did not decrease energy below threshold
-          if (sumEnergyFin > m_energyThreshold) {
-            cluster newPreCluster;
-            newPreCluster.eta = posEta;
-            newPreCluster.phi = posPhi;
-            newPreCluster.transEnergy = sumEnergyFin;
-            m_preClusters.push_back(newPreCluster);
-          }
-        }
+    // windows above threshold that are local maxima in eta and phi
+    sums.findSeeds(energyPlane, iEta, halfEtaWin, halfPhiWin, m_energyThreshold, seeds);
+    for (int iPhi : seeds) {
+      // Build precluster
+      // Calculate barycentre position (usually smaller window used to reduce noise influence)
+      sumEnergyPos = sums.windowSum(energyPlane, iEta, iPhi, halfEtaPos, halfPhiPos);
+      // If too small energy in the position window, calculate the position in the whole sliding window
+      // Assigns correct position for cases with maximum energy deposits close to the border in eta
+      if (sumEnergyPos > m_energyThresholdFraction * m_energyThreshold) {
+        posEta = sums.windowSum(etaPlane, iEta, iPhi, halfEtaPos, halfPhiPos) / sumEnergyPos;
+        posPhi = sums.windowSum(phiPlane, iEta, iPhi, halfEtaPos, halfPhiPos) / sumEnergyPos;
+      } else {
+        sumEnergyPos = sums.windowSum(energyPlane, iEta, iPhi, halfEtaWin, halfPhiWin);
+        posEta = sums.windowSum(etaPlane, iEta, iPhi, halfEtaWin, halfPhiWin) / sumEnergyPos;
+        posPhi = sums.windowSum(phiPlane, iEta, iPhi, halfEtaWin, halfPhiWin) / sumEnergyPos;
+      }
+      if (fabs(posPhi) > M_PI) {
+        posPhi += -2 * M_PI * posPhi / fabs(posPhi);
+      }
+      // Final cluster position
+      idEtaFin = m_towerTool->idEta(posEta);
+      idPhiFin = m_towerTool->idPhi(posPhi);
+      // Recalculating the energy within the final cluster size (towers outside of the map in eta are skipped)
+      if (m_ellipseFinalCluster) {
+        sumEnergyFin = sums.ellipseSum(energyPlane, idEtaFin, idPhiFin, halfEtaFin, halfPhiFin, m_nEtaFinal / 2.,
+                                       m_nPhiFinal / 2.);
+      } else {
+        sumEnergyFin = sums.windowSum(energyPlane, idEtaFin, idPhiFin, halfEtaFin, halfPhiFin);
+      }
+      // check if changing the barycentre did not decrease energy below threshold
+      if (sumEnergyFin > m_energyThreshold) {
+        cluster newPreCluster;
+        newPreCluster.eta = posEta;
+        newPreCluster.phi = posPhi;
+        newPreCluster.transEnergy = sumEnergyFin;
+        preClusters.push_back(newPreCluster);
       }
-      toRemove = false;
-      // finish processing that window in phi, shift window to the next phi tower
-      // substract first phi tower in current window
-      sumWindow -= sumOverEta[phiNeighbour(iPhi - halfPhiWin)];
-      // add next phi tower to the window
-      sumWindow += sumOverEta[phiNeighbour(iPhi + halfPhiWin + 1)];
-    }
-    sumWindow = 0;
-    // finish processing that slice, shift window to next eta tower
-    if (iEta < m_nEtaTower - halfEtaWin - 1) {
-      // substract first eta slice in current window
-      std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta - halfEtaWin].begin(), sumOverEta.begin(),
-                     std::minus<float>());
-      // add next eta slice to the window
-      std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta + halfEtaWin + 1].begin(), sumOverEta.begin(),
-                     std::plus<float>());
     }
   }
 
-  debug() << "Pre-clusters size before duplicates removal: " << m_preClusters.size() << endmsg;
+  debug() << "Pre-clusters size before duplicates removal: " << preClusters.size() << endmsg;
 
   // 4. Sort the preclusters according to the transverse energy (descending)
-  std::sort(m_preClusters.begin(), m_preClusters.end(),
+  std::sort(preClusters.begin(), preClusters.end(),
             [](cluster clu1, cluster clu2) { return clu1.transEnergy > clu2.transEnergy; });
 
   // 5. Remove duplicates
-  for (auto it1 = m_preClusters.begin(); it1 != m_preClusters.end(); it1++) {
-    // loop over all clusters with energy lower than it1 (sorting), erase if too close
-    for (auto it2 = it1 + 1; it2 != m_preClusters.end();) {
-      if ((abs(int(m_towerTool->idEta((*it1).eta) - m_towerTool->idEta((*it2).eta))) < m_nEtaDuplicates) &&
-          ((abs(int(m_towerTool->idPhi((*it1).phi) - m_towerTool->idPhi((*it2).phi))) < m_nPhiDuplicates) ||
-           (abs(int(m_towerTool->idPhi((*it1).phi) - m_towerTool->idPhi((*it2).phi))) >
-            m_nPhiTower - m_nPhiDuplicates))) {
-        m_preClusters.erase(it2);
-      } else {
-        it2++;
+  // a pre-cluster is removed if a kept one of higher energy is too close; the kept clusters near each pre-cluster
+  // are found from buckets of towers, rather than by comparing all pairs
+  std::vector<int> idEtaPreClusters(preClusters.size());
+  std::vector<int> idPhiPreClusters(preClusters.size());
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    idEtaPreClusters[iClu] = m_towerTool->idEta(preClusters[iClu].eta);
+    idPhiPreClusters[iClu] = m_towerTool->idPhi(preClusters[iClu].phi);
+  }
+  std::vector<k4::recCalo::TowerBucketGrid::index_t> neighbours;
+  k4::recCalo::TowerBucketGrid duplicatesGrid(m_nEtaTower, m_nPhiTower, m_nEtaDuplicates, m_nPhiDuplicates);
+  duplicatesGrid.fill(idEtaPreClusters, idPhiPreClusters);
+  std::vector<bool> isDuplicate(preClusters.size(), false);
+  size_t nKept = 0;
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    duplicatesGrid.query(idEtaPreClusters[iClu], idPhiPreClusters[iClu], m_nEtaDuplicates - 1,
+                         m_nPhiDuplicates - 1, neighbours);
+    // only the clusters with higher energy (sorting) which are kept can remove this one
+    for (auto iOther : neighbours) {
+      if (iOther >= iClu) {
+        break;
+      }
+      if (!isDuplicate[iOther] && abs(idEtaPreClusters[iOther] - idEtaPreClusters[iClu]) < m_nEtaDuplicates &&
+          ((abs(idPhiPreClusters[iOther] - idPhiPreClusters[iClu]) < m_nPhiDuplicates) ||
+           (abs(idPhiPreClusters[iOther] - idPhiPreClusters[iClu]) > m_nPhiTower - m_nPhiDuplicates))) {
+        isDuplicate[iClu] = true;
+        break;
       }
     }
+    if (!isDuplicate[iClu]) {
+      preClusters[nKept] = preClusters[iClu];
+      idEtaPreClusters[nKept] = idEtaPreClusters[iClu];
+      idPhiPreClusters[nKept] = idPhiPreClusters[iClu];
+      nKept++;
+    }
   }
-  debug() << "Pre-clusters size after duplicates removal: " << m_preClusters.size() << endmsg;
+  preClusters.resize(nKept);
+  idEtaPreClusters.resize(nKept);
+  idPhiPreClusters.resize(nKept);
+  debug() << "Pre-clusters size after duplicates removal: " << preClusters.size() << endmsg;
 
   // 6. Create final clusters
   // currently only role of r is to calculate x,y,z position
   double radius = m_towerTool->radiusForPosition();
-  for (const auto clu : m_preClusters) {
+  // energy sharing between clusters overlapping in the towers of the final cluster size
+  k4::recCalo::TowerEnergySharing sharing(m_nEtaTower, m_nPhiTower, halfEtaFin, halfPhiFin);
+  // energies of the towers, from their transverse energies
+  std::vector<float> sharingEnergies;
+  if (m_energySharingCorrection) {
+    sharing.fill(idEtaPreClusters, idPhiPreClusters);
+    sharingEnergies.resize(towers.size());
+    for (int iEta = 0; iEta < m_nEtaTower; iEta++) {
+      const auto coshEta = cosh(m_towerTool->eta(iEta));
+      for (int iPhi = 0; iPhi < m_nPhiTower; iPhi++) {
+        sharingEnergies[towers.tower(iEta, iPhi)] = towers[iEta][iPhi] * coshEta;
+      }
+    }
+  }
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    const auto& clu = preClusters[iClu];
     float clusterEnergy = clu.transEnergy * cosh(clu.eta);
     // apply energy sharing correction (if flag set to true)
     if (m_energySharingCorrection) {
-      int idEtaCl = m_towerTool->idEta(clu.eta);
-      int idPhiCl = m_towerTool->idPhi(clu.phi);
-      // sum of energies in other clusters in each eta-phi tower of our current cluster (idEtaCl, idPhiCl)
-      std::vector<std::vector<float>> sumEnergySharing;
-      sumEnergySharing.assign(m_nEtaFinal, std::vector<float>(m_nPhiFinal, 0));
-      // loop over all clusters and check if they have any tower in common with our current cluster
-      for (const auto cluSharing : m_preClusters) {
-        int idEtaClShare = m_towerTool->idEta(cluSharing.eta);
-        int idPhiClShare = m_towerTool->idPhi(cluSharing.phi);
-        if (idEtaCl != idEtaClShare && idPhiCl != idPhiClShare) {
-          // check for overlap between clusters
-          if (abs(idEtaClShare - idEtaCl) < m_nEtaFinal &&
-              ((abs(idPhiClShare - idPhiCl) < m_nPhiFinal) ||
-               (abs(idPhiClShare - idPhiCl) > m_nPhiTower - m_nPhiFinal))) {
-            // add energy in shared towers to sumEnergySharing[][]
-            for (int iEta = std::max(idEtaCl, idEtaClShare) - halfEtaFin;
-                 iEta <= std::min(idEtaCl, idEtaClShare) + halfEtaFin; iEta++) {
-              for (int iPhi = std::max(idPhiCl, idPhiClShare) - halfPhiFin;
-                   iEta <= std::min(idPhiCl, idPhiClShare) + halfPhiFin; iPhi++) {
-                if (iEta >= 0 && iEta < m_nEtaTower) { // check if we are not outside of map in eta
-                  sumEnergySharing[iEta - idEtaCl + halfEtaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)] +=
-                      m_towers[iEta][phiNeighbour(iPhi)] * cosh(m_towerTool->eta(iEta));
-                }
-              }
-            }
-          }
-        }
-      }
-      // apply the actual correction: substract the weighted energy contributions in other clusters
-      for (int iEta = idEtaCl - halfEtaFin; iEta <= idEtaCl + halfEtaFin; iEta++) {
-        for (int iPhi = idPhiCl - halfPhiFin; iPhi <= idPhiCl + halfPhiFin; iPhi++) {
-          if (iEta - idEtaCl + halfEtaFin >= 0)
-            if (sumEnergySharing[iEta - idEtaCl + halfEtaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)] != 0) {
-              float sumButOne =
-                  sumEnergySharing[iEta - idEtaCl + halfEtaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)];
-              float towerEnergy = m_towers[iEta][phiNeighbour(iPhi)] * cosh(m_towerTool->eta(iEta));
-              clusterEnergy -= towerEnergy * sumButOne / (sumButOne + towerEnergy);
-            }
-        }
-      }
+      clusterEnergy = sharing.correct(sharingEnergies, iClu, clusterEnergy);
     }
     // save the clusters in our EDM
     // check ET thereshold once more (ET could change with the energy sharing correction)
@@ -290,7 +217,7 @@ StatusCode CreateCaloClustersSlidingWindow::execute(const EventContext&) const {
       edmCluster.setEnergy(clusterEnergy);
       if (m_attachCells) {
         debug() << "Attaching cells to the clusters." << endmsg;
-        m_towerTool->attachCells(clu.eta, clu.phi, halfEtaFin, halfPhiFin, edmCluster, edmClusterCells,
+        m_towerTool->attachCells(caloTowers, clu.eta, clu.phi, halfEtaFin, halfPhiFin, edmCluster, edmClusterCells,
                                  m_ellipseFinalCluster);
       }
       debug() << "Cluster eta: " << clu.eta << " phi: " << clu.phi << " x: " << edmCluster.getPosition().x
@@ -302,12 +229,3 @@ StatusCode CreateCaloClustersSlidingWindow::execute(const EventContext&) const {
 }
 
 StatusCode CreateCaloClustersSlidingWindow::finalize() { return Gaudi::Algorithm::finalize(); }
-
-unsigned int CreateCaloClustersSlidingWindow::phiNeighbour(int aIPhi) const {
-  if (aIPhi < 0) {
-    return m_nPhiTower + aIPhi;
-  } else if (aIPhi >= m_nPhiTower) {
-    return aIPhi % m_nPhiTower;
-  }
-  return aIPhi;
-}
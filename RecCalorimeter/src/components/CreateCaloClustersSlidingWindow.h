@@ -83,13 +83,6 @@ private:
     float phi;
   };
 
-  /**  Correct way to access the neighbour of the phi tower, taking into account the full coverage in phi.
-   *   Full coverage means that first tower in phi, with ID = 0 is a direct neighbour
-   *   of the last tower in phi with ID = m_nPhiTower - 1).
-   *   @param[in] aIPhi requested ID of a phi tower, may be < 0 or >= m_nPhiTower
-   *   @return  ID of a tower - shifted and corrected (in [0, m_nPhiTower) range)
-   */
-  unsigned int phiNeighbour(int aIPhi) const;
   /// Handle for calo clusters (output collection)
   mutable k4FWCore::DataHandle<edm4hep::ClusterCollection> m_clusters{"calo/clusters", Gaudi::DataHandle::Writer, this};
   /// Handle for calo cluster cells (output collection)
@@ -97,10 +90,6 @@ private:
                                                                                  Gaudi::DataHandle::Writer, this};
   /// Handle for the tower building tool
   mutable ToolHandle<k4::recCalo::ITowerTool> m_towerTool;
-  // calorimeter towers
-  mutable std::vector<std::vector<float>> m_towers;
-  /// Vector of pre-clusters
-  mutable std::vector<cluster> m_preClusters;
   /// number of towers in eta (calculated from m_deltaEtaTower and the eta size of the first layer)
   int m_nEtaTower;
   /// Number of towers in phi (calculated from m_deltaPhiTower)
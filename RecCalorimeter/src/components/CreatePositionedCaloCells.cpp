@@ -11,6 +11,10 @@
 #include "edm4hep/CalorimeterHit.h"
 #include <k4FWCore/MetadataUtils.h>
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 DECLARE_COMPONENT(CreatePositionedCaloCells)
 
 CreatePositionedCaloCells::CreatePositionedCaloCells(const std::string& name, ISvcLocator* svcLoc)
@@ -40,6 +44,7 @@ StatusCode CreatePositionedCaloCells::initialize() {
   info() << "add cell noise : " << m_addCellNoise << endmsg;
   info() << "remove cells below threshold : " << m_filterCellNoise << endmsg;
   info() << "emulate crosstalk : " << m_addCrosstalk << endmsg;
+  info() << "sparse noise sampling : " << m_sparseNoise << endmsg;
 
   // Initialization of tools
 
@@ -69,24 +74,42 @@ StatusCode CreatePositionedCaloCells::initialize() {
       return StatusCode::FAILURE;
     }
   }
-  if (m_addCellNoise) {
-    // Geometry settings
+  // Geometry settings.  Needed for noise, and used if given to index the cells
+  // and to precompute cell positions.
+  if (m_addCellNoise || !m_geoTool.empty()) {
     if (!m_geoTool.retrieve()) {
       error() << "Unable to retrieve the geometry tool!!!" << endmsg;
       return StatusCode::FAILURE;
     }
-    // Prepare map of all existing cells in calorimeter to add noise to all
-    StatusCode sc_prepareCells = m_geoTool->prepareEmptyCells(m_cellsMap);
-    if (sc_prepareCells.isFailure()) {
+    if (m_addCellNoise && m_geoTool->cellIDs().empty()) {
       error() << "Unable to create empty cells!" << endmsg;
       return StatusCode::FAILURE;
     }
-    verbose() << "Initialised empty cell map with size " << m_cellsMap.size() << endmsg;
-    // noise filtering erases cells from the cell map after each event, so we need
-    // to backup the empty cell map for later reuse
-    if (m_filterCellNoise) {
-      m_emptyCellsMap = m_cellsMap;
+    if (m_addCellNoise && m_filterCellNoise && m_sparseNoise) {
+      info() << "sparse noise sampling for " << m_geoTool->cellIDs().size() << " cells" << endmsg;
+    }
+    m_indexer = m_geoTool->indexer();
+  }
+  if (!m_indexer) {
+    info() << "No cell indexer available; cell energies will be summed using a hash map" << endmsg;
+  }
+  // Per-event working storage.
+  m_accumulators = std::make_unique<k4::recCalo::ObjectPool<k4::recCalo::CellEnergyAccumulator>>(
+      [this]() { return std::make_unique<k4::recCalo::CellEnergyAccumulator>(m_indexer.get()); });
+
+  // Precompute the positions of all cells, if we know them.
+  // Otherwise, positions are cached as cells are first seen.
+  if (!m_geoTool.empty()) {
+    auto cellIDs = m_geoTool->cellIDs();
+    m_positions.reserve(cellIDs.size());
+    for (dd4hep::DDSegmentation::CellID id : cellIDs) {
+      m_positions.emplace(id, cellPosition(id));
     }
+    m_positionsPrecomputed = true;
+    info() << "Precomputed positions for " << m_positions.size() << " cells" << endmsg;
+  } else {
+    warning() << "No geometry tool given; cell positions cannot be precomputed, and will be cached as cells are seen"
+              << endmsg;
   }
 
   // Copy over the CellIDEncoding string from the input collection to the output collection
@@ -97,12 +120,11 @@ StatusCode CreatePositionedCaloCells::initialize() {
   }
   k4FWCore::putCellIDEncoding(m_cells.objKey(), hitsEncoding.value(), this);
   m_decoder = new dd4hep::DDSegmentation::BitFieldCoder(hitsEncoding.value());
+  m_systemIndex = m_decoder->index("system");
+  m_layerIndex = m_decoder->index("layer");
 
-  // these variables will be initilized in the execute() method
-  // once the system ID is extracted from one cell
-  m_calotype = -99; // -99 not initialized, -1 unknown, 0 em, 1 had, 2 muon
-  m_caloid = 0;     // 0 unknown, 1 ecal, 2 hcal, 3 yoke
-  m_layout = 0;     // 0 any, 1 barrel, 2 endcap
+  // Find the calorimeter type word for each system ID.
+  findCaloTypes();
 
   return StatusCode::SUCCESS;
 }
@@ -112,42 +134,44 @@ StatusCode CreatePositionedCaloCells::execute(const EventContext&) const {
   const edm4hep::SimCalorimeterHitCollection* hits = m_hits.get();
   debug() << "Input Hit collection size: " << hits->size() << endmsg;
 
-  // 0. Clear all cells
-  if (m_addCellNoise) {
-    // if cells are not filtered, the map has same size in each event, equal to the total number
-    // of cells in the calorimeter, so we can just reset the values to 0
-    // if cells are filtered, during each event they are removed from the cellsMap, so one has to
-    // restore the initial map of all empty cells
-    if (!m_filterCellNoise)
-      std::for_each(m_cellsMap.begin(), m_cellsMap.end(), [](std::pair<const uint64_t, double>& p) { p.second = 0; });
-    else
-      m_cellsMap = m_emptyCellsMap;
-  } else {
-    m_cellsMap.clear();
-  }
+  // With sparse noise, only empty cells passing the filter are added in step 4.
+  const bool sparseNoise = m_addCellNoise && m_filterCellNoise && m_sparseNoise;
+
+  // Accumulator for the cell energies, reused between events.
+  auto acc = m_accumulators->acquire();
+  acc->clear();
 
   // 1. Merge energy deposits into cells
-  // If running with noise, map was already prepared in initialize().
-  // Otherwise it is being created below
 
   // Keep track of hits by ID, to avoid N^2 behavior in making links.
-  std::unordered_multimap<size_t, size_t> hitIndices;
-  for (size_t ihit = 0; const auto& hit : *hits) {
-    auto id = hit.getCellID();
-    verbose() << "CellID : " << id << endmsg;
-    m_cellsMap[id] += hit.getEnergy();
-    hitIndices.emplace(id, ihit++);
+  // This is a list of (cell ID, hit index), sorted by cell ID.
+  std::vector<std::pair<uint64_t, size_t>> hitIndices;
+  {
+    std::vector<uint64_t> ids;
+    std::vector<double> energies;
+    ids.reserve(hits->size());
+    energies.reserve(hits->size());
+    hitIndices.reserve(hits->size());
+    for (size_t ihit = 0; const auto& hit : *hits) {
+      auto id = hit.getCellID();
+      verbose() << "CellID : " << id << endmsg;
+      ids.push_back(id);
+      energies.push_back(hit.getEnergy());
+      hitIndices.emplace_back(id, ihit++);
+    }
+    acc->add(ids, energies);
+    std::ranges::sort(hitIndices);
   }
-  debug() << "Number of calorimeter cells after merging of hits: " << m_cellsMap.size() << endmsg;
+  debug() << "Number of calorimeter cells after merging of hits: " << acc->size() << endmsg;
 
   // 2. Emulate cross-talk (if asked)
   if (m_addCrosstalk) {
-    // Derive the cross-talk contributions without affecting yet the nominal energy
-    // (one has to emulate crosstalk based on cells free from any cross-talk contributions)
-    m_crosstalkCellsMap.clear(); // this is a temporary map to hold energy exchange due to cross-talk, without affecting
-                                 // yet the nominal energy
+    // Derive the cross-talk contributions from the nominal energies,
+    // free from any cross-talk contributions
+    std::vector<std::pair<uint64_t, double>> nominalCells;
+    acc->exportTo(nominalCells);
     // loop over cells with nominal energies
-    for (const auto& this_cell : m_cellsMap) {
+    for (const auto& this_cell : nominalCells) {
       uint64_t this_cellId = this_cell.first;
       auto vec_neighbours = m_crosstalkTool->getNeighbours(this_cellId); // a vector of neighbour IDs
       auto vec_crosstalks = m_crosstalkTool->getCrosstalks(this_cellId); // a vector of crosstalk coefficients
@@ -155,85 +179,59 @@ StatusCode CreatePositionedCaloCells::execute(const EventContext&) const {
       for (unsigned int i_cell = 0; i_cell < vec_neighbours.size(); i_cell++) {
         // signal transfer = energy deposit brought by EM shower hits * crosstalk coefficient
         double signal_transfer = this_cell.second * vec_crosstalks[i_cell];
-        // for the cell under study, record the signal transfer that will be subtracted from its final cell energy
-        m_crosstalkCellsMap[this_cellId] -= signal_transfer;
-        // for the crosstalk neighbour, record the signal transfer that will be added to its final cell energy
-        m_crosstalkCellsMap[vec_neighbours[i_cell]] += signal_transfer;
+        // for the cell under study, subtract the signal transfer from its final cell energy
+        acc->add(this_cellId, -signal_transfer);
+        // for the crosstalk neighbour, add the signal transfer to its final cell energy
+        acc->add(vec_neighbours[i_cell], signal_transfer);
       }
     }
+  }
 
-    // apply the cross-talk contributions on the nominal cell-energy map
-    for (const auto& this_cell : m_crosstalkCellsMap) {
-      m_cellsMap[this_cell.first] += this_cell.second;
-    }
+  // Take all cells of the calorimeter if adding noise to them (unless using sparse noise),
+  // or only those with deposits otherwise.
+  std::vector<std::pair<uint64_t, double>> cells;
+  if (m_addCellNoise && !sparseNoise) {
+    acc->exportAll(m_geoTool->cellIDs(), cells);
+  } else {
+    acc->sortByIndex();
+    acc->exportTo(cells);
   }
 
   // 3. Calibrate simulation energy to EM scale
   if (m_doCellCalibration) {
-    m_calibTool->calibrate(m_cellsMap);
+    m_calibTool->calibrate(cells);
   }
 
   // 4. Add noise to all cells
-  if (m_addCellNoise) {
-    m_noiseTool->addRandomCellNoise(m_cellsMap);
-  }
-
   // 5. Filter cells
-  if (m_filterCellNoise) {
-    m_noiseTool->filterCellNoise(m_cellsMap);
+  if (sparseNoise) {
+    m_noiseTool->addFilteredCellNoise(cells, m_geoTool->cellIDs());
+  } else {
+    if (m_addCellNoise) {
+      m_noiseTool->addRandomCellNoise(cells);
+    }
+    if (m_filterCellNoise) {
+      m_noiseTool->filterCellNoise(cells);
+    }
   }
 
-  // determine detector type (only once)
-  if (m_calotype == -99 && m_cellsMap.size() > 0) {
-    info() << "Determining calorimeter type for input collection " << m_hits.objKey() << endmsg;
-    uint cellid = m_cellsMap.begin()->first;
-    int system = m_decoder->get(cellid, "system");
-    debug() << "System: " << system << endmsg;
-    dd4hep::Detector* dd4hepgeo = &(dd4hep::Detector::getInstance());
-    const dd4hep::Detector::HandleMap& children = dd4hepgeo->detectors();
-    for (dd4hep::Detector::HandleMap::const_iterator i = children.begin(); i != children.end(); ++i) {
-      dd4hep::DetElement det((*i).second);
-      int id = det.id();
-      if (id == system) {
-        dd4hep::DetType detType(det.typeFlag());
-        if (detType.is(dd4hep::DetType::CALORIMETER)) {
-          if (detType.is(dd4hep::DetType::ELECTROMAGNETIC)) {
-            m_calotype = 0;
-            m_caloid = 1;
-          } else if (detType.is(dd4hep::DetType::HADRONIC)) {
-            m_calotype = 1;
-            m_caloid = 2;
-          } else if (detType.is(dd4hep::DetType::MUON)) {
-            m_calotype = 2;
-            m_caloid = 3;
-          } else {
-            warning() << "Detector type is neither ELECTROMAGNETIC, HADRONIC nor MUON" << endmsg;
-          }
-          if (detType.is(dd4hep::DetType::BARREL)) {
-            m_layout = 1;
-          } else if (detType.is(dd4hep::DetType::ENDCAP)) {
-            m_layout = 2;
-          } else if (detType.is(dd4hep::DetType::FORWARD)) {
-            m_layout = 3;
-          } else {
-            warning() << "Detector type is neither BARREL nor ENDCAP" << endmsg;
-          }
-        } else {
-          warning() << "Detector type is not CALORIMETER" << endmsg;
-          m_calotype = -1;
-          m_caloid = 0;
-        }
-        break;
-      }
-    }
-    info() << "CaloType: " << m_calotype << endmsg;
-    info() << "CaloId: " << m_caloid << endmsg;
-    info() << "Layout: " << m_layout << endmsg;
+  // determine detector type, from the first cell
+  int caloTypeWord = -1;
+  if (!cells.empty()) {
+    unsigned system = m_decoder->get(cells.front().first, m_systemIndex);
+    if (system < m_caloTypes.size())
+      caloTypeWord = m_caloTypes[system];
+    debug() << "System: " << system << " calorimeter type: " << caloTypeWord << endmsg;
   }
 
   // 6. Copy information to CaloHitCollection
+  std::shared_lock positionsLock(m_positionsMutex, std::defer_lock);
+  if (!m_positionsPrecomputed) {
+    cachePositions(cells);
+    positionsLock.lock();
+  }
   edm4hep::CalorimeterHitCollection* edmCellsCollection = new edm4hep::CalorimeterHitCollection();
-  for (const auto& cell : m_cellsMap) {
+  for (const auto& cell : cells) {
     if (m_addCellNoise || (!m_addCellNoise && cell.second != 0.)) {
       auto newCell = edmCellsCollection->create();
       newCell.setEnergy(cell.second);
@@ -241,23 +239,16 @@ StatusCode CreatePositionedCaloCells::execute(const EventContext&) const {
       newCell.setCellID(cellid);
 
       // add cell position
-      auto cached_pos = m_positions_cache.find(cellid);
-      if (cached_pos == m_positions_cache.end()) {
-        // retrieve position from tool
-        dd4hep::Position posCell = m_cellPositionsTool->xyzPosition(cellid);
-        edm4hep::Vector3f edmPos;
-        edmPos.x = posCell.x() / dd4hep::mm;
-        edmPos.y = posCell.y() / dd4hep::mm;
-        edmPos.z = posCell.z() / dd4hep::mm;
-        m_positions_cache[cellid] = edmPos;
-        newCell.setPosition(edmPos);
-      } else {
+      auto cached_pos = m_positions.find(cellid);
+      if (cached_pos != m_positions.end()) {
         newCell.setPosition(cached_pos->second);
+      } else {
+        newCell.setPosition(cellPosition(cellid));
       }
 
       // add cell type (for Pandora) - see iLCSoft/MarlinUtil/source/include/CalorimeterHitType.h
-      int layer = m_decoder->get(cellid, "layer");
-      newCell.setType(m_calotype + 10 * m_caloid + 1000 * m_layout + 10000 * layer);
+      int layer = m_decoder->get(cellid, m_layerIndex);
+      newCell.setType(caloTypeWord + 10000 * layer);
 
       debug() << "Cell energy (GeV) : " << newCell.getEnergy() << "\tcellID " << newCell.getCellID() << "\tcellType "
               << newCell.getType() << endmsg;
@@ -266,12 +257,15 @@ StatusCode CreatePositionedCaloCells::execute(const EventContext&) const {
     }
   }
 
+  if (positionsLock.owns_lock())
+    positionsLock.unlock();
+
   // create hits<->cell links
   edm4hep::CaloHitSimCaloHitLinkCollection* edmCellHitLinksCollection = new edm4hep::CaloHitSimCaloHitLinkCollection();
   for (const auto& cell : *edmCellsCollection) {
     auto cellID = cell.getCellID();
-    auto range = hitIndices.equal_range(cellID);
-    for (auto it = range.first; it != range.second; ++it) {
+    auto it = std::ranges::lower_bound(hitIndices, cellID, {}, [](const auto& p) { return p.first; });
+    for (; it != hitIndices.end() && it->first == cellID; ++it) {
       auto hit = (*hits)[it->second];
       // create Sim<->Reco hit associations
       auto link = edmCellHitLinksCollection->create();
@@ -290,3 +284,81 @@ StatusCode CreatePositionedCaloCells::execute(const EventContext&) const {
 }
 
 StatusCode CreatePositionedCaloCells::finalize() { return Gaudi::Algorithm::finalize(); }
+
+/// Retrieve the position of a cell from the positions tool, in mm.
+edm4hep::Vector3f CreatePositionedCaloCells::cellPosition(uint64_t cellid) const {
+  dd4hep::Position posCell = m_cellPositionsTool->xyzPosition(cellid);
+  return edm4hep::Vector3f(posCell.x() / dd4hep::mm, posCell.y() / dd4hep::mm, posCell.z() / dd4hep::mm);
+}
+
+/// Add the positions of cells not yet in m_positions.
+/// The positions tool is called without holding the lock.
+void CreatePositionedCaloCells::cachePositions(const std::vector<std::pair<uint64_t, double>>& cells) const {
+  std::vector<uint64_t> missing;
+  {
+    std::shared_lock lock(m_positionsMutex);
+    for (const auto& cell : cells) {
+      if ((m_addCellNoise || cell.second != 0.) && !m_positions.contains(cell.first))
+        missing.push_back(cell.first);
+    }
+  }
+  if (missing.empty())
+    return;
+
+  std::vector<edm4hep::Vector3f> positions;
+  positions.reserve(missing.size());
+  for (uint64_t cellid : missing)
+    positions.push_back(cellPosition(cellid));
+
+  std::unique_lock lock(m_positionsMutex);
+  for (size_t i = 0; i < missing.size(); i++)
+    m_positions.try_emplace(missing[i], positions[i]);
+}
+
+/// Build m_caloTypes, giving the calorimeter type word per system ID.
+/// The word is calotype + 10 * caloid + 1000 * layout, where
+/// calotype is -1 unknown, 0 em, 1 had, 2 muon;
+/// caloid is 0 unknown, 1 ecal, 2 hcal, 3 yoke;
+/// and layout is 0 any, 1 barrel, 2 endcap, 3 forward.
+void CreatePositionedCaloCells::findCaloTypes() {
+  dd4hep::Detector* dd4hepgeo = &(dd4hep::Detector::getInstance());
+  for (const auto& p : dd4hepgeo->detectors()) {
+    dd4hep::DetElement det(p.second);
+    int id = det.id();
+    if (id < 0)
+      continue;
+    int calotype = -1;
+    int caloid = 0;
+    int layout = 0;
+    dd4hep::DetType detType(det.typeFlag());
+    if (detType.is(dd4hep::DetType::CALORIMETER)) {
+      if (detType.is(dd4hep::DetType::ELECTROMAGNETIC)) {
+        calotype = 0;
+        caloid = 1;
+      } else if (detType.is(dd4hep::DetType::HADRONIC)) {
+        calotype = 1;
+        caloid = 2;
+      } else if (detType.is(dd4hep::DetType::MUON)) {
+        calotype = 2;
+        caloid = 3;
+      } else {
+        debug() << "Detector type for calorimeter " << id << " is neither ELECTROMAGNETIC, HADRONIC nor MUON"
+                << endmsg;
+      }
+      if (detType.is(dd4hep::DetType::BARREL)) {
+        layout = 1;
+      } else if (detType.is(dd4hep::DetType::ENDCAP)) {
+        layout = 2;
+      } else if (detType.is(dd4hep::DetType::FORWARD)) {
+        layout = 3;
+      } else {
+        debug() << "Detector type for calorimeter " << id << " is neither BARREL nor ENDCAP" << endmsg;
+      }
+    }
+    if (static_cast<int>(m_caloTypes.size()) <= id) {
+      m_caloTypes.resize(id + 1, -1);
+    }
+    m_caloTypes[id] = calotype + 10 * caloid + 1000 * layout;
+    debug() << "System " << id << " calorimeter type word " << m_caloTypes[id] << endmsg;
+  }
+}
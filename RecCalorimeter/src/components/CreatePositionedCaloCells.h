@@ -5,11 +5,13 @@
 #include "k4FWCore/DataHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/CellEnergyAccumulator.h"
 #include "RecCaloCommon/ICalibrateCaloHitsTool.h"
 #include "RecCaloCommon/ICaloReadCrosstalkMap.h"
 #include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/ICellPositionsTool.h"
 #include "RecCaloCommon/INoiseCaloCellsTool.h"
+#include "RecCaloCommon/ObjectPool.h"
 
 // Gaudi
 #include "Gaudi/Algorithm.h"
@@ -20,6 +22,8 @@
 #include "edm4hep/CalorimeterHitCollection.h"
 #include "edm4hep/SimCalorimeterHitCollection.h"
 
+#include <shared_mutex>
+
 /** @class CreatePositionedCaloCells
  *
  *  Algorithm for creating positioned calorimeter cells from Geant4 hits.
@@ -27,13 +31,18 @@
  *  cells from the digitisation contain the correct position in 3D space.
  *
  *  Flow of the program:
- *  1/ Merge Geant4 energy deposits with same cellID
+ *  1/ Merge Geant4 energy deposits with same cellID (see CellEnergyAccumulator;
+ *     this uses the cell indexer of the geometry tool, if it has one)
  *  2/ Emulate cross-talk (if switched on)
  *  3/ Calibrate to electromagnetic scale (if calibration switched on)
  *  4/ Add random noise to each cell (if noise switched on)
  *  5/ Filter cells and remove those with energy below threshold (if noise +
- *     filtering switched on)
- *  6/ Add cell positions
+ *     filtering switched on).  With sparseNoise set, steps 4 and 5 are done
+ *     together: cells with deposits get the full noise, while for the empty
+ *     cells only those passing the filter are sampled.
+ *  6/ Add cell positions.  With a geometry tool, the positions of all its
+ *     cells are computed once in initialize(); otherwise they are cached
+ *     as cells are first seen.
  *
  *  Tools called:
  *    - CalibrateCaloHitsTool
@@ -58,9 +67,19 @@ public:
 
   StatusCode finalize();
 
+  /// All per-event state is local to execute(), so events may be processed concurrently.
+  bool isReEntrant() const override { return true; }
+
   virtual ~CreatePositionedCaloCells();
 
 private:
+  /// Retrieve the position of a cell from the positions tool, in mm.
+  edm4hep::Vector3f cellPosition(uint64_t cellid) const;
+  /// Add the positions of cells not yet in m_positions.
+  void cachePositions(const std::vector<std::pair<uint64_t, double>>& cells) const;
+  /// Build m_caloTypes, giving the calorimeter type word per system ID.
+  void findCaloTypes();
+
   /// Handle for tool to get cells positions
   ToolHandle<k4::recCalo::ICellPositionsTool> m_cellPositionsTool{"CellPositionsTool", this};
   /// Handle for the calorimeter cells crosstalk tool
@@ -81,6 +100,10 @@ private:
   /// Save only cells with energy above threshold?
   Gaudi::Property<bool> m_filterCellNoise{this, "filterCellNoise", false,
                                           "Save only cells with energy above threshold?"};
+  /// Sample only the empty cells passing the noise filter? (if addCellNoise and filterCellNoise are both set)
+  Gaudi::Property<bool> m_sparseNoise{this, "sparseNoise", false,
+                                      "Sample noise only for empty cells passing the filter (statistically "
+                                      "equivalent to adding noise to all cells and filtering)"};
 
   /// Handle for calo hits (input collection)
   mutable k4FWCore::DataHandle<edm4hep::SimCalorimeterHitCollection> m_hits{"hits", Gaudi::DataHandle::Reader, this};
@@ -89,19 +112,25 @@ private:
   /// Handle for hit<->cell link (output collection)
   mutable k4FWCore::DataHandle<edm4hep::CaloHitSimCaloHitLinkCollection> m_links{"links", Gaudi::DataHandle::Writer,
                                                                                  this};
-  /// Maps of cell IDs (corresponding to DD4hep IDs) vs digitised cell energies
-  mutable std::unordered_map<uint64_t, double> m_cellsMap;
-  /// Maps of cell IDs (corresponding to DD4hep IDs) on transfer of signals due to crosstalk
-  mutable std::unordered_map<uint64_t, double> m_crosstalkCellsMap;
-  /// Maps of cell IDs with zero energy, for all cells in calo (needed if addNoise and filterNoise are both set)
-  mutable std::unordered_map<uint64_t, double> m_emptyCellsMap;
-  /// Cache position vs cellID
-  mutable std::unordered_map<dd4hep::DDSegmentation::CellID, edm4hep::Vector3f> m_positions_cache{};
-
-  /// For cell type - for PandoraPFA
-  mutable int m_calotype;
-  mutable int m_caloid;
-  mutable int m_layout;
+  /// Indexer for the cells of the geometry tool, if available.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_indexer;
+  /// Accumulators for the per-event cell energies, one per concurrent call.
+  std::unique_ptr<k4::recCalo::ObjectPool<k4::recCalo::CellEnergyAccumulator>> m_accumulators;
+  /// Positions (in mm) of the cells.  Filled for all cells of the geometry tool during initialize()
+  /// if it is given; otherwise filled during execute(), under m_positionsMutex.
+  mutable std::unordered_map<dd4hep::DDSegmentation::CellID, edm4hep::Vector3f> m_positions;
+  mutable std::shared_mutex m_positionsMutex;
+  /// True if m_positions was filled during initialize(), so that it is read without locking.
+  bool m_positionsPrecomputed = false;
+
+  /// Indexed by system ID, giving the calorimeter type word (for PandoraPFA).
+  /// System IDs which are not calorimeters are set to -1.
+  std::vector<int> m_caloTypes;
+
+  /// Field indices for detector ID and layer.
+  unsigned m_systemIndex = -1;
+  unsigned m_layerIndex = -1;
+
   dd4hep::DDSegmentation::BitFieldCoder* m_decoder;
 };
 
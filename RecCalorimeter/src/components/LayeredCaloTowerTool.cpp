@@ -57,6 +57,33 @@ StatusCode LayeredCaloTowerTool::initialize() {
     m_addLayerRestriction = true;
   info() << "Minimum layer : " << m_minimumLayer << endmsg;
   info() << "Maximum layer : " << m_maximumLayer << endmsg;
+
+  // precompute the towers of the cells of the geometry tool
+  if (!m_geoTool.empty()) {
+    if (!m_geoTool.retrieve()) {
+      error() << "Unable to retrieve the geometry tool!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (m_geoTool->readoutName() != m_readoutName) {
+      error() << "Geometry tool " << m_geoTool.name() << " has readout " << m_geoTool->readoutName() << ", not "
+              << m_readoutName << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_indexer = m_geoTool->indexer();
+    if (!m_indexer) {
+      error() << "Geometry tool " << m_geoTool.name() << " does not provide an indexer!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    // the towers of the cells depend on the tower numbers
+    int nEta = 0, nPhi = 0;
+    towersNumber(nEta, nPhi);
+    m_cellTowerMap = k4::recCalo::CellTowerMap(
+        *m_indexer,
+        [this](dd4hep::DDSegmentation::CellID aCellId, std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) {
+          cellTowers(aCellId, aEntries);
+        });
+    info() << "Precomputed the towers of " << m_cellTowerMap.size() << " cells" << endmsg;
+  }
   return StatusCode::SUCCESS;
 }
 
@@ -77,16 +104,11 @@ void LayeredCaloTowerTool::towersNumber(int& nEta, int& nPhi) {
   nPhi = m_nPhiTower;
 }
 
-uint LayeredCaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers, [[maybe_unused]] bool fillTowerCells) {
-  // Get the input collection with cells from simulation + digitisation (after
-  // calibration and with noise)
-  const edm4hep::CalorimeterHitCollection* cells = m_cells.get();
-  debug() << "Input cell collection size: " << cells->size() << endmsg;
-  // Loop over a collection of calorimeter cells and build calo towers
+void LayeredCaloTowerTool::cellTowers(dd4hep::DDSegmentation::CellID aCellId,
+                                      std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) const {
   // borders of the cell in eta/phi
   float etaCellMin = 0, etaCellMax = 0;
   float phiCellMin = 0, phiCellMax = 0;
-  int layerCell = 0;
   // tower index of the borders of the cell
   int iPhiMin = 0, iPhiMax = 0;
   int iEtaMin = 0, iEtaMax = 0;
@@ -98,79 +120,108 @@ uint LayeredCaloTowerTool::buildTowers(std::vector<std::vector<float>>& aTowers,
   float fracEtaMin = 1.0, fracEtaMax = 1.0, fracEtaMiddle = 1.0;
   float fracPhiMin = 1.0, fracPhiMax = 1.0, fracPhiMiddle = 1.0;
   float epsilon = 0.0001;
-  for (const auto& cell : *cells) {
-    // find to which tower(s) the cell belongs
-    etaCellMin = m_segmentation->eta(cell.getCellID()) - m_segmentation->gridSizeEta() * 0.5;
-    etaCellMax = m_segmentation->eta(cell.getCellID()) + m_segmentation->gridSizeEta() * 0.5;
-    phiCellMin = m_segmentation->phi(cell.getCellID()) - M_PI / (double)m_segmentation->phiBins();
-    phiCellMax = m_segmentation->phi(cell.getCellID()) + M_PI / (double)m_segmentation->phiBins();
-    if (m_addLayerRestriction == true) {
-      dd4hep::DDSegmentation::CellID cID = cell.getCellID();
-      layerCell = m_decoder->get(cID, "layer");
-      debug() << "Cell' layer = " << layerCell << endmsg;
+  if (m_addLayerRestriction == true) {
+    int layerCell = m_decoder->get(aCellId, "layer");
+    if (layerCell < m_minimumLayer || layerCell > m_maximumLayer) {
+      return;
     }
-    iEtaMin = idEta(etaCellMin + epsilon);
-    iPhiMin = idPhi(phiCellMin + epsilon);
-    iEtaMax = idEta(etaCellMax - epsilon);
-    iPhiMax = idPhi(phiCellMax - epsilon);
-    // if a cell is larger than a tower in eta/phi, calculate the fraction of
-    // the cell area belonging to the first/last/middle towers
-    fracEtaMin = 1.0;
-    fracEtaMax = 1.0;
-    fracEtaMiddle = 1.0;
-    if (iEtaMin != iEtaMax) {
-      fracEtaMin = fabs(eta(iEtaMin) + 0.5 * m_deltaEtaTower - etaCellMin) / m_segmentation->gridSizeEta();
-      fracEtaMax = fabs(etaCellMax - eta(iEtaMax) + 0.5 * m_deltaEtaTower) / m_segmentation->gridSizeEta();
-      if ((iEtaMax - iEtaMin - 1) != 0) {
-        fracEtaMiddle = (1 - fracEtaMin - fracEtaMax) / float(iEtaMax - iEtaMin - 1);
-      } else {
-        fracEtaMiddle = 0.0;
-      }
+  }
+  // find to which tower(s) the cell belongs
+  etaCellMin = m_segmentation->eta(aCellId) - m_segmentation->gridSizeEta() * 0.5;
+  etaCellMax = m_segmentation->eta(aCellId) + m_segmentation->gridSizeEta() * 0.5;
+  phiCellMin = m_segmentation->phi(aCellId) - M_PI / (double)m_segmentation->phiBins();
+  phiCellMax = m_segmentation->phi(aCellId) + M_PI / (double)m_segmentation->phiBins();
+  iEtaMin = idEta(etaCellMin + epsilon);
+  iPhiMin = idPhi(phiCellMin + epsilon);
+  iEtaMax = idEta(etaCellMax - epsilon);
+  iPhiMax = idPhi(phiCellMax - epsilon);
+  // if a cell is larger than a tower in eta/phi, calculate the fraction of
+  // the cell area belonging to the first/last/middle towers
+  if (iEtaMin != iEtaMax) {
+    fracEtaMin = fabs(eta(iEtaMin) + 0.5 * m_deltaEtaTower - etaCellMin) / m_segmentation->gridSizeEta();
+    fracEtaMax = fabs(etaCellMax - eta(iEtaMax) + 0.5 * m_deltaEtaTower) / m_segmentation->gridSizeEta();
+    if ((iEtaMax - iEtaMin - 1) != 0) {
+      fracEtaMiddle = (1 - fracEtaMin - fracEtaMax) / float(iEtaMax - iEtaMin - 1);
+    } else {
+      fracEtaMiddle = 0.0;
     }
-    fracPhiMin = 1.0;
-    fracPhiMax = 1.0;
-    fracPhiMiddle = 1.0;
-    if (iPhiMin != iPhiMax) {
-      fracPhiMin =
-          fabs(phi(iPhiMin) + 0.5 * m_deltaPhiTower - phiCellMin) / (2 * M_PI / (double)m_segmentation->phiBins());
-      fracPhiMax =
-          fabs(phiCellMax - phi(iPhiMax) + 0.5 * m_deltaPhiTower) / (2 * M_PI / (double)m_segmentation->phiBins());
-      if ((iPhiMax - iPhiMin - 1) != 0) {
-        fracPhiMiddle = (1 - fracPhiMin - fracPhiMax) / float(iPhiMax - iPhiMin - 1);
-      } else {
-        fracPhiMiddle = 0.0;
-      }
+  }
+  if (iPhiMin != iPhiMax) {
+    fracPhiMin =
+        fabs(phi(iPhiMin) + 0.5 * m_deltaPhiTower - phiCellMin) / (2 * M_PI / (double)m_segmentation->phiBins());
+    fracPhiMax =
+        fabs(phiCellMax - phi(iPhiMax) + 0.5 * m_deltaPhiTower) / (2 * M_PI / (double)m_segmentation->phiBins());
+    if ((iPhiMax - iPhiMin - 1) != 0) {
+      fracPhiMiddle = (1 - fracPhiMin - fracPhiMax) / float(iPhiMax - iPhiMin - 1);
+    } else {
+      fracPhiMiddle = 0.0;
     }
+  }
 
-    // Loop through the appropriate towers and add transverse energy
-    for (auto iEta = iEtaMin; iEta <= iEtaMax; iEta++) {
-      if (iEta == iEtaMin) {
-        ratioEta = fracEtaMin;
-      } else if (iEta == iEtaMax) {
-        ratioEta = fracEtaMax;
+  // transverse energy per unit of cell energy
+  const double sinTheta = 1 / cosh(m_segmentation->eta(aCellId));
+  for (auto iEta = iEtaMin; iEta <= iEtaMax; iEta++) {
+    if (iEta == iEtaMin) {
+      ratioEta = fracEtaMin;
+    } else if (iEta == iEtaMax) {
+      ratioEta = fracEtaMax;
+    } else {
+      ratioEta = fracEtaMiddle;
+    }
+    for (auto iPhi = iPhiMin; iPhi <= iPhiMax; iPhi++) {
+      if (iPhi == iPhiMin) {
+        ratioPhi = fracPhiMin;
+      } else if (iPhi == iPhiMax) {
+        ratioPhi = fracPhiMax;
       } else {
-        ratioEta = fracEtaMiddle;
-      }
-      for (auto iPhi = iPhiMin; iPhi <= iPhiMax; iPhi++) {
-        if (iPhi == iPhiMin) {
-          ratioPhi = fracPhiMin;
-        } else if (iPhi == iPhiMax) {
-          ratioPhi = fracPhiMax;
-        } else {
-          ratioPhi = fracPhiMiddle;
-        }
-        if (m_addLayerRestriction == true) {
-          if (layerCell >= m_minimumLayer && layerCell <= m_maximumLayer) {
-            aTowers[iEta][phiNeighbour(iPhi)] +=
-                cell.getEnergy() / cosh(m_segmentation->eta(cell.getCellID())) * ratioEta * ratioPhi;
-          }
-        } else
-          aTowers[iEta][phiNeighbour(iPhi)] +=
-              cell.getEnergy() / cosh(m_segmentation->eta(cell.getCellID())) * ratioEta * ratioPhi;
+        ratioPhi = fracPhiMiddle;
       }
+      // flat index of the tower, as in TowerGrid
+      aEntries.push_back({static_cast<uint32_t>(iEta * m_nPhiTower + phiNeighbour(iPhi)),
+                          static_cast<float>(sinTheta * ratioEta * ratioPhi)});
+    }
+  }
+}
+
+k4::recCalo::CaloTowers LayeredCaloTowerTool::buildTowers([[maybe_unused]] bool fillTowerCells) const {
+  // Get the input collection with cells from simulation + digitisation (after
+  // calibration and with noise)
+  const edm4hep::CalorimeterHitCollection* cells = m_cells.get();
+  debug() << "Input cell collection size: " << cells->size() << endmsg;
+  k4::recCalo::CaloTowers towers(m_nEtaTower, m_nPhiTower);
+
+  // indices of the cells in the precomputed towers, if any
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices;
+  if (m_indexer) {
+    std::vector<dd4hep::DDSegmentation::CellID> ids;
+    ids.reserve(cells->size());
+    for (const auto& cell : *cells) {
+      ids.push_back(cell.getCellID());
+    }
+    indices.resize(ids.size());
+    m_indexer->indices(ids, indices);
+  }
+
+  // Loop over a collection of calorimeter cells and add transverse energy to the towers
+  std::span<float> energies = towers.grid.energies();
+  std::vector<k4::recCalo::CellTowerMap::Entry> cellEntries;
+  for (size_t i = 0; i < cells->size(); i++) {
+    const auto cell = (*cells)[i];
+    std::span<const k4::recCalo::CellTowerMap::Entry> cellTowerEntries;
+    if (m_indexer && indices[i] != k4::recCalo::ICaloIndexer::INVALID) {
+      cellTowerEntries = m_cellTowerMap.entries(indices[i]);
+    } else {
+      cellEntries.clear();
+      cellTowers(cell.getCellID(), cellEntries);
+      cellTowerEntries = cellEntries;
+    }
+    for (const auto& tower : cellTowerEntries) {
+      energies[tower.tower] += cell.getEnergy() * tower.weight;
     }
   }
-  return cells->size();
+  towers.grid.finalizeCells();
+  towers.nCells = cells->size();
+  return towers;
 }
 
 uint LayeredCaloTowerTool::idEta(float aEta) const {
@@ -204,9 +255,9 @@ uint LayeredCaloTowerTool::phiNeighbour(int aIPhi) const {
 
 float LayeredCaloTowerTool::radiusForPosition() const { return m_radius; }
 
-void LayeredCaloTowerTool::attachCells(float eta, float phi, uint halfEtaFin, uint halfPhiFin,
-                                       edm4hep::MutableCluster& aEdmCluster,
-                                       edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool) {
+void LayeredCaloTowerTool::attachCells(const k4::recCalo::CaloTowers&, float eta, float phi, uint halfEtaFin,
+                                       uint halfPhiFin, edm4hep::MutableCluster& aEdmCluster,
+                                       edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool) const {
   const edm4hep::CalorimeterHitCollection* cells = m_cells.get();
   for (const auto& cell : *cells) {
     float etaCell = m_segmentation->eta(cell.getCellID());
@@ -3,6 +3,7 @@
 
 // Gaudi
 #include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ToolHandle.h"
 
 // k4geo
 #include "detectorSegmentations/FCCSWGridPhiEta_k4geo.h"
@@ -11,9 +12,15 @@
 #include "k4FWCore/DataHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/CellTowerMap.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/ITowerTool.h"
 class IGeoSvc;
 
+#include <memory>
+#include <vector>
+
 // edm4hep
 namespace edm4hep {
 class CalorimeterHitCollection;
@@ -46,6 +53,9 @@ namespace DDSegmentation {
  *  It will only consider cells within the defined layers of the calorimeter, if the layers are defined by 'layer'
  * bitfield. By default it uses 0 to 130th layer.
  *
+ *  If '\b geometryTool' is given (with the same readout), the towers of all its cells, with the fractions of the
+ * cell in each tower, are computed once at initialize, and tower building is then a lookup and a scatter-add.
+ *
  *  For more explanation please [see reconstruction documentation](@ref
  * md_reconstruction_doc_reccalorimeter).
  *
@@ -72,10 +82,10 @@ public:
   /**  Build calorimeter towers.
    *   Tower is segmented in eta and phi, with the energy from all layers
    *   (no segmentation).
-   *   @param[out] aTowers Calorimeter towers.
-   *   @return Size of the cell collection.
+   *   @param[in] fillTowerCells Ignored: the cells of a cluster are found directly from the cell collection
+   *   @return Calorimeter towers; the number of cells is the size of the cell collection.
    */
-  virtual uint buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowerCells = true) final override;
+  virtual k4::recCalo::CaloTowers buildTowers(bool fillTowerCells = true) const final override;
   /**  Get the radius (in mm) for the position calculation.
    *   Reconstructed cluster has eta and phi position, without the radial
    * coordinate. The cluster in EDM contains
@@ -120,18 +130,28 @@ public:
    */
   uint phiNeighbour(int aIPhi) const;
   /**  Find cells belonging to a cluster.
+   *   @param[in] aTowers Calorimeter towers of the event (unused, cells are taken from the input collection)
    *   @param[in] aEta Position of the middle tower of a cluster in eta
    *   @param[in] aPhi Position of the middle tower of a cluster in phi
    *   @param[in] aHalfEtaFinal Half size of cluster in eta (in units of tower size). Cluster size is 2*aHalfEtaFinal+1
    *   @param[in] aHalfPhiFinal Half size of cluster in phi (in units of tower size). Cluster size is 2*aHalfPhiFinal+1
    *   @param[out] aEdmCluster Cluster where cells are attached to
    */
-  virtual void attachCells(float aEta, float aPhi, uint aHalfEtaFinal, uint aHalfPhiFinal,
-                           edm4hep::MutableCluster& aEdmCluster, edm4hep::CalorimeterHitCollection* aEdmClusterCells,
-                           bool aEllipse = false) final override;
+  virtual void attachCells(const k4::recCalo::CaloTowers& aTowers, float aEta, float aPhi, uint aHalfEtaFinal,
+                           uint aHalfPhiFinal, edm4hep::MutableCluster& aEdmCluster,
+                           edm4hep::CalorimeterHitCollection* aEdmClusterCells,
+                           bool aEllipse = false) const final override;
   std::shared_ptr<dd4hep::DDSegmentation::BitFieldCoder> m_decoder;
 
 private:
+  /**  Find the towers covered by a cell, and the weights of its energy in the towers.
+   *   The weight is the fraction of the cell in the tower divided by cosh(eta).
+   *   @param[in] aCellId ID of the cell
+   *   @param[out] aEntries List to which the towers are added; none are added for cells outside of the layers used
+   */
+  void cellTowers(dd4hep::DDSegmentation::CellID aCellId,
+                  std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) const;
+
   /// Handle for calo cells (input collection)
   mutable k4FWCore::DataHandle<edm4hep::CalorimeterHitCollection> m_cells{"calo/cells", Gaudi::DataHandle::Reader,
                                                                           this};
@@ -139,6 +159,13 @@ private:
   ServiceHandle<IGeoSvc> m_geoSvc;
   /// Name of the detector readout
   Gaudi::Property<std::string> m_readoutName{this, "readoutName", "", "Name of the detector readout"};
+  /// Handle for the geometry tool; if set, the towers of its cells are precomputed at initialize
+  ToolHandle<k4::recCalo::ICalorimeterTool> m_geoTool{
+      this, "geometryTool", "", "Handle for the geometry tool; if set, the towers of its cells are precomputed"};
+  /// Indexer of the cells of the geometry tool
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_indexer;
+  /// Towers of the cells, indexed by m_indexer
+  k4::recCalo::CellTowerMap m_cellTowerMap;
   /// PhiEta segmentation (owned by DD4hep)
   dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo* m_segmentation;
   /// Radius used to calculate cluster position from eta and phi (in mm)
@@ -758,8 +758,8 @@ StatusCode MassInv::execute(const EventContext&) const {
     }
 
     // create towers
-    m_towers.assign(m_nEtaTower, std::vector<float>(m_nPhiTower, 0));
-    m_towerTool->buildTowers(m_towers);
+    const k4::recCalo::CaloTowers caloTowers = m_towerTool->buildTowers(false);
+    const k4::recCalo::TowerGrid& towers = caloTowers.grid;
     // check all isolation windows around photons
     debug() << "Number of photon candidates: " << clustersMassInvScaled.size() << endmsg;
     for (uint iCluster = 0; iCluster < m_etaSizes.size(); iCluster++) {
@@ -776,7 +776,7 @@ StatusCode MassInv::execute(const EventContext&) const {
         double sumWindow = 0;
         for (size_t iEtaWindow = photonIdEta - halfEtaWin; iEtaWindow <= photonIdEta + halfEtaWin; iEtaWindow++) {
           for (size_t iPhiWindow = photonIdPhi - halfPhiWin; iPhiWindow <= photonIdPhi + halfPhiWin; iPhiWindow++) {
-            sumWindow += m_towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
+            sumWindow += towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
           }
         }
         m_hHCalEnergy->Fill(sumWindow);
@@ -793,7 +793,7 @@ StatusCode MassInv::execute(const EventContext&) const {
         double sumWindow = 0;
         for (size_t iEtaWindow = photonIdEta - halfEtaWin; iEtaWindow <= photonIdEta + halfEtaWin; iEtaWindow++) {
           for (size_t iPhiWindow = photonIdPhi - halfPhiWin; iPhiWindow <= photonIdPhi + halfPhiWin; iPhiWindow++) {
-            sumWindow += m_towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
+            sumWindow += towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
           }
         }
         m_hHCalEnergy->Fill(sumWindow);
@@ -810,7 +810,7 @@ StatusCode MassInv::execute(const EventContext&) const {
         double sumWindow = 0;
         for (size_t iEtaWindow = photonIdEta - halfEtaWin; iEtaWindow <= photonIdEta + halfEtaWin; iEtaWindow++) {
           for (size_t iPhiWindow = photonIdPhi - halfPhiWin; iPhiWindow <= photonIdPhi + halfPhiWin; iPhiWindow++) {
-            sumWindow += m_towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
+            sumWindow += towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
           }
         }
         m_hHCalEnergy->Fill(sumWindow);
@@ -827,7 +827,7 @@ StatusCode MassInv::execute(const EventContext&) const {
         double sumWindow = 0;
         for (size_t iEtaWindow = photonIdEta - halfEtaWin; iEtaWindow <= photonIdEta + halfEtaWin; iEtaWindow++) {
           for (size_t iPhiWindow = photonIdPhi - halfPhiWin; iPhiWindow <= photonIdPhi + halfPhiWin; iPhiWindow++) {
-            sumWindow += m_towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
+            sumWindow += towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
           }
         }
         m_hHCalEnergy->Fill(sumWindow);
@@ -844,7 +844,7 @@ StatusCode MassInv::execute(const EventContext&) const {
         double sumWindow = 0;
         for (size_t iEtaWindow = photonIdEta - halfEtaWin; iEtaWindow <= photonIdEta + halfEtaWin; iEtaWindow++) {
           for (size_t iPhiWindow = photonIdPhi - halfPhiWin; iPhiWindow <= photonIdPhi + halfPhiWin; iPhiWindow++) {
-            sumWindow += m_towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
+            sumWindow += towers[iEtaWindow][phiNeighbour(iPhiWindow, m_nPhiTower)];
           }
         }
         m_hHCalEnergy->Fill(sumWindow);
@@ -1,4 +1,5 @@
 #include "NoiseCaloCellsFlatTool.h"
+#include "RecCaloCommon/EventRng.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 #include <GaudiKernel/StatusCode.h>
 
@@ -6,8 +7,7 @@ DECLARE_COMPONENT(NoiseCaloCellsFlatTool)
 
 StatusCode NoiseCaloCellsFlatTool::initialize() {
   K4RECCALORIMETER_CHECK(AlgTool::initialize());
-  K4RECCALORIMETER_CHECK(m_randSvc = service<IRndmGenSvc>("RndmGenSvc", true));
-  K4RECCALORIMETER_CHECK(m_gauss.initialize(m_randSvc, Rndm::Gauss(0., 1.)));
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   info() << "RMS of the cell noise: " << m_cellNoiseRMS * 1.e3 << " MeV" << endmsg;
   info() << "Offset of the cell noise: " << m_cellNoiseOffset * 1.e3 << " MeV" << endmsg;
@@ -17,8 +17,16 @@ StatusCode NoiseCaloCellsFlatTool::initialize() {
 
 template <typename C>
 void NoiseCaloCellsFlatTool::addRandomCellNoiseT(C& aCells) const {
+  std::vector<uint64_t> ids;
+  ids.reserve(aCells.size());
+  for (const auto& p : aCells) {
+    ids.push_back(p.first);
+  }
+  std::vector<double> gauss(ids.size());
+  k4::recCalo::eventRng(m_randomSeed, m_rngStream).gauss(ids, gauss);
+  size_t i = 0;
   for (auto& p : aCells) {
-    p.second += m_cellNoiseOffset + (m_gauss.shoot() * m_cellNoiseRMS);
+    p.second += m_cellNoiseOffset + (gauss[i++] * m_cellNoiseRMS);
   }
 }
 
@@ -3,8 +3,6 @@
 
 // Gaudi
 #include "GaudiKernel/AlgTool.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 
 // Interfaces
 #include "RecCaloCommon/INoiseCaloCellsTool.h"
@@ -14,6 +12,8 @@
  *  Very simple tool for calorimeter noise using a single noise value for all cells
  *  createRandomCellNoise: Create random CaloHits (gaussian distribution) for the vector of cells
  *  filterCellNoise: remove cells with energy below threshold*sigma from the vector of cells
+ *  The noise of each cell is drawn from a k4::recCalo::CounterRng, and depends only on
+ *  "randomSeed", the tool name, the run and event numbers, and the cell ID.
  *
  *  @author Jana Faltova
  *  @date   2016-09
@@ -59,10 +59,12 @@ private:
   /// Energy threshold (Ecell < m_cellNoiseOffset + filterThreshold*m_cellNoiseRMS removed)
   Gaudi::Property<double> m_filterThreshold{this, "filterNoiseThreshold", 3,
                                             "remove cells with energy below offset + threshold * noise RMS"};
-  /// Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  /// Gaussian random number generator used for smearing with a constant resolution (m_sigma)
-  Rndm::Numbers m_gauss;
+  /// Seed for the noise random numbers, which also depend on the run, event, and cell ID
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0,
+                                         "Seed for the noise random numbers; they also depend on the run, event, "
+                                         "and cell ID, and on the name of this tool"};
+  /// Random number stream of this tool, made from its name
+  uint64_t m_rngStream = 0;
 };
 
 #endif /* RECCALORIMETER_NOISECALOCELLSFLATTOOL_H */
@@ -1,4 +1,5 @@
 #include "NoiseCaloCellsFromFileTool.h"
+#include "RecCaloCommon/EventRng.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 
 // k4geo
@@ -16,13 +17,28 @@
 #include "TMath.h"
 #include "TSystem.h"
 
+#include <algorithm>
+
 DECLARE_COMPONENT(NoiseCaloCellsFromFileTool)
 
+namespace {
+
+/// Return the IDs of a collection of cells, in iteration order.
+template <typename C>
+std::vector<uint64_t> cellIDsOf(const C& aCells) {
+  std::vector<uint64_t> ids;
+  ids.reserve(aCells.size());
+  for (const auto& p : aCells)
+    ids.push_back(p.first);
+  return ids;
+}
+
+} // anonymous namespace
+
 StatusCode NoiseCaloCellsFromFileTool::initialize() {
 
   K4RECCALORIMETER_CHECK(m_geoSvc.retrieve());
-  K4RECCALORIMETER_CHECK(m_randSvc = service<IRndmGenSvc>("RndmGenSvc", false));
-  K4RECCALORIMETER_CHECK(m_gauss.initialize(m_randSvc, Rndm::Gauss(0., 1.)));
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   // open and check file, read the histograms with noise constants
   K4RECCALORIMETER_CHECK(initNoiseFromFile());
@@ -68,6 +84,22 @@ StatusCode NoiseCaloCellsFromFileTool::initialize() {
 
   debug() << "Filter noise threshold: " << m_filterThreshold << "*sigma" << endmsg;
 
+  // Cache the noise of all cells of the geometry tool
+  if (!m_geoTool.empty()) {
+    if (!m_geoTool.retrieve()) {
+      error() << "Unable to retrieve the geometry tool!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_indexer = m_geoTool->indexer();
+    if (!m_indexer) {
+      error() << "Geometry tool " << m_geoTool.name() << " does not provide an indexer!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_noiseTable = std::make_unique<const k4::recCalo::IndexedNoiseTable>(
+        *m_indexer, [this](uint64_t id) { return std::make_pair(computeNoiseRMSPerCell(id), 0.); });
+    info() << "Cached the noise RMS of " << m_noiseTable->size() << " cells" << endmsg;
+  }
+
   K4RECCALORIMETER_CHECK(AlgTool::initialize());
 
   return StatusCode::SUCCESS;
@@ -75,8 +107,17 @@ StatusCode NoiseCaloCellsFromFileTool::initialize() {
 
 template <typename C>
 void NoiseCaloCellsFromFileTool::addRandomCellNoiseT(C& aCells) const {
+  std::vector<uint64_t> ids = cellIDsOf(aCells);
+  std::vector<double> noise(ids.size());
+  std::vector<double> gauss(ids.size());
+  getNoiseRMS(ids, noise);
+  k4::recCalo::eventRng(m_randomSeed, m_rngStream).gauss(ids, gauss);
+  for (size_t i = 0; i < noise.size(); ++i) {
+    noise[i] *= gauss[i];
+  }
+  size_t i = 0;
   for (auto& p : aCells) {
-    p.second += getNoiseRMSPerCell(p.first) * m_gauss.shoot();
+    p.second += noise[i++];
   }
 }
 
@@ -91,11 +132,27 @@ void NoiseCaloCellsFromFileTool::addRandomCellNoise(std::vector<std::pair<uint64
 template <typename C>
 void NoiseCaloCellsFromFileTool::filterCellNoiseT(C& aCells) const {
   // Erase a cell if it has energy bellow a threshold from the vector
-  if (m_useAbsInFilter) {
-    std::erase_if(aCells,
-                  [&](auto& p) { return std::abs(p.second) < m_filterThreshold * getNoiseRMSPerCell(p.first); });
+  std::vector<uint64_t> ids = cellIDsOf(aCells);
+  std::vector<double> noiseRMS(ids.size());
+  getNoiseRMS(ids, noiseRMS);
+  auto drop = [&](double energy, double rms) {
+    return (m_useAbsInFilter ? std::abs(energy) : energy) < m_filterThreshold * rms;
+  };
+  size_t i = 0;
+  if constexpr (requires { aCells.contains(0); }) {
+    for (auto it = aCells.begin(); it != aCells.end();) {
+      if (drop(it->second, noiseRMS[i++]))
+        it = aCells.erase(it);
+      else
+        ++it;
+    }
   } else {
-    std::erase_if(aCells, [&](auto& p) { return p.second < m_filterThreshold * getNoiseRMSPerCell(p.first); });
+    size_t nkeep = 0;
+    for (; i < aCells.size(); ++i) {
+      if (!drop(aCells[i].second, noiseRMS[i]))
+        aCells[nkeep++] = aCells[i];
+    }
+    aCells.resize(nkeep);
   }
 }
 
@@ -107,6 +164,66 @@ void NoiseCaloCellsFromFileTool::filterCellNoise(std::vector<std::pair<uint64_t,
   filterCellNoiseT(aCells);
 }
 
+template <typename C>
+void NoiseCaloCellsFromFileTool::addFilteredCellNoiseT(C& aCells, std::span<const uint64_t> allCells) const {
+  // For low thresholds, most empty cells pass the filter anyway;
+  // just do it the straightforward way.
+  if (m_filterThreshold < 1) {
+    k4::recCalo::INoiseCaloCellsTool::addFilteredCellNoise(aCells, allCells);
+    return;
+  }
+
+  // Draw the empty cells which fluctuate above threshold.
+  // Cells with deposits get the full noise below instead, so drop them here.
+  std::vector<std::pair<uint64_t, double>> noisyCells;
+  // The sampling uses a sequence of deviates distinct from those used for individual cells.
+  k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed, m_rngStream);
+  sparseNoise(allCells)->sample(rng.sequence(0), noisyCells);
+  if constexpr (requires { aCells.contains(0); }) {
+    std::erase_if(noisyCells, [&](const auto& p) { return aCells.contains(p.first); });
+  } else {
+    std::vector<uint64_t> ids;
+    ids.reserve(aCells.size());
+    for (const auto& p : aCells)
+      ids.push_back(p.first);
+    std::ranges::sort(ids);
+    std::erase_if(noisyCells, [&](const auto& p) { return std::ranges::binary_search(ids, p.first); });
+  }
+
+  addRandomCellNoiseT(aCells);
+  filterCellNoiseT(aCells);
+  if constexpr (requires { aCells.contains(0); }) {
+    aCells.insert(noisyCells.begin(), noisyCells.end());
+  } else {
+    aCells.insert(aCells.end(), noisyCells.begin(), noisyCells.end());
+  }
+}
+
+void NoiseCaloCellsFromFileTool::addFilteredCellNoise(std::unordered_map<uint64_t, double>& aCells,
+                                                      std::span<const uint64_t> allCells) const {
+  addFilteredCellNoiseT(aCells, allCells);
+}
+
+void NoiseCaloCellsFromFileTool::addFilteredCellNoise(std::vector<std::pair<uint64_t, double>>& aCells,
+                                                      std::span<const uint64_t> allCells) const {
+  addFilteredCellNoiseT(aCells, allCells);
+}
+
+std::shared_ptr<const k4::recCalo::SparseCellNoise>
+NoiseCaloCellsFromFileTool::sparseNoise(std::span<const uint64_t> allCells) const {
+  std::lock_guard lock(m_sparseNoiseMutex);
+  if (!m_sparseNoise || m_sparseNoiseCells != allCells.data() || m_sparseNoise->size() != allCells.size()) {
+    std::vector<double> noiseRMS(allCells.size());
+    getNoiseRMS(allCells, noiseRMS);
+    m_sparseNoise =
+        std::make_shared<const k4::recCalo::SparseCellNoise>(allCells, noiseRMS, m_filterThreshold, m_useAbsInFilter);
+    m_sparseNoiseCells = allCells.data();
+    debug() << "Sparse noise for " << m_sparseNoise->size() << " cells in " << m_sparseNoise->nClasses()
+            << " classes; expect " << m_sparseNoise->expectedCount() << " noise cells per event" << endmsg;
+  }
+  return m_sparseNoise;
+}
+
 StatusCode NoiseCaloCellsFromFileTool::initNoiseFromFile() {
   // Check if file exists
   if (m_noiseFileName.empty()) {
@@ -168,6 +285,34 @@ StatusCode NoiseCaloCellsFromFileTool::initNoiseFromFile() {
 }
 
 double NoiseCaloCellsFromFileTool::getNoiseRMSPerCell(uint64_t aCellId) const {
+  if (m_noiseTable) {
+    k4::recCalo::ICaloIndexer::index_t ndx = m_indexer->index(aCellId);
+    if (ndx != k4::recCalo::ICaloIndexer::INVALID)
+      return m_noiseTable->noiseRMS(ndx);
+  }
+  return computeNoiseRMSPerCell(aCellId);
+}
+
+void NoiseCaloCellsFromFileTool::getNoiseRMS(std::span<const uint64_t> aCellIDs, std::span<double> aNoiseRMS) const {
+  if (!m_noiseTable) {
+    for (size_t i = 0; i < aCellIDs.size(); ++i)
+      aNoiseRMS[i] = computeNoiseRMSPerCell(aCellIDs[i]);
+    return;
+  }
+  // The list of all cells of the geometry tool can be copied directly.
+  if (aCellIDs.data() == m_noiseTable->cellIDs().data() && aCellIDs.size() == m_noiseTable->size()) {
+    std::ranges::copy(m_noiseTable->noiseRMS(), aNoiseRMS.begin());
+    return;
+  }
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices(aCellIDs.size());
+  m_indexer->indices(aCellIDs, indices);
+  for (size_t i = 0; i < aCellIDs.size(); ++i) {
+    aNoiseRMS[i] = indices[i] != k4::recCalo::ICaloIndexer::INVALID ? m_noiseTable->noiseRMS(indices[i])
+                                                                    : computeNoiseRMSPerCell(aCellIDs[i]);
+  }
+}
+
+double NoiseCaloCellsFromFileTool::computeNoiseRMSPerCell(uint64_t aCellId) const {
   const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo* segmentation = m_segmentationPhiEta;
   if (segmentation == nullptr) {
     segmentation = dynamic_cast<const dd4hep::DDSegmentation::FCCSWGridPhiEta_k4geo*>(
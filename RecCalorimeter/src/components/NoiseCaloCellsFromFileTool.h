@@ -3,15 +3,17 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 
 // k4geo
 #include "detectorSegmentations/FCCSWGridPhiEta_k4geo.h"
 
 // Interfaces
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/ICellPositionsTool.h"
 #include "RecCaloCommon/INoiseCaloCellsTool.h"
+#include "RecCaloCommon/IndexedNoiseTable.h"
+#include "RecCaloCommon/SparseCellNoise.h"
 class IGeoSvc;
 
 // DD4hep
@@ -20,6 +22,9 @@ class IGeoSvc;
 // Root
 class TH1F;
 
+#include <memory>
+#include <mutex>
+
 /** @class NoiseCaloCellsFromFileTool
  *
  *  Tool for calorimeter noise
@@ -27,6 +32,15 @@ class TH1F;
  *  createRandomCellNoise: Create random CaloHits (gaussian distribution) for the vector of cells
  *  filterCellNoise: remove cells with energy bellow threshold*sigma from the vector of cells
  *
+ *  The random numbers are drawn from a k4::recCalo::CounterRng keyed by "randomSeed", the tool name,
+ *  and the run and event numbers, with the cell ID as the counter, so that the noise of each cell
+ *  does not depend on the order in which events are processed or on the number of threads.
+ *
+ *  If "geometryTool" is set, the noise RMS of all of its cells is computed once at initialize
+ *  and stored (in single precision) in arrays indexed by the indexer of that tool,
+ *  so that no geometry or histogram lookups are needed per event.
+ *  Other cells are still looked up in the histograms on each call.
+ *
  *  @author Jana Faltova
  *  @date   2016-09
  *
@@ -56,17 +70,40 @@ public:
    */
   virtual void filterCellNoise(std::vector<std::pair<uint64_t, double>>& aCells) const override final;
 
+  /** @brief Add noise to cells and filter them, as if done for all cells of the calorimeter.
+   * Only the empty cells whose noise passes the filter are sampled (see SparseCellNoise).
+   */
+  virtual void addFilteredCellNoise(std::unordered_map<uint64_t, double>& aCells,
+                                    std::span<const uint64_t> allCells) const override final;
+
+  /** @brief Add noise to cells and filter them, as if done for all cells of the calorimeter.
+   * Only the empty cells whose noise passes the filter are sampled (see SparseCellNoise).
+   */
+  virtual void addFilteredCellNoise(std::vector<std::pair<uint64_t, double>>& aCells,
+                                    std::span<const uint64_t> allCells) const override final;
+
   /// Open file and read noise histograms in the memory
   StatusCode initNoiseFromFile();
-  /// Find the appropriate noise RMS from the histogram
+  /// Find the appropriate noise RMS from the histogram (or the cached table)
   double getNoiseRMSPerCell(uint64_t aCellID) const;
 
 private:
+  /// Find the noise RMS of a cell from the histograms.
+  double computeNoiseRMSPerCell(uint64_t aCellID) const;
+  /// Find the noise RMS of a set of cells, using the cached table where possible.
+  void getNoiseRMS(std::span<const uint64_t> aCellIDs, std::span<double> aNoiseRMS) const;
   template <typename C>
   void addRandomCellNoiseT(C& aCells) const;
   template <typename C>
   void filterCellNoiseT(C& aCells) const;
+  template <typename C>
+  void addFilteredCellNoiseT(C& aCells, std::span<const uint64_t> allCells) const;
+  /// Return the sampler for empty cells for the given list of all cells.
+  std::shared_ptr<const k4::recCalo::SparseCellNoise> sparseNoise(std::span<const uint64_t> allCells) const;
 
+  /// Handle for the geometry tool, whose cells have their noise cached
+  ToolHandle<k4::recCalo::ICalorimeterTool> m_geoTool{
+      this, "geometryTool", "", "Handle for the geometry tool; if set, the noise of its cells is cached at initialize"};
   /// Handle for tool to get cell positions
   ToolHandle<k4::recCalo::ICellPositionsTool> m_cellPositionsTool{this, "cellPositionsTool", "CellPositionsDummyTool",
                                                                   "Handle for tool to retrieve cell positions"};
@@ -107,10 +144,22 @@ private:
   /// Histograms with electronics noise RMS (index in array - radial layer)
   std::vector<TH1F> m_histoElecNoiseRMS;
 
-  /// Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  /// Gaussian random number generator used for the generation of random noise hits
-  Rndm::Numbers m_gauss;
+  /// Seed for the noise random numbers, which also depend on the run, event, and cell ID
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0,
+                                         "Seed for the noise random numbers; they also depend on the run, event, "
+                                         "and cell ID, and on the name of this tool"};
+  /// Random number stream of this tool, made from its name
+  uint64_t m_rngStream = 0;
+
+  /// Indexer of the geometry tool, or nullptr if the noise is not cached.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_indexer;
+  /// Noise RMS of the cells of the geometry tool (offsets are zero).
+  std::unique_ptr<const k4::recCalo::IndexedNoiseTable> m_noiseTable;
+
+  /// Sampler for empty cells, built on first use, and the cell list for which it was built.
+  mutable std::shared_ptr<const k4::recCalo::SparseCellNoise> m_sparseNoise;
+  mutable const uint64_t* m_sparseNoiseCells = nullptr;
+  mutable std::mutex m_sparseNoiseMutex;
 
   /// Pointer to the geometry service
   ServiceHandle<IGeoSvc> m_geoSvc{this, "GeoSvc", "GeoSvc"};
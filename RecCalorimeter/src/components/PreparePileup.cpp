@@ -207,15 +207,15 @@ StatusCode PreparePileup::execute(const EventContext&) const {
   }
 
   // create towers
-  m_towers.assign(m_nEtaTower, std::vector<float>(m_nPhiTower, 0));
-  m_towerTool->buildTowers(m_towers);
+  const k4::recCalo::CaloTowers caloTowers = m_towerTool->buildTowers(false);
+  const k4::recCalo::TowerGrid& towers = caloTowers.grid;
   for (uint iCluster = 0; iCluster < m_etaSizes.size(); iCluster++) {
     debug() << "Size of the reconstruction window (eta,phi) " << m_etaSizes[iCluster] << ", " << m_phiSizes[iCluster]
             << endmsg;
     // calculate the sum of first m_nEtaWindow bins in eta, for each phi tower
     std::vector<float> sumOverEta(m_nPhiTower, 0);
     for (size_t iEta = 0; iEta < m_etaSizes[iCluster]; iEta++) {
-      std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta].begin(), sumOverEta.begin(),
+      std::transform(sumOverEta.begin(), sumOverEta.end(), towers[iEta].begin(), sumOverEta.begin(),
                      std::plus<float>());
     }
     int halfEtaWin = floor(m_etaSizes[iCluster] / 2.);
@@ -242,10 +242,10 @@ StatusCode PreparePileup::execute(const EventContext&) const {
       // finish processing that slice, shift window to next eta tower
       if (iEta < m_nEtaTower - halfEtaWin - 1) {
         // substract first eta slice in current window
-        std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta - halfEtaWin].begin(), sumOverEta.begin(),
+        std::transform(sumOverEta.begin(), sumOverEta.end(), towers[iEta - halfEtaWin].begin(), sumOverEta.begin(),
                        std::minus<float>());
         // add next eta slice to the window
-        std::transform(sumOverEta.begin(), sumOverEta.end(), m_towers[iEta + halfEtaWin + 1].begin(),
+        std::transform(sumOverEta.begin(), sumOverEta.end(), towers[iEta + halfEtaWin + 1].begin(),
                        sumOverEta.begin(), std::plus<float>());
       }
     }
@@ -68,8 +68,6 @@ private:
   ToolHandle<k4::recCalo::ICalorimeterTool> m_geoTool{"TubeLayerPhiEtaCaloTool", this};
   /// Handle for the tower building tool
   mutable ToolHandle<k4::recCalo::ITowerTool> m_towerTool;
-  // calorimeter towers
-  mutable std::vector<std::vector<float>> m_towers;
   /// number of towers in eta (calculated from m_deltaEtaTower and the eta size of the first layer)
   int m_nEtaTower;
   /// Number of towers in phi (calculated from m_deltaPhiTower)
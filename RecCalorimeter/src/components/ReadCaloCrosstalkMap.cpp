@@ -1,4 +1,5 @@
 #include "ReadCaloCrosstalkMap.h"
+#include "RecCaloCommon/CaloMapFile.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 
 #include "TBranch.h"
@@ -29,6 +30,24 @@ StatusCode ReadCaloCrosstalkMap::initialize() {
     error() << "File path: " << m_fileName.value() << endmsg;
     return StatusCode::FAILURE;
   }
+
+  if (k4::recCalo::CaloMapFile::isCaloMapFile(m_fileName.value())) {
+    info() << "Using the following binary file with the crosstalk map: " << m_fileName.value() << endmsg;
+    try {
+      m_table = std::make_unique<k4::recCalo::CrosstalkTable>(
+          k4::recCalo::CrosstalkTable::fromMapFile(m_fileName.value(), m_verifyChecksum.value()));
+    } catch (const std::exception& e) {
+      error() << "Unable to read the crosstalk map: " << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    info() << "Total number of cells = " << m_table->size() << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+  return readTable();
+}
+
+StatusCode ReadCaloCrosstalkMap::readTable() {
   std::unique_ptr<TFile> xtalkFile(TFile::Open(m_fileName.value().c_str(), "READ"));
   if (xtalkFile->IsZombie()) {
     error() << "Unable to read the file with the crosstalk map!" << endmsg;
@@ -47,16 +66,32 @@ StatusCode ReadCaloCrosstalkMap::initialize() {
   tree->SetBranchAddress("cellId", &read_cellId);
   tree->SetBranchAddress("list_crosstalk_neighbours", &read_neighbours);
   tree->SetBranchAddress("list_crosstalks", &read_crosstalks);
+  std::vector<CellID> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<CellID> neighbourIDs;
+  std::vector<double> coefficients;
   for (uint i = 0; i < tree->GetEntries(); i++) {
     tree->GetEntry(i);
-    m_mapNeighbours.insert(std::pair<CellID, std::vector<CellID>>(read_cellId, *read_neighbours));
-    m_mapCrosstalks.insert(std::pair<CellID, std::vector<double>>(read_cellId, *read_crosstalks));
+    if (read_neighbours->size() != read_crosstalks->size()) {
+      error() << "Mismatched crosstalk neighbours and coefficients for cell " << read_cellId << endmsg;
+      return StatusCode::FAILURE;
+    }
+    cells.push_back(read_cellId);
+    neighbourIDs.insert(neighbourIDs.end(), read_neighbours->begin(), read_neighbours->end());
+    coefficients.insert(coefficients.end(), read_crosstalks->begin(), read_crosstalks->end());
+    offsets.push_back(neighbourIDs.size());
+  }
+
+  try {
+    m_table = std::make_unique<k4::recCalo::CrosstalkTable>(cells, offsets, neighbourIDs, coefficients);
+  } catch (const std::exception& e) {
+    error() << "Unable to make the crosstalk table: " << e.what() << endmsg;
+    return StatusCode::FAILURE;
   }
 
   info() << "Crosstalk input: " << m_fileName.value().c_str() << endmsg;
-  info() << "Total number of cells = " << tree->GetEntries()
-         << ", Size of crosstalk neighbours = " << m_mapNeighbours.size()
-         << ", Size of coefficients = " << m_mapCrosstalks.size() << endmsg;
+  info() << "Total number of cells = " << tree->GetEntries() << ", Size of crosstalk map = " << m_table->size()
+         << endmsg;
   delete tree;
   delete read_neighbours;
   delete read_crosstalks;
@@ -66,17 +101,9 @@ StatusCode ReadCaloCrosstalkMap::initialize() {
 }
 
 auto ReadCaloCrosstalkMap::getNeighbours(CellID aCellId) const -> std::span<const CellID> {
-  auto it = m_mapNeighbours.find(aCellId);
-  if (it != m_mapNeighbours.end()) {
-    return it->second;
-  }
-  return std::span<const CellID>();
+  return m_table->neighbours(aCellId);
 }
 
 std::span<const double> ReadCaloCrosstalkMap::getCrosstalks(CellID aCellId) const {
-  auto it = m_mapCrosstalks.find(aCellId);
-  if (it != m_mapCrosstalks.end()) {
-    return it->second;
-  }
-  return std::span<const double>();
+  return m_table->crosstalks(aCellId);
 }
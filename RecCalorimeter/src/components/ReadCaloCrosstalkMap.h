@@ -5,7 +5,9 @@
 #include "GaudiKernel/AlgTool.h"
 
 // Interface
+#include "RecCaloCommon/CrosstalkTable.h"
 #include "RecCaloCommon/ICaloReadCrosstalkMap.h"
+#include <memory>
 #include <span>
 
 class IGeoSvc;
@@ -17,6 +19,9 @@ class IGeoSvc;
  *"list_crosstalks". This tools reads the tree, creates two maps, and allows a lookup of all crosstalk neighbours as
  *well as the corresponding crosstalk coefficients for a given cell.
  *
+ *  The file may also be in the binary format of k4::recCalo::CaloMapFile (as made by k4CaloMapConvert),
+ *  in which case it is mapped into memory and used in place.
+ *
  *  @author Zhibo Wu
  */
 
@@ -40,14 +45,19 @@ public:
   virtual std::span<const double> getCrosstalks(CellID aCellId) const final override;
 
 private:
+  /// Read the crosstalk map from the TTree in the file.
+  StatusCode readTable();
+
   /// Name of input root file that contains the TTree with cellID->vec<list_crosstalk_neighboursCellID> and
   /// cellId->vec<list_crosstalksCellID>
   Gaudi::Property<std::string> m_fileName{this, "fileName", "",
                                           "Name of the file that contains the crosstalk map. Leave the default empty "
                                           "to avoid crashes when cross-talk is not needed."};
-  /// Output maps to be used for the fast lookup in the creating calo-cells algorithm
-  std::unordered_map<CellID, std::vector<CellID>> m_mapNeighbours;
-  std::unordered_map<CellID, std::vector<double>> m_mapCrosstalks;
+  /// Verify the checksum of the contents of a binary map file.
+  Gaudi::Property<bool> m_verifyChecksum{this, "verifyChecksum", true,
+                                         "Verify the checksum of the contents of a binary map file"};
+  /// Output table to be used for the fast lookup in the creating calo-cells algorithm
+  std::unique_ptr<k4::recCalo::CrosstalkTable> m_table;
 };
 
 #endif /* RECCALORIMETER_READCALOXTALKMAP_H */
@@ -1,5 +1,6 @@
 #include "SimulateSiPMwithContrib.h"
 #include "DD4hep/DD4hepUnits.h"
+#include "RecCaloCommon/EventRng.h"
 #include <cmath>
 
 DECLARE_COMPONENT(SimulateSiPMwithContrib)
@@ -19,18 +20,7 @@ StatusCode SimulateSiPMwithContrib::initialize() {
   if (sc.isFailure())
     return sc;
 
-  // Initialize random services
-  m_randSvc = service("RndmGenSvc", false);
-
-  if (!m_randSvc) {
-    error() << "Couldn't get RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
-
-  if (m_rndmExp.initialize(m_randSvc, Rndm::Exponential(m_scintDecaytime.value())).isFailure()) {
-    error() << "Couldn't initialize RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   // initialize SiPM properties
   sipm::SiPMProperties properties;
@@ -61,10 +51,11 @@ StatusCode SimulateSiPMwithContrib::initialize() {
   return StatusCode::SUCCESS;
 }
 
-StatusCode SimulateSiPMwithContrib::execute(const EventContext&) const {
+StatusCode SimulateSiPMwithContrib::execute(const EventContext& ctx) const {
   const edm4hep::SimCalorimeterHitCollection* scintHits = m_simHits.get();
   edm4hep::CalorimeterHitCollection* digiHits = m_digiHits.createAndPut();
   auto* links = m_hitLinks.createAndPut();
+  const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed, m_rngStream, ctx);
 
   // loop through the hits (each hit corresponds to a fiber)
   for (unsigned int idx = 0; idx < scintHits->size(); idx++) {
@@ -79,7 +70,9 @@ StatusCode SimulateSiPMwithContrib::execute(const EventContext&) const {
     std::vector<double> vecWavelens;
 
     // loop through the hit contributions
-    for (auto contrib = scintHit.contributions_begin(); contrib != scintHit.contributions_end(); ++contrib) {
+    uint32_t icontrib = 0;
+    for (auto contrib = scintHit.contributions_begin(); contrib != scintHit.contributions_end();
+         ++contrib, ++icontrib) {
 
       if (!contrib->isAvailable()) {
         std::cerr << "ERROR: Hit contribution not available!" << std::endl;
@@ -95,7 +88,7 @@ StatusCode SimulateSiPMwithContrib::execute(const EventContext&) const {
       double thisTime = time;
       // if it is a scintillation hit, add scintillation decay time
       if (!m_isCherenkov) {
-        thisTime += m_rndmExp.shoot();
+        thisTime -= m_scintDecaytime.value() * std::log(rng.flat(scintHit.getCellID(), icontrib));
       }
 
       for (unsigned int pe = 0; pe < npe; pe++) {
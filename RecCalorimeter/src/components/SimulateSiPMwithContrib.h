@@ -10,8 +10,6 @@
 #include "k4FWCore/DataHandle.h"
 
 #include "Gaudi/Algorithm.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 #include "GaudiKernel/ToolHandle.h"
 
 // Check for SiPMSensor header location (similar to how DigiSiPM handles this)
@@ -37,6 +35,11 @@
  *  - Cell recovery time
  *  - Signal rise and fall times
  *
+ *  The scintillation decay times are drawn from a k4::recCalo::CounterRng keyed by
+ *  "randomSeed", the algorithm name, the run and event numbers, the cell ID, and the
+ *  index of the contribution within the hit.
+ *  (The noise simulated within the SiPM sensor itself uses the SimSiPM generator.)
+ *
  *  @author Lorenzo Pezzotti
  *  @date   2026-02-17
  */
@@ -51,9 +54,9 @@ public:
   StatusCode finalize();
 
 private:
-  // Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  Rndm::Numbers m_rndmExp;
+  // Random numbers
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0, "Seed for the scintillation decay times"};
+  uint64_t m_rngStream = 0;
 
   // readout name and segmentation (of specific type)
   // Not used for the moment, might be used in future
@@ -1,5 +1,6 @@
 #include "SimulateSiPMwithEdep.h"
 #include "DD4hep/DD4hepUnits.h"
+#include "RecCaloCommon/EventRng.h"
 #include <cmath>
 
 DECLARE_COMPONENT(SimulateSiPMwithEdep)
@@ -13,23 +14,7 @@ StatusCode SimulateSiPMwithEdep::initialize() {
   if (sc.isFailure())
     return sc;
 
-  // Initialize random services
-  m_randSvc = service("RndmGenSvc", false);
-
-  if (!m_randSvc) {
-    error() << "Couldn't get RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
-
-  if (m_rndmUniform.initialize(m_randSvc, Rndm::Flat(0., 1.)).isFailure()) {
-    error() << "Couldn't initialize RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
-
-  if (m_rndmExp.initialize(m_randSvc, Rndm::Exponential(m_scintDecaytime.value())).isFailure()) {
-    error() << "Couldn't initialize RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   if (m_wavelen.size() < 2) {
     error() << "SimulateSiPMwithEdep: "
@@ -133,13 +118,14 @@ std::vector<double> SimulateSiPMwithEdep::integral(const std::vector<double>& wa
   return result;
 }
 
-StatusCode SimulateSiPMwithEdep::execute(const EventContext&) const {
+StatusCode SimulateSiPMwithEdep::execute(const EventContext& ctx) const {
   const edm4hep::SimCalorimeterHitCollection* scintHits = m_scintHits.get();
   edm4hep::CalorimeterHitCollection* digiHits = m_digiHits.createAndPut();
   edm4hep::TimeSeriesCollection* waveforms = m_waveforms.createAndPut();
   edm4hep::CaloHitSimCaloHitLinkCollection* hitLinks = m_hitLinks.createAndPut();
 
   const double yield = m_scintYield.value() / dd4hep::keV;
+  const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed, m_rngStream, ctx);
 
   for (unsigned int idx = 0; idx < scintHits->size(); idx++) {
     const auto& scintHit = scintHits->at(idx);
@@ -151,20 +137,22 @@ StatusCode SimulateSiPMwithEdep::execute(const EventContext&) const {
     // SimSiPM ignores negative time photons, so translate the whole time structure if needed
     double minTime = 0.;
 
+    uint32_t icontrib = 0;
     for (auto contrib = scintHit.contributions_begin(); contrib != scintHit.contributions_end(); ++contrib) {
       const double edep = contrib->getEnergy() * dd4hep::GeV;
       double avgNphoton = edep * yield * m_efficiency;
 
+      // all random numbers for this contribution
+      auto rnd = rng.sequence(scintHit.getCellID(), icontrib++);
+
       // generate the number of p.e. (npe)
       unsigned npe = 0;
 
       if (avgNphoton < 10.) {
-        Rndm::Numbers rnd(m_randSvc, Rndm::Poisson(avgNphoton));
-        npe = static_cast<unsigned>(std::floor(rnd.shoot() + 0.5));
+        npe = rnd.poisson(avgNphoton);
       } else {
-        Rndm::Numbers rnd(m_randSvc, Rndm::Gauss(avgNphoton, std::sqrt(avgNphoton)));
         // prevent underflow since Gaussian can shoot negative in rare case
-        double val = std::floor(rnd.shoot() + 0.5);
+        double val = std::floor(avgNphoton + std::sqrt(avgNphoton) * rnd.gauss() + 0.5);
         npe = static_cast<unsigned>(std::max(val, 0.));
       }
 
@@ -190,7 +178,7 @@ StatusCode SimulateSiPMwithEdep::execute(const EventContext&) const {
         // get photon wavelength
         // similar to
         // https://gitlab.cern.ch/geant4/geant4/-/blob/master/source/processes/electromagnetic/xrays/src/G4Scintillation.cc
-        const double randval = m_integral.back() * m_rndmUniform.shoot();
+        const double randval = m_integral.back() * rnd();
         unsigned xhigh = 1;
 
         for (xhigh = 1; xhigh < m_integral.size() - 1; xhigh++) {
@@ -225,7 +213,7 @@ StatusCode SimulateSiPMwithEdep::execute(const EventContext&) const {
 
           // check absorption
           // similar to https://gitlab.cern.ch/geant4/geant4/-/blob/master/source/processes/management/src/G4VProcess.cc
-          const double nInteractionLengthLeft = -std::log(m_rndmUniform.shoot());
+          const double nInteractionLengthLeft = -std::log(rnd());
           const double nInteractionLength = dist / (absLen * dd4hep::meter);
 
           // absorb photons
@@ -234,7 +222,7 @@ StatusCode SimulateSiPMwithEdep::execute(const EventContext&) const {
         }
 
         // get scintillation time
-        double scintTime = arrivalTime + m_rndmExp.shoot();
+        double scintTime = arrivalTime - m_scintDecaytime.value() * std::log(rnd());
 
         if (scintTime < minTime)
           minTime = scintTime;
@@ -10,8 +10,6 @@
 #include "k4FWCore/DataHandle.h"
 
 #include "Gaudi/Algorithm.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 #include "GaudiKernel/ToolHandle.h"
 
 // geometry (needed for timing, based on the distance btn the step and the rear end of the fiber)
@@ -38,6 +36,11 @@
  *  - Cell recovery time
  *  - Signal rise and fall times
  *
+ *  The photon statistics, wavelengths, absorption and emission times are drawn from
+ *  a k4::recCalo::CounterRng keyed by "randomSeed", the algorithm name, the run and event
+ *  numbers, the cell ID, and the index of the contribution within the hit.
+ *  (The noise simulated within the SiPM sensor itself uses the SimSiPM generator.)
+ *
  *  @author Sanghyun Ko
  *  @date   2025-03-27
  */
@@ -54,10 +57,9 @@ public:
 private:
   std::vector<double> integral(const std::vector<double>& wavelen, const std::vector<double>& yval) const;
 
-  // Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  Rndm::Numbers m_rndmUniform;
-  Rndm::Numbers m_rndmExp;
+  // Random numbers
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0, "Seed for the photon random numbers"};
+  uint64_t m_rngStream = 0;
 
   // requires GeoSvc and segmentation to estimate timing & attenuation
   SmartIF<IGeoSvc> m_geoSvc;
@@ -1,4 +1,5 @@
 #include "SimulateSiPMwithOpticalPhoton.h"
+#include "RecCaloCommon/EventRng.h"
 
 // DECLARE_COMPONENT macro connects the algorithm to the framework
 DECLARE_COMPONENT(SimulateSiPMwithOpticalPhoton)
@@ -15,18 +16,7 @@ StatusCode SimulateSiPMwithOpticalPhoton::initialize() {
   if (sc.isFailure())
     return sc;
 
-  // Initialize random services
-  m_randSvc = service("RndmGenSvc", false);
-
-  if (!m_randSvc) {
-    error() << "Couldn't get RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
-
-  if (m_rndmUniform.initialize(m_randSvc, Rndm::Flat(0., 1.)).isFailure()) {
-    error() << "Couldn't initialize RndmGenSvc!" << endmsg;
-    return StatusCode::FAILURE;
-  }
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   if (m_wavelen.size() < 2) {
     error() << "SimulateSiPMwithOpticalPhoton: "
@@ -88,7 +78,7 @@ std::vector<double> SimulateSiPMwithOpticalPhoton::integral(const std::vector<do
   return result;
 }
 
-StatusCode SimulateSiPMwithOpticalPhoton::execute(const EventContext&) const {
+StatusCode SimulateSiPMwithOpticalPhoton::execute(const EventContext& ctx) const {
   // Get input collections
   const edm4hep::RawTimeSeriesCollection* timeStructs = m_timeStruct.get();
   const edm4hep::RawTimeSeriesCollection* waveLenStructs = m_wavelenStruct.get();
@@ -98,6 +88,8 @@ StatusCode SimulateSiPMwithOpticalPhoton::execute(const EventContext&) const {
   edm4hep::TimeSeriesCollection* waveforms = m_waveforms.createAndPut();
   edm4hep::CalorimeterHitCollection* digiHits = m_digiHits.createAndPut();
 
+  const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed, m_rngStream, ctx);
+
   // Process each hit
   for (unsigned int idx = 0; idx < timeStructs->size(); idx++) {
     const auto& timeStruct = timeStructs->at(idx);
@@ -158,6 +150,7 @@ StatusCode SimulateSiPMwithOpticalPhoton::execute(const EventContext&) const {
     }
 
     // now fill the photon vectors
+    auto rnd = rng.sequence(timeStruct.getCellID());
     for (unsigned int bin = 0; bin < timeStruct.adcCounts_size(); bin++) {
       int counts = static_cast<int>(timeStruct.getAdcCounts(bin));
       double timeBin = timeStruct.getTime() + timeStruct.getInterval() * (static_cast<float>(bin) + 0.5);
@@ -167,7 +160,7 @@ StatusCode SimulateSiPMwithOpticalPhoton::execute(const EventContext&) const {
         vecTimes.emplace_back(timeBin - minTime); // shift to non-negative time
 
         // generate wavelength
-        const double randval = integralSpectrum.back() * m_rndmUniform.shoot();
+        const double randval = integralSpectrum.back() * rnd();
         unsigned xhigh = 1;
 
         for (; xhigh < integralSpectrum.size() - 1; xhigh++) {
@@ -12,8 +12,6 @@
 
 // Gaudi includes
 #include "Gaudi/Algorithm.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 #include "GaudiKernel/ToolHandle.h"
 
 // Check for SiPMSensor header location (similar to how DigiSiPM handles this)
@@ -36,6 +34,10 @@
  *  - Cell recovery time
  *  - Signal rise and fall times
  *
+ *  The photon wavelengths are drawn from a k4::recCalo::CounterRng keyed by "randomSeed",
+ *  the algorithm name, the run and event numbers, and the cell ID.
+ *  (The noise simulated within the SiPM sensor itself uses the SimSiPM generator.)
+ *
  *  @author Sanghyun Ko
  *  @author Sungwon Kim
  *  @date   2025-03-18
@@ -54,9 +56,9 @@ private:
   // integral function for the wavelength random generation
   std::vector<double> integral(const std::vector<double>& wavelen, const std::vector<double>& yval) const;
 
-  // Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  Rndm::Numbers m_rndmUniform;
+  // Random numbers
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0, "Seed for the photon random numbers"};
+  uint64_t m_rngStream = 0;
 
   // input collection names
   Gaudi::Property<std::string> m_hitColl{this, "inputHitCollection", "DRcaloSiPMreadoutSimHit",
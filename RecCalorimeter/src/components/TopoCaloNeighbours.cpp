@@ -1,11 +1,17 @@
 #include "TopoCaloNeighbours.h"
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/MultiIndexer.h"
 #include "k4FWCore/GaudiChecks.h"
 
+#include "DDSegmentation/BitFieldCoder.h"
+
 #include "TBranch.h"
 #include "TFile.h"
 #include "TSystem.h"
 #include "TTree.h"
 
+#include <stdexcept>
+
 DECLARE_COMPONENT(TopoCaloNeighbours)
 
 StatusCode TopoCaloNeighbours::initialize() {
@@ -16,51 +22,174 @@ StatusCode TopoCaloNeighbours::initialize() {
     error() << "Proper filepath for the neighbours map not provided!" << endmsg;
     return StatusCode::FAILURE;
   }
+
+  if (!m_constantsSvc.retrieve()) {
+    error() << "Unable to retrieve the cell constants service!!!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // The table may have already been read by another instance of this tool.
+  std::string keyName = "neighbours-" + m_fileName.value();
+  m_table = m_constantsSvc->getObj<k4::recCalo::NeighbourTable>(keyName);
+  if (m_table) {
+    info() << "Using the neighbours map already read from: " << m_fileName.value() << endmsg;
+    return indexTable(keyName);
+  }
+
   if (gSystem->AccessPathName(m_fileName.value().c_str())) {
     error() << "Provided neighbours map file not found!" << endmsg;
     error() << "File path: " << m_fileName.value() << endmsg;
     return StatusCode::FAILURE;
   }
-  std::unique_ptr<TFile> inFile(TFile::Open(m_fileName.value().c_str(), "READ"));
-  if (inFile->IsZombie()) {
-    error() << "Unable to open the provide file with neighbours map!" << endmsg;
-    error() << "File path: " << m_fileName.value() << endmsg;
-    return StatusCode::FAILURE;
+  if (k4::recCalo::CaloMapFile::isCaloMapFile(m_fileName.value())) {
+    K4_GAUDI_CHECK(mapTable(keyName));
   } else {
-    info() << "Using the following file with neighbours map: " << m_fileName.value() << endmsg;
+    K4_GAUDI_CHECK(readTable(keyName));
   }
+  m_table = m_constantsSvc->getObj<k4::recCalo::NeighbourTable>(keyName);
+  K4_GAUDI_CHECK(m_table != nullptr);
 
-  TTree* tree = nullptr;
-  inFile->GetObject("neighbours", tree);
-  ULong64_t readCellId;
-  std::vector<uint64_t>* readNeighbours = nullptr;
-  tree->SetBranchAddress("cellId", &readCellId);
-  tree->SetBranchAddress("neighbours", &readNeighbours);
-  for (uint i = 0; i < tree->GetEntries(); i++) {
-    tree->GetEntry(i);
-    m_map.insert(std::pair<uint64_t, std::vector<uint64_t>>(readCellId, *readNeighbours));
-  }
   std::vector<int> counterL;
   counterL.assign(100, 0);
-  for (const auto& item : m_map) {
-    counterL[item.second.size()]++;
+  for (size_t i = 0; i < m_table->size(); i++) {
+    counterL[m_table->neighbours(i).size()]++;
   }
   for (uint iCount = 0; iCount < counterL.size(); iCount++) {
     if (counterL[iCount] != 0) {
       info() << counterL[iCount] << " cells have " << iCount << " neighbours" << endmsg;
     }
   }
-  delete tree;
-  delete readNeighbours;
-  inFile->Close();
+
+  return indexTable(keyName);
+}
+
+StatusCode TopoCaloNeighbours::indexTable(const std::string& keyName) {
+  if (m_caloTools.empty()) {
+    return StatusCode::SUCCESS;
+  }
+  if (!m_caloTools.retrieve()) {
+    error() << "Unable to retrieve the calorimeter tools!!!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // Set up the indexer for all cells of the calorimeters
+  std::vector<std::unique_ptr<k4::recCalo::ICaloIndexer>> caloIndexers;
+  std::vector<const k4::recCalo::ICaloIndexer*> indexers;
+  std::string indexedKeyName = keyName + "-indexed";
+  for (auto& caloTool : m_caloTools) {
+    std::unique_ptr<k4::recCalo::ICaloIndexer> indexer = caloTool->indexer();
+    if (!indexer) {
+      error() << "Calorimeter tool " << caloTool.name() << " does not provide an indexer!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    indexers.push_back(indexer.get());
+    caloIndexers.push_back(std::move(indexer));
+    indexedKeyName += "-" + caloTool->readoutName();
+  }
+  const k4::recCalo::ICaloIndexer* indexer = indexers[0];
+  std::unique_ptr<k4::recCalo::ICaloIndexer> multiIndexer;
+  if (indexers.size() > 1) {
+    dd4hep::DDSegmentation::BitFieldCoder decoder(m_systemEncoding);
+    try {
+      multiIndexer = std::make_unique<k4::recCalo::MultiIndexer>(decoder[decoder.index("system")].width(), indexers,
+                                                                 *m_constantsSvc);
+    } catch (const std::exception& e) {
+      error() << "Unable to combine the calorimeter indexers: " << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    indexer = multiIndexer.get();
+  }
+
+  // The re-indexed table may have already been made by another instance of this tool.
+  // It does not refer to the indexer, so it may outlive it.
+  const k4::recCalo::NeighbourTable* table = m_constantsSvc->getObj<k4::recCalo::NeighbourTable>(indexedKeyName);
+  if (!table) {
+    info() << "Indexing the neighbours map like the " << indexer->cellIDs().size() << " cells of the calorimeter tools"
+           << endmsg;
+    try {
+      m_constantsSvc->putObj(indexedKeyName, k4::recCalo::NeighbourTable(*indexer, *m_table));
+    } catch (const std::exception& e) {
+      error() << "Unable to index the neighbours table: " << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    table = m_constantsSvc->getObj<k4::recCalo::NeighbourTable>(indexedKeyName);
+    K4_GAUDI_CHECK(table != nullptr);
+  }
+  if (!table->matches(*indexer)) {
+    error() << "Neighbours table " << indexedKeyName << " was made for different cells!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  m_table = table;
+  return StatusCode::SUCCESS;
+}
+
+StatusCode TopoCaloNeighbours::mapTable(const std::string& keyName) {
+  info() << "Using the following binary file with neighbours map: " << m_fileName.value() << endmsg;
+  try {
+    K4_GAUDI_CHECK(m_constantsSvc->putObj(
+        keyName, k4::recCalo::NeighbourTable::fromMapFile(m_fileName.value(), m_verifyChecksum.value())));
+  } catch (const std::exception& e) {
+    error() << "Unable to read the neighbours map: " << e.what() << endmsg;
+    return StatusCode::FAILURE;
+  }
+  return StatusCode::SUCCESS;
+}
+
+StatusCode TopoCaloNeighbours::readTable(const std::string& keyName) {
+  // Reading the TTree is slow, so the resulting table may be shared
+  // with other processes via the constants service.
+  auto build = [&]() {
+    std::unique_ptr<TFile> inFile(TFile::Open(m_fileName.value().c_str(), "READ"));
+    if (!inFile || inFile->IsZombie())
+      throw std::runtime_error("unable to open " + m_fileName.value());
+    info() << "Using the following file with neighbours map: " << m_fileName.value() << endmsg;
+
+    TTree* tree = nullptr;
+    inFile->GetObject("neighbours", tree);
+    if (!tree)
+      throw std::runtime_error("no neighbours tree in " + m_fileName.value());
+    ULong64_t readCellId;
+    std::vector<uint64_t>* readNeighbours = nullptr;
+    tree->SetBranchAddress("cellId", &readCellId);
+    tree->SetBranchAddress("neighbours", &readNeighbours);
+
+    // Collect the map in compressed-sparse-row form, keyed by cell ID.
+    std::vector<CellID> cells;
+    std::vector<uint64_t> offsets{0};
+    std::vector<CellID> neighbourIDs;
+    cells.reserve(tree->GetEntries());
+    offsets.reserve(tree->GetEntries() + 1);
+    for (uint i = 0; i < tree->GetEntries(); i++) {
+      tree->GetEntry(i);
+      cells.push_back(readCellId);
+      neighbourIDs.insert(neighbourIDs.end(), readNeighbours->begin(), readNeighbours->end());
+      offsets.push_back(neighbourIDs.size());
+    }
+    delete tree;
+    delete readNeighbours;
+    inFile->Close();
+
+    return k4::recCalo::NeighbourTable(cells, offsets, neighbourIDs);
+  };
+
+  try {
+    K4_GAUDI_CHECK(m_constantsSvc->getOrMakeObj<k4::recCalo::NeighbourTable>(
+                       keyName, k4::recCalo::ICaloCellConstantsSvc::fileVersion(m_fileName.value()), build) !=
+                   nullptr);
+  } catch (const std::exception& e) {
+    error() << "Unable to make the neighbours table: " << e.what() << endmsg;
+    return StatusCode::FAILURE;
+  }
 
   return StatusCode::SUCCESS;
 }
 
 auto TopoCaloNeighbours::neighbours(CellID aCellId) const -> const std::vector<CellID>& {
-  auto it = m_map.find(aCellId);
-  if (it != m_map.end())
-    return it->second;
-  static const std::vector<CellID> empty;
-  return empty;
+  // Adapter for callers using cell IDs.  The result is only valid until the next
+  // call from the same thread.
+  thread_local std::vector<CellID> result;
+  m_table->neighbourIDs(aCellId, result);
+  return result;
 }
+
+const k4::recCalo::NeighbourTable* TopoCaloNeighbours::neighbourTable() const { return m_table; }
@@ -3,9 +3,13 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ServiceHandle.h"
+#include "GaudiKernel/ToolHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/ICaloCellConstantsSvc.h"
 #include "RecCaloCommon/ICaloReadNeighboursMap.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 
 class IGeoSvc;
 
@@ -15,6 +19,17 @@ class IGeoSvc;
  *  Tool that reads a ROOT file containing the TTree with branch "cellId" and branch "neighbours".
  *  This tools reads the tree, creates a map, and allows a lookup of all neighbours of a cell.
  *
+ *  The map is held as a k4::recCalo::NeighbourTable in the CaloCellConstantsSvc, so that it is shared
+ *  between all instances of this tool reading the same file.
+ *
+ *  The file may also be in the binary format of k4::recCalo::CaloMapFile (as made by k4CaloMapConvert),
+ *  in which case it is mapped into memory and used in place.
+ *
+ *  If "calorimeterTools" are given, the table returned by neighbourTable() is re-indexed like the
+ *  indexers of those tools (combined if there are several calorimeters), so that clients indexing the
+ *  same cells (such as CaloTopoClusterFCCee with the same "calorimeterTools") can use the neighbour
+ *  indices directly, without looking up the neighbour cell IDs.
+ *
  *  @author Anna Zaborowska
  *  @author Coralie Neubueser
  */
@@ -33,11 +48,35 @@ public:
    */
   virtual const std::vector<CellID>& neighbours(CellID aCellId) const final override;
 
+  /** Return the neighbours as a compact table indexed by cell.
+   *  If calorimeter tools are configured, the table is indexed like their indexer.
+   */
+  virtual const k4::recCalo::NeighbourTable* neighbourTable() const final override;
+
 private:
+  /// Read the TTree and record the neighbour table in the constants service
+  /// (or attach to a copy shared by another process).
+  StatusCode readTable(const std::string& keyName);
+  /// Map the binary file and record the neighbour table in the constants service.
+  StatusCode mapTable(const std::string& keyName);
+  /// If calorimeter tools are configured, replace the table by one indexed like their cells.
+  StatusCode indexTable(const std::string& keyName);
+
   /// Name of input root file that contains the TTree with cellID->vec<neighboursCellID>
   Gaudi::Property<std::string> m_fileName{this, "fileName", "neighbours_map.root"};
-  /// Output map to be used for the fast lookup in the topo-clusering algorithm
-  std::unordered_map<CellID, std::vector<CellID>> m_map;
+  /// Verify the checksum of the contents of a binary map file.
+  Gaudi::Property<bool> m_verifyChecksum{this, "verifyChecksum", true,
+                                         "Verify the checksum of the contents of a binary map file"};
+  /// Geometry tools of the calorimeters, whose indexer is used to index the table.
+  ToolHandleArray<k4::recCalo::ICalorimeterTool> m_caloTools{
+      this, "calorimeterTools", {}, "Geometry tools of the calorimeters; if given, index the table like their cells"};
+  /// System encoding string, used to combine the indexers of several calorimeters.
+  Gaudi::Property<std::string> m_systemEncoding{this, "systemEncoding", "system:4", "System encoding string"};
+  /// Handle to the cell constants service, which holds the neighbour table.
+  ServiceHandle<k4::recCalo::ICaloCellConstantsSvc> m_constantsSvc{this, "CaloCellConstantsSvc",
+                                                                   "k4::recCalo::CaloCellConstantsSvc", ""};
+  /// Table to be used for the fast lookup in the topo-clusering algorithm
+  const k4::recCalo::NeighbourTable* m_table = nullptr;
 };
 
 #endif /* RECCALORIMETER_TOPOCALONEIGHBOURS_H */
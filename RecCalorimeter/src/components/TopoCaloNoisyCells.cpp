@@ -1,4 +1,5 @@
 #include "TopoCaloNoisyCells.h"
+#include "RecCaloCommon/CaloMapFile.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 
 #include "TBranch.h"
@@ -6,6 +7,8 @@
 #include "TSystem.h"
 #include "TTree.h"
 
+#include <stdexcept>
+
 DECLARE_COMPONENT(TopoCaloNoisyCells)
 
 StatusCode TopoCaloNoisyCells::initialize() {
@@ -21,55 +24,89 @@ StatusCode TopoCaloNoisyCells::initialize() {
     error() << "File path: " << m_fileName.value() << endmsg;
     return StatusCode::FAILURE;
   }
-  std::unique_ptr<TFile> inFile(TFile::Open(m_fileName.value().c_str(), "READ"));
-  if (inFile->IsZombie()) {
-    error() << "Unable to open the file with the noisy cells!" << endmsg;
-    error() << "File path: " << m_fileName.value() << endmsg;
-    return StatusCode::FAILURE;
-  } else {
-    info() << "Using the following file with the noisy cells: " << m_fileName.value() << endmsg;
+
+  K4RECCALORIMETER_CHECK(m_constantsSvc.retrieve());
+
+  // The table may have already been read by another instance of this tool.
+  std::string keyName = "noisyCells-" + m_fileName.value();
+  m_table = m_constantsSvc->getObj<k4::recCalo::CellNoiseTable>(keyName);
+  if (m_table) {
+    info() << "Using the noisy cells already read from: " << m_fileName.value() << endmsg;
+    return StatusCode::SUCCESS;
   }
 
-  TTree* tree = nullptr;
-  inFile->GetObject("noisyCells", tree);
-  ULong64_t readCellId;
-  double readNoisyCells;
-  double readNoisyCellsOffset;
-  tree->SetBranchAddress("cellId", &readCellId);
-  tree->SetBranchAddress("noiseLevel",
-                         &readNoisyCells); // would be better to call branch noiseRMS rather than noiseLevel
-  tree->SetBranchAddress("noiseOffset", &readNoisyCellsOffset);
-  for (uint i = 0; i < tree->GetEntries(); i++) {
-    tree->GetEntry(i);
-    m_map.insert(std::pair<uint64_t, std::pair<double, double>>(readCellId,
-                                                                std::make_pair(readNoisyCells, readNoisyCellsOffset)));
+  if (k4::recCalo::CaloMapFile::isCaloMapFile(m_fileName.value())) {
+    info() << "Using the following binary file with the noisy cells: " << m_fileName.value() << endmsg;
+    try {
+      m_constantsSvc->putObj(keyName,
+                             k4::recCalo::CellNoiseTable::fromMapFile(m_fileName.value(), m_verifyChecksum.value()));
+    } catch (const std::exception& e) {
+      error() << "Unable to read the noisy cells: " << e.what() << endmsg;
+      return StatusCode::FAILURE;
+    }
+  } else {
+    K4RECCALORIMETER_CHECK(readTable(keyName));
   }
-  delete tree;
-  inFile->Close();
+  m_table = m_constantsSvc->getObj<k4::recCalo::CellNoiseTable>(keyName);
+  K4RECCALORIMETER_CHECK(m_table != nullptr);
 
   return StatusCode::SUCCESS;
 }
 
-double TopoCaloNoisyCells::getNoiseRMSPerCell(CellID aCellId) const {
-  auto it = m_map.find(aCellId);
-  if (it != m_map.end()) {
-    return it->second.first;
-  }
-  return 0;
-}
+StatusCode TopoCaloNoisyCells::readTable(const std::string& keyName) {
+  // Reading the TTree is slow, so the resulting table may be shared
+  // with other processes via the constants service.
+  auto build = [&]() {
+    std::unique_ptr<TFile> inFile(TFile::Open(m_fileName.value().c_str(), "READ"));
+    if (!inFile || inFile->IsZombie())
+      throw std::runtime_error("unable to open " + m_fileName.value());
+    info() << "Using the following file with the noisy cells: " << m_fileName.value() << endmsg;
+
+    TTree* tree = nullptr;
+    inFile->GetObject("noisyCells", tree);
+    if (!tree)
+      throw std::runtime_error("no noisyCells tree in " + m_fileName.value());
+    ULong64_t readCellId;
+    double readNoisyCells;
+    double readNoisyCellsOffset;
+    tree->SetBranchAddress("cellId", &readCellId);
+    tree->SetBranchAddress("noiseLevel",
+                           &readNoisyCells); // would be better to call branch noiseRMS rather than noiseLevel
+    tree->SetBranchAddress("noiseOffset", &readNoisyCellsOffset);
+    std::vector<CellID> cells;
+    std::vector<double> noiseRMS;
+    std::vector<double> noiseOffset;
+    cells.reserve(tree->GetEntries());
+    noiseRMS.reserve(tree->GetEntries());
+    noiseOffset.reserve(tree->GetEntries());
+    for (uint i = 0; i < tree->GetEntries(); i++) {
+      tree->GetEntry(i);
+      cells.push_back(readCellId);
+      noiseRMS.push_back(readNoisyCells);
+      noiseOffset.push_back(readNoisyCellsOffset);
+    }
+    delete tree;
+    inFile->Close();
+
+    return k4::recCalo::CellNoiseTable(cells, noiseRMS, noiseOffset);
+  };
 
-double TopoCaloNoisyCells::getNoiseOffsetPerCell(CellID aCellId) const {
-  auto it = m_map.find(aCellId);
-  if (it != m_map.end()) {
-    return it->second.second;
+  try {
+    K4RECCALORIMETER_CHECK(m_constantsSvc->getOrMakeObj<k4::recCalo::CellNoiseTable>(
+                               keyName, k4::recCalo::ICaloCellConstantsSvc::fileVersion(m_fileName.value()),
+                               build) != nullptr);
+  } catch (const std::exception& e) {
+    error() << "Unable to make the noisy cells table: " << e.what() << endmsg;
+    return StatusCode::FAILURE;
   }
-  return 0;
+
+  return StatusCode::SUCCESS;
 }
 
+double TopoCaloNoisyCells::getNoiseRMSPerCell(CellID aCellId) const { return m_table->noise(aCellId).first; }
+
+double TopoCaloNoisyCells::getNoiseOffsetPerCell(CellID aCellId) const { return m_table->noise(aCellId).second; }
+
 std::pair<double, double> TopoCaloNoisyCells::getNoisePerCell(CellID aCellId) const {
-  auto it = m_map.find(aCellId);
-  if (it != m_map.end()) {
-    return it->second;
-  }
-  return std::make_pair(0., 0.);
+  return m_table->noise(aCellId);
 }
@@ -3,8 +3,11 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ServiceHandle.h"
 
 // k4FWCore
+#include "RecCaloCommon/CellNoiseTable.h"
+#include "RecCaloCommon/ICaloCellConstantsSvc.h"
 #include "RecCaloCommon/INoiseConstTool.h"
 
 class IGeoSvc;
@@ -15,6 +18,11 @@ class IGeoSvc;
  *  Tool that reads a ROOT file containing the TTree with branchs "cellId", "noiseLevel", and "noiseOffset".
  *  This tool reads the tree, creates a map, and allows a lookup of noise level and mean noise of a cell, by its cellID.
  *
+ *  The file may also be in the binary format of k4::recCalo::CaloMapFile (as made by k4CaloMapConvert),
+ *  in which case it is mapped into memory and used in place.
+ *  The table is held in the CaloCellConstantsSvc, so that it is shared between instances of this tool,
+ *  and, when read from a TTree, possibly with other processes.
+ *
  *  @author Coralie Neubueser
  */
 
@@ -46,10 +54,21 @@ public:
   virtual std::pair<double, double> getNoisePerCell(CellID aCellId) const override final;
 
 private:
+  /// Read the TTree and record the noise table in the constants service
+  /// (or attach to a copy shared by another process).
+  StatusCode readTable(const std::string& keyName);
+
   /// Name
   Gaudi::Property<std::string> m_fileName{this, "fileName",
                                           "/afs/cern.ch/user/c/cneubuse/public/FCChh/cellNoise_map_segHcal.root"};
-  std::unordered_map<uint64_t, std::pair<double, double>> m_map;
+  /// Verify the checksum of the contents of a binary map file.
+  Gaudi::Property<bool> m_verifyChecksum{this, "verifyChecksum", true,
+                                         "Verify the checksum of the contents of a binary map file"};
+  /// Handle to the cell constants service, which holds the noise table.
+  ServiceHandle<k4::recCalo::ICaloCellConstantsSvc> m_constantsSvc{this, "CaloCellConstantsSvc",
+                                                                   "k4::recCalo::CaloCellConstantsSvc", ""};
+  /// Table of noise constants, owned by the constants service.
+  const k4::recCalo::CellNoiseTable* m_table = nullptr;
 };
 
 #endif /* RECCALORIMETER_TOPOCALONOISYCELLS_H */
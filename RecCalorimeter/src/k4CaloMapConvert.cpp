@@ -0,0 +1,150 @@
+/**
+ * @file RecCalorimeter/src/k4CaloMapConvert.cpp
+ * @date Oct, 2026
+ * @brief Convert calorimeter maps from ROOT TTrees to the binary CaloMapFile format.
+ *
+ * Usage: k4CaloMapConvert neighbours|noise|crosstalk INPUT.root OUTPUT
+ *
+ * The input files are those read by TopoCaloNeighbours, TopoCaloNoisyCells,
+ * and ReadCaloCrosstalkMap respectively; the output files may be given
+ * to the same tools in place of the ROOT files.
+ */
+
+#include "RecCaloCommon/CellNoiseTable.h"
+#include "RecCaloCommon/CrosstalkTable.h"
+#include "RecCaloCommon/NeighbourTable.h"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using CellID = k4::recCalo::NeighbourTable::CellID;
+
+TTree* getTree(TFile& file, const char* name) {
+  TTree* tree = nullptr;
+  file.GetObject(name, tree);
+  if (!tree)
+    throw std::runtime_error(std::string("TTree ") + name + " not found in " + file.GetName());
+  return tree;
+}
+
+void convertNeighbours(TFile& file, const std::string& output) {
+  std::unique_ptr<TTree> tree(getTree(file, "neighbours"));
+  ULong64_t readCellId;
+  std::vector<uint64_t>* readNeighbours = nullptr;
+  tree->SetBranchAddress("cellId", &readCellId);
+  tree->SetBranchAddress("neighbours", &readNeighbours);
+
+  std::vector<CellID> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<CellID> neighbourIDs;
+  for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+    tree->GetEntry(i);
+    cells.push_back(readCellId);
+    neighbourIDs.insert(neighbourIDs.end(), readNeighbours->begin(), readNeighbours->end());
+    offsets.push_back(neighbourIDs.size());
+  }
+  delete readNeighbours;
+
+  k4::recCalo::NeighbourTable table(cells, offsets, neighbourIDs);
+  table.writeMapFile(output);
+  std::cout << "Wrote " << table.size() << " cells with " << table.nEntries() << " neighbour entries to " << output
+            << "\n";
+}
+
+void convertNoise(TFile& file, const std::string& output) {
+  std::unique_ptr<TTree> tree(getTree(file, "noisyCells"));
+  ULong64_t readCellId;
+  double readNoiseRMS;
+  double readNoiseOffset;
+  tree->SetBranchAddress("cellId", &readCellId);
+  tree->SetBranchAddress("noiseLevel", &readNoiseRMS);
+  tree->SetBranchAddress("noiseOffset", &readNoiseOffset);
+
+  std::vector<CellID> cells;
+  std::vector<double> noiseRMS;
+  std::vector<double> noiseOffset;
+  for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+    tree->GetEntry(i);
+    cells.push_back(readCellId);
+    noiseRMS.push_back(readNoiseRMS);
+    noiseOffset.push_back(readNoiseOffset);
+  }
+
+  k4::recCalo::CellNoiseTable table(cells, noiseRMS, noiseOffset);
+  table.writeMapFile(output);
+  std::cout << "Wrote noise for " << table.size() << " cells to " << output << "\n";
+}
+
+void convertCrosstalk(TFile& file, const std::string& output) {
+  std::unique_ptr<TTree> tree(getTree(file, "crosstalk_neighbours"));
+  ULong64_t readCellId;
+  std::vector<uint64_t>* readNeighbours = nullptr;
+  std::vector<double>* readCrosstalks = nullptr;
+  tree->SetBranchAddress("cellId", &readCellId);
+  tree->SetBranchAddress("list_crosstalk_neighbours", &readNeighbours);
+  tree->SetBranchAddress("list_crosstalks", &readCrosstalks);
+
+  std::vector<CellID> cells;
+  std::vector<uint64_t> offsets{0};
+  std::vector<CellID> neighbourIDs;
+  std::vector<double> coefficients;
+  for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+    tree->GetEntry(i);
+    if (readNeighbours->size() != readCrosstalks->size())
+      throw std::runtime_error("mismatched crosstalk neighbours and coefficients for cell " +
+                               std::to_string(readCellId));
+    cells.push_back(readCellId);
+    neighbourIDs.insert(neighbourIDs.end(), readNeighbours->begin(), readNeighbours->end());
+    coefficients.insert(coefficients.end(), readCrosstalks->begin(), readCrosstalks->end());
+    offsets.push_back(neighbourIDs.size());
+  }
+  delete readNeighbours;
+  delete readCrosstalks;
+
+  k4::recCalo::CrosstalkTable table(cells, offsets, neighbourIDs, coefficients);
+  table.writeMapFile(output);
+  std::cout << "Wrote crosstalk for " << table.size() << " cells to " << output << "\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+  if (argc != 4) {
+    std::cerr << "Usage: " << argv[0] << " neighbours|noise|crosstalk INPUT.root OUTPUT\n";
+    return 1;
+  }
+  const std::string kind = argv[1];
+  const std::string input = argv[2];
+  const std::string output = argv[3];
+
+  std::unique_ptr<TFile> file(TFile::Open(input.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    std::cerr << "Unable to open " << input << "\n";
+    return 1;
+  }
+
+  try {
+    if (kind == "neighbours") {
+      convertNeighbours(*file, output);
+    } else if (kind == "noise") {
+      convertNoise(*file, output);
+    } else if (kind == "crosstalk") {
+      convertCrosstalk(*file, output);
+    } else {
+      std::cerr << "Unknown kind of map: " << kind << "\n";
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error converting " << input << ": " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
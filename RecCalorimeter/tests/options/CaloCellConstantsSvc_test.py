@@ -5,7 +5,14 @@
 # Purpose: Test for CaloCellConstantsSvc
 #
 
+import os
+import tempfile
 import Configurables as C
 
+# No geometry is loaded, so identify it by hand.
+C.k4__recCalo__CaloCellConstantsSvc(
+    sharedDir=os.path.join(tempfile.gettempdir(), "CaloCellConstantsSvc_test"), hashGeometry=False, geometryKey="test"
+)
+
 appmgr = C.ApplicationMgr()
 appmgr.TopAlg += [C.k4__recCalo__CaloCellConstantsSvcTestAlg()]
@@ -7,8 +7,10 @@
 
 #include "GaudiKernel/Algorithm.h"
 #include "GaudiKernel/ServiceHandle.h"
+#include "RecCaloCommon/CellIDList.h"
 #include "RecCaloCommon/ICaloCellConstantsSvc.h"
 #include "k4FWCore/GaudiChecks.h"
+#include <algorithm>
 
 namespace k4::recCalo {
 
@@ -43,6 +45,35 @@ StatusCode CaloCellConstantsSvcTestAlg::initialize() {
   K4_GAUDI_CHECK((v3 = m_svc->getObj<payload_t>("test")));
   K4_GAUDI_CHECK(*v3 == v1);
 
+  // Objects which may be shared between processes.  The service is
+  // configured with a shared area, which may have been filled by a previous
+  // run, so the list is built at most once.
+  const std::vector<uint64_t> cells{30, 10, 20};
+  int nbuild = 0;
+  auto build = [&]() {
+    ++nbuild;
+    return CellIDList(std::vector<uint64_t>(cells));
+  };
+  const CellIDList* list = nullptr;
+  K4_GAUDI_CHECK((list = m_svc->getOrMakeObj<CellIDList>("testCells", 1, build)));
+  K4_GAUDI_CHECK(std::ranges::equal(list->cellIDs(), cells));
+  K4_GAUDI_CHECK(nbuild <= 1);
+  K4_GAUDI_CHECK(m_svc->getOrMakeObj<CellIDList>("testCells", 1, build) == list);
+  K4_GAUDI_CHECK(nbuild <= 1);
+
+  // The list has now been published, so attaching again should not
+  // publish it again.
+  bool published = false;
+  auto publish = [&](const std::string&, uint64_t) { published = true; };
+  auto file = m_svc->attachShared("testCells", CaloMapFile::CELLLIST, 1, publish);
+  K4_GAUDI_CHECK(file != nullptr);
+  K4_GAUDI_CHECK(!published);
+  K4_GAUDI_CHECK(std::ranges::equal(CellIDList::fromMapFile(file).cellIDs(), cells));
+
+  // A different version key is not satisfied by the published file.
+  K4_GAUDI_CHECK(!m_svc->attachShared("testCells", CaloMapFile::CELLLIST, 2, publish));
+  K4_GAUDI_CHECK(published);
+
   return StatusCode::SUCCESS;
 }
 
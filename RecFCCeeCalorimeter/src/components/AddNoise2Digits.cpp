@@ -31,7 +31,14 @@
  *     - m_noiseSimSamples: The number of noise samples to be used to compute the noise correlation matrix during
  initialization.
  *     - m_noiseSeed: The seed for the random number generator used to generate the Gaussian noise.
+ The noise of each sample is drawn from a k4::recCalo::CounterRng keyed by this seed, the algorithm name, and the run
+ and event numbers, using the cell ID and sample index as the counter; it therefore does not depend on the order in
+ which events are processed or on the number of threads.
  *     - m_lenSample: The number of samples in the digitized pulse.
+ *     - m_noiseCacheDir: Directory in which to cache the noise information (optional). The file for a given set of
+ noise parameters and seed is named by a hash of these (the noise statistics use a fixed random number stream, so
+ they do not depend on the algorithm name); if it exists, it is read instead of simulating
+ the noise samples again, and otherwise it is added once the noise has been simulated.
 
  *
  * @section outputs Outputs:
@@ -55,21 +62,14 @@
 
 #include "k4FWCore/Transformer.h"
 
-#include <algorithm>
-#include <string>
-#include <vector>
+#include "RecCaloCommon/EventRng.h"
 
-#include "TFile.h"
-#include "TSystem.h"
-#include "TTree.h"
+#include "CaloDigiNoiseInfo.h"
 
-#include <TMatrixD.h>
-#include <TRandom3.h>
-#include <TVectorD.h>
-
-// For correlation calculation
-#include <TMatrixDSym.h>
+#include <algorithm>
 #include <cmath>
+#include <optional>
+#include <string>
 #include <vector>
 
 struct CaloAddNoise2Digits final
@@ -90,21 +90,28 @@ struct CaloAddNoise2Digits final
    * \return StatusCode indicating success or failure.
    */
   StatusCode initialize() override {
-    r3->SetSeed(m_noiseSeed.value()); // Set the seed for the random number generator
-
-    TMatrixD NoiseSampleMat(m_noiseSimSamples.value(), m_lenSample.value());
-    std::vector<double> means(m_lenSample.value(), 0.0); // Pulse size to calculate means
-    createNoiseSampleMatrix(&NoiseSampleMat, &means);
-
-    TMatrixDSym covMat = ComputeCovarianceMatrix(NoiseSampleMat, means);
-    TMatrixDSym corMat = ComputeCorrelationMatrix(covMat);
-    TMatrixDSym invCorrMat(corMat);
-    invCorrMat.Invert(); // Invert correlation matrix to then save
-
-    TVectorD meansVec(m_lenSample.value());
+    m_rngStream = k4::recCalo::CounterRng::streamID(name());
+
+    // Noise statistics; these use their own stream, independent of the name of this algorithm
+    const std::string cacheKey =
+        CaloDigiNoiseInfo::cacheKey(m_noiseSimSamples.value(), m_lenSample.value(), m_noiseEnergy.value(),
+                                    m_noiseWidth.value(), m_noiseSeed.value());
+    std::optional<CaloDigiNoiseInfo> cachedInfo;
+    if (!m_noiseCacheDir.empty())
+      cachedInfo = CaloDigiNoiseInfo::readCache(m_noiseCacheDir.value(), cacheKey);
+    if (cachedInfo) {
+      info() << "Using cached noise info from: " << CaloDigiNoiseInfo::cachePath(m_noiseCacheDir.value(), cacheKey)
+             << endmsg;
+    } else {
+      cachedInfo = CaloDigiNoiseInfo::simulate(m_noiseSimSamples.value(), m_lenSample.value(), m_noiseEnergy.value(),
+                                               m_noiseWidth.value(), m_noiseSeed.value());
+      if (!m_noiseCacheDir.empty() && !cachedInfo->writeCache(m_noiseCacheDir.value(), cacheKey)) {
+        warning() << "Unable to add the noise info to the cache in: " << m_noiseCacheDir.value() << endmsg;
+      }
+    }
+    const CaloDigiNoiseInfo& noiseInfo = *cachedInfo;
     for (int i = 0; i < m_lenSample.value(); ++i) {
-      meansVec[i] = means[i];
-      info() << "MeansVec[" << i << "]: " << means[i] << endmsg;
+      info() << "MeansVec[" << i << "]: " << noiseInfo.means[i] << endmsg;
     }
 
     // Check if file exists
@@ -116,18 +123,13 @@ struct CaloAddNoise2Digits final
     info() << "Saving noise sample matrix, means vector, covariance matrix, correlation matrix, and inverse "
               "correlation matrix to: "
            << m_noiseInfoFileName.value() << endmsg;
-    auto f = TFile::Open(m_noiseInfoFileName.value().c_str(), "RECREATE");
-    f->cd();
-    NoiseSampleMat.Write("NoiseSampleMatrix");
-
-    meansVec.Write("NoiseSampleMat_MeansVector");
-    covMat.Write("CovarianceMatrix");
-    corMat.Write("CorrelationMatrix");
-    invCorrMat.Write("InvertedCorrelationMatrix");
-    f->Close();
+    if (!noiseInfo.write(m_noiseInfoFileName.value())) {
+      error() << "Unable to write the file with the noise info!" << endmsg;
+      return StatusCode::FAILURE;
+    }
 
-    info() << "Noise sample matrix created with size: " << NoiseSampleMat.GetNrows() << "x" << NoiseSampleMat.GetNcols()
-           << endmsg;
+    info() << "Noise sample matrix created with size: " << noiseInfo.sampleMatrix.GetNrows() << "x"
+           << noiseInfo.sampleMatrix.GetNcols() << endmsg;
     return StatusCode::SUCCESS;
   }
 
@@ -144,6 +146,7 @@ struct CaloAddNoise2Digits final
     info() << "Digitized pulse collection size: " << DigitsPulse.size() << endmsg;
 
     edm4hep::TimeSeriesCollection DigitsWNoiseCollection;
+    const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_noiseSeed.value(), m_rngStream);
 
     // Loop over DigitsPulse to extract the pulse amplitudes
     for (const auto& Digit : DigitsPulse) {
@@ -156,7 +159,7 @@ struct CaloAddNoise2Digits final
       DigitWNoise.setInterval(Digit.getInterval()); // Set the interval for the digitized pulse in ns
 
       // Apply noise to the digitized pulse
-      auto Out = applyGaussianNoise(InputPulse, m_noiseEnergy, m_noiseWidth);
+      auto Out = applyGaussianNoise(rng, Digit.getCellID(), InputPulse, m_noiseEnergy, m_noiseWidth);
 
       for (unsigned int i = 0; i < Out.size(); i++) {
         DigitWNoise.addToAmplitude(Out[i]);
@@ -169,99 +172,30 @@ struct CaloAddNoise2Digits final
    * \brief Adds random Gaussian noise to a digitized pulse.
    *
    * This function takes as input a digitized pulse represented as a vector of floats and adds Gaussian noise to each
-   * sample in the pulse. The Gaussian noise is calculated using TRandom3's Gaus method.
+   * sample in the pulse. The Gaussian noise of sample i is drawn from the random number generator using the cell ID
+   * and block i.
    *
+   * \param rng: The random number generator for this event.
+   * \param CellID: The ID of the cell.
    * \param Digits: The digitized pulse samples.
    * \param NoiseEnergy: The mean of the Gaussian noise.
    * \param NoiseWidth: The standard deviation of the Gaussian noise.
    * \return Vector<float> of the digitized pulse samples with added Gaussian noise.
    */
-  std::vector<float> applyGaussianNoise(const podio::RelationRange<float> Digits, float NoiseEnergy,
+  std::vector<float> applyGaussianNoise(const k4::recCalo::CounterRng& rng, uint64_t CellID,
+                                        const podio::RelationRange<float> Digits, float NoiseEnergy,
                                         float NoiseWidth) const {
     std::vector<float> OutVector(Digits.size(), 0.0f);
+    std::vector<double> Gauss(Digits.size());
+    rng.gauss(CellID, Gauss);
 
     // Loop over the DigitVector
     for (unsigned int i = 0; i < OutVector.size(); ++i) {
-      OutVector[i] = Digits[i] + r3->Gaus(NoiseEnergy, NoiseWidth);
+      OutVector[i] = Digits[i] + (NoiseEnergy + NoiseWidth * Gauss[i]);
     }
     return OutVector;
   }
 
-  /**
-   * \brief Computes an \f$n \times n \f$ covariance matrix.
-   *
-   * This function takes as input a matrix of noise samples and a vector of means per sample, and computes the
-   * covariance matrix.
-   *
-   * \param data: The matrix of noise samples.
-   * \param means: The vector of means per sample.
-   * \return The covariance matrix.
-   */
-  TMatrixDSym ComputeCovarianceMatrix(const TMatrixD& data, const std::vector<double>& means) {
-    // Compute covariance matrix
-    int nVars = data.GetNcols();
-    TMatrixDSym cov(nVars);
-    for (int i = 0; i < nVars; ++i) {
-      for (int j = i; j < nVars; ++j) {
-        double sum = 0.0;
-        for (int k = 0; k < m_noiseSimSamples.value(); ++k) {
-          sum += (data(k, i) - means[i]) * (data(k, j) - means[j]);
-        }
-        cov(i, j) = sum / (m_noiseSimSamples.value() - 1);
-        if (i != j)
-          cov(j, i) = cov(i, j);
-      }
-    }
-    return cov;
-  }
-
-  /**
-   * \brief Computes a correlation matrix from a covariance matrix.
-   *
-   * This function takes as input a covariance matrix and computes the corresponding correlation matrix by normalizing
-   * it correctly.
-   *
-   * \param cov: The covariance matrix.
-   * \return The correlation matrix.
-   */
-  TMatrixDSym ComputeCorrelationMatrix(const TMatrixDSym& cov) {
-    // Compute correlation matrix from cov mat
-    int nVars = cov.GetNcols();
-    TMatrixDSym corr(nVars);
-    for (int i = 0; i < nVars; ++i) {
-      for (int j = i; j < nVars; ++j) {
-        double denom = std::sqrt(cov(i, i) * cov(j, j));
-        debug() << "Covariance: " << cov(i, j) << ", Denominator: " << denom << std::endl;
-        double val = denom != 0.0 ? cov(i, j) / denom : 0.0;
-        corr(i, j) = val;
-        if (i != j)
-          corr(j, i) = val;
-      }
-    }
-    return corr;
-  }
-
-  /**
-   * \brief Creates a matrix of noise samples.
-   *
-   * This function takes as input a pointer to a matrix to be filled with noise samples and a pointer to a vector to
-   * store the means per sample. It fills the matrix with Gaussian noise samples and computes the means for each sample.
-   * The matrix is of size (m_noiseSimSamples x m_lenSample).
-   *
-   * \param NoiseSampleMat: Pointer to the matrix to be filled with noise samples.
-   * \param means: Pointer to the vector to store the means per sample.
-   */
-  void createNoiseSampleMatrix(TMatrixD* NoiseSampleMat, std::vector<double>* means) const {
-    for (int j = 0; j < m_lenSample.value(); ++j) {
-      for (int i = 0; i < m_noiseSimSamples.value(); ++i) {
-        (*NoiseSampleMat)(i, j) = r3->Gaus(m_noiseEnergy.value(), m_noiseWidth.value());
-        debug() << "NoiseSampleMat(" << i << ", " << j << ") = " << (*NoiseSampleMat)(i, j) << std::endl;
-        (*means)[j] += (*NoiseSampleMat)(i, j);
-      }
-      (*means)[j] /= m_noiseSimSamples.value(); // Calculate mean for each pulse sample
-    }
-  }
-
   /**
    * \brief Finalizes the transformer but does nothing in this case.
    * \return StatusCode indicating success or failure.
@@ -277,8 +211,11 @@ private:
   Gaudi::Property<int> m_noiseSimSamples{this, "noiseSimSamples", 1000, "Number of samples for noise simulation"};
   Gaudi::Property<int> m_noiseSeed{this, "noiseSeed", 32, "Seed for the random number generator"};
   Gaudi::Property<int> m_lenSample{this, "pulseSamplingLength", 30, "Number of samples in pulse"};
+  Gaudi::Property<std::string> m_noiseCacheDir{
+      this, "noiseCacheDir", "", "Directory in which to cache the noise info, keyed by the noise parameters"};
 
-  TRandom* r3 = new TRandom3();
+  /// Random number stream of this algorithm, made from its name
+  uint64_t m_rngStream = 0;
 };
 
 DECLARE_COMPONENT(CaloAddNoise2Digits)
@@ -0,0 +1,132 @@
+#include "CaloDigiNoiseInfo.h"
+
+#include "RecCaloCommon/CaloMapFile.h"
+#include "RecCaloCommon/PulseProcessing.h"
+
+#include "TFile.h"
+#include "TObjString.h"
+
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <span>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/// Version of the simulation, part of the cache key.  Increment when simulate() gives different results.
+constexpr int simulationVersion = 2;
+
+} // anonymous namespace
+
+CaloDigiNoiseInfo CaloDigiNoiseInfo::simulate(int nSimSamples, int lenSample, float noiseEnergy, float noiseWidth,
+                                              uint64_t seed) {
+  const k4::recCalo::CounterRng rng(seed, rngStream, 0, 0);
+  CaloDigiNoiseInfo info{TMatrixD(nSimSamples, lenSample), TVectorD(lenSample), TMatrixDSym(lenSample),
+                         TMatrixDSym(lenSample), TMatrixDSym(lenSample)};
+  TMatrixD& data = info.sampleMatrix;
+
+  // Noise pulses; the matrix is stored by rows, one pulse per row
+  double* rows = data.GetMatrixArray();
+  for (int i = 0; i < nSimSamples; ++i) {
+    std::span<double> row(rows + static_cast<size_t>(i) * lenSample, lenSample);
+    rng.gauss(i, row);
+    for (double& x : row)
+      x = noiseEnergy + noiseWidth * x;
+  }
+
+  // Mean of each sample, and the covariance matrix
+  std::vector<double> cov(static_cast<size_t>(lenSample) * lenSample);
+  k4::recCalo::sampleCovariance(std::span<const double>(rows, static_cast<size_t>(nSimSamples) * lenSample),
+                                lenSample, std::span<double>(info.means.GetMatrixArray(), lenSample), cov);
+  info.covariance.SetMatrixArray(cov.data());
+
+  // Correlation matrix, and its inverse
+  const TMatrixDSym& covm = info.covariance;
+  TMatrixDSym& corr = info.correlation;
+  for (int i = 0; i < lenSample; ++i) {
+    for (int j = i; j < lenSample; ++j) {
+      double denom = std::sqrt(covm(i, i) * covm(j, j));
+      double val = denom != 0.0 ? covm(i, j) / denom : 0.0;
+      corr(i, j) = val;
+      if (i != j)
+        corr(j, i) = val;
+    }
+  }
+  info.invCorrelation = corr;
+  info.invCorrelation.Invert();
+
+  return info;
+}
+
+bool CaloDigiNoiseInfo::write(const std::string& fileName, const std::string& cacheKey) const {
+  std::unique_ptr<TFile> f(TFile::Open(fileName.c_str(), "RECREATE"));
+  if (!f || f->IsZombie())
+    return false;
+  f->cd();
+  sampleMatrix.Write("NoiseSampleMatrix");
+  means.Write("NoiseSampleMat_MeansVector");
+  covariance.Write("CovarianceMatrix");
+  correlation.Write("CorrelationMatrix");
+  invCorrelation.Write("InvertedCorrelationMatrix");
+  if (!cacheKey.empty())
+    TObjString(cacheKey.c_str()).Write("CacheKey");
+  f->Close();
+  return true;
+}
+
+std::string CaloDigiNoiseInfo::cacheKey(int nSimSamples, int lenSample, float noiseEnergy, float noiseWidth,
+                                        uint64_t seed) {
+  // Floats are formatted exactly.
+  return std::format("CaloDigiNoiseInfo v{} nSimSamples={} lenSample={} noiseEnergy={} noiseWidth={} seed={}",
+                     simulationVersion, nSimSamples, lenSample, noiseEnergy, noiseWidth, seed);
+}
+
+std::string CaloDigiNoiseInfo::cachePath(const std::string& cacheDir, const std::string& key) {
+  const uint64_t hash = k4::recCalo::CaloMapFile::checksum(std::as_bytes(std::span(key)));
+  return std::format("{}/CaloDigiNoiseInfo-{:016x}.root", cacheDir, hash);
+}
+
+std::optional<CaloDigiNoiseInfo> CaloDigiNoiseInfo::readCache(const std::string& cacheDir, const std::string& key) {
+  const std::string path = cachePath(cacheDir, key);
+  if (!std::filesystem::exists(path))
+    return std::nullopt;
+  std::unique_ptr<TFile> f(TFile::Open(path.c_str(), "READ"));
+  if (!f || f->IsZombie())
+    return std::nullopt;
+
+  // Guard against hash collisions.  Objects read from the file are owned by us.
+  std::unique_ptr<TObjString> storedKey(f->Get<TObjString>("CacheKey"));
+  if (!storedKey || storedKey->GetString() != key.c_str())
+    return std::nullopt;
+
+  std::unique_ptr<TMatrixD> sampleMatrix(f->Get<TMatrixD>("NoiseSampleMatrix"));
+  std::unique_ptr<TVectorD> means(f->Get<TVectorD>("NoiseSampleMat_MeansVector"));
+  std::unique_ptr<TMatrixDSym> covariance(f->Get<TMatrixDSym>("CovarianceMatrix"));
+  std::unique_ptr<TMatrixDSym> correlation(f->Get<TMatrixDSym>("CorrelationMatrix"));
+  std::unique_ptr<TMatrixDSym> invCorrelation(f->Get<TMatrixDSym>("InvertedCorrelationMatrix"));
+  if (!sampleMatrix || !means || !covariance || !correlation || !invCorrelation)
+    return std::nullopt;
+  return CaloDigiNoiseInfo{*sampleMatrix, *means, *covariance, *correlation, *invCorrelation};
+}
+
+bool CaloDigiNoiseInfo::writeCache(const std::string& cacheDir, const std::string& key) const {
+  std::error_code ec;
+  std::filesystem::create_directories(cacheDir, ec);
+  if (ec)
+    return false;
+  const std::string path = cachePath(cacheDir, key);
+  const std::string tmpPath = std::format("{}.tmp{}", path, ::getpid());
+  if (!write(tmpPath, key)) {
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+  return true;
+}
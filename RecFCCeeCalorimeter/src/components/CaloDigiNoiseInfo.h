@@ -0,0 +1,86 @@
+#ifndef RECFCCEECALORIMETER_CALODIGINOISEINFO_H
+#define RECFCCEECALORIMETER_CALODIGINOISEINFO_H
+
+#include "RecCaloCommon/CounterRng.h"
+
+#include <TMatrixD.h>
+#include <TMatrixDSym.h>
+#include <TVectorD.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/** @class CaloDigiNoiseInfo RecFCCeeCalorimeter/src/components/CaloDigiNoiseInfo.h
+ *
+ *  Noise statistics of digitized pulses, as used by the digitization chain.
+ *  Made by simulating a set of independent Gaussian noise pulses, from which the mean per sample and
+ *  the covariance, correlation and inverse correlation matrices between samples are computed.
+ *  Shared by CaloAddNoise2Digits and CaloDigitizeAndFilter, which write it to the file read by
+ *  CaloWhitening and CaloFilterFunc.
+ *
+ *  The simulation draws from a CounterRng with a fixed stream ID, so it depends only on its
+ *  parameters and on the random number seed, and not on the algorithm running it.  Its results
+ *  may be kept in a cache directory, in files named by a hash of these (see cacheKey), so that
+ *  jobs with the same configuration simulate the noise only once.
+ */
+struct CaloDigiNoiseInfo {
+  /// Stream ID of the random numbers of simulate(), the same for all algorithms.
+  static constexpr uint64_t rngStream = k4::recCalo::CounterRng::streamID("CaloDigiNoiseInfo.noiseSamples");
+
+  /// Simulated noise pulses, one per row.
+  TMatrixD sampleMatrix;
+  /// Mean of the noise per sample.
+  TVectorD means;
+  TMatrixDSym covariance;
+  TMatrixDSym correlation;
+  TMatrixDSym invCorrelation;
+
+  /** Simulate the noise pulses and compute their statistics.
+   *   @param[in] nSimSamples Number of noise pulses to simulate.
+   *   @param[in] lenSample Number of samples per pulse.
+   *   @param[in] noiseEnergy Mean of the Gaussian noise.
+   *   @param[in] noiseWidth Standard deviation of the Gaussian noise.
+   *   @param[in] seed Seed of the random numbers; sample j of pulse i uses item i and block j
+   *                   of the stream @c rngStream.
+   */
+  static CaloDigiNoiseInfo simulate(int nSimSamples, int lenSample, float noiseEnergy, float noiseWidth,
+                                    uint64_t seed);
+
+  /** Write the noise information to a ROOT file, under the names read by CaloWhitening and CaloFilterFunc.
+   *   @param[in] fileName Name of the file, which is recreated.
+   *   @param[in] cacheKey If not empty, also written to the file, to identify it in a cache.
+   *   return false if the file could not be opened.
+   */
+  bool write(const std::string& fileName, const std::string& cacheKey = "") const;
+
+  /** Make the key identifying the results of simulate() for a set of parameters.
+   *   @param[in] nSimSamples, lenSample, noiseEnergy, noiseWidth As for simulate().
+   *   @param[in] seed Seed of the random numbers.
+   */
+  static std::string cacheKey(int nSimSamples, int lenSample, float noiseEnergy, float noiseWidth, uint64_t seed);
+
+  /** Return the path of the file holding the noise information for a key in a cache directory.
+   *   @param[in] cacheDir The cache directory.
+   *   @param[in] key The key, from cacheKey().
+   */
+  static std::string cachePath(const std::string& cacheDir, const std::string& key);
+
+  /** Read the noise information for a key from a cache directory.
+   *   @param[in] cacheDir The cache directory.
+   *   @param[in] key The key, from cacheKey().
+   *   return std::nullopt if the cache has no usable file for the key.
+   */
+  static std::optional<CaloDigiNoiseInfo> readCache(const std::string& cacheDir, const std::string& key);
+
+  /** Add the noise information to a cache directory, creating it if needed.
+   *  The file is written under a temporary name and then renamed, so that concurrent jobs
+   *  never see a partial file.
+   *   @param[in] cacheDir The cache directory.
+   *   @param[in] key The key, from cacheKey().
+   *   return false if the file could not be written.
+   */
+  bool writeCache(const std::string& cacheDir, const std::string& key) const;
+};
+
+#endif /* RECFCCEECALORIMETER_CALODIGINOISEINFO_H */
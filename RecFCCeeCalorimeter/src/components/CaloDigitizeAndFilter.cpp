@@ -0,0 +1,329 @@
+/** @class CaloDigitizeAndFilter
+ * Gaudi MultiTransformer running the full ALLEGRO digitization chain in one pass per cell
+ *
+ * @date   2026-10-16
+ *
+ * Gaudi MultiTransformer that digitizes a SimCalorimeterHitCollection, adds Gaussian noise, whitens the pulses and
+ *applies the matched filter. It replaces running CaloDigitizerFunc, CaloAddNoise2Digits, CaloWhitening and
+ *CaloFilterFunc one after another (see DigitizationSteeringFiles/DigiFiltFunc.py), with the same outputs as
+ *CaloFilterFunc.
+ *
+ * Running the steps as separate algorithms creates three intermediate TimeSeriesCollections per event, each filled
+ *sample by sample. Here, the pulse of each cell is instead kept in a buffer that is reused for all cells of the event,
+ *and passes through all steps before the next cell is processed. Only the outputs of the filter are written; the
+ *filtered pulses themselves are only stored if "storeFilteredPulses" is set.
+ *
+ * The steps are the same as in the separate algorithms (see those for details):
+ *     - Each contribution to a hit is converted to a pulse of the given shape and added to the pulse of the cell.
+ *     - Gaussian noise is added to each sample, drawn from a k4::recCalo::CounterRng keyed by "noiseSeed", the
+ *algorithm name, and the run and event numbers, using the cell ID and sample index as the counter.
+ *     - The noise mean is subtracted and the ZCA whitening matrix is applied.
+ *     - The matched filter is applied, and its maximum gives the energy and the sample index.
+ * The noise statistics needed by the whitening and the filter are simulated at initialize (or read from the cache in
+ *"noiseCacheDir"), as in CaloAddNoise2Digits, and are also written to "noiseInfoFileName" if that is not empty.
+ *
+ * Since the per-event noise is keyed by the algorithm name, it differs from that drawn by CaloAddNoise2Digits. The
+ *noise statistics do not depend on the name, so the two algorithms share cache entries when configured alike.
+ *
+ *The unit system used here is GeV and ns throughout.
+ * Inputs:
+ *     - SimCalorimeterHitCollection: Collection of simulated calorimeter hits from ddsim/G4.
+ *
+ * Properties:
+ *     - @param m_pulseType: The name of pulse shape to use for digitization. Currently only "Gaussian" is implemented.
+ *     - @param m_mu: Mean of the Gaussian pulse shape in ns.
+ *     - @param m_sigma: Standard deviation of the Gaussian pulse shape in ns.
+ *     - @param m_lenSample: Number of samples in the digitized pulse.
+ *     - @param m_pulseInitTime: Start time of the digitized pulse in ns.
+ *     - @param m_pulseEndTime: End time of the digitized pulse in ns.
+ *     - @param m_noiseEnergy: The mean of the Gaussian noise added to each sample (GeV).
+ *     - @param m_noiseWidth: The standard deviation of the Gaussian noise added to each sample (GeV).
+ *     - @param m_noiseSimSamples: The number of noise pulses simulated to compute the noise correlation matrix.
+ *     - @param m_noiseSeed: The seed for the random number generator.
+ *     - @param m_noiseInfoFileName: The name of the ROOT file to save the noise information to (optional).
+ *     - @param m_noiseCacheDir: Directory in which to cache the noise information, as in CaloAddNoise2Digits
+ *(optional).
+ *     - @param m_whiteningName: The name of the whitening filter to apply. Currently only "ZCA" is implemented.
+ *     - @param m_filterName: The name of the filter to apply. Currently only "Matched_Gaussian" is implemented.
+ *     - @param m_filterTemplateSize: The number of samples of the pulse shape used for the matched filter.
+ *     - @param m_storeFilteredPulses: Whether to store the filtered pulses.
+ *
+ * Outputs:
+ *     - TimeSeriesCollection: The cell ID of each cell, with the filtered pulse if "storeFilteredPulses" is set.
+ *     - int: Index representing the best estimate of the timing information.
+ *     - float: The best estimate of the energy in the cell.
+ */
+
+#include "Gaudi/Property.h"
+
+// edm4hep
+#include "edm4hep/SimCalorimeterHitCollection.h"
+#include "edm4hep/TimeSeriesCollection.h"
+
+#include "podio/UserDataCollection.h"
+
+#include "k4FWCore/Transformer.h"
+
+#include "RecCaloCommon/EventRng.h"
+#include "RecCaloCommon/PulseProcessing.h"
+
+#include "CaloDigiNoiseInfo.h"
+
+#include <TMatrixDSymEigen.h>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+using FilterColl = edm4hep::TimeSeriesCollection;
+using MatchedSampleIdxColl = podio::UserDataCollection<int>;
+using MatchedSampleEnergyColl = podio::UserDataCollection<float>;
+
+struct CaloDigitizeAndFilter final
+    : k4FWCore::MultiTransformer<std::tuple<FilterColl, MatchedSampleIdxColl, MatchedSampleEnergyColl>(
+          const edm4hep::SimCalorimeterHitCollection&)> {
+  CaloDigitizeAndFilter(const std::string& name, ISvcLocator* svcLoc)
+      : MultiTransformer(name, svcLoc, {KeyValues("InputCollection", {"SimCaloHitsCollection"})},
+                         {KeyValues("OutputCollectionFilteredPulse", {"FilteredDigitsCollection"}),
+                          KeyValues("OutputCollectionMatchedSampleIdx", {"MatchedSampleIdx"}),
+                          KeyValues("OutputCollectionMatchedSampleEnergy", {"MatchedSampleEnergy"})}) {}
+
+  /**
+   * \brief Computes the pulse shape, the noise statistics, the whitening matrix and the filter template.
+   *
+   * \param None -> See class parameters for inputs.
+   * \return StatusCode indicating success or failure.
+   */
+  StatusCode initialize() override {
+    m_rngStream = k4::recCalo::CounterRng::streamID(name());
+    m_samplingInterval = (m_pulseEndTime.value() - m_pulseInitTime.value()) / m_lenSample.value();
+
+    // Pulse shape and its derivative
+    if (m_pulseType.value() != "Gaussian") {
+      error() << "Unknown pulse type: " << m_pulseType.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    for (int i = 0; i < m_lenSample.value(); ++i) {
+      m_pulseShape.push_back(Gaussian(i * m_samplingInterval, m_mu.value(), m_sigma.value()));
+      m_pulseShapeDeriv.push_back(GaussianDerivative(i * m_samplingInterval, m_mu.value(), m_sigma.value()));
+    }
+
+    // Noise statistics; these use their own stream, independent of the name of this algorithm
+    const std::string cacheKey =
+        CaloDigiNoiseInfo::cacheKey(m_noiseSimSamples.value(), m_lenSample.value(), m_noiseEnergy.value(),
+                                    m_noiseWidth.value(), m_noiseSeed.value());
+    std::optional<CaloDigiNoiseInfo> cachedInfo;
+    if (!m_noiseCacheDir.empty())
+      cachedInfo = CaloDigiNoiseInfo::readCache(m_noiseCacheDir.value(), cacheKey);
+    if (cachedInfo) {
+      info() << "Using cached noise info from: " << CaloDigiNoiseInfo::cachePath(m_noiseCacheDir.value(), cacheKey)
+             << endmsg;
+    } else {
+      cachedInfo = CaloDigiNoiseInfo::simulate(m_noiseSimSamples.value(), m_lenSample.value(), m_noiseEnergy.value(),
+                                               m_noiseWidth.value(), m_noiseSeed.value());
+      if (!m_noiseCacheDir.empty() && !cachedInfo->writeCache(m_noiseCacheDir.value(), cacheKey)) {
+        warning() << "Unable to add the noise info to the cache in: " << m_noiseCacheDir.value() << endmsg;
+      }
+    }
+    const CaloDigiNoiseInfo& noiseInfo = *cachedInfo;
+    if (!m_noiseInfoFileName.empty()) {
+      info() << "Saving the noise info to: " << m_noiseInfoFileName.value() << endmsg;
+      if (!noiseInfo.write(m_noiseInfoFileName.value())) {
+        error() << "Unable to write the file with the noise info!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+    }
+    m_noiseMean.assign(noiseInfo.means.GetMatrixArray(), noiseInfo.means.GetMatrixArray() + m_lenSample.value());
+
+    // ZCA whitening matrix: sqrt(corr^-1) = V * sqrt(D) * V^T
+    if (m_whiteningName.value() != "ZCA") {
+      error() << "Unknown whitening filter name: " << m_whiteningName.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    TMatrixDSymEigen eig(noiseInfo.invCorrelation);
+    TVectorD eigenVals = eig.GetEigenValues();
+    TMatrixD eigenVecs = eig.GetEigenVectors();
+    TMatrixD sqrtDiag(eigenVals.GetNrows(), eigenVals.GetNrows());
+    sqrtDiag.Zero();
+    for (int i = 0; i < eigenVals.GetNrows(); ++i) {
+      sqrtDiag(i, i) = std::sqrt(eigenVals[i]);
+    }
+    TMatrixD whitening(eigenVecs, TMatrixD::kMult, sqrtDiag);
+    whitening *= eigenVecs.T();
+    m_whitening.assign(whitening.GetMatrixArray(), whitening.GetMatrixArray() + whitening.GetNoElements());
+
+    // Matched filter template: (corr^-1 s) / (s^T corr^-1 s), for the part of the pulse shape around its maximum
+    if (m_filterName.value() != "Matched_Gaussian") {
+      error() << "Unknown filter name: " << m_filterName.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    int DownCnt = (m_filterTemplateSize.value() - 1) / 2;
+    int UpCnt = m_filterTemplateSize.value() - DownCnt - 1;
+    int MaxIdx = std::distance(m_pulseShape.begin(), std::max_element(m_pulseShape.begin(), m_pulseShape.end()));
+    int DownIdx = MaxIdx - DownCnt;
+    int UpIdx = MaxIdx + UpCnt;
+    if (DownIdx < 0 || UpIdx >= m_lenSample.value()) {
+      error() << "Index out of bounds: DownIdx=" << DownIdx << ", UpIdx=" << UpIdx
+              << ", PulseShape.size()=" << m_pulseShape.size() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    TVectorD FilterTemplatePadded(m_lenSample.value());
+    for (int i = DownIdx; i <= UpIdx; ++i) {
+      FilterTemplatePadded[i] = m_pulseShape[i];
+    }
+    TVectorD Temp = noiseInfo.invCorrelation * FilterTemplatePadded;
+    float Norm = FilterTemplatePadded * Temp;
+    // Stored time-reversed, as needed for the convolution
+    for (int i = UpIdx; i >= DownIdx; --i) {
+      m_reversedFilter.push_back(Temp[i] / Norm);
+    }
+
+    return StatusCode::SUCCESS;
+  }
+
+  /**
+   * \brief Digitizes the hits and applies the noise, whitening and filter to each cell.
+   *
+   * \param CaloHits: The input SimCalorimeterHitCollection.
+   * \return A tuple containing the filtered pulses (or only their cell IDs), sample index representing the timing
+   * estimate, and the best estimate for the energy.
+   */
+  std::tuple<FilterColl, MatchedSampleIdxColl, MatchedSampleEnergyColl>
+  operator()(const edm4hep::SimCalorimeterHitCollection& CaloHits) const override {
+    debug() << "calorimeter hits collection size: " << CaloHits.size() << endmsg;
+
+    FilterColl FilteredDigitsCollection;
+    MatchedSampleIdxColl MaxIdxCollection;
+    MatchedSampleEnergyColl EnergyCollection;
+
+    const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_noiseSeed.value(), m_rngStream);
+
+    // Buffers for the pulse of one cell, reused for all cells
+    const size_t n = m_pulseShape.size();
+    std::vector<float> buffer(3 * n);
+    std::vector<double> noise(n);
+    std::span<float> pulse(buffer.data(), n);
+    std::span<float> whitened(buffer.data() + n, n);
+    std::span<float> filtered;
+    if (m_storeFilteredPulses.value())
+      filtered = std::span<float>(buffer.data() + 2 * n, n);
+
+    for (const auto& hit : CaloHits) {
+      const uint64_t cellID = hit.getCellID();
+
+      // Digitize
+      std::fill(pulse.begin(), pulse.end(), 0.0f);
+      for (const auto& contribution : hit.getContributions()) {
+        k4::recCalo::addPulseContribution(pulse, contribution.getEnergy(), contribution.getTime(), m_samplingInterval,
+                                          m_pulseShape, m_pulseShapeDeriv);
+      }
+
+      // Add noise
+      rng.gauss(cellID, noise);
+      for (size_t i = 0; i < n; ++i) {
+        pulse[i] = pulse[i] + (m_noiseEnergy.value() + m_noiseWidth.value() * noise[i]);
+      }
+
+      // Whiten and filter
+      k4::recCalo::whitenPulse(pulse, m_noiseMean, m_whitening, whitened);
+      const k4::recCalo::PulsePeak peak = k4::recCalo::matchedFilter(whitened, m_reversedFilter, filtered);
+
+      auto FilteredDigit = FilteredDigitsCollection.create();
+      FilteredDigit.setCellID(cellID);
+      FilteredDigit.setTime(0.0);                    // Placeholder for time info
+      FilteredDigit.setInterval(m_samplingInterval); // Set the interval for the digitized pulse in ns
+      for (float x : filtered) {
+        FilteredDigit.addToAmplitude(x);
+      }
+
+      if (msgLevel(MSG::DEBUG)) {
+        debug() << "Cell ID" << cellID << ", MaxIdx: " << peak.index << ", Energy - max val: " << peak.energy << endmsg;
+      }
+      MaxIdxCollection.push_back(peak.index);
+      EnergyCollection.push_back(peak.energy);
+    }
+
+    return std::make_tuple(std::move(FilteredDigitsCollection), std::move(MaxIdxCollection),
+                           std::move(EnergyCollection));
+  }
+
+  /**
+   * \brief Finalizes the transformer but does nothing in this case.
+   * \return StatusCode indicating success or failure.
+   */
+  StatusCode finalize() override { return StatusCode::SUCCESS; }
+
+  /**
+   * \brief Computes the value of a Gaussian function analytically.
+   *
+   * \param x: The input variable.
+   * \param mu: The mean of the Gaussian.
+   * \param sigma: The standard deviation of the Gaussian.
+   * \return The value of the Gaussian function at x.
+   */
+  float Gaussian(float x, float mu = 0.0, float sigma = 1.0) const {
+    return (1.0 / (sigma * sqrt(2 * M_PI))) * exp(-0.5 * pow((x - mu) / sigma, 2));
+  }
+
+  /**
+   * \brief Computes the derivative of a Gaussian function analytically.
+   *
+   * \param x: The input variable.
+   * \param mu: The mean of the Gaussian.
+   * \param sigma: The standard deviation of the Gaussian.
+   * \return The value of the derivative of the Gaussian function at x.
+   */
+  float GaussianDerivative(float x, float mu = 0.0, float sigma = 1.0) const {
+    return -(x - mu) / (sigma * sigma) * Gaussian(x, mu, sigma);
+  }
+
+private:
+  // Type of pulse to create
+  Gaudi::Property<std::string> m_pulseType{this, "pulseType", "Gaussian", "Type of pulse to create"};
+  // Initial time of the pulse
+  Gaudi::Property<float> m_pulseInitTime{this, "pulseInitTime", 0.0, "Initial time of the pulse"};
+  // End time of the pulse
+  Gaudi::Property<float> m_pulseEndTime{this, "pulseEndTime", 750.0, "End time of the pulse"};
+  // Number of samples in pulse
+  Gaudi::Property<int> m_lenSample{this, "pulseSamplingLength", 30, "Number of samples in pulse"};
+  // Gaussian pulse properties
+  Gaudi::Property<float> m_mu{this, "mu", 100.0, "Mean of Gaussian pulse"};
+  Gaudi::Property<float> m_sigma{this, "sigma", 20.0, "Sigma of Gaussian pulse"};
+
+  // Noise properties
+  Gaudi::Property<float> m_noiseEnergy{this, "noiseEnergy", 0.1, "Noise energy for Gaussian (mean) - in GeV"};
+  Gaudi::Property<float> m_noiseWidth{this, "noiseWidth", 0.05, "Noise width - in GeV as well"};
+  Gaudi::Property<int> m_noiseSimSamples{this, "noiseSimSamples", 1000, "Number of samples for noise simulation"};
+  Gaudi::Property<int> m_noiseSeed{this, "noiseSeed", 32, "Seed for the random number generator"};
+  Gaudi::Property<std::string> m_noiseInfoFileName{
+      this, "noiseInfoFileName", "", "Name of file to store noise samples, means, cov, and corr matrices (optional)"};
+  Gaudi::Property<std::string> m_noiseCacheDir{
+      this, "noiseCacheDir", "", "Directory in which to cache the noise info, keyed by the noise parameters"};
+
+  // Whitening and filter properties
+  Gaudi::Property<std::string> m_whiteningName{this, "whiteningFilterName", "ZCA",
+                                               "Name of the whitening filter to apply"};
+  Gaudi::Property<std::string> m_filterName{this, "filterName", "Matched_Gaussian", "Name of the filter to apply"};
+  Gaudi::Property<int> m_filterTemplateSize{this, "filterTemplateSize", 5, "Size of the filter template"};
+  Gaudi::Property<bool> m_storeFilteredPulses{this, "storeFilteredPulses", false,
+                                              "Store the filtered pulses, rather than only the cell IDs"};
+
+  std::vector<float> m_pulseShape;
+  std::vector<float> m_pulseShapeDeriv;
+  float m_samplingInterval = 0;
+
+  /// Noise mean per sample
+  std::vector<double> m_noiseMean;
+  /// Whitening matrix, row-major
+  std::vector<double> m_whitening;
+  /// Matched filter template, time-reversed
+  std::vector<float> m_reversedFilter;
+
+  /// Random number stream of this algorithm, made from its name
+  uint64_t m_rngStream = 0;
+};
+
+DECLARE_COMPONENT(CaloDigitizeAndFilter)
@@ -28,9 +28,31 @@
  *     - @param m_lenSample: Number of samples in the digitized pulse.
  *     - @param m_pulseInitTime: Start time of the digitized pulse in ns.
  *     - @param m_pulseEndTime: End time of the digitized pulse in ns.
+ *     - @param m_pulsePhases: Number of sub-sample phases at which the pulse shape is tabulated. Each contribution
+ *uses the shape at the nearest phase, added to the pulse of its cell without any allocation. If 0, the shape is
+ *instead corrected to first order in the time offset from the nearest sample, as in the LAr note.
+ *     - @param m_sparseMode: If true, only hits above a per-cell threshold are digitized (zero suppression).
+ *     - @param m_noiseTool: The tool giving the noise of each cell, used for the threshold in sparse mode.
+ *     - @param m_sparseThreshold: In sparse mode, a hit is digitized only if its energy is above the noise offset of
+ *its cell plus this many times the noise RMS.
+ *     - @param m_samplingFraction: In sparse mode, the sampling fraction by which the hit energy is divided before it
+ *is compared with the noise.
+ *     - @param m_randomSeed: Seed for the noise added to the suppressed hits.
+ *
+ * In sparse mode, the cost of the digitization follows the number of cells with signal rather than the number of
+ *simulated hits. The energy of a SimCalorimeterHit is the energy deposited in the active material, while the noise
+ *tool gives the noise at the calibrated scale of the cells (as used by CreateCaloCells). The hit energy is therefore
+ *divided by "samplingFraction" before the threshold; the default of 1 takes the noise to be given at the scale of the
+ *deposited energy. Hits below the threshold get no pulse; their pulse synthesis is replaced by summing their energy and
+ *energy-weighted time, which are stored as a CalorimeterHit if "SuppressedOutputCollection" is set. Their energy is
+ *smeared by the noise of the cell, drawn from a k4::recCalo::CounterRng keyed by "randomSeed", the algorithm name, the
+ *run and event numbers, and the cell ID.
  *
  * Outputs:
  *     - TimeSeriesCollection: Digitised hits collection for each cell
+ *     - CalorimeterHitCollection: The hits below the threshold in sparse mode, with their noisy energy (at the scale
+ *of the noise tool) and mean time.
+ *Written only if "SuppressedOutputCollection" is given a name; by default it is empty, and nothing is written.
  *
  * LIMITATIONS: (status 01/12/2025)
  *     - The digitization does not yet include the full noise simulation but a simpler one, in conjunction with
@@ -42,6 +64,7 @@
  */
 
 #include "Gaudi/Property.h"
+#include "GaudiKernel/ToolHandle.h"
 
 // edm4hep
 #include "edm4hep/CaloHitContributionCollection.h"
@@ -53,8 +76,15 @@
 
 #include "k4FWCore/Transformer.h"
 
+#include "RecCaloCommon/EventRng.h"
+#include "RecCaloCommon/INoiseConstTool.h"
+#include "RecCaloCommon/PulseProcessing.h"
+#include "RecCaloCommon/PulseShapeLibrary.h"
+
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "TFile.h"
@@ -62,10 +92,13 @@
 #include "TTree.h"
 
 struct CaloDigitizerFunc final
-    : k4FWCore::Transformer<edm4hep::TimeSeriesCollection(const edm4hep::SimCalorimeterHitCollection&)> {
+    : k4FWCore::MultiTransformer<
+          std::tuple<edm4hep::TimeSeriesCollection, std::vector<edm4hep::CalorimeterHitCollection>>(
+              const edm4hep::SimCalorimeterHitCollection&)> {
   CaloDigitizerFunc(const std::string& name, ISvcLocator* svcLoc)
-      : Transformer(name, svcLoc, {KeyValues("InputCollection", {"SimCaloHitsCollection"})},
-                    {KeyValues("OutputCollection", {"DigitsFloat"})}) {}
+      : MultiTransformer(name, svcLoc, {KeyValues("InputCollection", {"SimCaloHitsCollection"})},
+                         {KeyValues("OutputCollection", {"DigitsFloat"}),
+                          KeyValues("SuppressedOutputCollection", {})}) {}
 
   /**
    * \brief Computes the pulse shape and its derivative.
@@ -78,6 +111,11 @@ struct CaloDigitizerFunc final
    * \return StatusCode indicating success or failure.
    */
   StatusCode initialize() override {
+    if (m_pulsePhases.value() < 0) {
+      error() << "pulsePhases must not be negative; got " << m_pulsePhases.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+
     // Decide which pulse shape to use and create the pulse shape and derivative vectors on the fly
     m_samplingInterval = (m_pulseEndTime.value() - m_pulseInitTime.value()) / m_lenSample.value();
 
@@ -90,9 +128,41 @@ struct CaloDigitizerFunc final
         info() << "PulseShape[" << i * m_samplingInterval << "]: " << PulseShape[i] << ", PulseShapeDeriv["
                << i * m_samplingInterval << "]: " << PulseShapeDeriv[i] << endmsg;
       }
+      if (m_pulsePhases.value() > 0) {
+        m_pulseLibrary = std::make_unique<k4::recCalo::PulseShapeLibrary>(
+            k4::recCalo::GaussianPulseShape{m_mu.value(), m_sigma.value()}, m_lenSample.value(), m_samplingInterval,
+            m_pulsePhases.value());
+      }
     } else {
       error() << "Unknown pulse type: " << m_pulseType.value() << endmsg;
     }
+
+    // Suppressed hits are stored if their output collection is named
+    const size_t nSuppressedOutputs = outputLocations("SuppressedOutputCollection").size();
+    if (nSuppressedOutputs > 1) {
+      error() << "SuppressedOutputCollection takes at most one collection name" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_storeSuppressedHits = nSuppressedOutputs == 1;
+    if (m_storeSuppressedHits && !m_sparseMode.value())
+      warning() << "SuppressedOutputCollection is set but sparseMode is not; it will be empty" << endmsg;
+    m_rngStream = k4::recCalo::CounterRng::streamID(name());
+
+    // Noise tool, for the threshold in sparse mode
+    if (m_sparseMode.value()) {
+      if (!m_noiseTool.retrieve()) {
+        error() << "Unable to retrieve the noise tool!!!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      if (!(m_samplingFraction.value() > 0)) {
+        error() << "samplingFraction must be positive; got " << m_samplingFraction.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      info() << "Sparse mode: digitizing hits above " << m_sparseThreshold.value() << " sigma of the cell noise"
+             << ", with a sampling fraction of " << m_samplingFraction.value() << endmsg;
+    } else {
+      m_noiseTool.disable();
+    }
     return StatusCode::SUCCESS;
   }
 
@@ -101,36 +171,58 @@ struct CaloDigitizerFunc final
    *
    * This function takes as input a SimCalorimeterHitCollection and digitizes each hit using the predefined pulse shape
    * and its derivative. The digitized pulses are stored in a TimeSeriesCollection, which is returned as output.
+   * In sparse mode, hits below the noise threshold of their cell are not digitized, and are instead returned
+   * as CalorimeterHits if "SuppressedOutputCollection" is set.
    *
    * \param CaloHits: The input SimCalorimeterHitCollection.
-   * \return TimeSeriesCollection of digitized hits.
+   * \return TimeSeriesCollection of digitized hits, and CalorimeterHitCollection of suppressed hits if requested.
    */
-  edm4hep::TimeSeriesCollection operator()(const edm4hep::SimCalorimeterHitCollection& CaloHits) const override {
+  std::tuple<edm4hep::TimeSeriesCollection, std::vector<edm4hep::CalorimeterHitCollection>>
+  operator()(const edm4hep::SimCalorimeterHitCollection& CaloHits) const override {
     info() << "calorimeter hits collection size: " << CaloHits.size() << endmsg;
 
     edm4hep::TimeSeriesCollection DigitsCollection;
+    edm4hep::CalorimeterHitCollection SuppressedCollection;
+    const bool debugOn = msgLevel(MSG::DEBUG);
+    size_t nSuppressed = 0;
+    const k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed.value(), m_rngStream);
+
+    // Pulse of the current hit, reused for all hits
+    std::vector<float> DigitVectorSum(PulseShape.size());
 
     // Loop over CaloHits to accumulate energy
     for (const auto& hit : CaloHits) {
       uint64_t cellID = hit.getCellID();
-      float energy = hit.getEnergy();
-      debug() << "Hit energy: " << energy << endmsg;
-      auto Contributions = hit.getContributions();
+      if (debugOn)
+        debug() << "Hit energy: " << hit.getEnergy() << endmsg;
 
-      std::vector<float> DigitVectorSum(PulseShape.size(), 0.0f);
+      // Zero suppression
+      if (m_sparseMode.value()) {
+        const auto [rms, offset] = m_noiseTool->getNoisePerCell(cellID);
+        const double cellEnergy = hit.getEnergy() / m_samplingFraction.value();
+        if (cellEnergy <= offset + m_sparseThreshold.value() * rms) {
+          ++nSuppressed;
+          if (m_storeSuppressedHits)
+            storeSuppressedHit(hit, cellEnergy, rms, offset, rng, SuppressedCollection);
+          continue;
+        }
+      }
 
-      // Loop over contributions to get the energy and time
-      for (const auto& contribution : Contributions) {
-        auto DigitVector =
-            Hit2DigitFloat(contribution.getEnergy(), contribution.getTime(), PulseShape, PulseShapeDeriv);
+      std::fill(DigitVectorSum.begin(), DigitVectorSum.end(), 0.0f);
 
-        // Sum the contributions
-        std::transform(DigitVectorSum.begin(), DigitVectorSum.end(), DigitVector.begin(), DigitVectorSum.begin(),
-                       std::plus<float>());
+      // Loop over contributions to get the energy and time, adding each to the pulse
+      for (const auto& contribution : hit.getContributions()) {
+        if (m_pulseLibrary) {
+          m_pulseLibrary->add(DigitVectorSum, contribution.getEnergy(), contribution.getTime());
+        } else {
+          k4::recCalo::addPulseContribution(DigitVectorSum, contribution.getEnergy(), contribution.getTime(),
+                                            m_samplingInterval, PulseShape, PulseShapeDeriv);
+        }
 
         // Print the contribution info
-        debug() << "Contribution (energy, time): (" << contribution.getEnergy() << ", " << contribution.getTime() << ")"
-                << endmsg;
+        if (debugOn)
+          debug() << "Contribution (energy, time): (" << contribution.getEnergy() << ", " << contribution.getTime()
+                  << ")" << endmsg;
       }
       auto Digit = DigitsCollection.create();
       Digit.setCellID(cellID);
@@ -141,38 +233,37 @@ struct CaloDigitizerFunc final
         Digit.addToAmplitude(DigitVectorSum[i]);
       }
     }
-    return DigitsCollection;
+    if (m_sparseMode.value() && debugOn)
+      debug() << "Suppressed " << nSuppressed << " of " << CaloHits.size() << " hits" << endmsg;
+    std::vector<edm4hep::CalorimeterHitCollection> SuppressedOutputs;
+    if (m_storeSuppressedHits)
+      SuppressedOutputs.push_back(std::move(SuppressedCollection));
+    return std::make_tuple(std::move(DigitsCollection), std::move(SuppressedOutputs));
   }
 
   /**
-   * \brief Function to convert a hit to a digitized pulse.
-   *
-   * This function takes as input the energy and time of a hit, along with the pulse shape and its derivative, and
-   * computes the corresponding digitized pulse samples. The digitized pulse is represented as a vector of floats. See
-   * ATLAS LAr digitization note for details.
+   * \brief Records a hit below the threshold, with its noisy energy and energy-weighted time.
    *
-   * \param Energy: The energy of the hit.
-   * \param time: The time of the hit.
-   * \param pulseShape: The pulse shape vector.
-   * \param pulseShapeDeriv: The derivative of the pulse shape vector.
-   * \return Vector<float> representing the digitized pulse samples.
+   * \param hit: The simulated hit.
+   * \param cellEnergy: Energy of the hit at the scale of the noise.
+   * \param rms: Noise RMS of the cell.
+   * \param offset: Noise offset of the cell.
+   * \param rng: Random numbers of this event.
+   * \param out: The collection to which to add it.
    */
-  std::vector<float> Hit2DigitFloat(float Energy, float time, const std::vector<float>& pulseShape,
-                                    const std::vector<float>& pulseShapeDeriv) const {
-    // Basing this off of LArDigitization pub note: https://inspirehep.net/files/8b92316ea8786d3954cccbfaa0d10ada
-    std::vector<float> DigitVector(pulseShape.size(), 0.0f);
-
-    // Loop over the DigitVector
-    for (unsigned int i = 0; i < DigitVector.size(); ++i) {
-      int j = i - std::rint(time / m_samplingInterval);
-      // if j < 0, it means the pulse is not in the time window so set it to 0
-      if (j >= 0) {
-        float DeltaT = time - m_samplingInterval * std::rint(time / m_samplingInterval);
-
-        DigitVector[i] = Energy * (pulseShape[j] - DeltaT * pulseShapeDeriv[j]);
-      }
+  void storeSuppressedHit(const edm4hep::SimCalorimeterHit& hit, double cellEnergy, double rms, double offset,
+                          const k4::recCalo::CounterRng& rng, edm4hep::CalorimeterHitCollection& out) const {
+    double energy = 0;
+    double energyTime = 0;
+    for (const auto& contribution : hit.getContributions()) {
+      energy += contribution.getEnergy();
+      energyTime += contribution.getEnergy() * contribution.getTime();
     }
-    return DigitVector;
+    auto suppressed = out.create();
+    suppressed.setCellID(hit.getCellID());
+    suppressed.setEnergy(cellEnergy + offset + rms * rng.gauss(hit.getCellID()));
+    suppressed.setTime(energy != 0 ? energyTime / energy : 0);
+    suppressed.setPosition(hit.getPosition());
   }
 
   /**
@@ -223,10 +314,37 @@ private:
   // Gaussian pulse properties
   Gaudi::Property<float> m_mu{this, "mu", 100.0, "Mean of Gaussian pulse"};
   Gaudi::Property<float> m_sigma{this, "sigma", 20.0, "Sigma of Gaussian pulse"};
+  // Number of sub-sample phases of the pulse shape
+  Gaudi::Property<int> m_pulsePhases{this, "pulsePhases", 32,
+                                     "Number of sub-sample phases at which the pulse shape is tabulated; "
+                                     "0 to use the first-order correction instead"};
 
   std::vector<float> PulseShape;
   std::vector<float> PulseShapeDeriv;
 
+  // Sparse mode
+  Gaudi::Property<bool> m_sparseMode{this, "sparseMode", false,
+                                     "Digitize only hits above the noise threshold of their cell"};
+  Gaudi::Property<double> m_sparseThreshold{this, "sparseThreshold", 3,
+                                            "In sparse mode, threshold on the hit energy, in units of the noise RMS "
+                                            "above the noise offset of the cell"};
+  Gaudi::Property<double> m_samplingFraction{this, "samplingFraction", 1,
+                                             "In sparse mode, sampling fraction by which the hit energy is divided "
+                                             "to compare it with the noise of the cell"};
+  // Seed for the noise of the suppressed hits, which also depends on the run, event, and cell ID
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0,
+                                         "Seed for the noise added to the suppressed hits; it also depends on the "
+                                         "run, event, and cell ID, and on the name of this algorithm"};
+  // Random number stream of this algorithm, made from its name
+  uint64_t m_rngStream = 0;
+  // Whether SuppressedOutputCollection is named
+  bool m_storeSuppressedHits = false;
+  // Noise of each cell, for the threshold in sparse mode
+  ToolHandle<k4::recCalo::INoiseConstTool> m_noiseTool{this, "noiseTool", "ConstNoiseTool",
+                                                       "Tool giving the noise of each cell, used in sparse mode"};
+  // Pulse shape at each phase, if m_pulsePhases > 0
+  std::unique_ptr<k4::recCalo::PulseShapeLibrary> m_pulseLibrary;
+
   float m_samplingInterval;
 };
 
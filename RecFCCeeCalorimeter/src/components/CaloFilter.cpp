@@ -30,12 +30,18 @@
  * Note that the length of \f$ \vec{O} \f$ is set to be of the same size as \f$ \vec{D} \f$ in the convolution.
  * The maximum value of \f$ \vec{O} \f$ is taken as the best estimate of the energy in the cell, and the index of this
  *maximum value is taken as the best estimate of the timing.
+ * The filter is applied to all the pulses of an event together, using the vectorized kernel
+ *k4::recCalo::matchedFilterBatch, which also returns the maximum and its index.
  *
  * Future iterations of this MultiTransformer will include other filter types.
  *
+ * The algorithm is available as CaloFilterFunc, reading float amplitudes, and as CaloFilterFuncRaw, reading ADC counts
+ *(as made by CaloQuantizeDigits), which are decoded to amplitudes with the "adcGain" and "adcPedestal" properties.
+ *
  *The unit system used here is GeV and ns throughout.
  * Inputs:
- *     - TimeSeriesCollection: Collection of digitized pulses per cell (see CaloDigitizerFunc for more detail).
+ *     - TimeSeriesCollection: Collection of digitized pulses per cell (see CaloDigitizerFunc for more detail);
+ *RawTimeSeriesCollection for CaloFilterFuncRaw.
  *
  * Properties:
  *     - @param m_filterName: The name of the filter to apply. Currently only "Matched_Gaussian" is implemented.
@@ -50,6 +56,8 @@
  *     - @param m_noiseInfoFileName: The name of the ROOT file to load the noise correlation matrix from.
  *     - @param m_invCorrMatName: The name of the ROOT TMatrixD that represents the inverse of the correlation matrix of
  *the noise.
+ *     - @param m_adcGain: For CaloFilterFuncRaw, ADC counts per GeV of amplitude.
+ *     - @param m_adcPedestal: For CaloFilterFuncRaw, ADC count of a zero amplitude.
  *
  * Outputs:
  *     - TimeSeriesCollection: Collection of digitized pulses after applying the filter.
@@ -57,8 +65,8 @@
  *     - float: The best estimate of the energy in the cell.
  *
  * LIMITATIONS: (status 01/12/2025)
- *     - Only the matched filter, assuming a Gaussian signal pulse shape, is currently implemented. The OFC method might
- *be added in the future.
+ *     - Only the matched filter, assuming a Gaussian signal pulse shape, is implemented here. The OFC method is in
+ *CaloOptimalFilter.
  *     - A nicer way to provide the signal shape would be good to have in the future, rather than hardcoding a Gaussian
  *shape.
  *     - The matched filter should technically be a conjugate but since we are dealing with real numbers only, this is
@@ -79,10 +87,18 @@
 
 #include "k4FWCore/Transformer.h"
 
+#include "RecCaloCommon/AdcCodec.h"
+#include "RecCaloCommon/PulseProcessing.h"
+
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "TFile.h"
 #include "TMatrixDSym.h"
@@ -90,21 +106,31 @@
 #include <TMatrixD.h>
 #include <TVectorD.h>
 
-using DigitsColl = edm4hep::TimeSeriesCollection;
-
 using FilterColl = edm4hep::TimeSeriesCollection;
 using MatchedSampleIdxColl = podio::UserDataCollection<int>;
 using MatchedSampleEnergyColl = podio::UserDataCollection<float>;
 
-struct CaloFilterFunc final
+template <class DigitsColl>
+struct CaloFilterFuncT final
     : k4FWCore::MultiTransformer<std::tuple<FilterColl, MatchedSampleIdxColl, MatchedSampleEnergyColl>(
           const DigitsColl&)> {
-  CaloFilterFunc(const std::string& name, ISvcLocator* svcLoc)
-      : MultiTransformer(name, svcLoc, {KeyValues("InputCollection", {"TimeSeriesCollection"})},
+  using Base = k4FWCore::MultiTransformer<std::tuple<FilterColl, MatchedSampleIdxColl, MatchedSampleEnergyColl>(
+      const DigitsColl&)>;
+  using typename Base::KeyValues;
+  using Base::debug;
+  using Base::error;
+  using Base::info;
+  using Base::msgLevel;
+
+  /// True if the input is ADC counts.
+  static constexpr bool isRaw = std::is_same_v<DigitsColl, edm4hep::RawTimeSeriesCollection>;
+
+  CaloFilterFuncT(const std::string& name, ISvcLocator* svcLoc)
+      : Base(name, svcLoc, {KeyValues("InputCollection", {"TimeSeriesCollection"})},
 
-                         {KeyValues("OutputCollectionFilteredPulse", {"FilteredDigitsCollection"}),
-                          KeyValues("OutputCollectionMatchedSampleIdx", {"MatchedSampleIdx"}),
-                          KeyValues("OutputCollectionMatchedSampleEnergy", {"MatchedSampleEnergy"})}) {}
+             {KeyValues("OutputCollectionFilteredPulse", {"FilteredDigitsCollection"}),
+              KeyValues("OutputCollectionMatchedSampleIdx", {"MatchedSampleIdx"}),
+              KeyValues("OutputCollectionMatchedSampleEnergy", {"MatchedSampleEnergy"})}) {}
 
   /**
    * \brief Computes the quantities necessary for the filter.
@@ -117,6 +143,16 @@ struct CaloFilterFunc final
    * \return StatusCode indicating success or failure.
    */
   StatusCode initialize() override {
+    // Decoding of ADC counts
+    if constexpr (isRaw) {
+      if (!(m_adcGain.value() > 0)) {
+        error() << "adcGain must be positive, not " << m_adcGain.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      // The number of bits of the ADC does not matter for decoding.
+      m_adc.emplace(m_adcGain.value(), m_adcPedestal.value(), 31);
+    }
+
     // Get matched filter template
     if (m_filterName.value() == "Matched_Gaussian") {
       info() << "Using the matched filter: Matched Gaussian" << endmsg;
@@ -183,6 +219,7 @@ struct CaloFilterFunc final
       for (size_t i = 0; i < FilterTemplate->size(); ++i) {
         info() << "FilterTemplate[" << i << "] = " << (*FilterTemplate)[i] << endmsg;
       }
+      m_reversedFilter.assign(FilterTemplate->rbegin(), FilterTemplate->rend());
 
     } else {
       error() << "Unknown filter name: " << m_filterName.value() << endmsg;
@@ -207,42 +244,85 @@ struct CaloFilterFunc final
   operator()(const DigitsColl& DigitsPulse) const override {
     info() << "Digitized pulse collection size: " << DigitsPulse.size() << endmsg;
 
-    DigitsColl FilteredDigitsCollection;
+    FilterColl FilteredDigitsCollection;
     MatchedSampleIdxColl MaxIdxCollection;
     MatchedSampleEnergyColl EnergyCollection;
 
-    // Loop over DigitsPulse to extract the pulse amplitudes
-    for (const auto& Digit : DigitsPulse) {
-      const auto InputPulse = Digit.getAmplitude();
+    // The pulses are copied into one matrix and filtered together, in batches of consecutive pulses with the same
+    // number of samples (normally all of them).
+    std::vector<float> Pulses;
+    std::vector<float> Out;
+    std::vector<k4::recCalo::PulsePeak> Peaks;
+    const size_t nDigits = DigitsPulse.size();
+    size_t first = 0;
+    while (first < nDigits) {
+      const size_t nSamples = pulseSize(DigitsPulse[first]);
+      size_t last = first;
+      Pulses.clear();
+      for (; last < nDigits && pulseSize(DigitsPulse[last]) == nSamples; ++last) {
+        const size_t offset = Pulses.size();
+        Pulses.resize(offset + nSamples);
+        pulseAmplitudes(DigitsPulse[last], std::span<float>(Pulses.data() + offset, nSamples));
+      }
 
-      auto FilteredDigit = FilteredDigitsCollection.create();
-      FilteredDigit.setCellID(Digit.getCellID());
+      // Apply matched filter, also giving the energy (maximum) and the matched sample index
+      Out.resize(Pulses.size());
+      Peaks.resize(last - first);
+      k4::recCalo::matchedFilterBatch(Pulses, nSamples, m_reversedFilter, Peaks, Out);
 
-      FilteredDigit.setTime(0.0);                     // Placeholder for time info
-      FilteredDigit.setInterval(Digit.getInterval()); // Set the interval for the digitized pulse in ns
+      for (size_t c = first; c < last; ++c) {
+        const auto Digit = DigitsPulse[c];
+        const k4::recCalo::PulsePeak& Peak = Peaks[c - first];
 
-      // Apply matched filter
-      auto Out = applyMatchedFilter(InputPulse, *FilterTemplate);
+        auto FilteredDigit = FilteredDigitsCollection.create();
+        FilteredDigit.setCellID(Digit.getCellID());
 
-      for (unsigned int i = 0; i < Out.size(); i++) {
-        FilteredDigit.addToAmplitude(Out[i]);
-      }
+        FilteredDigit.setTime(0.0);                     // Placeholder for time info
+        FilteredDigit.setInterval(Digit.getInterval()); // Set the interval for the digitized pulse in ns
 
-      // Calculate the energy of the matched filter and the matched sample index
-      auto MaxIdx = std::distance(Out.begin(), std::max_element(Out.begin(), Out.end()));
-      auto Energy = *std::max_element(Out.begin(), Out.end());
+        for (size_t i = 0; i < nSamples; i++) {
+          FilteredDigit.addToAmplitude(Out[(c - first) * nSamples + i]);
+        }
 
-      debug() << "Cell ID" << Digit.getCellID() << ", MaxIdx: " << MaxIdx << ", Energy - max val: " << Energy << endmsg;
+        if (msgLevel(MSG::DEBUG)) {
+          debug() << "Cell ID" << Digit.getCellID() << ", MaxIdx: " << Peak.index
+                  << ", Energy - max val: " << Peak.energy << endmsg;
+        }
 
-      // Store the matched sample index and energy
-      MaxIdxCollection.push_back(MaxIdx);
-      EnergyCollection.push_back(Energy);
+        // Store the matched sample index and energy
+        MaxIdxCollection.push_back(Peak.index);
+        EnergyCollection.push_back(Peak.energy);
+      }
+      first = last;
     }
 
     return std::make_tuple(std::move(FilteredDigitsCollection), std::move(MaxIdxCollection),
                            std::move(EnergyCollection));
   }
 
+  /**
+   * \brief Returns the number of samples of a pulse.
+   */
+  static size_t pulseSize(const edm4hep::TimeSeries& Digit) { return Digit.getAmplitude().size(); }
+  static size_t pulseSize(const edm4hep::RawTimeSeries& Digit) { return Digit.getAdcCounts().size(); }
+
+  /**
+   * \brief Copies the amplitudes of a pulse, decoding them from ADC counts for raw input.
+   *
+   * \param Digit: The input pulse.
+   * \param Out: The amplitudes, of size pulseSize(Digit).
+   */
+  void pulseAmplitudes(const edm4hep::TimeSeries& Digit, std::span<float> Out) const {
+    const auto Amplitudes = Digit.getAmplitude();
+    std::copy(Amplitudes.begin(), Amplitudes.end(), Out.begin());
+  }
+  void pulseAmplitudes(const edm4hep::RawTimeSeries& Digit, std::span<float> Out) const {
+    const auto Counts = Digit.getAdcCounts();
+    for (size_t i = 0; i < Counts.size(); ++i) {
+      Out[i] = m_adc->decode(Counts[i]);
+    }
+  }
+
   /**
    * \brief Finalizes the transformer but does nothing in this case.
    * \return StatusCode indicating success or failure.
@@ -288,25 +368,6 @@ struct CaloFilterFunc final
     return StatusCode::SUCCESS;
   }
 
-  /**
-   * \brief Apply the matched filter to a digitized pulse.
-   *
-   * This function takes as input a digitized pulse and the matched filter template. It convolves the digitized pulse
-   * with the time reversed version of the matched filter template and returns the filtered pulse.
-   *
-   * \param pulse: The input digitized pulse.
-   * \param Cfilter: The matched filter template. This should NOT be time reversedyet.
-   * \return Vector<float> of the filtered pulse after applying the matched filter.
-   */
-  std::vector<float> applyMatchedFilter(const podio::RelationRange<float>& pulse,
-                                        const std::vector<float>& Cfilter) const {
-    // Reverse filter
-    std::vector<float> filter = Cfilter;
-    std::reverse(filter.begin(), filter.end());
-    // Convolve the pulse with the filter
-    return ConvolveSame(pulse, filter);
-  }
-
   /**
    * \brief Computes the value of a Gaussian function analytically.
    *
@@ -337,32 +398,6 @@ struct CaloFilterFunc final
     return exp(-0.5 * pow((x - mu) / sigma, 2));
   }
 
-  /**
-   * \brief Computes the convolution of two vectors and returns a result of the same size as the input pulse.
-   *
-   * This function computes the convolution of the input pulse with the provided filter and returns a vector of the same
-   * size as the input pulse. This is the equivalent of np.convolve(..., mode='same') in Python.
-   * \param pulse: The input digitized pulse.
-   * \param filter: The filter to convolve with the pulse.
-   * \return Vector<float> representing the convolved pulse of the same size as the input pulse.
-   */
-  std::vector<float> ConvolveSame(const podio::RelationRange<float>& pulse, const std::vector<float>& filter) const {
-    int n = pulse.size();
-    int m = filter.size();
-    int conv_size = n + m - 1;
-    int start = (m - 1) / 2;
-    int end = start + n;
-
-    std::vector<float> result(conv_size, 0.0);
-    for (size_t i = 0; i < pulse.size(); ++i) {
-      for (size_t j = 0; j < filter.size(); ++j) {
-        result[i + j] += pulse[i] * filter[j];
-      }
-    }
-    std::vector<float> result_same(result.begin() + start, result.begin() + end);
-    return result_same;
-  }
-
 private:
   /// Map to be used for the lookup of the pulse shapes
   Gaudi::Property<std::string> m_filterName{this, "filterName", "Matched_Gaussian", "Name of the filter to apply"};
@@ -384,9 +419,16 @@ private:
   Gaudi::Property<std::string> m_invCorrMatName{
       this, "invCorrMatName", "InvertedCorrelationMatrix",
       "Name of ROOT TMatrixD that represents the inverse of the correlation matrix of the noise"};
+  Gaudi::Property<float> m_adcGain{this, "adcGain", 1000, "For raw input, ADC counts per GeV of amplitude"};
+  Gaudi::Property<float> m_adcPedestal{this, "adcPedestal", 200, "For raw input, ADC count of a zero amplitude"};
 
   TMatrixDSym* invCorrMat = nullptr;
   std::vector<float>* FilterTemplate = nullptr;
+  /// The filter template, time-reversed, as used in the convolution
+  std::vector<float> m_reversedFilter;
+  /// Decoding of ADC counts, for raw input
+  std::optional<k4::recCalo::AdcCodec> m_adc;
 };
 
-DECLARE_COMPONENT(CaloFilterFunc)
\ No newline at end of file
+DECLARE_COMPONENT_WITH_ID(CaloFilterFuncT<edm4hep::TimeSeriesCollection>, "CaloFilterFunc")
+DECLARE_COMPONENT_WITH_ID(CaloFilterFuncT<edm4hep::RawTimeSeriesCollection>, "CaloFilterFuncRaw")
\ No newline at end of file
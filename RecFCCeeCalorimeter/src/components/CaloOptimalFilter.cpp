@@ -0,0 +1,336 @@
+/** @class CaloOptimalFilter
+ * @brief Gaudi Transformer to reconstruct the energy and time of digitized pulses by optimal filtering
+ *
+ * @date   2026-10-16
+ *
+ * @details
+ * Gaudi Transformer that reconstructs the energy and time of each cell from a TimeSeriesCollection of digitized
+ *pulses with noise, using optimal filtering (Cleland and Stern, NIM A338 (1994) 467), as done for the ATLAS LAr
+ *calorimeter.
+ *
+ * For a pulse of amplitude \f$ A \f$ delayed by a small time \f$ \tau \f$, the samples around the peak are
+ * \f$ s_i = A g_i - A \tau g'_i + n_i \f$, where \f$ g \f$ is the pulse shape, \f$ g' \f$ its derivative and
+ * \f$ n \f$ the noise. The optimal filtering coefficients \f$ a_i \f$ and \f$ b_i \f$ are the weights giving
+ * \f$ A = \sum_i a_i s_i \f$ and \f$ A \tau = \sum_i b_i s_i \f$ without bias and with the least noise variance,
+ *given the noise covariance matrix \f$ V \f$:
+ * \f$ \vec{a} = (Q_2 V^{-1} \vec{g} - Q_3 V^{-1} \vec{g'}) / \Delta \f$,
+ * \f$ \vec{b} = (Q_3 V^{-1} \vec{g} - Q_1 V^{-1} \vec{g'}) / \Delta \f$,
+ * with \f$ Q_1 = g^T V^{-1} g \f$, \f$ Q_2 = g'^T V^{-1} g' \f$, \f$ Q_3 = g'^T V^{-1} g \f$ and
+ * \f$ \Delta = Q_1 Q_2 - Q_3^2 \f$ (see k4::recCalo::optimalFilterCoefficients).
+ *
+ * The coefficients are computed once at initialization, from the Gaussian pulse shape and the noise covariance
+ *matrix and mean written by CaloAddNoise2Digits. Each cell then takes one dot product for the energy and one for the
+ *time over the samples around the peak, rather than a convolution over the whole pulse as CaloFilterFunc does.
+ *The mean of the noise is subtracted through constant terms computed at initialization.
+ *
+ * The pulses are not whitened beforehand: the noise correlations are taken into account by the coefficients.
+ *
+ * The algorithm is available as CaloOptimalFilter, reading float amplitudes, and as CaloOptimalFilterRaw, reading
+ *ADC counts (as made by CaloQuantizeDigits), which are decoded with the "adcGain" and "adcPedestal" properties.
+ *
+ *The unit system used here is GeV and ns throughout.
+ * @section inputs Inputs
+ *     - TimeSeriesCollection: Collection of digitized pulses with noise per cell (e.g. from CaloAddNoise2Digits);
+ *RawTimeSeriesCollection for CaloOptimalFilterRaw.
+ *
+ * @section params Configuration Parameters
+ *     - m_mu: Mean of the Gaussian pulse shape in ns.
+ *     - m_sigma: Standard deviation of the Gaussian pulse shape in ns.
+ *     - m_pulseInitTime: Start time of the digitized pulse in ns.
+ *     - m_pulseEndTime: End time of the digitized pulse in ns.
+ *     - m_lenSample: Number of samples in the full digitized pulse.
+ *     - m_nOFSamples: Number of samples around the peak used (typically 5 in LAr).
+ *     - m_noiseInfoFileName: The name of the ROOT file to load the noise covariance matrix and mean from.
+ *     - m_covMatName: The name of the ROOT TMatrixDSym with the covariance matrix of the noise.
+ *     - m_muVecName: The name of the ROOT TVectorD with the mean of the noise.
+ *     - m_adcGain: For CaloOptimalFilterRaw, ADC counts per GeV of amplitude.
+ *     - m_adcPedestal: For CaloOptimalFilterRaw, ADC count of a zero amplitude.
+ *
+ * @section outputs Outputs:
+ *     - CalorimeterHitCollection: One hit per cell, with the reconstructed energy, and as time the delay of the pulse
+ *with respect to a deposit at time 0 (set to 0 if the energy is not positive). The position is not set.
+ *
+ * LIMITATIONS:
+ *     - The time is reconstructed to first order in the delay, so it is only reliable for delays well below the
+ *sampling interval, as is the case for in-time deposits. Iterating on the phase, as done in ATLAS, is not implemented.
+ */
+
+#include "Gaudi/Property.h"
+
+// edm4hep
+#include "edm4hep/CalorimeterHitCollection.h"
+#include "edm4hep/RawTimeSeriesCollection.h"
+#include "edm4hep/TimeSeriesCollection.h"
+
+#include "k4FWCore/Transformer.h"
+
+#include "RecCaloCommon/AdcCodec.h"
+#include "RecCaloCommon/PulseProcessing.h"
+#include "RecCaloCommon/PulseShapeLibrary.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "TFile.h"
+#include "TMatrixDSym.h"
+#include "TSystem.h"
+#include "TVectorD.h"
+
+template <class DigitsColl>
+struct CaloOptimalFilterT final
+    : k4FWCore::Transformer<edm4hep::CalorimeterHitCollection(const DigitsColl&)> {
+  using Base = k4FWCore::Transformer<edm4hep::CalorimeterHitCollection(const DigitsColl&)>;
+  using typename Base::KeyValues;
+  using Base::debug;
+  using Base::error;
+  using Base::info;
+  using Base::msgLevel;
+
+  /// True if the input is ADC counts.
+  static constexpr bool isRaw = std::is_same_v<DigitsColl, edm4hep::RawTimeSeriesCollection>;
+
+  CaloOptimalFilterT(const std::string& name, ISvcLocator* svcLoc)
+      : Base(name, svcLoc, {KeyValues("InputCollection", {"DigitsWithNoiseFloat"})},
+             {KeyValues("OutputCollection", {"OptimalFilterHits"})}) {}
+
+  /**
+   * \brief Computes the optimal filtering coefficients.
+   *
+   * The pulse shape and its derivative are sampled over the m_nOFSamples samples around the peak, and the noise
+   * covariance matrix between these samples is loaded from the noise info file and inverted.
+   *
+   * \return StatusCode indicating success or failure.
+   */
+  StatusCode initialize() override {
+    // Decoding of ADC counts
+    if constexpr (isRaw) {
+      if (!(m_adcGain.value() > 0)) {
+        error() << "adcGain must be positive, not " << m_adcGain.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      // The number of bits of the ADC does not matter for decoding.
+      m_adc.emplace(m_adcGain.value(), m_adcPedestal.value(), 31);
+    }
+
+    if (m_lenSample.value() <= 0 || m_nOFSamples.value() <= 0 || m_nOFSamples.value() > m_lenSample.value()) {
+      error() << "nOFSamples must be between 1 and pulseSamplingLength (" << m_lenSample.value() << "), not "
+              << m_nOFSamples.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    // Pulse shape, as made by CaloDigitizerFunc for a deposit at time 0
+    const float samplingInterval = (m_pulseEndTime.value() - m_pulseInitTime.value()) / m_lenSample.value();
+    const k4::recCalo::GaussianPulseShape shape{m_mu.value(), m_sigma.value()};
+    std::vector<double> PulseShape(m_lenSample.value());
+    for (int i = 0; i < m_lenSample.value(); ++i) {
+      PulseShape[i] = shape(i * samplingInterval);
+    }
+
+    // Samples around the maximum; if an even number, one more after it
+    const int MaxIdx = std::distance(PulseShape.begin(), std::max_element(PulseShape.begin(), PulseShape.end()));
+    const int n = m_nOFSamples.value();
+    m_firstSample = MaxIdx - (n - 1) / 2;
+    if (m_firstSample < 0 || m_firstSample + n > m_lenSample.value()) {
+      error() << "The " << n << " samples around the peak at sample " << MaxIdx << " do not fit in the pulse of "
+              << m_lenSample.value() << " samples" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    std::vector<double> g(n), dg(n);
+    for (int i = 0; i < n; ++i) {
+      const float t = (m_firstSample + i) * samplingInterval;
+      g[i] = PulseShape[m_firstSample + i];
+      dg[i] = -(t - m_mu.value()) / (m_sigma.value() * m_sigma.value()) * g[i];
+    }
+
+    // Noise covariance and mean over these samples
+    TMatrixDSym InvCov(n);
+    std::vector<double> NoiseMean(n);
+    auto NoiseStatus = GetNoiseInfo(InvCov, NoiseMean);
+    if (NoiseStatus != StatusCode::SUCCESS) {
+      return NoiseStatus;
+    }
+    double det = 0;
+    InvCov.Invert(&det);
+    if (det == 0) {
+      error() << "The noise covariance matrix is singular" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    std::vector<double> a(n), b(n);
+    if (!k4::recCalo::optimalFilterCoefficients(g, dg, std::span<const double>(InvCov.GetMatrixArray(), n * n), a, b)) {
+      error() << "Unable to compute the optimal filtering coefficients: the pulse shape and its derivative are "
+                 "degenerate"
+              << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    // Coefficients, and the contribution of the noise mean to each sum
+    m_a.assign(a.begin(), a.end());
+    m_b.assign(b.begin(), b.end());
+    m_aMean = 0;
+    m_bMean = 0;
+    for (int i = 0; i < n; ++i) {
+      m_aMean += a[i] * NoiseMean[i];
+      m_bMean += b[i] * NoiseMean[i];
+      info() << "OFC sample " << m_firstSample + i << ": a = " << a[i] << ", b = " << b[i] << endmsg;
+    }
+
+    return StatusCode::SUCCESS;
+  }
+
+  /**
+   * \brief Reconstructs the energy and time of each digitized pulse.
+   *
+   * \param DigitsPulse: The input collection of digitized pulses.
+   * \return CalorimeterHitCollection with one hit per pulse.
+   */
+  edm4hep::CalorimeterHitCollection operator()(const DigitsColl& DigitsPulse) const override {
+    debug() << "Digitized pulse collection size: " << DigitsPulse.size() << endmsg;
+
+    edm4hep::CalorimeterHitCollection Hits;
+    const size_t n = m_a.size();
+    std::vector<float> Samples(n);
+
+    for (const auto& Digit : DigitsPulse) {
+      if (pulseSize(Digit) != static_cast<size_t>(m_lenSample.value())) {
+        error() << "Cell " << Digit.getCellID() << " has " << pulseSize(Digit) << " samples rather than "
+                << m_lenSample.value() << "; skipping" << endmsg;
+        continue;
+      }
+      pulseAmplitudes(Digit, Samples);
+
+      float Energy = -m_aMean;
+      float EnergyTime = -m_bMean;
+      for (size_t i = 0; i < n; ++i) {
+        Energy += m_a[i] * Samples[i];
+        EnergyTime += m_b[i] * Samples[i];
+      }
+      const float Time = Energy > 0 ? EnergyTime / Energy : 0;
+
+      auto Hit = Hits.create();
+      Hit.setCellID(Digit.getCellID());
+      Hit.setEnergy(Energy);
+      Hit.setTime(Time);
+
+      if (msgLevel(MSG::DEBUG)) {
+        debug() << "Cell ID " << Digit.getCellID() << ", energy: " << Energy << ", time: " << Time << endmsg;
+      }
+    }
+
+    return Hits;
+  }
+
+  /**
+   * \brief Returns the number of samples of a pulse.
+   */
+  static size_t pulseSize(const edm4hep::TimeSeries& Digit) { return Digit.getAmplitude().size(); }
+  static size_t pulseSize(const edm4hep::RawTimeSeries& Digit) { return Digit.getAdcCounts().size(); }
+
+  /**
+   * \brief Copies the amplitudes of the samples used, decoding them from ADC counts for raw input.
+   *
+   * \param Digit: The input pulse.
+   * \param Out: The amplitudes of the m_nOFSamples samples around the peak.
+   */
+  void pulseAmplitudes(const edm4hep::TimeSeries& Digit, std::span<float> Out) const {
+    const auto Amplitudes = Digit.getAmplitude();
+    std::copy_n(Amplitudes.begin() + m_firstSample, Out.size(), Out.begin());
+  }
+  void pulseAmplitudes(const edm4hep::RawTimeSeries& Digit, std::span<float> Out) const {
+    const auto Counts = Digit.getAdcCounts();
+    for (size_t i = 0; i < Out.size(); ++i) {
+      Out[i] = m_adc->decode(Counts[m_firstSample + i]);
+    }
+  }
+
+  /**
+   * \brief Reads the noise covariance matrix and mean over the samples used from file.
+   *
+   * \param Cov: The covariance matrix between the samples used.
+   * \param Mean: The noise mean of the samples used.
+   * \return StatusCode indicating success or failure.
+   */
+  StatusCode GetNoiseInfo(TMatrixDSym& Cov, std::vector<double>& Mean) {
+    if (m_noiseInfoFileName.empty()) {
+      error() << "Name of the file with the noise info not provided!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (gSystem->AccessPathName(m_noiseInfoFileName.value().c_str())) {
+      error() << "Provided file with the noise info not found!" << endmsg;
+      error() << "File path: " << m_noiseInfoFileName.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    std::unique_ptr<TFile> NoiseInfoFile(TFile::Open(m_noiseInfoFileName.value().c_str(), "READ"));
+    if (!NoiseInfoFile || NoiseInfoFile->IsZombie()) {
+      error() << "Unable to open the file with the noise info!" << endmsg;
+      error() << "File path: " << m_noiseInfoFileName.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    info() << "Using the following file with noise info: " << m_noiseInfoFileName.value() << endmsg;
+
+    // Objects read from the file are owned by us.
+    std::unique_ptr<TMatrixDSym> FullCov(NoiseInfoFile->Get<TMatrixDSym>(m_covMatName.value().c_str()));
+    std::unique_ptr<TVectorD> FullMean(NoiseInfoFile->Get<TVectorD>(m_muVecName.value().c_str()));
+    if (!FullCov || !FullMean) {
+      error() << "Unable to load the noise covariance matrix or mean from file!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    const int n = Cov.GetNrows();
+    if (FullCov->GetNrows() < m_firstSample + n || FullMean->GetNrows() < m_firstSample + n) {
+      error() << "The noise info has " << FullCov->GetNrows() << " samples, fewer than the " << m_firstSample + n
+              << " needed" << endmsg;
+      return StatusCode::FAILURE;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      Mean[i] = (*FullMean)[m_firstSample + i];
+      for (int j = 0; j < n; ++j) {
+        Cov(i, j) = (*FullCov)(m_firstSample + i, m_firstSample + j);
+      }
+    }
+    return StatusCode::SUCCESS;
+  }
+
+private:
+  Gaudi::Property<float> m_mu{this, "mu", 100, "Mean of Gaussian pulse"};
+  Gaudi::Property<float> m_sigma{this, "sigma", 20, "Sigma of Gaussian pulse"};
+
+  // Initial time of the pulse
+  Gaudi::Property<float> m_pulseInitTime{this, "pulseInitTime", 0.0, "Initial time of the pulse"};
+  // End time of the pulse
+  Gaudi::Property<float> m_pulseEndTime{this, "pulseEndTime", 750.0, "End time of the pulse"};
+  // Number of samples in pulse
+  Gaudi::Property<int> m_lenSample{this, "pulseSamplingLength", 30, "Number of samples in pulse"};
+  Gaudi::Property<int> m_nOFSamples{this, "nOFSamples", 5, "Number of samples around the peak used"};
+  Gaudi::Property<std::string> m_noiseInfoFileName{this, "noiseInfoFileName", "NoiseInfo.root",
+                                                   "Name of file to load the noise covariance matrix from"};
+  Gaudi::Property<std::string> m_covMatName{this, "covMatName", "CovarianceMatrix",
+                                            "Name of ROOT TMatrixDSym with the covariance matrix of the noise"};
+  Gaudi::Property<std::string> m_muVecName{this, "muVecName", "NoiseSampleMat_MeansVector",
+                                           "Name of ROOT TVectorD with the mean of the noise"};
+  Gaudi::Property<float> m_adcGain{this, "adcGain", 1000, "For raw input, ADC counts per GeV of amplitude"};
+  Gaudi::Property<float> m_adcPedestal{this, "adcPedestal", 200, "For raw input, ADC count of a zero amplitude"};
+
+  /// First sample used
+  int m_firstSample = 0;
+  /// Optimal filtering coefficients for the energy
+  std::vector<float> m_a;
+  /// Optimal filtering coefficients for the energy times the time
+  std::vector<float> m_b;
+  /// Contributions of the noise mean to the energy and energy times time sums
+  float m_aMean = 0;
+  float m_bMean = 0;
+  /// Decoding of ADC counts, for raw input
+  std::optional<k4::recCalo::AdcCodec> m_adc;
+};
+
+DECLARE_COMPONENT_WITH_ID(CaloOptimalFilterT<edm4hep::TimeSeriesCollection>, "CaloOptimalFilter")
+DECLARE_COMPONENT_WITH_ID(CaloOptimalFilterT<edm4hep::RawTimeSeriesCollection>, "CaloOptimalFilterRaw")
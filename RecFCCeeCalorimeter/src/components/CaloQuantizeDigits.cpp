@@ -0,0 +1,111 @@
+/** @class CaloQuantizeDigits
+ * @brief Gaudi Transformer to convert digitized pulses to integer ADC counts
+ *
+ * @date   2026-10-16
+ *
+ * @details
+ * Gaudi Transformer that converts a TimeSeriesCollection of digitized pulses (float amplitudes) to a
+ *RawTimeSeriesCollection of ADC counts, as an ADC with a given gain, pedestal and number of bits would give
+ *(see k4::recCalo::AdcCodec). Samples outside the range of the ADC are clipped.
+ *
+ * The ADC counts take much less space on disk than the float amplitudes once compressed, so it is this collection
+ *that should be written out, rather than the float one. CaloWhiteningRaw and CaloFilterFuncRaw read it back, decoding
+ *the counts with the same gain and pedestal.
+ *
+ *The unit system used here is GeV and ns throughout.
+ * @section inputs Inputs
+ *     - TimeSeriesCollection: Collection of digitized pulses per cell (e.g. from CaloAddNoise2Digits).
+ *
+ * @section params Configuration Parameters
+ *     - m_adcGain: ADC counts per GeV of amplitude.
+ *     - m_adcPedestal: ADC count of a zero amplitude.
+ *     - m_adcBits: Number of bits of the ADC (12 or 16).
+ *
+ * @section outputs Outputs:
+ *     - RawTimeSeriesCollection: The ADC counts of each pulse. The quality is the number of clipped samples.
+ */
+
+#include "Gaudi/Property.h"
+
+// edm4hep
+#include "edm4hep/RawTimeSeriesCollection.h"
+#include "edm4hep/TimeSeriesCollection.h"
+
+#include "k4FWCore/Transformer.h"
+
+#include "RecCaloCommon/AdcCodec.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+struct CaloQuantizeDigits final
+    : k4FWCore::Transformer<edm4hep::RawTimeSeriesCollection(const edm4hep::TimeSeriesCollection&)> {
+  CaloQuantizeDigits(const std::string& name, ISvcLocator* svcLoc)
+      : Transformer(name, svcLoc, {KeyValues("InputCollection", {"DigitsWithNoiseFloat"})},
+                    {KeyValues("OutputCollection", {"DigitsADC"})}) {}
+
+  /**
+   * \brief Checks the ADC parameters.
+   * \return StatusCode indicating success or failure.
+   */
+  StatusCode initialize() override {
+    if (m_adcBits.value() != 12 && m_adcBits.value() != 16) {
+      error() << "adcBits must be 12 or 16, not " << m_adcBits.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (!(m_adcGain.value() > 0)) {
+      error() << "adcGain must be positive, not " << m_adcGain.value() << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_adc.emplace(m_adcGain.value(), m_adcPedestal.value(), m_adcBits.value());
+    info() << "Quantizing pulses with " << m_adcGain.value() << " counts/GeV, pedestal " << m_adcPedestal.value()
+           << ", " << m_adcBits.value() << " bits" << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+  /**
+   * \brief Converts each digitized pulse to ADC counts.
+   *
+   * \param DigitsPulse: The input TimeSeriesCollection of digitized pulses.
+   * \return RawTimeSeriesCollection of ADC counts.
+   */
+  edm4hep::RawTimeSeriesCollection operator()(const edm4hep::TimeSeriesCollection& DigitsPulse) const override {
+    debug() << "Digitized pulse collection size: " << DigitsPulse.size() << endmsg;
+
+    edm4hep::RawTimeSeriesCollection RawCollection;
+    std::vector<float> Pulse;
+    std::vector<int32_t> Counts;
+    size_t nClipped = 0;
+
+    for (const auto& Digit : DigitsPulse) {
+      const auto InputPulse = Digit.getAmplitude();
+      Pulse.assign(InputPulse.begin(), InputPulse.end());
+      Counts.resize(Pulse.size());
+      const size_t clipped = m_adc->encode(Pulse, Counts);
+      nClipped += clipped;
+
+      auto Raw = RawCollection.create();
+      Raw.setCellID(Digit.getCellID());
+      Raw.setQuality(clipped);
+      Raw.setTime(Digit.getTime());
+      Raw.setInterval(Digit.getInterval());
+      for (int32_t c : Counts) {
+        Raw.addToAdcCounts(c);
+      }
+    }
+    if (nClipped > 0)
+      debug() << nClipped << " samples clipped to the range of the ADC" << endmsg;
+    return RawCollection;
+  }
+
+private:
+  Gaudi::Property<float> m_adcGain{this, "adcGain", 1000, "ADC counts per GeV of amplitude"};
+  Gaudi::Property<float> m_adcPedestal{this, "adcPedestal", 200, "ADC count of a zero amplitude"};
+  Gaudi::Property<unsigned> m_adcBits{this, "adcBits", 12, "Number of bits of the ADC (12 or 16)"};
+
+  /// The conversion to ADC counts
+  std::optional<k4::recCalo::AdcCodec> m_adc;
+};
+
+DECLARE_COMPONENT(CaloQuantizeDigits)
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <set>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -11,6 +13,8 @@
 // k4geo
 #include "detectorCommon/DetUtils_k4geo.h"
 
+#include "RecCaloCommon/MultiIndexer.h"
+
 #include "k4FWCore/MetadataUtils.h"
 
 // EDM4hep
@@ -89,6 +93,68 @@ StatusCode CaloTopoClusterFCCee::initialize() {
   m_decoder = new dd4hep::DDSegmentation::BitFieldCoder(m_systemEncoding);
   m_indexSystem = m_decoder->index("system");
 
+  // set up the indexer for index-based clustering, if requested
+  if (!m_caloTools.empty()) {
+    if (!m_caloTools.retrieve()) {
+      error() << "Unable to retrieve the calorimeter tools!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    std::vector<const k4::recCalo::ICaloIndexer*> indexers;
+    for (auto& caloTool : m_caloTools) {
+      std::unique_ptr<k4::recCalo::ICaloIndexer> indexer = caloTool->indexer();
+      if (!indexer) {
+        error() << "Calorimeter tool " << caloTool.name() << " does not provide an indexer!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      indexers.push_back(indexer.get());
+      m_caloIndexers.push_back(std::move(indexer));
+    }
+    if (indexers.size() == 1) {
+      m_indexer = indexers[0];
+    } else {
+      if (!m_constantsSvc.retrieve()) {
+        error() << "Unable to retrieve the cell constants service!!!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      try {
+        m_multiIndexer =
+            std::make_unique<k4::recCalo::MultiIndexer>((*m_decoder)[m_indexSystem].width(), indexers, *m_constantsSvc);
+      } catch (const std::exception& e) {
+        error() << "Unable to combine the calorimeter indexers: " << e.what() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      m_indexer = m_multiIndexer.get();
+    }
+    info() << "Using index-based clustering over " << m_indexer->cellIDs().size() << " cells" << endmsg;
+    // use the noise table of the noise tool directly, if it is indexed like our cells
+    m_noiseTable = m_noiseTool->indexedNoiseTable();
+    if (m_noiseTable && !m_noiseTable->matches(*m_indexer)) {
+      m_noiseTable = nullptr;
+    }
+    if (m_noiseTable) {
+      info() << "Using the indexed noise table of " << m_noiseTool.name() << endmsg;
+    }
+    // likewise for the neighbour table, so that neighbours need not be looked up by cell ID
+    if (m_useNeighborMap) {
+      m_neighbourTable = m_neighboursTool->neighbourTable();
+      if (m_neighbourTable && !m_neighbourTable->matches(*m_indexer)) {
+        m_neighbourTable = nullptr;
+      }
+    }
+    if (m_neighbourTable) {
+      info() << "Using the indexed neighbour table of " << m_neighboursTool.name() << endmsg;
+    }
+    // Per-event working storage.
+    m_engines = std::make_unique<k4::recCalo::ObjectPool<k4::recCalo::TopoClusterEngine>>(
+        [this]() { return std::make_unique<k4::recCalo::TopoClusterEngine>(*m_indexer); });
+    if (m_nThreads > 1) {
+      m_arena = std::make_unique<tbb::task_arena>(m_nThreads);
+      info() << "Using " << m_nThreads.value() << " threads for clustering within each event" << endmsg;
+    }
+  } else if (m_nThreads > 1) {
+    warning() << "nThreads is only used for index-based clustering; clustering sequentially" << endmsg;
+  }
+
   // initialise the list of metadata for the clusters
   std::vector<std::string> shapeParameterNames = {"dR_over_E"};
   k4FWCore::putCollectionParameter(m_clusterCollection.objKey(), edm4hep::labels::ShapeParameterNames,
@@ -126,6 +192,12 @@ StatusCode CaloTopoClusterFCCee::execute(const EventContext&) const {
     outClusterCells = m_clusterCellsCollection.createAndPut();
   }
 
+  // Use the index-based clustering engine if configured
+  if (m_indexer) {
+    auto engine = m_engines->acquire();
+    return buildClustersIndexed(*engine, outClusters, outClusterCells);
+  }
+
   // Get input collection with calorimeter cells
   edm4hep::CalorimeterHitCollection* inCells = new edm4hep::CalorimeterHitCollection();
   for (size_t ih = 0; ih < m_cellCollectionHandles.size(); ih++) {
@@ -187,32 +259,8 @@ StatusCode CaloTopoClusterFCCee::execute(const EventContext&) const {
     cluster.setEnergy(clusterEnergy);
     checkTotEnergyAboveThreshold += cluster.getEnergy();
 
-    // loop over the cells attached to the cluster to calculate cluster barycenter and attach cells to cluster
-    double clusterPosX = 0.;
-    double clusterPosY = 0.;
-    double clusterPosZ = 0.;
-    double deltaR = 0.;
-    std::vector<double> cellPosPhi(protoCluster.second.size(), 0);
-    std::vector<double> cellPosTheta(protoCluster.second.size(), 0);
-    std::vector<double> cellEnergy(protoCluster.second.size(), 0);
-    double sumCellPhi = 0.;
-    double sumCellTheta = 0.;
-    std::map<int, int> system;
+    // attach cells to cluster
     for (const auto& protoCell : protoCluster.second) {
-      // identify calo system
-      auto systemId = m_decoder->get(protoCell.getCellID(), m_indexSystem);
-      system[int(systemId)]++;
-      auto cellPos = dd4hep::Position(protoCell.getPosition().x, protoCell.getPosition().y, protoCell.getPosition().z);
-
-      clusterPosX += protoCell.getPosition().x * protoCell.getEnergy();
-      clusterPosY += protoCell.getPosition().y * protoCell.getEnergy();
-      clusterPosZ += protoCell.getPosition().z * protoCell.getEnergy();
-      cellPosPhi.push_back(cellPos.Phi());
-      cellPosTheta.push_back(cellPos.Theta());
-      cellEnergy.push_back(protoCell.getEnergy());
-      sumCellPhi += cellPos.Phi() * protoCell.getEnergy();
-      sumCellTheta += cellPos.Theta() * protoCell.getEnergy();
-
       if (m_createClusterCellCollection) {
         auto cell = protoCell.clone();
         outClusterCells->push_back(cell);
@@ -229,26 +277,11 @@ StatusCode CaloTopoClusterFCCee::execute(const EventContext&) const {
       }
     }
 
-    // set cluster position (weighted barycentre of cell positions)
-    cluster.setPosition(
-        edm4hep::Vector3f(clusterPosX / clusterEnergy, clusterPosY / clusterEnergy, clusterPosZ / clusterEnergy));
-
-    // store deltaR of cluster in time for the moment..
-    sumCellPhi = sumCellPhi / clusterEnergy;
-    sumCellTheta = sumCellTheta / clusterEnergy;
-    for (size_t i = 0; i < cellEnergy.size(); ++i) {
-      deltaR += std::sqrt(std::pow(cellPosTheta[i] - sumCellTheta, 2) + std::pow(cellPosPhi[i] - sumCellPhi, 2)) *
-                cellEnergy[i];
-    }
-    cluster.addToShapeParameters(deltaR / clusterEnergy);
-
-    outClusters->push_back(cluster);
-    if (system.size() > 1)
+    // calculate cluster barycenter and shape
+    if (setClusterPosition(cluster, clusterEnergy, protoCluster.second))
       clusterWithMixedCells++;
 
-    cellPosPhi.clear();
-    cellPosTheta.clear();
-    cellEnergy.clear();
+    outClusters->push_back(cluster);
   }
 
   debug() << "Number of clusters with cells in E and HCal:        " << clusterWithMixedCells << endmsg;
@@ -264,6 +297,183 @@ StatusCode CaloTopoClusterFCCee::execute(const EventContext&) const {
   return StatusCode::SUCCESS;
 }
 
+StatusCode CaloTopoClusterFCCee::buildClustersIndexed(k4::recCalo::TopoClusterEngine& engine,
+                                                      edm4hep::ClusterCollection* outClusters,
+                                                      edm4hep::CalorimeterHitCollection* outClusterCells) const {
+  using slot_t = k4::recCalo::TopoClusterEngine::slot_t;
+
+  // Map the input cells into the engine; hits are stored by slot
+  engine.clear();
+  std::vector<edm4hep::CalorimeterHit> hits;
+  std::vector<uint64_t> ids;
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices;
+  for (size_t ih = 0; ih < m_cellCollectionHandles.size(); ih++) {
+    verbose() << "Processing collection " << ih << endmsg;
+    const edm4hep::CalorimeterHitCollection* coll = m_cellCollectionHandles[ih]->get();
+    hits.reserve(hits.size() + coll->size());
+    ids.clear();
+    for (const auto& hit : *coll) {
+      ids.push_back(hit.getCellID());
+    }
+    indices.resize(ids.size());
+    m_indexer->indices(ids, indices);
+    size_t i = 0;
+    for (const auto& hit : *coll) {
+      auto [rms, offset] = m_noiseTable && indices[i] != k4::recCalo::ICaloIndexer::INVALID
+                               ? m_noiseTable->noise(indices[i])
+                               : m_noiseTool->getNoisePerCell(ids[i]);
+      if (engine.addCell(indices[i], ids[i], hit.getEnergy(), rms, offset) == k4::recCalo::TopoClusterEngine::NOSLOT) {
+        error() << "Cell " << ids[i] << " is not known to the calorimeter tools!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      hits.push_back(hit);
+      ++i;
+    }
+  }
+  if (hits.empty()) {
+    debug() << "No active cells, skipping event..." << endmsg;
+    return StatusCode::SUCCESS;
+  }
+
+  debug() << "Number of active cells                               : " << hits.size() << endmsg;
+
+  // Build protoclusters.
+  // With an indexed neighbour table, the neighbour indices are used directly.
+  // Otherwise, the lambda owns its scratch vector, so that it may be copied for each thread.
+  auto neighbours = [this, segmentationNeighbours = std::vector<uint64_t>()](
+                        uint64_t cellID) mutable -> std::span<const uint64_t> {
+    if (m_useNeighborMap) {
+      return m_neighboursTool->neighbours(cellID);
+    }
+    // DDSegmentation returns std::set
+    std::set<dd4hep::DDSegmentation::CellID> outputNeighbors;
+    m_segmentation->neighbours(cellID, outputNeighbors);
+    segmentationNeighbours.assign(outputNeighbors.begin(), outputNeighbors.end());
+    return segmentationNeighbours;
+  };
+  k4::recCalo::TopoClusterEngine::Thresholds thresholds{m_seedSigma, m_neighbourSigma, m_lastNeighbourSigma};
+  bool built = m_neighbourTable ? engine.build(thresholds, true, *m_neighbourTable, m_arena.get())
+                                : engine.build(thresholds, m_useNeighborMap, neighbours, m_arena.get());
+  if (!built) {
+    error() << "No neighbours for cellID found! " << endmsg;
+    error() << "to cellID :  " << engine.failedCell() << endmsg;
+    error() << "in system:   " << m_decoder->get(engine.failedCell(), m_indexSystem) << endmsg;
+    error() << "Unable to build the protoclusters!" << endmsg;
+    return StatusCode::FAILURE;
+  }
+  debug() << "Number of seeds found                                : " << engine.nSeeds() << endmsg;
+
+  // Build clusters
+  debug() << "Building " << engine.nClusters() << " clusters" << endmsg;
+  double checkTotEnergy = 0.;
+  double checkTotEnergyAboveThreshold = 0.;
+  int clusterWithMixedCells = 0;
+  size_t nClusterCells = 0;
+  std::vector<edm4hep::CalorimeterHit> clusterHits;
+  for (size_t iclus = 0; iclus < engine.nClusters(); ++iclus) {
+    std::span<const slot_t> slots = engine.clusterCells(iclus);
+
+    // calculate cluster energy and decide whether to keep it
+    double clusterEnergy = 0.;
+    for (slot_t s : slots) {
+      clusterEnergy += hits[s].getEnergy();
+    }
+    verbose() << "Cluster energy:     " << clusterEnergy << endmsg;
+    checkTotEnergy += clusterEnergy;
+    if (clusterEnergy < m_minClusterEnergy) {
+      continue;
+    }
+
+    // build cluster
+    debug() << "Building cluster with ID: " << engine.clusterID(iclus) << endmsg;
+    edm4hep::MutableCluster cluster;
+
+    // set cluster energy
+    cluster.setEnergy(clusterEnergy);
+    checkTotEnergyAboveThreshold += cluster.getEnergy();
+
+    // attach cells to cluster
+    clusterHits.clear();
+    for (slot_t s : slots) {
+      clusterHits.push_back(hits[s]);
+      if (m_createClusterCellCollection) {
+        auto cell = hits[s].clone();
+        cell.setType(engine.cellType(s));
+        outClusterCells->push_back(cell);
+        cluster.addToHits(cell);
+      } else {
+        // attach all input hits with this cellID
+        for (slot_t d = engine.canonical(s); d != k4::recCalo::TopoClusterEngine::NOSLOT;
+             d = engine.nextDuplicate(d)) {
+          cluster.addToHits(hits[d]);
+        }
+      }
+    }
+    nClusterCells += slots.size();
+
+    // calculate cluster barycenter and shape
+    if (setClusterPosition(cluster, clusterEnergy, clusterHits))
+      clusterWithMixedCells++;
+
+    outClusters->push_back(cluster);
+  }
+
+  debug() << "Number of clusters with cells in E and HCal:        " << clusterWithMixedCells << endmsg;
+  debug() << "Total energy of clusters:                           " << checkTotEnergy << endmsg;
+  debug() << "Total energy of clusters above threshold:                           " << checkTotEnergyAboveThreshold
+          << endmsg;
+  if (m_createClusterCellCollection) {
+    debug() << "Leftover cells :                                    " << hits.size() - nClusterCells << endmsg;
+  }
+
+  return StatusCode::SUCCESS;
+}
+
+template <class CELLS>
+bool CaloTopoClusterFCCee::setClusterPosition(edm4hep::MutableCluster& cluster, double clusterEnergy,
+                                              const CELLS& cells) const {
+  double clusterPosX = 0.;
+  double clusterPosY = 0.;
+  double clusterPosZ = 0.;
+  double deltaR = 0.;
+  std::vector<double> cellPosPhi;
+  std::vector<double> cellPosTheta;
+  std::vector<double> cellEnergy;
+  double sumCellPhi = 0.;
+  double sumCellTheta = 0.;
+  std::set<int> systems;
+  for (const auto& cell : cells) {
+    // identify calo system
+    auto systemId = m_decoder->get(cell.getCellID(), m_indexSystem);
+    systems.insert(int(systemId));
+    auto cellPos = dd4hep::Position(cell.getPosition().x, cell.getPosition().y, cell.getPosition().z);
+
+    clusterPosX += cell.getPosition().x * cell.getEnergy();
+    clusterPosY += cell.getPosition().y * cell.getEnergy();
+    clusterPosZ += cell.getPosition().z * cell.getEnergy();
+    cellPosPhi.push_back(cellPos.Phi());
+    cellPosTheta.push_back(cellPos.Theta());
+    cellEnergy.push_back(cell.getEnergy());
+    sumCellPhi += cellPos.Phi() * cell.getEnergy();
+    sumCellTheta += cellPos.Theta() * cell.getEnergy();
+  }
+
+  // set cluster position (weighted barycentre of cell positions)
+  cluster.setPosition(
+      edm4hep::Vector3f(clusterPosX / clusterEnergy, clusterPosY / clusterEnergy, clusterPosZ / clusterEnergy));
+
+  // store deltaR of cluster in time for the moment..
+  sumCellPhi = sumCellPhi / clusterEnergy;
+  sumCellTheta = sumCellTheta / clusterEnergy;
+  for (size_t i = 0; i < cellEnergy.size(); ++i) {
+    deltaR += std::sqrt(std::pow(cellPosTheta[i] - sumCellTheta, 2) + std::pow(cellPosPhi[i] - sumCellPhi, 2)) *
+              cellEnergy[i];
+  }
+  cluster.addToShapeParameters(deltaR / clusterEnergy);
+
+  return systems.size() > 1;
+}
+
 edm4hep::CalorimeterHitCollection
 CaloTopoClusterFCCee::findSeeds(const edm4hep::CalorimeterHitCollection* allCells) const {
 
@@ -488,6 +698,12 @@ std::vector<std::pair<uint64_t, uint32_t>> CaloTopoClusterFCCee::searchForNeighb
 }
 
 StatusCode CaloTopoClusterFCCee::finalize() {
+  m_engines.reset();
+  m_arena.reset();
+  m_noiseTable = nullptr;
+  m_neighbourTable = nullptr;
+  m_multiIndexer.reset();
+  m_caloIndexers.clear();
   delete m_decoder;
   for (size_t ih = 0; ih < m_cellCollectionHandles.size(); ih++)
     delete m_cellCollectionHandles[ih];
@@ -4,16 +4,23 @@
 // std
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <sys/types.h>
 #include <vector>
 
 // Gaudi
 #include "Gaudi/Algorithm.h"
+#include "GaudiKernel/ServiceHandle.h"
 #include "GaudiKernel/ToolHandle.h"
 
 // Key4HEP
+#include "RecCaloCommon/ICaloCellConstantsSvc.h"
+#include "RecCaloCommon/ICaloIndexer.h"
 #include "RecCaloCommon/ICaloReadNeighboursMap.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/INoiseConstTool.h"
+#include "RecCaloCommon/ObjectPool.h"
+#include "RecCaloCommon/TopoClusterEngine.h"
 #include "k4FWCore/DataHandle.h"
 #include "k4Interface/IGeoSvc.h"
 
@@ -22,6 +29,7 @@ namespace edm4hep {
 class CalorimeterHit;
 class CalorimeterHitCollection;
 class ClusterCollection;
+class MutableCluster;
 } // namespace edm4hep
 
 // DD4HEP
@@ -45,6 +53,15 @@ namespace DDSegmentation {
  * "lastNeighbourSigma". In case that a neighbour is found that has already been assigned to another cluster, both
  * clusters are merged and assigned to the "older" clusterID, this is the one originating from a higher seed energy. The
  * iteration over neighburing cellIDs is continued.
+ *
+ *  If "calorimeterTools" is set, the proto-clusters are instead built with k4::recCalo::TopoClusterEngine,
+ *  which maps the active cells once to dense indices using the indexers provided by those tools, and keeps
+ *  all clustering state in flat arrays.  The resulting clusters are identical, but this is much faster
+ *  for events with many active cells.  All input cells must then be known to the calorimeter tools.
+ *  In that mode, the cluster growth within one event can also be spread over "nThreads" threads;
+ *  the clusters do not depend on the number of threads.
+ *  If the noise tool provides a noise table indexed like these cells (see CachedNoiseConstTool),
+ *  the noise of each cell is read directly from that table.
  *  @author Coralie Neubueser
  *  @author Giovanni Marchiori, based on code from Juraj Smiesko
  */
@@ -100,6 +117,23 @@ public:
   StatusCode finalize();
 
 private:
+  /** Build the clusters using the index-based clustering engine.
+   *   @param[in] engine, the clustering engine to use.
+   *   @param[out] outClusters, the output cluster collection.
+   *   @param[out] outClusterCells, the output collection of clustered cells, or nullptr.
+   */
+  StatusCode buildClustersIndexed(k4::recCalo::TopoClusterEngine& engine, edm4hep::ClusterCollection* outClusters,
+                                  edm4hep::CalorimeterHitCollection* outClusterCells) const;
+
+  /** Set the position and shape parameters of a cluster from its cells.
+   *   @param[inout] cluster, the cluster to fill.
+   *   @param[in] clusterEnergy, the cluster energy.
+   *   @param[in] cells, range of the cells of the cluster.
+   *   return true if the cluster contains cells from more than one system.
+   */
+  template <class CELLS>
+  bool setClusterPosition(edm4hep::MutableCluster& cluster, double clusterEnergy, const CELLS& cells) const;
+
   /// List of input cell collections
   Gaudi::Property<std::vector<std::string>> m_cellCollections{
       this, "cells", {}, "Names of CalorimeterHit collections to read"};
@@ -114,6 +148,29 @@ private:
 
   Gaudi::Property<std::vector<int>> m_caloIDs{this, "calorimeterIDs", {}, "Corresponding list of calorimeter IDs"};
 
+  /// Geometry tools of the input calorimeters.  If set, their indexers are used for the index-based clustering.
+  ToolHandleArray<k4::recCalo::ICalorimeterTool> m_caloTools{
+      this, "calorimeterTools", {}, "Geometry tools of the input calorimeters, used for index-based clustering"};
+  /// Handle to the cell constants service; needed to combine indexers of several calorimeters.
+  ServiceHandle<k4::recCalo::ICaloCellConstantsSvc> m_constantsSvc{this, "CaloCellConstantsSvc",
+                                                                   "k4::recCalo::CaloCellConstantsSvc", ""};
+  /// Indexers of the individual calorimeters.
+  std::vector<std::unique_ptr<k4::recCalo::ICaloIndexer>> m_caloIndexers;
+  /// Indexer covering all input calorimeters, or nullptr if index-based clustering is not used.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_multiIndexer;
+  const k4::recCalo::ICaloIndexer* m_indexer = nullptr;
+  /// Noise table of the noise tool, if it is indexed like m_indexer; owned by the noise tool.
+  const k4::recCalo::IndexedNoiseTable* m_noiseTable = nullptr;
+  /// Neighbour table of the neighbours tool, if it is indexed like m_indexer; owned by the constants service.
+  const k4::recCalo::NeighbourTable* m_neighbourTable = nullptr;
+  /// Clustering engines, one per concurrent call.  Each holds per-event scratch storage.
+  std::unique_ptr<k4::recCalo::ObjectPool<k4::recCalo::TopoClusterEngine>> m_engines;
+  /// Number of threads used to grow the clusters of one event.
+  Gaudi::Property<unsigned> m_nThreads{
+      this, "nThreads", 1, "Number of threads used within one event for index-based clustering (1 = sequential)"};
+  /// Threads used for clustering within one event, or nullptr for sequential clustering.
+  std::unique_ptr<tbb::task_arena> m_arena;
+
   /// Handle for the cells noise tool
   mutable ToolHandle<k4::recCalo::INoiseConstTool> m_noiseTool{"TopoCaloNoisyCells", this};
   /// Handle for neighbours tool
@@ -6,6 +6,7 @@
 #include "edm4hep/MutableCluster.h"
 
 // DD4hep
+#include "DD4hep/DD4hepUnits.h"
 #include "DD4hep/Detector.h"
 
 DECLARE_COMPONENT(CaloTowerToolFCCee)
@@ -39,6 +40,42 @@ StatusCode CaloTowerToolFCCee::initialize() {
   debug() << "Towers: phiMin " << m_phiMin.value() << ", phiMax " << m_phiMax.value() << ", deltaPhiTower "
           << m_deltaPhiTower.value() << ", nPhiTower " << m_nPhiTower << endmsg;
 
+  // precompute the towers of the cells of each collection, if the geometry tools are given
+  if (!m_caloTools.empty()) {
+    if (m_caloTools.size() != m_cellCollections.size() || m_cellPositionsTools.size() != m_cellCollections.size()) {
+      error() << "calorimeterTools and cellPositionsTools must be given for each cell collection" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    if (!m_caloTools.retrieve() || !m_cellPositionsTools.retrieve()) {
+      error() << "Unable to retrieve the calorimeter or cell positions tools!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    for (size_t ih = 0; ih < m_cellCollections.size(); ih++) {
+      std::unique_ptr<k4::recCalo::ICaloIndexer> indexer = m_caloTools[ih]->indexer();
+      if (!indexer) {
+        error() << "Calorimeter tool " << m_caloTools[ih].name() << " does not provide an indexer!" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      size_t nOutside = 0;
+      m_cellTowerMaps.emplace_back(*indexer, [&](dd4hep::DDSegmentation::CellID aCellId,
+                                                 std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries) {
+        // positions as stored in the cells, in mm
+        dd4hep::Position posCell = m_cellPositionsTools[ih]->xyzPosition(aCellId);
+        if (!cellTowers(posCell.x() / dd4hep::mm, posCell.y() / dd4hep::mm, posCell.z() / dd4hep::mm, aEntries,
+                        false)) {
+          ++nOutside;
+        }
+      });
+      m_indexers.push_back(std::move(indexer));
+      info() << "Precomputed the towers of " << m_cellTowerMaps.back().size() << " cells of "
+             << m_cellCollections[ih] << endmsg;
+      if (nOutside > 0) {
+        warning() << nOutside << " cells of " << m_cellCollections[ih]
+                  << " are outside of the range of towers, they will not be clustered" << endmsg;
+      }
+    }
+  }
+
   return StatusCode::SUCCESS;
 }
 
@@ -47,12 +84,10 @@ void CaloTowerToolFCCee::towersNumber(int& nTheta, int& nPhi) {
   nPhi = m_nPhiTower;
 }
 
-uint CaloTowerToolFCCee::buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells) {
+k4::recCalo::CaloTowers CaloTowerToolFCCee::buildTowers(bool fillTowersCells) const {
+  k4::recCalo::CaloTowers towers(m_nThetaTower, m_nPhiTower);
   uint totalNumberOfCells = 0;
   uint totalNumberOfClusteredCells = 0;
-  for (auto& towerInMap : m_cellsInTowers) {
-    towerInMap.second.clear();
-  }
 
   // Loop over input cell collections to build towers
   for (size_t ih = 0; ih < m_cellCollectionHandles.size(); ih++) {
@@ -61,7 +96,7 @@ uint CaloTowerToolFCCee::buildTowers(std::vector<std::vector<float>>& aTowers, b
     debug() << "Input cell collection size: " << coll->size() << endmsg;
     // Loop over collection of calorimeter cells
     if (coll->size() > 0) {
-      totalNumberOfClusteredCells += CellsIntoTowers(aTowers, coll, fillTowersCells);
+      totalNumberOfClusteredCells += CellsIntoTowers(towers, coll, ih, fillTowersCells);
       totalNumberOfCells += coll->size();
     }
   }
@@ -69,14 +104,16 @@ uint CaloTowerToolFCCee::buildTowers(std::vector<std::vector<float>>& aTowers, b
   debug() << "Total number of input cells: " << totalNumberOfCells << endmsg;
   debug() << "Total number of clustered input cells: " << totalNumberOfClusteredCells << endmsg;
 
-  return totalNumberOfClusteredCells;
+  towers.grid.finalizeCells();
+  towers.nCells = totalNumberOfClusteredCells;
+  return towers;
 }
 
 // Get the tower IDs in theta
 // aTheta Position of the calorimeter cell in theta
 // Note that the function returns an unsigned int so it
 // assumes that aTheta is <= thetaMax.
-// This is checked in CellsIntoTowers
+// This is checked in cellTowers
 uint CaloTowerToolFCCee::idTheta(float aTheta) const {
   uint id = floor((m_thetaMax - aTheta) / m_deltaThetaTower);
   return id;
@@ -86,7 +123,7 @@ uint CaloTowerToolFCCee::idTheta(float aTheta) const {
 // aPhi Position of the calorimeter cell in phi
 // Note hat the function returns an unsigned int so it
 // assumes that aPhi is >= phiMin.
-// This is checked in CellsIntoTowers
+// This is checked in cellTowers
 uint CaloTowerToolFCCee::idPhi(float aPhi) const {
   uint id = floor((aPhi - m_phiMin) / m_deltaPhiTower);
   return id;
@@ -116,60 +153,99 @@ uint CaloTowerToolFCCee::phiIndexTower(int aIPhi) const {
     return aIPhi;
 }
 
-std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> CaloTowerToolFCCee::cellsInTowers() const {
-  return m_cellsInTowers;
+// Cells in a tower; towers outside the grid in theta are empty
+std::span<const k4::recCalo::TowerGrid::index_t>
+CaloTowerToolFCCee::towerCells(const k4::recCalo::CaloTowers& aTowers, int aITheta, int aIPhi) const {
+  if (aITheta < 0 || aITheta >= aTowers.grid.nRows()) {
+    return {};
+  }
+  return aTowers.grid.cells(aITheta, phiIndexTower(aIPhi));
+}
+
+// tower of a cell, and the weight of its energy in the tower
+bool CaloTowerToolFCCee::cellTowers(float aX, float aY, float aZ,
+                                    std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries, bool aWarn) const {
+  float cellTheta = atan2(sqrt(aX * aX + aY * aY), aZ);
+  float cellPhi = atan2(aY, aX);
+  // skip cells outside of specified ranges
+  if (cellTheta < m_thetaMin || cellTheta > m_thetaMax) {
+    if (aWarn) {
+      warning() << "Cell theta " << cellTheta << " outside of theta range of towers, will not be clustered" << endmsg;
+    }
+    return false;
+  }
+  if (cellPhi < m_phiMin || cellPhi > m_phiMax) {
+    if (aWarn) {
+      warning() << "Cell phi " << cellPhi << " outside of phi range of towers, will not be clustered" << endmsg;
+    }
+    return false;
+  }
+  int iTheta = idTheta(cellTheta);
+  int iPhi = idPhi(cellPhi);
+  // flat index of the tower, as in TowerGrid
+  aEntries.push_back(
+      {static_cast<uint32_t>(iTheta * m_nPhiTower + phiIndexTower(iPhi)), static_cast<float>(sin(cellTheta))});
+  return true;
 }
 
 // to fill the cell infomation into towers
-uint CaloTowerToolFCCee::CellsIntoTowers(std::vector<std::vector<float>>& aTowers,
-                                         const edm4hep::CalorimeterHitCollection* aCells, bool fillTowersCells) {
+uint CaloTowerToolFCCee::CellsIntoTowers(k4::recCalo::CaloTowers& aTowers,
+                                         const edm4hep::CalorimeterHitCollection* aCells, size_t aCollection,
+                                         bool fillTowersCells) const {
   // Loop over a collection of calorimeter cells and build calo towers
-  // tower index of the borders of the cell
-  int iTheta = 0;
-  int iPhi = 0;
   uint clusteredCells = 0;
 
-  for (const auto& cell : *aCells) {
-    float cellX = cell.getPosition().x;
-    float cellY = cell.getPosition().y;
-    float cellZ = cell.getPosition().z;
-    float cellTheta = atan2(sqrt(cellX * cellX + cellY * cellY), cellZ);
-    float cellPhi = atan2(cellY, cellX);
-    // skip cells outside of specified ranges
-    if (cellTheta < m_thetaMin || cellTheta > m_thetaMax) {
-      warning() << "Cell theta " << cellTheta << " outside of theta range of towers, will not be clustered" << endmsg;
-      continue;
+  // indices of the cells in the precomputed towers, if any
+  const k4::recCalo::ICaloIndexer* indexer =
+      aCollection < m_indexers.size() ? m_indexers[aCollection].get() : nullptr;
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices;
+  if (indexer) {
+    std::vector<dd4hep::DDSegmentation::CellID> ids;
+    ids.reserve(aCells->size());
+    for (const auto& cell : *aCells) {
+      ids.push_back(cell.getCellID());
     }
-    if (cellPhi < m_phiMin || cellPhi > m_phiMax) {
-      warning() << "Cell phi " << cellPhi << " outside of phi range of towers, will not be clustered" << endmsg;
+    indices.resize(ids.size());
+    indexer->indices(ids, indices);
+  }
+
+  std::span<float> energies = aTowers.grid.energies();
+  std::vector<k4::recCalo::CellTowerMap::Entry> cellEntries;
+  for (size_t i = 0; i < aCells->size(); i++) {
+    const auto cell = (*aCells)[i];
+    std::span<const k4::recCalo::CellTowerMap::Entry> towers;
+    if (indexer && indices[i] != k4::recCalo::ICaloIndexer::INVALID) {
+      towers = m_cellTowerMaps[aCollection].entries(indices[i]);
+    } else {
+      cellEntries.clear();
+      cellTowers(cell.getPosition().x, cell.getPosition().y, cell.getPosition().z, cellEntries, true);
+      towers = cellEntries;
+    }
+    if (towers.empty()) {
       continue;
     }
-    iTheta = idTheta(cellTheta);
-    iPhi = idPhi(cellPhi);
-    // debug() << "Cell: x = " << cellX << " y = " << cellY << " z = " << cellZ << endmsg;
-    // debug() << "Cell: theta = " << cellTheta << " phi = " << cellPhi << endmsg;
-    // debug() << "Cell: iTheta = " << iTheta << " iPhi = " << iPhi << " iPhi(cyclic) = " << phiIndexTower(iPhi) <<
-    // endmsg;
-    aTowers[iTheta][phiIndexTower(iPhi)] += cell.getEnergy() * sin(cellTheta);
+    for (const auto& tower : towers) {
+      energies[tower.tower] += cell.getEnergy() * tower.weight;
+    }
     if (fillTowersCells) {
       clusteredCells++;
-      m_cellsInTowers[std::make_pair(iTheta, phiIndexTower(iPhi))].push_back(cell);
-      int ncells = m_cellsInTowers[std::make_pair(iTheta, phiIndexTower(iPhi))].size();
-
-      if (ncells > 5)
-        verbose() << "NUM CELLs IN TOWER : " << ncells << endmsg;
+      for (const auto& tower : towers) {
+        aTowers.grid.addCell(tower.tower, aTowers.cells.size());
+      }
+      aTowers.cells.push_back(cell);
     }
   }
 
   return clusteredCells;
 }
 
-void CaloTowerToolFCCee::attachCells(float theta, float phi, uint halfThetaFin, uint halfPhiFin,
-                                     edm4hep::MutableCluster& aEdmCluster,
-                                     edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool aEllipse) {
+void CaloTowerToolFCCee::attachCells(const k4::recCalo::CaloTowers& aTowers, float theta, float phi,
+                                     uint halfThetaFin, uint halfPhiFin, edm4hep::MutableCluster& aEdmCluster,
+                                     edm4hep::CalorimeterHitCollection* aEdmClusterCells, bool aEllipse) const {
   int thetaId = idTheta(theta);
   int phiId = idPhi(phi);
-  std::vector<dd4hep::DDSegmentation::CellID> seen_cellIDs;
+  // cells already attached to this cluster, by index in aTowers.cells
+  aTowers.attachedCells.clear(aTowers.cells.size());
 
   std::vector<float> subDetectorEnergies(m_nSubDetectors);
 
@@ -177,12 +253,12 @@ void CaloTowerToolFCCee::attachCells(float theta, float phi, uint halfThetaFin,
     for (int iTheta = thetaId - halfThetaFin; iTheta <= int(thetaId + halfThetaFin); iTheta++) {
       for (int iPhi = phiId - halfPhiFin; iPhi <= int(phiId + halfPhiFin); iPhi++) {
         if (pow((thetaId - iTheta) / (halfThetaFin + 0.5), 2) + pow((phiId - iPhi) / (halfPhiFin + 0.5), 2) < 1) {
-          for (auto cell : m_cellsInTowers[std::make_pair(iTheta, phiIndexTower(iPhi))]) {
-            if (std::find(seen_cellIDs.begin(), seen_cellIDs.end(), cell.getCellID()) !=
-                seen_cellIDs.end()) { // towers can be smaller than cells in which case a cell belongs to several towers
+          for (auto iCell : towerCells(aTowers, iTheta, iPhi)) {
+            const auto& cell = aTowers.cells[iCell];
+            // towers can be smaller than cells in which case a cell belongs to several towers
+            if (!aTowers.attachedCells.mark(iCell)) {
               continue;
             }
-            seen_cellIDs.push_back(cell.getCellID());
             // if aEdmClusterCells it not nullptr, the user wants the clustered cells to be put into a new collection
             // otherwise we just set links to the existing cells
             if (aEdmClusterCells) {
@@ -210,12 +286,12 @@ void CaloTowerToolFCCee::attachCells(float theta, float phi, uint halfThetaFin,
   } else {
     for (int iTheta = thetaId - halfThetaFin; iTheta <= int(thetaId + halfThetaFin); iTheta++) {
       for (int iPhi = phiId - halfPhiFin; iPhi <= int(phiId + halfPhiFin); iPhi++) {
-        for (auto cell : m_cellsInTowers[std::make_pair(iTheta, phiIndexTower(iPhi))]) {
-          if (std::find(seen_cellIDs.begin(), seen_cellIDs.end(), cell.getCellID()) !=
-              seen_cellIDs.end()) { // towers can be smaller than cells in which case a cell belongs to several towers
+        for (auto iCell : towerCells(aTowers, iTheta, iPhi)) {
+          const auto& cell = aTowers.cells[iCell];
+          // towers can be smaller than cells in which case a cell belongs to several towers
+          if (!aTowers.attachedCells.mark(iCell)) {
             continue;
           }
-          seen_cellIDs.push_back(cell.getCellID());
           if (aEdmClusterCells) {
             auto cellclone = cell.clone();
             aEdmClusterCells->push_back(cellclone);
@@ -3,15 +3,22 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
+#include "GaudiKernel/ToolHandle.h"
 
 // k4FWCore
 #include "k4FWCore/DataHandle.h"
 
 // Interfaces
+#include "RecCaloCommon/CellTowerMap.h"
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
+#include "RecCaloCommon/ICellPositionsTool.h"
 #include "RecCaloCommon/ITowerToolThetaModule.h"
 
 #include <cmath>
 #include <memory>
+#include <span>
+#include <vector>
 
 // edm4hep
 namespace edm4hep {
@@ -29,6 +36,12 @@ class Cluster;
  *  Towers are built of cells in theta-phi, summed over all radial layers.
  *  A tower contains all cells within certain theta and phi (tower size: '\b deltaThetaTower', '\b deltaPhiTower').
  *
+ *  If '\b calorimeterTools' and '\b cellPositionsTools' are given (one of each per input cell collection), the tower
+ *  and sin(theta) weight of every cell of those calorimeters are computed once at initialize, from the cell positions
+ *  given by the positions tools, and tower building is then a lookup and a scatter-add.  The positions tools should
+ *  be those used to position the input cells.  Cells not known to the calorimeter tools are placed from their position
+ *  in each event, as without the tools.
+ *
  *  @author Anna Zaborowska
  *  @author Jana Faltova
  *  @author Tong Li: implement theta-based grid
@@ -54,15 +67,10 @@ public:
   virtual void towersNumber(int& nTheta, int& nPhi) final override;
   /**  Build calorimeter towers.
    *   Tower is defined by a segment in theta and phi, with the energy from all layers (no r segmentation).
-   *   @param[out] aTowers Calorimeter towers.
-   *   @param[in] fillTowersCells Whether to fill maps of cells into towers, for later use in attachCells
-   *   @return Size of the cell collection.
-   */
-  virtual uint buildTowers(std::vector<std::vector<float>>& aTowers, bool fillTowersCells = true) final override;
-  /**  Get the map of cells contained within a tower.
-   *   @return Map of cells in a tower
+   *   @param[in] fillTowersCells Whether to fill the lists of cells in each tower, for later use in attachCells
+   *   @return Calorimeter towers; the number of cells is the number of clustered cells.
    */
-  virtual std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> cellsInTowers() const final override;
+  virtual k4::recCalo::CaloTowers buildTowers(bool fillTowersCells = true) const final override;
   /**  Get the tower IDs in theta.
    *   @param[in] aTheta Position of the calorimeter cell in theta
    *   @return ID (theta) of a tower
@@ -84,6 +92,7 @@ public:
    */
   virtual float phi(int aIdPhi) const final override;
   /**  Find cells belonging to a cluster.
+   *   @param[in] aTowers Calorimeter towers of the event, from buildTowers
    *   @param[in] aTheta Position of the middle tower of a cluster in theta
    *   @param[in] aPhi Position of the middle tower of a cluster in phi
    *   @param[in] aHalfThetaFinal Half size of cluster in theta (in units of tower size). Cluster size is
@@ -91,9 +100,10 @@ public:
    *   @param[in] aHalfPhiFinal Half size of cluster in phi (in units of tower size). Cluster size is 2*aHalfPhiFinal+1
    *   @param[out] aEdmCluster Cluster where cells are attached to
    */
-  virtual void attachCells(float aTheta, float aPhi, uint aHalfThetaFinal, uint aHalfPhiFinal,
-                           edm4hep::MutableCluster& aEdmCluster, edm4hep::CalorimeterHitCollection* aEdmClusterCells,
-                           bool aEllipse = false) final override;
+  virtual void attachCells(const k4::recCalo::CaloTowers& aTowers, float aTheta, float aPhi, uint aHalfThetaFinal,
+                           uint aHalfPhiFinal, edm4hep::MutableCluster& aEdmCluster,
+                           edm4hep::CalorimeterHitCollection* aEdmClusterCells,
+                           bool aEllipse = false) const final override;
 
   /** Get the list of input cell collections
    *  @return List of input cell collections
@@ -124,14 +134,31 @@ private:
    *   @return ID of a tower - shifted and corrected (in [0, m_nPhiTower) range)
    */
   uint phiIndexTower(int aIPhi) const;
+  /**  Get the cells in a tower, taking into account the phi periodicity.
+   *   @param[in] aTowers Calorimeter towers of the event.
+   *   @param[in] aITheta ID of a theta tower; there are no cells outside of [0, m_nThetaTower)
+   *   @param[in] aIPhi ID of a phi tower, may be < 0 or >=m_nPhiTower
+   *   @return Indices of the cells in aTowers.cells
+   */
+  std::span<const k4::recCalo::TowerGrid::index_t> towerCells(const k4::recCalo::CaloTowers& aTowers, int aITheta,
+                                                              int aIPhi) const;
+  /**  Find the tower of a cell and the weight of its energy in the tower.
+   *   @param[in] aX, aY, aZ Position of the cell
+   *   @param[out] aEntries List to which the tower is added, unless the cell is outside of the towers
+   *   @param[in] aWarn Whether to warn about cells outside of the towers
+   *   @return false if the cell is outside of the towers
+   */
+  bool cellTowers(float aX, float aY, float aZ, std::vector<k4::recCalo::CellTowerMap::Entry>& aEntries,
+                  bool aWarn) const;
   /**  This is where the cell info is filled into towers
-   *   @param[in] aTowers Calorimeter towers.
+   *   @param[in,out] aTowers Calorimeter towers.
    *   @param[in] aCells Calorimeter cells collection.
+   *   @param[in] aCollection Index of the cell collection in '\b cells'
    *   @param[in] fillTowerCells If true, make a list of the cells in each tower
    *   @return number of clustered cells
    */
-  uint CellsIntoTowers(std::vector<std::vector<float>>& aTowers, const edm4hep::CalorimeterHitCollection* aCells,
-                       bool fillTowersCells);
+  uint CellsIntoTowers(k4::recCalo::CaloTowers& aTowers, const edm4hep::CalorimeterHitCollection* aCells,
+                       size_t aCollection, bool fillTowersCells) const;
 
   /// List of input cell collections
   Gaudi::Property<std::vector<std::string>> m_cellCollections{
@@ -147,6 +174,18 @@ private:
   /// The vector of input k4FWCore::DataHandles for the input cell collections
   std::vector<std::unique_ptr<k4FWCore::DataHandle<edm4hep::CalorimeterHitCollection>>> m_cellCollectionHandles;
 
+  /// Geometry tools of the calorimeters of the input cell collections, in the same order.
+  /// If set, the towers of their cells are precomputed at initialize.
+  ToolHandleArray<k4::recCalo::ICalorimeterTool> m_caloTools{
+      this, "calorimeterTools", {}, "Geometry tools of the input cell collections, to precompute the cell towers"};
+  /// Tools giving the positions of the cells of the input cell collections, in the same order.
+  ToolHandleArray<k4::recCalo::ICellPositionsTool> m_cellPositionsTools{
+      this, "cellPositionsTools", {}, "Positions tools of the input cell collections, to precompute the cell towers"};
+  /// Indexers of the cells of each input collection, if the cell towers are precomputed.
+  std::vector<std::unique_ptr<k4::recCalo::ICaloIndexer>> m_indexers;
+  /// Towers of the cells of each input collection, indexed like m_indexers.
+  std::vector<k4::recCalo::CellTowerMap> m_cellTowerMaps;
+
   /// Maximum theta of towers
   /// Can be left to pi, it won't hurt
   // (there will just be towers beyond the detector acceptance with zero energy)
@@ -174,8 +213,6 @@ private:
   int m_nThetaTower;
   /// Number of towers in phi
   int m_nPhiTower;
-  /// map to cells contained within a tower so they can be attached to a reconstructed cluster
-  std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> m_cellsInTowers;
 };
 
 #endif /* RECFCCEECALORIMETER_CALOTOWERTOOLFCCEE_H */
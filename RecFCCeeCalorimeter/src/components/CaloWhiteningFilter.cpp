@@ -23,9 +23,13 @@
  *samples in the digitized pulse and are thus defined per sample. More details for v01 be found at:
  *https://indico.cern.ch/event/1580025/contributions/6686602/attachments/3133485/5559196/FCCDigitization4BNLWorkshopEndOfWeekUpdate.pdf.
  *
+ * The algorithm is available as CaloWhitening, reading float amplitudes, and as CaloWhiteningRaw, reading ADC counts
+ *(as made by CaloQuantizeDigits), which are decoded to amplitudes with the "adcGain" and "adcPedestal" properties.
+ *
  *The unit system used here is GeV and ns throughout.
  * Inputs:
- *     - TimeSeriesCollection: Collection of digitized pulses per cell (see CaloDigitizerFunc for more detail).
+ *     - TimeSeriesCollection: Collection of digitized pulses per cell (see CaloDigitizerFunc for more detail);
+ *RawTimeSeriesCollection for CaloWhiteningRaw.
  *
  * Properties:
  *     - @param m_noiseInfoFileName: The name of the ROOT file to load the noise correlation matrix from.
@@ -33,9 +37,15 @@
  *the noise.
  *     - @param m_muVecName: The name of the ROOT TVectorD that represents the mean vector of the noise.
  *    - @param m_filterName: The name of the whitening filter to apply. Currently only "ZCA" is implemented.
+ *    - @param m_batchMode: If true (the default), all pulses of an event are whitened together as one single precision
+ *matrix-matrix product (see k4::recCalo::whitenPulseBatch). Otherwise, each pulse is whitened separately in double
+ *precision.
+ *     - @param m_adcGain: For CaloWhiteningRaw, ADC counts per GeV of amplitude.
+ *     - @param m_adcPedestal: For CaloWhiteningRaw, ADC count of a zero amplitude.
  *
  * Outputs:
- *     - TimeSeriesCollection: Collection of digitized pulses after applying the whitening filter.
+ *     - TimeSeriesCollection: Collection of digitized pulses after applying the whitening filter. Pulses whose number
+ *of samples differs from the size of the whitening matrix are reported as errors and left out.
  *
  * LIMITATIONS: (status 01/12/2025)
  *     - Only the ZCA whitening method is currently implemented.
@@ -53,6 +63,9 @@
 
 #include "k4FWCore/Transformer.h"
 
+#include "RecCaloCommon/AdcCodec.h"
+#include "RecCaloCommon/PulseProcessing.h"
+
 #include "TFile.h"
 #include "TSystem.h"
 
@@ -62,13 +75,28 @@
 // For correlation calculation
 #include <TMatrixDSym.h>
 #include <TMatrixDSymEigen.h>
+#include <algorithm>
 #include <cmath>
-
-struct CaloWhitening final
-    : k4FWCore::Transformer<edm4hep::TimeSeriesCollection(const edm4hep::TimeSeriesCollection&)> {
-  CaloWhitening(const std::string& name, ISvcLocator* svcLoc)
-      : Transformer(name, svcLoc, {KeyValues("InputCollection", {"DigitsFloat"})},
-                    {KeyValues("OutputCollection", {"WhitenedDigitsCollection"})}) {}
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+template <class DIGITS>
+struct CaloWhiteningT final : k4FWCore::Transformer<edm4hep::TimeSeriesCollection(const DIGITS&)> {
+  using Base = k4FWCore::Transformer<edm4hep::TimeSeriesCollection(const DIGITS&)>;
+  using typename Base::KeyValues;
+  using Base::debug;
+  using Base::error;
+  using Base::info;
+  using Base::msgLevel;
+
+  /// True if the input is ADC counts.
+  static constexpr bool isRaw = std::is_same_v<DIGITS, edm4hep::RawTimeSeriesCollection>;
+
+  CaloWhiteningT(const std::string& name, ISvcLocator* svcLoc)
+      : Base(name, svcLoc, {KeyValues("InputCollection", {"DigitsFloat"})},
+             {KeyValues("OutputCollection", {"WhitenedDigitsCollection"})}) {}
 
   /**
    * \brief Computes the quantities necessary for the filter.
@@ -81,6 +109,16 @@ struct CaloWhitening final
    * \return StatusCode indicating success or failure.
    */
   StatusCode initialize() override {
+    // Decoding of ADC counts
+    if constexpr (isRaw) {
+      if (!(m_adcGain.value() > 0)) {
+        error() << "adcGain must be positive, not " << m_adcGain.value() << endmsg;
+        return StatusCode::FAILURE;
+      }
+      // The number of bits of the ADC does not matter for decoding.
+      m_adc.emplace(m_adcGain.value(), m_adcPedestal.value(), 31);
+    }
+
     // Check if file exists
     if (m_noiseInfoFileName.empty()) {
       error() << "Name of the file with the noise info not provided!" << endmsg;
@@ -161,6 +199,13 @@ struct CaloWhitening final
       error() << "Unknown filter name: " << m_filterName.value() << endmsg;
     }
 
+    // Single precision copies for the batch mode
+    if (WhiteningMatrix) {
+      m_whiteningF.assign(WhiteningMatrix->GetMatrixArray(),
+                          WhiteningMatrix->GetMatrixArray() + WhiteningMatrix->GetNoElements());
+      m_muVecF.assign(MuVec->GetMatrixArray(), MuVec->GetMatrixArray() + MuVec->GetNrows());
+    }
+
     return StatusCode::SUCCESS;
   }
 
@@ -170,17 +215,57 @@ struct CaloWhitening final
    * This function takes as input a TimeSeriesCollection of digitized pulses per cell and applies the whitening filter
    * to each pulse. The resulting TimeSeriesCollection with whitened pulses is returned.
    *
-   * \param DigitsPulse: The input TimeSeriesCollection of digitized pulses.
+   * \param DigitsPulse: The input collection of digitized pulses.
    * \return TimeSeriesCollection of whitened pulses.
    */
-  edm4hep::TimeSeriesCollection operator()(const edm4hep::TimeSeriesCollection& DigitsPulse) const override {
+  edm4hep::TimeSeriesCollection operator()(const DIGITS& DigitsPulse) const override {
     info() << "Input digitized pulse collection size: " << DigitsPulse.size() << endmsg;
 
     edm4hep::TimeSeriesCollection WhitenedDigitsCollection;
 
+    const size_t nSamples = MuVec->GetNrows();
+    if (m_batchMode.value()) {
+      // Stack the pulses into one matrix and whiten them together
+      std::vector<float> Pulses;
+      std::vector<size_t> Stacked; // Index in DigitsPulse of each stacked pulse
+      Pulses.reserve(DigitsPulse.size() * nSamples);
+      Stacked.reserve(DigitsPulse.size());
+      for (size_t c = 0; c < DigitsPulse.size(); ++c) {
+        const auto Digit = DigitsPulse[c];
+        if (!checkPulseSize(Digit, nSamples)) {
+          continue;
+        }
+        const size_t offset = Pulses.size();
+        Pulses.resize(offset + nSamples);
+        pulseAmplitudes(Digit, std::span<float>(Pulses.data() + offset, nSamples));
+        Stacked.push_back(c);
+      }
+      std::vector<float> WhitenedPulses(Pulses.size());
+      k4::recCalo::whitenPulseBatch(Pulses, nSamples, m_muVecF, m_whiteningF, WhitenedPulses);
+
+      for (size_t p = 0; p < Stacked.size(); ++p) {
+        const auto Digit = DigitsPulse[Stacked[p]];
+        auto WhitenedDigit = WhitenedDigitsCollection.create();
+        WhitenedDigit.setCellID(Digit.getCellID());
+
+        WhitenedDigit.setTime(0.0);                     // Placeholder for time info
+        WhitenedDigit.setInterval(Digit.getInterval()); // Set the interval for the digitized pulse in ns
+
+        for (size_t i = 0; i < nSamples; i++) {
+          WhitenedDigit.addToAmplitude(WhitenedPulses[p * nSamples + i]);
+        }
+      }
+      return WhitenedDigitsCollection;
+    }
+
     // Loop over DigitsPulse to extract the pulse amplitudes
+    std::vector<float> InputPulse;
     for (const auto& Digit : DigitsPulse) {
-      const auto InputPulse = Digit.getAmplitude();
+      if (!checkPulseSize(Digit, nSamples)) {
+        continue;
+      }
+      InputPulse.resize(nSamples);
+      pulseAmplitudes(Digit, InputPulse);
 
       auto WhitenedDigit = WhitenedDigitsCollection.create();
       WhitenedDigit.setCellID(Digit.getCellID());
@@ -209,7 +294,7 @@ struct CaloWhitening final
    * \param Digits: The input digitized pulse.
    * \return TVectorD representing the whitened pulse.
    */
-  TVectorD ApplyWhiteningMat(const podio::RelationRange<float> Digits) const {
+  TVectorD ApplyWhiteningMat(std::span<const float> Digits) const {
     TVectorD Pulse(Digits.size());
     // Loop over the DigitVector
     for (unsigned int i = 0; i < Digits.size(); ++i) {
@@ -221,6 +306,48 @@ struct CaloWhitening final
     return WhitenedPulse;
   }
 
+  /**
+   * \brief Returns the number of samples of a pulse.
+   */
+  static size_t pulseSize(const edm4hep::TimeSeries& Digit) { return Digit.getAmplitude().size(); }
+  static size_t pulseSize(const edm4hep::RawTimeSeries& Digit) { return Digit.getAdcCounts().size(); }
+
+  /**
+   * \brief Checks that a pulse has as many samples as the whitening matrix, reporting an error otherwise.
+   *
+   * Pulses of another length are skipped: no whitened pulse is made for them.
+   *
+   * \param Digit: The input pulse.
+   * \param nSamples: The number of samples of the whitening matrix.
+   * \return True if the pulse can be whitened.
+   */
+  template <class DIGIT>
+  bool checkPulseSize(const DIGIT& Digit, size_t nSamples) const {
+    if (pulseSize(Digit) == nSamples) {
+      return true;
+    }
+    error() << "Cell " << Digit.getCellID() << " has " << pulseSize(Digit) << " samples rather than " << nSamples
+            << "; skipping" << endmsg;
+    return false;
+  }
+
+  /**
+   * \brief Copies the amplitudes of a pulse, decoding them from ADC counts for raw input.
+   *
+   * \param Digit: The input pulse.
+   * \param Out: The amplitudes, of size pulseSize(Digit).
+   */
+  void pulseAmplitudes(const edm4hep::TimeSeries& Digit, std::span<float> Out) const {
+    const auto Amplitudes = Digit.getAmplitude();
+    std::copy(Amplitudes.begin(), Amplitudes.end(), Out.begin());
+  }
+  void pulseAmplitudes(const edm4hep::RawTimeSeries& Digit, std::span<float> Out) const {
+    const auto Counts = Digit.getAdcCounts();
+    for (size_t i = 0; i < Counts.size(); ++i) {
+      Out[i] = m_adc->decode(Counts[i]);
+    }
+  }
+
   /**
    * \brief Finalizes the transformer but does nothing in this case.
    * \return StatusCode indicating success or failure.
@@ -236,8 +363,18 @@ private:
   Gaudi::Property<std::string> m_muVecName{this, "muVecName", "NoiseSampleMat_MeansVector",
                                            "Name of ROOT TVectorD that represents the mean vector of the noise"};
   Gaudi::Property<std::string> m_filterName{this, "filterName", "ZCA", "Name of the whitening filter to apply"};
+  Gaudi::Property<bool> m_batchMode{this, "batchMode", true,
+                                    "Whiten all pulses of an event together, in single precision"};
+  Gaudi::Property<float> m_adcGain{this, "adcGain", 1000, "For raw input, ADC counts per GeV of amplitude"};
+  Gaudi::Property<float> m_adcPedestal{this, "adcPedestal", 200, "For raw input, ADC count of a zero amplitude"};
   TMatrixD* WhiteningMatrix = nullptr;
   TVectorD* MuVec = nullptr;
+  /// Whitening matrix (row-major) and noise mean, in single precision, for the batch mode
+  std::vector<float> m_whiteningF;
+  std::vector<float> m_muVecF;
+  /// Decoding of ADC counts, for raw input
+  std::optional<k4::recCalo::AdcCodec> m_adc;
 };
 
-DECLARE_COMPONENT(CaloWhitening)
+DECLARE_COMPONENT_WITH_ID(CaloWhiteningT<edm4hep::TimeSeriesCollection>, "CaloWhitening")
+DECLARE_COMPONENT_WITH_ID(CaloWhiteningT<edm4hep::RawTimeSeriesCollection>, "CaloWhiteningRaw")
@@ -10,6 +10,12 @@
 #include "edm4hep/ClusterCollection.h"
 #include "edm4hep/Vector3f.h"
 
+#include "RecCaloCommon/TowerBucketGrid.h"
+#include "RecCaloCommon/TowerEnergySharing.h"
+#include "RecCaloCommon/TowerSumTable.h"
+
+#include <algorithm>
+
 DECLARE_COMPONENT(CreateCaloClustersSlidingWindowFCCee)
 
 CreateCaloClustersSlidingWindowFCCee::CreateCaloClustersSlidingWindowFCCee(const std::string& name, ISvcLocator* svcLoc)
@@ -66,8 +72,6 @@ StatusCode CreateCaloClustersSlidingWindowFCCee::initialize() {
 
 StatusCode CreateCaloClustersSlidingWindowFCCee::execute(const EventContext&) const {
 
-  // 1. Create calorimeter towers (calorimeter grid in theta phi, all layers merged)
-  m_towers.assign(m_nThetaTower, std::vector<float>(m_nPhiTower, 0));
   // Create an output cluster collection
   auto clusters = m_clusters.createAndPut();
   edm4hep::CalorimeterHitCollection* clusterCells = nullptr;
@@ -76,29 +80,25 @@ StatusCode CreateCaloClustersSlidingWindowFCCee::execute(const EventContext&) co
   if (m_createClusterCellCollection) {
     clusterCells = m_clusterCells.createAndPut();
   }
-  // Build towers
-  if (m_towerTool->buildTowers(m_towers, true) == 0) {
+  // 1. Create calorimeter towers (calorimeter grid in theta phi, all layers merged)
+  k4::recCalo::CaloTowers caloTowers = m_towerTool->buildTowers(true);
+  if (caloTowers.nCells == 0) {
     debug() << "Empty cell collection." << endmsg;
     return StatusCode::SUCCESS;
   }
+  // the grid has at least as many towers in theta as the sliding window
+  caloTowers.grid.extendRows(m_nThetaTower);
+  const k4::recCalo::TowerGrid& towers = caloTowers.grid;
 
   // 2. Find local maxima with sliding window, build preclusters, calculate their barycentre position
-  // calculate the sum of first m_nThetaWindow bins in theta, for each phi tower
-  std::vector<float> sumOverTheta(m_nPhiTower, 0);
-  for (int iTheta = 0; iTheta < m_nThetaWindow; iTheta++) {
-    std::transform(sumOverTheta.begin(), sumOverTheta.end(), m_towers[iTheta].begin(), sumOverTheta.begin(),
-                   std::plus<float>());
-  }
-
   // preclusters with phi, theta weighted position and transverse energy
-  m_preClusters.clear();
+  std::vector<precluster> preClusters;
   int halfThetaPos = floor(m_nThetaPosition / 2.);
   int halfPhiPos = floor(m_nPhiPosition / 2.);
   float posX = 0;
   float posY = 0;
   float posZ = 0;
   float sumEnergyPos = 0;
-  std::map<std::pair<uint, uint>, std::vector<edm4hep::CalorimeterHit>> cellsInTowersMap = m_towerTool->cellsInTowers();
 
   // final cluster window
   int halfThetaFin = floor(m_nThetaFinal / 2.);
@@ -107,227 +107,151 @@ StatusCode CreateCaloClustersSlidingWindowFCCee::execute(const EventContext&) co
   int idThetaFin = 0;
   int idPhiFin = 0;
 
-  // loop over all Theta slices starting at the half of the first window
+  // sliding window
   int halfThetaWin = floor(m_nThetaWindow / 2.);
   int halfPhiWin = floor(m_nPhiWindow / 2.);
-  float sumWindow = 0;
-  float sumPhiSlicePrevThetaWin = 0;
-  float sumPhiSliceNextThetaWin = 0;
-  float sumFirstPhiSlice = 0;
-  float sumLastPhiSlice = 0;
-  bool toRemove = false;
 
-  // one slice in theta = window, now only sum over window elements in phi
-  for (int iTheta = halfThetaWin; iTheta < m_nThetaTower - halfThetaWin; iTheta++) {
-    // sum the first window in phi
-    for (int iPhiWindow = -halfPhiWin; iPhiWindow <= halfPhiWin; iPhiWindow++) {
-      sumWindow += sumOverTheta[phiNeighbour(iPhiWindow)];
-    }
-    // loop over all the phi slices
+  // energy of the cells in each tower, and their position weighted with their energy, for the barycentre
+  std::vector<float> cellEnergyTowers(towers.size(), 0);
+  std::vector<float> xTowers(towers.size(), 0);
+  std::vector<float> yTowers(towers.size(), 0);
+  std::vector<float> zTowers(towers.size(), 0);
+  for (int iTheta = 0; iTheta < m_nThetaTower; iTheta++) {
     for (int iPhi = 0; iPhi < m_nPhiTower; iPhi++) {
-      // if energy is above threshold, it may be a precluster
-      if (sumWindow > m_energyThreshold) {
-        // test local maximum in phi
-        // check closest neighbour on the right
-        if (sumOverTheta[phiNeighbour(iPhi - halfPhiWin)] < sumOverTheta[phiNeighbour(iPhi + halfPhiWin + 1)]) {
-          toRemove = true;
-        }
-        // check closest neighbour on the left
-        if (sumOverTheta[phiNeighbour(iPhi + halfPhiWin)] < sumOverTheta[phiNeighbour(iPhi - halfPhiWin - 1)]) {
-          toRemove = true;
-        }
-        // test local maximum in theta
-        // check closest neighbour on the right (if it is not the first window)
-        if (iTheta > halfThetaWin) {
-          for (int iPhiWindowLocalCheck = iPhi - halfPhiWin; iPhiWindowLocalCheck <= iPhi + halfPhiWin;
-               iPhiWindowLocalCheck++) {
-            sumPhiSlicePrevThetaWin += m_towers[iTheta - halfThetaWin - 1][phiNeighbour(iPhiWindowLocalCheck)];
-            sumLastPhiSlice += m_towers[iTheta + halfThetaWin][phiNeighbour(iPhiWindowLocalCheck)];
-          }
-          if (sumPhiSlicePrevThetaWin > sumLastPhiSlice) {
-            toRemove = true;
-          }
-        }
-        // check closest neighbour on the left (if it is not the last window)
-        if (iTheta < m_nThetaTower - halfThetaWin - 1) {
-          for (int iPhiWindowLocalCheck = iPhi - halfPhiWin; iPhiWindowLocalCheck <= iPhi + halfPhiWin;
-               iPhiWindowLocalCheck++) {
-            sumPhiSliceNextThetaWin += m_towers[iTheta + halfThetaWin + 1][phiNeighbour(iPhiWindowLocalCheck)];
-            sumFirstPhiSlice += m_towers[iTheta - halfThetaWin][phiNeighbour(iPhiWindowLocalCheck)];
-          }
-          if (sumPhiSliceNextThetaWin > sumFirstPhiSlice) {
-            toRemove = true;
-          }
-        }
-        sumFirstPhiSlice = 0;
-        sumLastPhiSlice = 0;
-        sumPhiSlicePrevThetaWin = 0;
-        sumPhiSliceNextThetaWin = 0;
-        // Build precluster
-        if (!toRemove) {
-          // Calculate barycentre position (usually smaller window used to reduce noise influence)
-          posX = 0;
-          posY = 0;
-          posZ = 0;
-          sumEnergyPos = 0;
-          // weighted mean for position in theta and phi
-          for (int ipTheta = iTheta - halfThetaPos; ipTheta <= iTheta + halfThetaPos; ipTheta++) {
-            for (int ipPhi = iPhi - halfPhiPos; ipPhi <= iPhi + halfPhiPos; ipPhi++) {
-              for (auto cell : cellsInTowersMap[std::make_pair(ipTheta, phiNeighbour(ipPhi))]) {
-                posX += cell.getPosition().x * cell.getEnergy();
-                posY += cell.getPosition().y * cell.getEnergy();
-                posZ += cell.getPosition().z * cell.getEnergy();
-                sumEnergyPos += cell.getEnergy();
-              }
-            }
-          }
-          // If too small energy in the position window, calculate the position in the whole sliding window
-          // Assigns correct position for cases with maximum energy deposits close to the border in theta
-          if (sumEnergyPos > m_energyThresholdFraction * m_energyThreshold) {
-            posX /= sumEnergyPos;
-            posY /= sumEnergyPos;
-            posZ /= sumEnergyPos;
-          } else {
-            posX = 0;
-            posY = 0;
-            posZ = 0;
-            sumEnergyPos = 0;
-            for (int ipTheta = iTheta - halfThetaWin; ipTheta <= iTheta + halfThetaWin; ipTheta++) {
-              for (int ipPhi = iPhi - halfPhiWin; ipPhi <= iPhi + halfPhiWin; ipPhi++) {
-                for (auto cell : cellsInTowersMap[std::make_pair(ipTheta, phiNeighbour(ipPhi))]) {
-                  posX += cell.getPosition().x * cell.getEnergy();
-                  posY += cell.getPosition().y * cell.getEnergy();
-                  posZ += cell.getPosition().z * cell.getEnergy();
-                  sumEnergyPos += cell.getEnergy();
-                }
-              }
-            }
-            posX /= sumEnergyPos;
-            posY /= sumEnergyPos;
-            posZ /= sumEnergyPos;
-          }
-          // Calculate final cluster energy
-          sumEnergyFin = 0;
-          // Final cluster position
-          idThetaFin = m_towerTool->idTheta(atan2(sqrt(posX * posX + posY * posY), posZ));
-          idPhiFin = m_towerTool->idPhi(atan2(posY, posX));
-          // Recalculating the energy within the final cluster size
-          for (int ipTheta = idThetaFin - halfThetaFin; ipTheta <= idThetaFin + halfThetaFin; ipTheta++) {
-            for (int ipPhi = idPhiFin - halfPhiFin; ipPhi <= idPhiFin + halfPhiFin; ipPhi++) {
-              if (ipTheta >= 0 && ipTheta < m_nThetaTower) { // check if we are not outside of map in theta
-                if (m_ellipseFinalCluster) {
-                  if (pow((ipTheta - idThetaFin) / (m_nThetaFinal / 2.), 2) +
-                          pow((ipPhi - idPhiFin) / (m_nPhiFinal / 2.), 2) <
-                      1) {
-                    sumEnergyFin += m_towers[ipTheta][phiNeighbour(ipPhi)];
-                  }
-                } else {
-                  sumEnergyFin += m_towers[ipTheta][phiNeighbour(ipPhi)];
-                }
-              }
-            }
-          }
-          // check if changing the barycentre did not decrease energy below threshold
-          if (sumEnergyFin > m_energyThreshold) {
-            precluster newPreCluster;
-            newPreCluster.X = posX;
-            newPreCluster.Y = posY;
-            newPreCluster.Z = posZ;
-            newPreCluster.theta = atan2(sqrt(posX * posX + posY * posY), posZ);
-            newPreCluster.phi = atan2(posY, posX);
-            newPreCluster.transEnergy = sumEnergyFin;
-            m_preClusters.push_back(newPreCluster);
-          }
-        }
+      const size_t iTower = towers.tower(iTheta, iPhi);
+      for (auto iCell : towers.cells(iTheta, iPhi)) {
+        const auto& cell = caloTowers.cells[iCell];
+        xTowers[iTower] += cell.getPosition().x * cell.getEnergy();
+        yTowers[iTower] += cell.getPosition().y * cell.getEnergy();
+        zTowers[iTower] += cell.getPosition().z * cell.getEnergy();
+        cellEnergyTowers[iTower] += cell.getEnergy();
       }
-      toRemove = false;
-      // finish processing that window in phi, shift window to the next phi tower
-      // substract first phi tower in current window
-      sumWindow -= sumOverTheta[phiNeighbour(iPhi - halfPhiWin)];
-      // add next phi tower to the window
-      sumWindow += sumOverTheta[phiNeighbour(iPhi + halfPhiWin + 1)];
     }
-    sumWindow = 0;
-    // finish processing that slice, shift window to next theta tower
-    if (iTheta < m_nThetaTower - halfThetaWin - 1) {
-      // substract first theta slice in current window
-      std::transform(sumOverTheta.begin(), sumOverTheta.end(), m_towers[iTheta - halfThetaWin].begin(),
-                     sumOverTheta.begin(), std::minus<float>());
-      // add next theta slice to the window
-      std::transform(sumOverTheta.begin(), sumOverTheta.end(), m_towers[iTheta + halfThetaWin + 1].begin(),
-                     sumOverTheta.begin(), std::plus<float>());
+  }
+
+  // summed-area tables of the towers, with enough ghost columns in phi for all the windows,
+  // so that the sum over any window takes constant time
+  k4::recCalo::TowerSumTable sums(m_nThetaTower, m_nPhiTower, std::max({halfPhiWin + 1, halfPhiPos, halfPhiFin}));
+  const int energyPlane = sums.addPlane(towers.energies());
+  const int cellEnergyPlane = sums.addPlane(cellEnergyTowers);
+  const int xPlane = sums.addPlane(xTowers);
+  const int yPlane = sums.addPlane(yTowers);
+  const int zPlane = sums.addPlane(zTowers);
+
+  // loop over all Theta slices starting at the half of the first window
+  std::vector<int> seeds;
+  for (int iTheta = halfThetaWin; iTheta < m_nThetaTower - halfThetaWin; iTheta++) {
+    // windows above threshold that are local maxima in theta and phi
+    sums.findSeeds(energyPlane, iTheta, halfThetaWin, halfPhiWin, m_energyThreshold, seeds);
+    for (int iPhi : seeds) {
+      // Build precluster
+      // Calculate barycentre position (usually smaller window used to reduce noise influence)
+      sumEnergyPos = sums.windowSum(cellEnergyPlane, iTheta, iPhi, halfThetaPos, halfPhiPos);
+      // If too small energy in the position window, calculate the position in the whole sliding window
+      // Assigns correct position for cases with maximum energy deposits close to the border in theta
+      if (sumEnergyPos > m_energyThresholdFraction * m_energyThreshold) {
+        posX = sums.windowSum(xPlane, iTheta, iPhi, halfThetaPos, halfPhiPos) / sumEnergyPos;
+        posY = sums.windowSum(yPlane, iTheta, iPhi, halfThetaPos, halfPhiPos) / sumEnergyPos;
+        posZ = sums.windowSum(zPlane, iTheta, iPhi, halfThetaPos, halfPhiPos) / sumEnergyPos;
+      } else {
+        sumEnergyPos = sums.windowSum(cellEnergyPlane, iTheta, iPhi, halfThetaWin, halfPhiWin);
+        posX = sums.windowSum(xPlane, iTheta, iPhi, halfThetaWin, halfPhiWin) / sumEnergyPos;
+        posY = sums.windowSum(yPlane, iTheta, iPhi, halfThetaWin, halfPhiWin) / sumEnergyPos;
+        posZ = sums.windowSum(zPlane, iTheta, iPhi, halfThetaWin, halfPhiWin) / sumEnergyPos;
+      }
+      // Final cluster position
+      idThetaFin = m_towerTool->idTheta(atan2(sqrt(posX * posX + posY * posY), posZ));
+      idPhiFin = m_towerTool->idPhi(atan2(posY, posX));
+      // Recalculating the energy within the final cluster size (towers outside of the map in theta are skipped)
+      if (m_ellipseFinalCluster) {
+        sumEnergyFin = sums.ellipseSum(energyPlane, idThetaFin, idPhiFin, halfThetaFin, halfPhiFin,
+                                       m_nThetaFinal / 2., m_nPhiFinal / 2.);
+      } else {
+        sumEnergyFin = sums.windowSum(energyPlane, idThetaFin, idPhiFin, halfThetaFin, halfPhiFin);
+      }
+      // check if changing the barycentre did not decrease energy below threshold
+      if (sumEnergyFin > m_energyThreshold) {
+        precluster newPreCluster;
+        newPreCluster.X = posX;
+        newPreCluster.Y = posY;
+        newPreCluster.Z = posZ;
+        newPreCluster.theta = atan2(sqrt(posX * posX + posY * posY), posZ);
+        newPreCluster.phi = atan2(posY, posX);
+        newPreCluster.transEnergy = sumEnergyFin;
+        preClusters.push_back(newPreCluster);
+      }
     }
   }
 
-  debug() << "Pre-clusters size before duplicates removal: " << m_preClusters.size() << endmsg;
+  debug() << "Pre-clusters size before duplicates removal: " << preClusters.size() << endmsg;
 
   // 4. Sort the preclusters according to the transverse energy (descending)
-  std::sort(m_preClusters.begin(), m_preClusters.end(),
+  std::sort(preClusters.begin(), preClusters.end(),
             [](precluster clu1, precluster clu2) { return clu1.transEnergy > clu2.transEnergy; });
 
   // 5. Remove duplicates
-  for (auto it1 = m_preClusters.begin(); it1 != m_preClusters.end(); it1++) {
-    // loop over all clusters with energy lower than it1 (sorting), erase if too close
-    for (auto it2 = it1 + 1; it2 != m_preClusters.end();) {
-      if ((abs(int(m_towerTool->idTheta((*it1).theta) - m_towerTool->idTheta((*it2).theta))) < m_nThetaDuplicates) &&
-          ((abs(int(m_towerTool->idPhi((*it1).phi) - m_towerTool->idPhi((*it2).phi))) < m_nPhiDuplicates) ||
-           (abs(int(m_towerTool->idPhi((*it1).phi) - m_towerTool->idPhi((*it2).phi))) >
-            m_nPhiTower - m_nPhiDuplicates))) {
-        m_preClusters.erase(it2);
-      } else {
-        it2++;
+  // a pre-cluster is removed if a kept one of higher energy is too close; the kept clusters near each pre-cluster
+  // are found from buckets of towers, rather than by comparing all pairs
+  std::vector<int> idThetaPreClusters(preClusters.size());
+  std::vector<int> idPhiPreClusters(preClusters.size());
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    idThetaPreClusters[iClu] = m_towerTool->idTheta(preClusters[iClu].theta);
+    idPhiPreClusters[iClu] = m_towerTool->idPhi(preClusters[iClu].phi);
+  }
+  std::vector<k4::recCalo::TowerBucketGrid::index_t> neighbours;
+  k4::recCalo::TowerBucketGrid duplicatesGrid(m_nThetaTower, m_nPhiTower, m_nThetaDuplicates, m_nPhiDuplicates);
+  duplicatesGrid.fill(idThetaPreClusters, idPhiPreClusters);
+  std::vector<bool> isDuplicate(preClusters.size(), false);
+  size_t nKept = 0;
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    duplicatesGrid.query(idThetaPreClusters[iClu], idPhiPreClusters[iClu], m_nThetaDuplicates - 1,
+                         m_nPhiDuplicates - 1, neighbours);
+    // only the clusters with higher energy (sorting) which are kept can remove this one
+    for (auto iOther : neighbours) {
+      if (iOther >= iClu) {
+        break;
+      }
+      if (!isDuplicate[iOther] && abs(idThetaPreClusters[iOther] - idThetaPreClusters[iClu]) < m_nThetaDuplicates &&
+          ((abs(idPhiPreClusters[iOther] - idPhiPreClusters[iClu]) < m_nPhiDuplicates) ||
+           (abs(idPhiPreClusters[iOther] - idPhiPreClusters[iClu]) > m_nPhiTower - m_nPhiDuplicates))) {
+        isDuplicate[iClu] = true;
+        break;
       }
     }
+    if (!isDuplicate[iClu]) {
+      preClusters[nKept] = preClusters[iClu];
+      idThetaPreClusters[nKept] = idThetaPreClusters[iClu];
+      idPhiPreClusters[nKept] = idPhiPreClusters[iClu];
+      nKept++;
+    }
   }
-  debug() << "Pre-clusters size after duplicates removal: " << m_preClusters.size() << endmsg;
+  preClusters.resize(nKept);
+  idThetaPreClusters.resize(nKept);
+  idPhiPreClusters.resize(nKept);
+  debug() << "Pre-clusters size after duplicates removal: " << preClusters.size() << endmsg;
 
   // 6. Create final clusters
-  for (const auto clu : m_preClusters) {
+  // energy sharing between clusters overlapping in the towers of the final cluster size
+  k4::recCalo::TowerEnergySharing sharing(m_nThetaTower, m_nPhiTower, halfThetaFin, halfPhiFin);
+  // energies of the towers, from their transverse energies
+  std::vector<float> sharingEnergies;
+  if (m_energySharingCorrection) {
+    sharing.fill(idThetaPreClusters, idPhiPreClusters);
+    sharingEnergies.resize(towers.size());
+    for (int iTheta = 0; iTheta < m_nThetaTower; iTheta++) {
+      const auto sinTheta = sin(m_towerTool->theta(iTheta));
+      for (int iPhi = 0; iPhi < m_nPhiTower; iPhi++) {
+        sharingEnergies[towers.tower(iTheta, iPhi)] = towers[iTheta][iPhi] / sinTheta;
+      }
+    }
+  }
+  for (size_t iClu = 0; iClu < preClusters.size(); iClu++) {
+    const auto& clu = preClusters[iClu];
     float clusterEnergy = clu.transEnergy / sin(clu.theta);
     // apply energy sharing correction (if flag set to true)
     if (m_energySharingCorrection) {
-      int idThetaCl = m_towerTool->idTheta(clu.theta);
-      int idPhiCl = m_towerTool->idPhi(clu.phi);
-      // sum of energies in other clusters in each theta-phi tower of our current cluster (idThetaCl, idPhiCl)
-      std::vector<std::vector<float>> sumEnergySharing;
-      sumEnergySharing.assign(m_nThetaFinal, std::vector<float>(m_nPhiFinal, 0));
-      // loop over all clusters and check if they have any tower in common with our current cluster
-      for (const auto cluSharing : m_preClusters) {
-        int idThetaClShare = m_towerTool->idTheta(cluSharing.theta);
-        int idPhiClShare = m_towerTool->idPhi(cluSharing.phi);
-        if (idThetaCl != idThetaClShare && idPhiCl != idPhiClShare) {
-          // check for overlap between clusters
-          if (abs(idThetaClShare - idThetaCl) < m_nThetaFinal &&
-              ((abs(idPhiClShare - idPhiCl) < m_nPhiFinal) ||
-               (abs(idPhiClShare - idPhiCl) > m_nPhiTower - m_nPhiFinal))) {
-            // add energy in shared towers to sumEnergySharing[][]
-            for (int iTheta = std::max(idThetaCl, idThetaClShare) - halfThetaFin;
-                 iTheta <= std::min(idThetaCl, idThetaClShare) + halfThetaFin; iTheta++) {
-              for (int iPhi = std::max(idPhiCl, idPhiClShare) - halfPhiFin;
-                   iTheta <= std::min(idPhiCl, idPhiClShare) + halfPhiFin; iPhi++) {
-                if (iTheta >= 0 && iTheta < m_nThetaTower) { // check if we are not outside of map in theta
-                  sumEnergySharing[iTheta - idThetaCl + halfThetaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)] +=
-                      m_towers[iTheta][phiNeighbour(iPhi)] / sin(m_towerTool->theta(iTheta));
-                }
-              }
-            }
-          }
-        }
-      }
-      // apply the actual correction: substract the weighted energy contributions in other clusters
-      for (int iTheta = idThetaCl - halfThetaFin; iTheta <= idThetaCl + halfThetaFin; iTheta++) {
-        for (int iPhi = idPhiCl - halfPhiFin; iPhi <= idPhiCl + halfPhiFin; iPhi++) {
-          if (iTheta - idThetaCl + halfThetaFin >= 0)
-            if (sumEnergySharing[iTheta - idThetaCl + halfThetaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)] != 0) {
-              float sumButOne =
-                  sumEnergySharing[iTheta - idThetaCl + halfThetaFin][phiNeighbour(iPhi - idPhiCl + halfPhiFin)];
-              float towerEnergy = m_towers[iTheta][phiNeighbour(iPhi)] / sin(m_towerTool->theta(iTheta));
-              clusterEnergy -= towerEnergy * sumButOne / (sumButOne + towerEnergy);
-            }
-        }
-      }
+      clusterEnergy = sharing.correct(sharingEnergies, iClu, clusterEnergy);
     }
-
     // save the clusters in our EDM
     // check ET threshold once more (ET could change with the energy sharing correction)
     if (clusterEnergy * sin(clu.theta) > m_energyThreshold) {
@@ -335,7 +259,7 @@ StatusCode CreateCaloClustersSlidingWindowFCCee::execute(const EventContext&) co
       cluster.setPosition(edm4hep::Vector3f(clu.X, clu.Y, clu.Z));
       cluster.setEnergy(clusterEnergy);
       debug() << "Attaching cells to the clusters." << endmsg;
-      m_towerTool->attachCells(clu.theta, clu.phi, halfThetaFin, halfPhiFin, cluster, clusterCells,
+      m_towerTool->attachCells(caloTowers, clu.theta, clu.phi, halfThetaFin, halfPhiFin, cluster, clusterCells,
                                m_ellipseFinalCluster);
       debug() << "Cluster theta: " << clu.theta << " phi: " << clu.phi << " x: " << cluster.getPosition().x
               << " y: " << cluster.getPosition().y << " z: " << cluster.getPosition().z
@@ -346,12 +270,3 @@ StatusCode CreateCaloClustersSlidingWindowFCCee::execute(const EventContext&) co
 }
 
 StatusCode CreateCaloClustersSlidingWindowFCCee::finalize() { return Gaudi::Algorithm::finalize(); }
-
-unsigned int CreateCaloClustersSlidingWindowFCCee::phiNeighbour(int aIPhi) const {
-  if (aIPhi < 0) {
-    return m_nPhiTower + aIPhi;
-  } else if (aIPhi >= m_nPhiTower) {
-    return aIPhi % m_nPhiTower;
-  }
-  return aIPhi;
-}
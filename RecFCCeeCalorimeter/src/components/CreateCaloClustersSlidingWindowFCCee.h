@@ -81,13 +81,6 @@ private:
     float Z;
   };
 
-  /**  Correct way to access the neighbour of the phi tower, taking into account the full coverage in phi.
-   *   Full coverage means that first tower in phi, with ID = 0 is a direct neighbour
-   *   of the last tower in phi with ID = m_nPhiTower - 1).
-   *   @param[in] aIPhi requested ID of a phi tower, may be < 0 or >= m_nPhiTower
-   *   @return  ID of a tower - shifted and corrected (in [0, m_nPhiTower) range)
-   */
-  unsigned int phiNeighbour(int aIPhi) const;
   /// Handle for calo clusters (output collection)
   mutable k4FWCore::DataHandle<edm4hep::ClusterCollection> m_clusters{"calo/clusters", Gaudi::DataHandle::Writer, this};
   /// Handle for calo cluster cells (output collection)
@@ -95,10 +88,6 @@ private:
                                                                                  Gaudi::DataHandle::Writer, this};
   /// Handle for the tower building tool
   mutable ToolHandle<k4::recCalo::ITowerToolThetaModule> m_towerTool;
-  /// Calorimeter towers
-  mutable std::vector<std::vector<float>> m_towers;
-  /// Vector of pre-clusters
-  mutable std::vector<precluster> m_preClusters;
   /// number of towers in theta (calculated from m_deltaThetaTower and the theta size of the first layer)
   int m_nThetaTower;
   /// Number of towers in phi (calculated from m_deltaPhiTower)
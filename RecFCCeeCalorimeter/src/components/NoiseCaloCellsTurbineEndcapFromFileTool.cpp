@@ -1,4 +1,5 @@
 #include "NoiseCaloCellsTurbineEndcapFromFileTool.h"
+#include "RecCaloCommon/EventRng.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 
 // k4geo
@@ -21,8 +22,7 @@ DECLARE_COMPONENT(NoiseCaloCellsTurbineEndcapFromFileTool)
 StatusCode NoiseCaloCellsTurbineEndcapFromFileTool::initialize() {
   K4RECCALORIMETER_CHECK(m_geoSvc.retrieve());
   K4RECCALORIMETER_CHECK(m_cellPositionsTool.retrieve());
-  K4RECCALORIMETER_CHECK(m_randSvc = service<IRndmGenSvc>("RndmGenSvc", false));
-  K4RECCALORIMETER_CHECK(m_gauss.initialize(m_randSvc, Rndm::Gauss(0., 1.)));
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   // open and check file, read the histograms with noise constants
   K4RECCALORIMETER_CHECK(initNoiseFromFile());
@@ -41,9 +41,10 @@ StatusCode NoiseCaloCellsTurbineEndcapFromFileTool::initialize() {
 
 template <class C>
 void NoiseCaloCellsTurbineEndcapFromFileTool::addRandomCellNoiseT(C& aCells) const {
+  k4::recCalo::CounterRng rng = k4::recCalo::eventRng(m_randomSeed, m_rngStream);
   for (auto& p : aCells) {
     p.second += getNoiseOffsetPerCell(p.first);
-    p.second += (getNoiseRMSPerCell(p.first) * m_gauss.shoot());
+    p.second += (getNoiseRMSPerCell(p.first) * rng.gauss(p.first));
   }
 }
 
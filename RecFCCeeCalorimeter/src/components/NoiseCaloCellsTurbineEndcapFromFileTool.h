@@ -3,8 +3,6 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 
 // k4geo
 // #include "detectorSegmentations/FCCSWGridPhiEta_k4geo.h"
@@ -25,7 +23,8 @@ class TH1F;
  *  Access noise constants from TH1F histogram (noise vs. calibration layer)
  *  createRandomCellNoise: Create random CaloHits (gaussian distribution) for the vector of cells
  *  filterCellNoise: remove cells with energy below threshold*sigma from the vector of cells
- *
+ *  The noise of each cell is drawn from a k4::recCalo::CounterRng, and depends only on
+ *  "randomSeed", the tool name, the run and event numbers, and the cell ID.
  *
  *  @author Erich Varnes
  *  @date   2026-03
@@ -123,10 +122,12 @@ private:
   /// Histograms with electronics noise offset (histograms binned in rho and z, array index -- wheel )
   std::vector<TH2F> m_histoElecNoiseOffset;
 
-  /// Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  /// Gaussian random number generator used for the generation of random noise hits
-  Rndm::Numbers m_gauss;
+  /// Seed for the noise random numbers, which also depend on the run, event, and cell ID
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0,
+                                         "Seed for the noise random numbers; they also depend on the run, event, "
+                                         "and cell ID, and on the name of this tool"};
+  /// Random number stream of this tool, made from its name
+  uint64_t m_rngStream = 0;
 
   /// Pointer to the geometry service
   ServiceHandle<IGeoSvc> m_geoSvc{this, "GeoSvc", "GeoSvc"};
@@ -1,4 +1,5 @@
 #include "NoiseCaloCellsVsThetaFromFileTool.h"
+#include "RecCaloCommon/EventRng.h"
 #include "RecCaloCommon/k4RecCalorimeter_check.h"
 
 // k4geo
@@ -18,11 +19,24 @@
 
 DECLARE_COMPONENT(NoiseCaloCellsVsThetaFromFileTool)
 
+namespace {
+
+/// Return the IDs of a collection of cells, in iteration order.
+template <typename C>
+std::vector<uint64_t> cellIDsOf(const C& aCells) {
+  std::vector<uint64_t> ids;
+  ids.reserve(aCells.size());
+  for (const auto& p : aCells)
+    ids.push_back(p.first);
+  return ids;
+}
+
+} // anonymous namespace
+
 StatusCode NoiseCaloCellsVsThetaFromFileTool::initialize() {
   K4RECCALORIMETER_CHECK(m_geoSvc.retrieve());
   K4RECCALORIMETER_CHECK(m_cellPositionsTool.retrieve());
-  K4RECCALORIMETER_CHECK(m_randSvc = service<IRndmGenSvc>("RndmGenSvc", false));
-  K4RECCALORIMETER_CHECK(m_gauss.initialize(m_randSvc, Rndm::Gauss(0., 1.)));
+  m_rngStream = k4::recCalo::CounterRng::streamID(name());
 
   // open and check file, read the histograms with noise constants
   K4RECCALORIMETER_CHECK(initNoiseFromFile());
@@ -34,6 +48,23 @@ StatusCode NoiseCaloCellsVsThetaFromFileTool::initialize() {
 
   debug() << "Filter noise threshold: " << m_filterThreshold << "*sigma" << endmsg;
 
+  // Cache the noise of all cells of the geometry tool
+  if (!m_geoTool.empty()) {
+    if (!m_geoTool.retrieve()) {
+      error() << "Unable to retrieve the geometry tool!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_indexer = m_geoTool->indexer();
+    if (!m_indexer) {
+      error() << "Geometry tool " << m_geoTool.name() << " does not provide an indexer!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_noiseTable = std::make_unique<const k4::recCalo::IndexedNoiseTable>(*m_indexer, [this](CellID id) {
+      return std::make_pair(computeNoiseRMSPerCell(id), computeNoiseOffsetPerCell(id));
+    });
+    info() << "Cached the noise of " << m_noiseTable->size() << " cells" << endmsg;
+  }
+
   K4RECCALORIMETER_CHECK(AlgTool::initialize());
 
   return StatusCode::SUCCESS;
@@ -41,9 +72,16 @@ StatusCode NoiseCaloCellsVsThetaFromFileTool::initialize() {
 
 template <class C>
 void NoiseCaloCellsVsThetaFromFileTool::addRandomCellNoiseT(C& aCells) const {
+  std::vector<uint64_t> ids = cellIDsOf(aCells);
+  std::vector<std::pair<double, double>> noise = getNoise(ids);
+  std::vector<double> gauss(ids.size());
+  k4::recCalo::eventRng(m_randomSeed, m_rngStream).gauss(ids, gauss);
+  size_t i = 0;
   for (auto& p : aCells) {
-    p.second += getNoiseOffsetPerCell(p.first);
-    p.second += (getNoiseRMSPerCell(p.first) * m_gauss.shoot());
+    auto [rms, offset] = noise[i];
+    p.second += offset;
+    p.second += (rms * gauss[i]);
+    ++i;
   }
 }
 
@@ -58,17 +96,51 @@ void NoiseCaloCellsVsThetaFromFileTool::addRandomCellNoise(std::vector<std::pair
 template <typename C>
 void NoiseCaloCellsVsThetaFromFileTool::filterCellNoiseT(C& aCells) const {
   // Erase a cell if it has energy below a threshold from the vector
-  if (m_useAbsInFilter) {
-    std::erase_if(aCells, [&](auto& p) {
-      return std::abs(p.second - getNoiseOffsetPerCell(p.first)) < m_filterThreshold * getNoiseRMSPerCell(p.first);
-    });
+  std::vector<std::pair<double, double>> noise = getNoise(cellIDsOf(aCells));
+  auto drop = [&](double energy, const std::pair<double, double>& n) {
+    auto [rms, offset] = n;
+    if (m_useAbsInFilter)
+      return std::abs(energy - offset) < m_filterThreshold * rms;
+    return energy < offset + m_filterThreshold * rms;
+  };
+  size_t i = 0;
+  if constexpr (requires { aCells.contains(0); }) {
+    for (auto it = aCells.begin(); it != aCells.end();) {
+      if (drop(it->second, noise[i++]))
+        it = aCells.erase(it);
+      else
+        ++it;
+    }
   } else {
-    std::erase_if(aCells, [&](auto& p) {
-      return p.second < getNoiseOffsetPerCell(p.first) + m_filterThreshold * getNoiseRMSPerCell(p.first);
-    });
+    size_t nkeep = 0;
+    for (; i < aCells.size(); ++i) {
+      if (!drop(aCells[i].second, noise[i]))
+        aCells[nkeep++] = aCells[i];
+    }
+    aCells.resize(nkeep);
   }
 }
 
+std::vector<std::pair<double, double>>
+NoiseCaloCellsVsThetaFromFileTool::getNoise(std::span<const CellID> ids) const {
+  std::vector<std::pair<double, double>> noise;
+  noise.reserve(ids.size());
+  if (!m_noiseTable) {
+    for (CellID id : ids)
+      noise.push_back(std::make_pair(computeNoiseRMSPerCell(id), computeNoiseOffsetPerCell(id)));
+    return noise;
+  }
+  std::vector<k4::recCalo::ICaloIndexer::index_t> indices(ids.size());
+  m_indexer->indices(ids, indices);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (indices[i] != k4::recCalo::ICaloIndexer::INVALID)
+      noise.push_back(m_noiseTable->noise(indices[i]));
+    else
+      noise.push_back(std::make_pair(computeNoiseRMSPerCell(ids[i]), computeNoiseOffsetPerCell(ids[i])));
+  }
+  return noise;
+}
+
 void NoiseCaloCellsVsThetaFromFileTool::filterCellNoise(std::unordered_map<CellID, double>& aCells) const {
   filterCellNoiseT(aCells);
 }
@@ -175,6 +247,37 @@ StatusCode NoiseCaloCellsVsThetaFromFileTool::initNoiseFromFile() {
 }
 
 double NoiseCaloCellsVsThetaFromFileTool::getNoiseRMSPerCell(CellID aCellId) const {
+  if (m_noiseTable) {
+    k4::recCalo::ICaloIndexer::index_t ndx = m_indexer->index(aCellId);
+    if (ndx != k4::recCalo::ICaloIndexer::INVALID)
+      return m_noiseTable->noiseRMS(ndx);
+  }
+  return computeNoiseRMSPerCell(aCellId);
+}
+
+double NoiseCaloCellsVsThetaFromFileTool::getNoiseOffsetPerCell(CellID aCellId) const {
+  if (m_noiseTable) {
+    k4::recCalo::ICaloIndexer::index_t ndx = m_indexer->index(aCellId);
+    if (ndx != k4::recCalo::ICaloIndexer::INVALID)
+      return m_noiseTable->noiseOffset(ndx);
+  }
+  return computeNoiseOffsetPerCell(aCellId);
+}
+
+std::pair<double, double> NoiseCaloCellsVsThetaFromFileTool::getNoisePerCell(CellID aCellId) const {
+  if (m_noiseTable) {
+    k4::recCalo::ICaloIndexer::index_t ndx = m_indexer->index(aCellId);
+    if (ndx != k4::recCalo::ICaloIndexer::INVALID)
+      return m_noiseTable->noise(ndx);
+  }
+  return std::make_pair(computeNoiseRMSPerCell(aCellId), computeNoiseOffsetPerCell(aCellId));
+}
+
+const k4::recCalo::IndexedNoiseTable* NoiseCaloCellsVsThetaFromFileTool::indexedNoiseTable() const {
+  return m_noiseTable.get();
+}
+
+double NoiseCaloCellsVsThetaFromFileTool::computeNoiseRMSPerCell(CellID aCellId) const {
 
   double elecNoiseRMS = 0.;
   double pileupNoiseRMS = 0.;
@@ -218,7 +321,7 @@ double NoiseCaloCellsVsThetaFromFileTool::getNoiseRMSPerCell(CellID aCellId) con
   return totalNoiseRMS;
 }
 
-double NoiseCaloCellsVsThetaFromFileTool::getNoiseOffsetPerCell(CellID aCellId) const {
+double NoiseCaloCellsVsThetaFromFileTool::computeNoiseOffsetPerCell(CellID aCellId) const {
 
   if (!m_setNoiseOffset)
     return 0.;
@@ -263,7 +366,3 @@ double NoiseCaloCellsVsThetaFromFileTool::getNoiseOffsetPerCell(CellID aCellId)
 
   return totalNoiseOffset;
 }
-
-std::pair<double, double> NoiseCaloCellsVsThetaFromFileTool::getNoisePerCell(CellID aCellId) const {
-  return std::make_pair(getNoiseRMSPerCell(aCellId), getNoiseOffsetPerCell(aCellId));
-}
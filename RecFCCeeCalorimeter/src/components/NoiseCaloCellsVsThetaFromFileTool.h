@@ -3,16 +3,19 @@
 
 // from Gaudi
 #include "GaudiKernel/AlgTool.h"
-#include "GaudiKernel/IRndmGenSvc.h"
-#include "GaudiKernel/RndmGenerators.h"
 
 // k4geo
 // #include "detectorSegmentations/FCCSWGridPhiEta_k4geo.h"
 
 // Interfaces
+#include "RecCaloCommon/ICaloIndexer.h"
+#include "RecCaloCommon/ICalorimeterTool.h"
 #include "RecCaloCommon/ICellPositionsTool.h"
 #include "RecCaloCommon/INoiseCaloCellsTool.h"
 #include "RecCaloCommon/INoiseConstTool.h"
+#include "RecCaloCommon/IndexedNoiseTable.h"
+
+#include <memory>
 
 class IGeoSvc;
 
@@ -32,6 +35,13 @@ class TH1F;
  * - save directly the noise histograms as histos of noise vs thetaID
  * - or, keep histos of noise vs theta, but change the interfaces and the tool to accept
  *   cells rather than cellIDs as input. One would then get theta from the cells.
+ * The random numbers are drawn from a k4::recCalo::CounterRng keyed by "randomSeed", the tool name,
+ * and the run and event numbers, with the cell ID as the counter, so that the noise does not depend
+ * on the order in which events are processed or on the number of threads.
+ * Alternatively, if "geometryTool" is set, the noise RMS and offset of all of its cells are computed
+ * once at initialize and stored (in single precision) in arrays indexed by the indexer of that tool.
+ * The positioning tool is then only used for cells not known to the geometry tool.
+ * The table is also returned by indexedNoiseTable(), for use by the topo-clustering.
  *
  *  @author Giovanni Marchiori
  *  @date   2024-07
@@ -71,13 +81,24 @@ public:
   virtual double getNoiseRMSPerCell(CellID aCellID) const override final;
   virtual double getNoiseOffsetPerCell(CellID aCellID) const override final;
   virtual std::pair<double, double> getNoisePerCell(CellID aCellID) const override final;
+  /// Table of the noise of the cells of the geometry tool, or nullptr if not cached
+  virtual const k4::recCalo::IndexedNoiseTable* indexedNoiseTable() const override final;
 
 private:
+  /// Find the noise RMS of a cell from the histograms.
+  double computeNoiseRMSPerCell(CellID aCellID) const;
+  /// Find the noise offset of a cell from the histograms.
+  double computeNoiseOffsetPerCell(CellID aCellID) const;
+  /// Find the noise [rms, offset] of a set of cells, using the cached table where possible.
+  std::vector<std::pair<double, double>> getNoise(std::span<const CellID> aCellIDs) const;
   template <typename C>
   void addRandomCellNoiseT(C& aCells) const;
   template <typename C>
   void filterCellNoiseT(C& aCells) const;
 
+  /// Handle for the geometry tool, whose cells have their noise cached
+  ToolHandle<k4::recCalo::ICalorimeterTool> m_geoTool{
+      this, "geometryTool", "", "Handle for the geometry tool; if set, the noise of its cells is cached at initialize"};
   /// Handle for tool to get cell positions
   ToolHandle<k4::recCalo::ICellPositionsTool> m_cellPositionsTool{this, "cellPositionsTool", "CellPositionsDummyTool",
                                                                   "Handle for tool to retrieve cell positions"};
@@ -132,10 +153,17 @@ private:
   /// Histograms with electronics noise offset (index in array - radial layer)
   std::vector<TH1F> m_histoElecNoiseOffset;
 
-  /// Random Number Service
-  SmartIF<IRndmGenSvc> m_randSvc;
-  /// Gaussian random number generator used for the generation of random noise hits
-  Rndm::Numbers m_gauss;
+  /// Indexer of the geometry tool, or nullptr if the noise is not cached.
+  std::unique_ptr<k4::recCalo::ICaloIndexer> m_indexer;
+  /// Noise of the cells of the geometry tool.
+  std::unique_ptr<const k4::recCalo::IndexedNoiseTable> m_noiseTable;
+
+  /// Seed for the noise random numbers, which also depend on the run, event, and cell ID
+  Gaudi::Property<uint64_t> m_randomSeed{this, "randomSeed", 0,
+                                         "Seed for the noise random numbers; they also depend on the run, event, "
+                                         "and cell ID, and on the name of this tool"};
+  /// Random number stream of this tool, made from its name
+  uint64_t m_rngStream = 0;
 
   /// Pointer to the geometry service
   ServiceHandle<IGeoSvc> m_geoSvc{this, "GeoSvc", "GeoSvc"};
@@ -428,22 +428,23 @@ if addNoise:
         scaleFactor=1 / 1000.0,  # MeV to GeV
         OutputLevel=INFO,
     )
-
-    from Configurables import TubeLayerModuleThetaCaloTool
-
-    ecalBarrelGeometryTool = TubeLayerModuleThetaCaloTool(
-        "ecalBarrelGeometryTool",
-        readoutName=ecalBarrelReadoutName,
-        activeVolumeName="LAr_sensitive",
-        activeFieldName="layer",
-        activeVolumesNumber=ecalBarrelLayers,
-        fieldNames=["system"],
-        fieldValues=[IDs["ECAL_Barrel"]],
-        OutputLevel=INFO,
-    )
 else:
     ecalBarrelNoiseTool = None
-    ecalBarrelGeometryTool = None
+
+# - geometry tool: list of all cells of the ECal barrel, used to add noise
+#   to empty cells, to index the cells and to precompute their positions
+from Configurables import TubeLayerModuleThetaCaloTool
+
+ecalBarrelGeometryTool = TubeLayerModuleThetaCaloTool(
+    "ecalBarrelGeometryTool",
+    readoutName=ecalBarrelReadoutName,
+    activeVolumeName="LAr_sensitive",
+    activeFieldName="layer",
+    activeVolumesNumber=ecalBarrelLayers,
+    fieldNames=["system"],
+    fieldValues=[IDs["ECAL_Barrel"]],
+    OutputLevel=INFO,
+)
 
 # Create cells in ECal barrel (calibrated and positioned - optionally with xtalk and noise added)
 # from uncalibrated cells (+cellID info) from ddsim
@@ -460,6 +461,7 @@ createEcalBarrelCells = CreatePositionedCaloCells(
     crosstalkTool=readCrosstalkMap,
     addCellNoise=False,
     filterCellNoise=False,
+    geometryTool=ecalBarrelGeometryTool,
     OutputLevel=INFO,
     hits=ecalBarrelReadoutName,
     cells=ecalBarrelPositionedCellsName,
@@ -0,0 +1,130 @@
+from Gaudi.Configuration import INFO
+from Configurables import (
+    CaloDigitizerFunc,
+    CaloAddNoise2Digits,
+    CaloOptimalFilter,
+    CaloOptimalFilterRaw,
+    CaloQuantizeDigits,
+)
+from k4FWCore import ApplicationMgr, IOSvc
+
+
+# Additional information on this algorithm can be found in https://indico.cern.ch/event/1580025/contributions/6686602/attachments/3133485/5559196/FCCDigitization4BNLWorkshopEndOfWeekUpdate.pdf
+
+Nevts = 10  # -1 means all events
+DigitInitTime = 0.0  # Defining the initial time for digitization
+DigitEndTime = 775.0  # time range of the digitization
+PulseSampleLen = 31  # number of samples in the signal pulse shape
+ecalBarrelInputName = (
+    "ECalBarrelModuleThetaMerged"  # name of the ECal barrel readout in input file
+)
+PulseShapeName = "Gaussian"  # name of the signal pulse shape
+GaussianMean = 100.0  # Mean of the Gaussian pulse shape used to represent a "signal"
+GaussianSigma = (
+    20.0  # Standard deviation of the Gaussian pulse shape used to represent a "signal"
+)
+OFSamples = 5  # Number of samples around the peak used by the optimal filter
+
+NumberOfNoiseSamplesToSimulate = 2000  # Number of noise samples to simulate
+NoiseEnergy = (
+    0.001  # Noise mean value to consider (simulation is Gaussian and units are in GeV)
+)
+NoiseWidth = 0.0001  # Width of noise to consider (units in GeV)
+NoiseSampleSimulationFName = "NoiseInfoTest_OptimalFilter.root"  # File name to save the correlation matrix after simulating noise
+
+# The pulses with noise are also stored as 16-bit ADC counts, and the optimal filter is applied to both
+AdcGain = 1e5  # ADC counts per GeV
+AdcPedestal = 1000  # ADC count of a zero amplitude
+AdcBits = 16  # Number of bits of the ADC
+
+io_svc = IOSvc()
+
+io_svc.Input = "ALLEGRO_sim_e.root"  # Input filename from ddsim
+
+io_svc.Output = "output_digitization_optimal_filter.root"  # Output filename
+
+# The collections that we don't drop will also be present in the output file
+io_svc.outputCommands = [
+    "drop Lumi*",
+    "drop Vertex*",
+    "drop DriftChamber_simHits*",
+    "drop MuonTagger*",
+    "drop *SiWr*",
+    "drop ECalEndcap*",
+    "drop HCal*",
+    "drop ECalBarrelDigitized*",
+]
+
+CaloDigitizer = CaloDigitizerFunc(
+    "CaloDigitizerFunc",
+    InputCollection=[ecalBarrelInputName],  # Name of input collection
+    pulseInitTime=DigitInitTime,  # Time of pulse start [ns]
+    pulseEndTime=DigitEndTime,  # Time of pulse ending [ns]
+    pulseSamplingLength=PulseSampleLen,  # Number of samples in the signal pulse shape
+    pulseType=PulseShapeName,  # Name of the signal pulse shape
+    mu=GaussianMean,  # Mean of the Gaussian pulse shape
+    sigma=GaussianSigma,  # Sigma of the Gaussian pulse shape
+    OutputCollection=["ECalBarrelDigitized"],  # Name of output collection
+)
+
+CaloAddNoise = CaloAddNoise2Digits(
+    "CaloAddNoise",
+    InputCollection=["ECalBarrelDigitized"],
+    OutputCollection=["ECalBarrelDigitizedWithNoise"],
+    noiseEnergy=NoiseEnergy,
+    noiseWidth=NoiseWidth,
+    noiseSimSamples=NumberOfNoiseSamplesToSimulate,
+    noiseInfoFileName=NoiseSampleSimulationFName,
+    pulseSamplingLength=PulseSampleLen,
+)
+
+CaloQuantize = CaloQuantizeDigits(
+    "CaloQuantizeDigits",
+    InputCollection=["ECalBarrelDigitizedWithNoise"],
+    OutputCollection=["ECalBarrelDigitsADC"],
+    adcGain=AdcGain,
+    adcPedestal=AdcPedestal,
+    adcBits=AdcBits,
+)
+
+OptimalFilterParams = dict(
+    pulseInitTime=DigitInitTime,  # Time of pulse start [ns]
+    pulseEndTime=DigitEndTime,  # Time of pulse ending [ns]
+    pulseSamplingLength=PulseSampleLen,  # Number of samples in the signal pulse shape
+    nOFSamples=OFSamples,  # Number of samples used by the optimal filter
+    mu=GaussianMean,  # Mean of the Gaussian pulse shape
+    sigma=GaussianSigma,  # Sigma of the Gaussian pulse shape
+    noiseInfoFileName=NoiseSampleSimulationFName,
+    covMatName="CovarianceMatrix",
+    muVecName="NoiseSampleMat_MeansVector",
+)
+
+CaloOF = CaloOptimalFilter(
+    "CaloOptimalFilter",
+    InputCollection=["ECalBarrelDigitizedWithNoise"],  # Name of input collection
+    OutputCollection=["ECalBarrelOptimalFilterHits"],  # Name of output collection
+    **OptimalFilterParams,
+)
+
+CaloOFRaw = CaloOptimalFilterRaw(
+    "CaloOptimalFilterRaw",
+    InputCollection=["ECalBarrelDigitsADC"],  # Name of input collection
+    OutputCollection=["ECalBarrelOptimalFilterHitsFromADC"],  # Name of output collection
+    adcGain=AdcGain,
+    adcPedestal=AdcPedestal,
+    **OptimalFilterParams,
+)
+
+ApplicationMgr(
+    TopAlg=[
+        CaloDigitizer,
+        CaloAddNoise,
+        CaloQuantize,
+        CaloOF,
+        CaloOFRaw,
+    ],
+    EvtSel="NONE",
+    EvtMax=Nevts,
+    ExtSvc=[],
+    OutputLevel=INFO,
+)
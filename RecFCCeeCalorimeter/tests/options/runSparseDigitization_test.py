@@ -0,0 +1,75 @@
+#
+# File: RecFCCeeCalorimeter/tests/options/runSparseDigitization_test.py
+# Date: Oct, 2026
+# Purpose: Test for the sparse mode of CaloDigitizerFunc
+#
+
+import os
+from Gaudi.Configuration import INFO
+from Configurables import (
+    GeoSvc,
+    ConstNoiseTool,
+    CaloDigitizerFunc,
+    k4__recCalo__CaloSparseDigitizationTestAlg,
+)
+from k4FWCore import ApplicationMgr, IOSvc
+
+compactFile = "ALLEGRO_o1_v03.xml"
+pathToDetector = (
+    os.environ.get("K4GEO", "")
+    + "/FCCee/ALLEGRO/compact/"
+    + os.path.splitext(compactFile)[0]
+)
+geoSvc = GeoSvc("GeoSvc", detectors=[os.path.join(pathToDetector, compactFile)])
+
+io_svc = IOSvc()
+io_svc.Input = "ALLEGRO_sim_e.root"  # Input filename from ddsim
+io_svc.Output = "output_sparse_digitization.root"
+io_svc.outputCommands = [
+    "drop *",
+    "keep ECalBarrelDigitized",
+    "keep ECalBarrelSuppressed",
+]
+
+SparseThreshold = 3  # threshold in units of the noise RMS
+SamplingFraction = 0.2  # rough sampling fraction of the ECal barrel
+
+# Noise of the ECal barrel cells, at the calibrated scale
+noiseTool = ConstNoiseTool(
+    "ConstNoiseTool",
+    detectors=["ECAL_Barrel"],
+    detectorsNoiseRMS=[0.0075 / 4],
+    detectorsNoiseOffset=[0.0],
+)
+
+CaloDigitizer = CaloDigitizerFunc(
+    "CaloDigitizerFunc",
+    InputCollection=["ECalBarrelModuleThetaMerged"],
+    OutputCollection=["ECalBarrelDigitized"],
+    SuppressedOutputCollection=["ECalBarrelSuppressed"],
+    pulseInitTime=0.0,
+    pulseEndTime=775.0,
+    pulseSamplingLength=31,
+    sparseMode=True,
+    sparseThreshold=SparseThreshold,
+    samplingFraction=SamplingFraction,
+    noiseTool=noiseTool,
+)
+
+CheckSparse = k4__recCalo__CaloSparseDigitizationTestAlg(
+    "CheckSparseDigitization",
+    InputCollection=["ECalBarrelModuleThetaMerged"],
+    DigitsCollection=["ECalBarrelDigitized"],
+    SuppressedCollection=["ECalBarrelSuppressed"],
+    sparseThreshold=SparseThreshold,
+    samplingFraction=SamplingFraction,
+    noiseTool=noiseTool,
+)
+
+ApplicationMgr(
+    TopAlg=[CaloDigitizer, CheckSparse],
+    EvtSel="NONE",
+    EvtMax=2,
+    ExtSvc=[geoSvc],
+    OutputLevel=INFO,
+)
@@ -0,0 +1,80 @@
+#
+# File: RecFCCeeCalorimeter/tests/options/runWhiteningMismatch_test.py
+# Date: Oct, 2026
+# Purpose: Test that CaloWhitening skips pulses of the wrong length
+#
+
+from Gaudi.Configuration import INFO
+from Configurables import (
+    CaloDigitizerFunc,
+    CaloAddNoise2Digits,
+    CaloWhitening,
+    k4__recCalo__CaloTruncatePulsesTestAlg,
+    k4__recCalo__CaloWhiteningMismatchTestAlg,
+)
+from k4FWCore import ApplicationMgr, IOSvc
+
+PulseSampleLen = 31  # number of samples in the signal pulse shape
+NoiseSampleSimulationFName = "NoiseInfoTest_WhiteningMismatch.root"
+
+io_svc = IOSvc()
+io_svc.Input = "ALLEGRO_sim_e.root"  # Input filename from ddsim
+io_svc.Output = "output_whitening_mismatch.root"
+io_svc.outputCommands = ["drop *", "keep ECalBarrelWhitened*"]
+
+CaloDigitizer = CaloDigitizerFunc(
+    "CaloDigitizerFunc",
+    InputCollection=["ECalBarrelModuleThetaMerged"],
+    OutputCollection=["ECalBarrelDigitized"],
+    pulseInitTime=0.0,
+    pulseEndTime=775.0,
+    pulseSamplingLength=PulseSampleLen,
+)
+
+CaloAddNoise = CaloAddNoise2Digits(
+    "CaloAddNoise",
+    InputCollection=["ECalBarrelDigitized"],
+    OutputCollection=["ECalBarrelDigitizedWithNoise"],
+    noiseEnergy=0.001,
+    noiseWidth=0.0001,
+    noiseSimSamples=2000,
+    noiseInfoFileName=NoiseSampleSimulationFName,
+    pulseSamplingLength=PulseSampleLen,
+)
+
+# Every other pulse loses its last sample
+TruncatePulses = k4__recCalo__CaloTruncatePulsesTestAlg(
+    "TruncatePulses",
+    InputCollection=["ECalBarrelDigitizedWithNoise"],
+    OutputCollection=["ECalBarrelTruncatedDigits"],
+)
+
+# Whiten in both modes, and check that only the pulses of the right length are kept
+algs = [CaloDigitizer, CaloAddNoise, TruncatePulses]
+for batchMode in [True, False]:
+    suffix = "Batch" if batchMode else "PerPulse"
+    algs.append(
+        CaloWhitening(
+            "CaloWhitening" + suffix,
+            InputCollection=["ECalBarrelTruncatedDigits"],
+            OutputCollection=["ECalBarrelWhitened" + suffix],
+            noiseInfoFileName=NoiseSampleSimulationFName,
+            batchMode=batchMode,
+        )
+    )
+    algs.append(
+        k4__recCalo__CaloWhiteningMismatchTestAlg(
+            "CheckWhitening" + suffix,
+            InputCollection=["ECalBarrelTruncatedDigits"],
+            WhitenedCollection=["ECalBarrelWhitened" + suffix],
+            nSamples=PulseSampleLen,
+        )
+    )
+
+ApplicationMgr(
+    TopAlg=algs,
+    EvtSel="NONE",
+    EvtMax=2,
+    ExtSvc=[],
+    OutputLevel=INFO,
+)
@@ -0,0 +1,83 @@
+/**
+ * @file RecFCCeeCalorimeter/tests/src/CaloSparseDigitizationTestAlg.cpp
+ * @date Oct, 2026
+ * @brief Test for the sparse mode of CaloDigitizerFunc.
+ *
+ * Checks that each simulated hit is either digitized or suppressed,
+ * according to the threshold on its energy, in the order of the hits.
+ */
+
+#include "Gaudi/Property.h"
+#include "GaudiKernel/GaudiException.h"
+#include "GaudiKernel/ToolHandle.h"
+#include "RecCaloCommon/INoiseConstTool.h"
+#include "edm4hep/CalorimeterHitCollection.h"
+#include "edm4hep/SimCalorimeterHitCollection.h"
+#include "edm4hep/TimeSeriesCollection.h"
+#include "k4FWCore/Consumer.h"
+#include <atomic>
+#include <string>
+
+namespace k4::recCalo {
+
+struct CaloSparseDigitizationTestAlg final
+    : k4FWCore::Consumer<void(const edm4hep::SimCalorimeterHitCollection&, const edm4hep::TimeSeriesCollection&,
+                              const edm4hep::CalorimeterHitCollection&)> {
+  CaloSparseDigitizationTestAlg(const std::string& name, ISvcLocator* svcLoc)
+      : Consumer(name, svcLoc,
+                 {KeyValues("InputCollection", {"SimCaloHitsCollection"}), KeyValues("DigitsCollection", {"Digits"}),
+                  KeyValues("SuppressedCollection", {"SuppressedHits"})}) {}
+
+  StatusCode initialize() override {
+    if (!m_noiseTool.retrieve()) {
+      error() << "Unable to retrieve the noise tool!!!" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    return StatusCode::SUCCESS;
+  }
+
+  void operator()(const edm4hep::SimCalorimeterHitCollection& hits, const edm4hep::TimeSeriesCollection& digits,
+                  const edm4hep::CalorimeterHitCollection& suppressed) const override {
+    size_t iDigit = 0;
+    size_t iSuppressed = 0;
+    for (const auto& hit : hits) {
+      const auto [rms, offset] = m_noiseTool->getNoisePerCell(hit.getCellID());
+      if (hit.getEnergy() / m_samplingFraction.value() > offset + m_sparseThreshold.value() * rms) {
+        check(iDigit < digits.size() && digits[iDigit++].getCellID() == hit.getCellID(), "Hit not digitized");
+      } else {
+        check(iSuppressed < suppressed.size() && suppressed[iSuppressed++].getCellID() == hit.getCellID(),
+              "Hit not suppressed");
+      }
+    }
+    check(iDigit == digits.size(), "Extra digitized hits");
+    check(iSuppressed == suppressed.size(), "Extra suppressed hits");
+    m_nDigits += iDigit;
+    m_nSuppressed += iSuppressed;
+  }
+
+  StatusCode finalize() override {
+    info() << "Digitized " << m_nDigits.load() << " hits; suppressed " << m_nSuppressed.load() << endmsg;
+    if (m_nDigits == 0 || m_nSuppressed == 0) {
+      error() << "Test needs hits both above and below the threshold" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    return StatusCode::SUCCESS;
+  }
+
+private:
+  void check(bool ok, const std::string& what) const {
+    if (!ok)
+      throw GaudiException(what, name(), StatusCode::FAILURE);
+  }
+
+  Gaudi::Property<double> m_sparseThreshold{this, "sparseThreshold", 3, "Threshold of the digitization"};
+  Gaudi::Property<double> m_samplingFraction{this, "samplingFraction", 1, "Sampling fraction of the digitization"};
+  ToolHandle<k4::recCalo::INoiseConstTool> m_noiseTool{this, "noiseTool", "ConstNoiseTool",
+                                                       "Noise tool of the digitization"};
+  mutable std::atomic<size_t> m_nDigits = 0;
+  mutable std::atomic<size_t> m_nSuppressed = 0;
+};
+
+DECLARE_COMPONENT(k4::recCalo::CaloSparseDigitizationTestAlg);
+
+} // namespace k4::recCalo
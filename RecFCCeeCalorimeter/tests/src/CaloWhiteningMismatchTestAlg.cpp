@@ -0,0 +1,77 @@
+/**
+ * @file RecFCCeeCalorimeter/tests/src/CaloWhiteningMismatchTestAlg.cpp
+ * @date Oct, 2026
+ * @brief Test for CaloWhitening with pulses of the wrong length.
+ *
+ * CaloTruncatePulsesTestAlg drops the last sample of every other pulse
+ * of a collection; CaloWhiteningMismatchTestAlg then checks that the
+ * whitening made a pulse for each of the other cells only.
+ */
+
+#include "Gaudi/Property.h"
+#include "GaudiKernel/GaudiException.h"
+#include "edm4hep/TimeSeriesCollection.h"
+#include "k4FWCore/Consumer.h"
+#include "k4FWCore/Transformer.h"
+#include <string>
+
+namespace k4::recCalo {
+
+struct CaloTruncatePulsesTestAlg final
+    : k4FWCore::Transformer<edm4hep::TimeSeriesCollection(const edm4hep::TimeSeriesCollection&)> {
+  CaloTruncatePulsesTestAlg(const std::string& name, ISvcLocator* svcLoc)
+      : Transformer(name, svcLoc, {KeyValues("InputCollection", {"Digits"})},
+                    {KeyValues("OutputCollection", {"TruncatedDigits"})}) {}
+
+  edm4hep::TimeSeriesCollection operator()(const edm4hep::TimeSeriesCollection& digits) const override {
+    edm4hep::TimeSeriesCollection out;
+    for (size_t i = 0; i < digits.size(); ++i) {
+      const auto digit = digits[i];
+      auto copy = out.create();
+      copy.setCellID(digit.getCellID());
+      copy.setTime(digit.getTime());
+      copy.setInterval(digit.getInterval());
+      const auto amplitudes = digit.getAmplitude();
+      const size_t n = (i % 2 == 1 && !amplitudes.empty()) ? amplitudes.size() - 1 : amplitudes.size();
+      for (size_t j = 0; j < n; ++j)
+        copy.addToAmplitude(amplitudes[j]);
+    }
+    return out;
+  }
+};
+
+struct CaloWhiteningMismatchTestAlg final
+    : k4FWCore::Consumer<void(const edm4hep::TimeSeriesCollection&, const edm4hep::TimeSeriesCollection&)> {
+  CaloWhiteningMismatchTestAlg(const std::string& name, ISvcLocator* svcLoc)
+      : Consumer(name, svcLoc,
+                 {KeyValues("InputCollection", {"TruncatedDigits"}),
+                  KeyValues("WhitenedCollection", {"WhitenedDigits"})}) {}
+
+  void operator()(const edm4hep::TimeSeriesCollection& digits,
+                  const edm4hep::TimeSeriesCollection& whitened) const override {
+    auto check = [&](bool ok, const std::string& what) {
+      if (!ok)
+        throw GaudiException(what, name(), StatusCode::FAILURE);
+    };
+
+    size_t iWhitened = 0;
+    for (const auto& digit : digits) {
+      if (digit.getAmplitude().size() != m_nSamples.value())
+        continue;
+      check(iWhitened < whitened.size(), "Missing whitened pulse");
+      const auto pulse = whitened[iWhitened++];
+      check(pulse.getCellID() == digit.getCellID(), "Whitened pulse for the wrong cell");
+      check(pulse.getAmplitude().size() == m_nSamples.value(), "Whitened pulse of the wrong length");
+    }
+    check(iWhitened == whitened.size(), "Whitened pulse for a pulse of the wrong length");
+    check(iWhitened > 0 && iWhitened < digits.size(), "Test needs pulses of both lengths");
+  }
+
+private:
+  Gaudi::Property<size_t> m_nSamples{this, "nSamples", 31, "Number of samples of the whitening matrix"};
+};
+
+DECLARE_COMPONENT(k4::recCalo::CaloTruncatePulsesTestAlg);
+DECLARE_COMPONENT(k4::recCalo::CaloWhiteningMismatchTestAlg);
+
+} // namespace k4::recCalo